@@ -0,0 +1,64 @@
+#include "calculator_concurrent.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Бенчмарк масштабирования evaluateBatch по числу потоков
+ *
+ * Вычисляет пакет случайных операций в пулах из 1, 2, 4, ... потоков (до --max-threads,
+ * по умолчанию 32) и печатает пропускную способность, ускорение и эффективность
+ * относительно одного потока. Ускорение выше числа аппаратных потоков машины не ожидается.
+ * Использование: calculator_batch_scaling [--count N] [--max-threads T] [--runs R]
+ */
+int main(int argc, char* argv[]) {
+    size_t count = 4000000;
+    size_t maxThreads = 32;
+    int runs = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--count")
+            count = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--max-threads")
+            maxThreads = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--runs")
+            runs = std::atoi(argv[i + 1]);
+    }
+
+    const Operation ops[] = { Operation::Add, Operation::Subtract, Operation::Multiply, Operation::Divide,
+        Operation::Power, Operation::Factorial, Operation::Sin, Operation::Cos, Operation::Tan, Operation::Cot };
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> operand(-360.0, 360.0);
+    std::vector<EvaluationRequest> requests(count);
+    for (auto& request : requests) {
+        request.op = ops[random() % 10];
+        request.a = request.op == Operation::Factorial ? static_cast<double>(random() % 40) : operand(random);
+        request.b = operand(random) / 100.0;
+    }
+    std::vector<EvaluationResult> results(count);
+
+    std::cout << "batch of " << count << " requests, " << std::thread::hardware_concurrency()
+        << " hardware threads\n";
+    double baseline = 0.0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        evaluateBatch(pool, requests.data(), results.data(), count);
+        double best = 1e30;
+        for (int r = 0; r < runs; r++) {
+            auto start = std::chrono::steady_clock::now();
+            evaluateBatch(pool, requests.data(), results.data(), count);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        double throughput = count / best;
+        if (threads == 1)
+            baseline = throughput;
+        std::cout << threads << " threads: " << static_cast<uint64_t>(throughput) << " ops/s, speedup "
+            << throughput / baseline << "x, efficiency " << 100.0 * throughput / baseline / threads << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "calculator_c.h"
+#include "calculator_math.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Лучшее из runs время вызова body, в наносекундах на элемент
+ */
+template <typename F>
+static double measure(size_t count, int runs, F body) {
+    double best = 1e30;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best / static_cast<double>(count);
+}
+
+/**
+ * @brief Печатает время и контрольную сумму результатов, чтобы вычисления не были выброшены оптимизатором
+ */
+static void report(const char* name, double nanoseconds, double checksum) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+              << nanoseconds << " ns/value   (checksum " << std::setprecision(6) << checksum << ")\n";
+}
+
+/**
+ * @brief Бенчмарк накладных расходов C ABI (calculator_c.h) на одно значение
+ *
+ * Сравнивает вызов через границу библиотеки по одному значению и пакетные функции
+ * с прямыми вызовами C++ (tryEvaluate, Expression) и со строковым интерфейсом
+ * applyBinaryOperation, через который значения передавались раньше.
+ * Использование: calculator_c_bench [--count N] [--runs R]
+ */
+int main(int argc, char* argv[]) {
+    size_t count = 1000000;
+    int runs = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--count")
+            count = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--runs")
+            runs = std::atoi(argv[i + 1]);
+    }
+    count = std::max<size_t>(count, 1);
+
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> operand(-360.0, 360.0);
+    std::vector<double> a(count);
+    std::vector<double> b(count);
+    for (size_t i = 0; i < count; i++) {
+        a[i] = operand(random);
+        b[i] = operand(random) / 100.0 + 1.0;
+    }
+    std::vector<double> result(count);
+    auto checksum = [&result]() {
+        double sum = 0.0;
+        for (double value : result)
+            sum += value == value ? value : 0.0;
+        return sum;
+    };
+
+    double time;
+    std::cout << "C ABI " << calc_abi_version() << ", " << count << " values, best of " << runs << " runs\n";
+
+    time = measure(count, runs, [&]() {
+        for (size_t i = 0; i < count; i++)
+            tryEvaluate(Operation::Multiply, a[i], b[i], result[i]);
+    });
+    report("C++ tryEvaluate (Multiply)", time, checksum());
+    time = measure(count, runs, [&]() {
+        const std::string op = "*";
+        for (size_t i = 0; i < count; i++)
+            result[i] = applyBinaryOperation(a[i], op, b[i]);
+    });
+    report("C++ applyBinaryOperation(a, \"*\", b)", time, checksum());
+    time = measure(count, runs, [&]() {
+        for (size_t i = 0; i < count; i++)
+            calc_evaluate_operation(CALC_MULTIPLY, a[i], b[i], &result[i]);
+    });
+    report("C calc_evaluate_operation per value", time, checksum());
+    time = measure(count, runs, [&]() {
+        calc_evaluate_vector(CALC_MULTIPLY, a.data(), b.data(), result.data(), count);
+    });
+    report("C calc_evaluate_vector", time, checksum());
+
+    const char* names[] = { "x", "y" };
+    const char text[] = "x^2 / y + sin x";
+    calc_expression* expression = nullptr;
+    char error[128];
+    if (calc_expression_create(text, sizeof(text) - 1, names, 2, &expression, error, sizeof(error)) != CALC_OK) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    time = measure(count, runs, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            double point[2] = { a[i], b[i] };
+            calc_expression_evaluate(expression, point, &result[i]);
+        }
+    });
+    report("C calc_expression_evaluate per point", time, checksum());
+    const double* columns[2] = { a.data(), b.data() };
+    time = measure(count, runs, [&]() {
+        calc_expression_evaluate_batch(expression, columns, result.data(), count);
+    });
+    report("C calc_expression_evaluate_batch", time, checksum());
+    calc_expression_destroy(expression);
+
+    // Строки выражений: по одной и одним пакетом через переиспользуемый вычислитель
+    size_t lines = std::min<size_t>(count, 200000);
+    std::vector<std::string> texts(lines);
+    std::vector<const char*> pointers(lines);
+    std::vector<size_t> lengths(lines);
+    for (size_t i = 0; i < lines; i++) {
+        texts[i] = std::to_string(i) + " * 3 + sin " + std::to_string(i % 90);
+        pointers[i] = texts[i].c_str();
+        lengths[i] = texts[i].size();
+    }
+    calc_evaluator* evaluator = calc_evaluator_create();
+    if (evaluator == nullptr)
+        return 1;
+    result.assign(lines, 0.0);
+    time = measure(lines, runs, [&]() {
+        for (size_t i = 0; i < lines; i++)
+            calc_evaluate_string(evaluator, pointers[i], lengths[i], &result[i], nullptr, 0);
+    });
+    report("C calc_evaluate_string per expression", time, checksum());
+    time = measure(lines, runs, [&]() {
+        calc_evaluate_strings(evaluator, pointers.data(), lengths.data(), lines, result.data(), nullptr);
+    });
+    report("C calc_evaluate_strings", time, checksum());
+    calc_evaluator_destroy(evaluator);
+    return 0;
+}
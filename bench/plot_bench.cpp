@@ -0,0 +1,572 @@
+#include "adaptive_sampler.h"
+#include "baked_font.h"
+#include "heatmap_tiles.h"
+#include "implicit_plotter.h"
+#include "interval_plotter.h"
+#include "parametric_sampler.h"
+#include "plot_export.h"
+#include "png_writer.h"
+#include "plot_decimation.h"
+#include "plot_evaluator.h"
+#include "sample_cache.h"
+#include "surface_renderer.h"
+#include "plot_viewport.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Время перерисовки графика: выборка из SampleCache и построение вершин ломаной
+ */
+static double redrawMs(SampleCache& cache, const PlotViewport& viewport, std::vector<PlotPoint>& points,
+    std::vector<float>& vertices) {
+    auto start = std::chrono::steady_clock::now();
+    cache.sample(viewport.xMin, viewport.xMax, viewport.width, points);
+    vertices.clear();
+    for (const auto& point : points) {
+        if (std::isnan(point.y))
+            continue;
+        vertices.push_back(static_cast<float>(viewport.toScreenX(point.x)));
+        vertices.push_back(static_cast<float>(viewport.toScreenY(point.y)));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief 99-й перцентиль расстояния по вертикали (в пикселях) между ломаной и плотной эталонной выборкой
+ *
+ * Эталонные точки, попадающие на отрезок с разрывом или на пиксель рядом с асимптотой, не учитываются.
+ */
+static double screenError(const std::vector<PlotPoint>& polyline, const std::vector<PlotPoint>& reference,
+    const PlotViewport& viewport) {
+    std::vector<double> errors;
+    double pixel = (viewport.xMax - viewport.xMin) / viewport.width;
+    size_t k = 0;
+    for (const auto& point : reference) {
+        while (k + 1 < polyline.size() && polyline[k + 1].x < point.x)
+            k++;
+        if (k + 1 >= polyline.size() || !std::isfinite(point.y))
+            continue;
+        const PlotPoint& a = polyline[k];
+        const PlotPoint& b = polyline[k + 1];
+        if (!std::isfinite(a.y) || !std::isfinite(b.y) || b.x - a.x > 16 * pixel)
+            continue;
+        double sa = viewport.toScreenY(a.y);
+        double sb = viewport.toScreenY(b.y);
+        double sy = viewport.toScreenY(point.y);
+        if (std::fabs(sa - sb) > viewport.height || std::fabs(sy) > 4 * viewport.height)
+            continue;
+        double t = (point.x - a.x) / (b.x - a.x);
+        errors.push_back(std::fabs(sa + t * (sb - sa) - sy));
+    }
+    if (errors.empty())
+        return 0.0;
+    std::sort(errors.begin(), errors.end());
+    return errors[errors.size() * 99 / 100];
+}
+
+/**
+ * @brief Столбцы, в которых плотная эталонная выборка попадает в пиксель, не покрытый графиком
+ *
+ * @param covered covered[c] — пары [начало, конец) отмеченных строк столбца c
+ */
+static size_t missedColumns(const std::vector<std::vector<int>>& covered, const std::vector<PlotPoint>& reference,
+    const PlotViewport& viewport) {
+    std::vector<bool> missed(viewport.width, false);
+    for (const auto& point : reference) {
+        if (!(point.y >= viewport.yMin && point.y <= viewport.yMax))
+            continue;
+        int column = std::min(static_cast<int>(viewport.toScreenX(point.x)), viewport.width - 1);
+        int row = std::min(static_cast<int>(viewport.toScreenY(point.y)), viewport.height - 1);
+        bool found = false;
+        for (size_t k = 0; column >= 0 && k < covered[column].size(); k += 2)
+            found = found || (covered[column][k] - 1 <= row && row <= covered[column][k + 1]);
+        if (column >= 0 && !found)
+            missed[column] = true;
+    }
+    return static_cast<size_t>(std::count(missed.begin(), missed.end(), true));
+}
+
+/**
+ * @brief Строки, которые закрашивает ломаная в каждом столбце (так же, как окно графика: без разрывов и скачков больше 4 высот)
+ */
+static std::vector<std::vector<int>> polylineCoverage(const std::vector<PlotPoint>& points, const PlotViewport& viewport) {
+    std::vector<std::vector<int>> covered(viewport.width);
+    for (size_t i = 1; i < points.size(); i++) {
+        double ay = viewport.toScreenY(points[i - 1].y);
+        double by = viewport.toScreenY(points[i].y);
+        if (!std::isfinite(ay) || !std::isfinite(by) || std::fabs(ay - by) > 4.0 * viewport.height)
+            continue;
+        double ax = viewport.toScreenX(points[i - 1].x);
+        double bx = viewport.toScreenX(points[i].x);
+        int first = std::max(static_cast<int>(std::floor(ax)), 0);
+        int last = std::min(static_cast<int>(std::floor(bx)), viewport.width - 1);
+        for (int column = first; column <= last; column++) {
+            double t0 = std::min(std::max((column - ax) / (bx - ax), 0.0), 1.0);
+            double t1 = std::min(std::max((column + 1 - ax) / (bx - ax), 0.0), 1.0);
+            double y0 = ay + t0 * (by - ay);
+            double y1 = ay + t1 * (by - ay);
+            covered[column].push_back(static_cast<int>(std::floor(std::min(y0, y1))));
+            covered[column].push_back(static_cast<int>(std::floor(std::max(y0, y1))) + 1);
+        }
+    }
+    return covered;
+}
+
+/**
+ * @brief Наибольшее расстояние (в пикселях) от точек плотной выборки кривой до ломаной
+ *
+ * Учитываются только видимые точки; отрезки ломаной ищутся в ячейках сетки по 8 пикселей,
+ * поэтому расстояния больше 8 пикселей считаются равными 8.
+ */
+static double curveError(const std::vector<PlotPoint>& polyline, const std::vector<PlotPoint>& reference,
+    const PlotViewport& viewport) {
+    const int cell = 8;
+    int columns = viewport.width / cell + 1;
+    int rows = viewport.height / cell + 1;
+    std::vector<std::vector<size_t>> grid(static_cast<size_t>(columns) * rows);
+    for (size_t i = 1; i < polyline.size(); i++) {
+        double ax = viewport.toScreenX(polyline[i - 1].x);
+        double ay = viewport.toScreenY(polyline[i - 1].y);
+        double bx = viewport.toScreenX(polyline[i].x);
+        double by = viewport.toScreenY(polyline[i].y);
+        if (!std::isfinite(ax + ay + bx + by) || std::hypot(bx - ax, by - ay) > viewport.height)
+            continue;
+        int c0 = std::max(static_cast<int>(std::floor(std::min(ax, bx) / cell)) - 1, 0);
+        int c1 = std::min(static_cast<int>(std::floor(std::max(ax, bx) / cell)) + 1, columns - 1);
+        int r0 = std::max(static_cast<int>(std::floor(std::min(ay, by) / cell)) - 1, 0);
+        int r1 = std::min(static_cast<int>(std::floor(std::max(ay, by) / cell)) + 1, rows - 1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++)
+                grid[static_cast<size_t>(r) * columns + c].push_back(i);
+        }
+    }
+    double error = 0.0;
+    for (const auto& point : reference) {
+        double px = viewport.toScreenX(point.x);
+        double py = viewport.toScreenY(point.y);
+        if (!(px >= 0 && px < viewport.width && py >= 0 && py < viewport.height))
+            continue;
+        double best = cell;
+        for (size_t i : grid[static_cast<size_t>(py / cell) * columns + static_cast<size_t>(px / cell)]) {
+            double ax = viewport.toScreenX(polyline[i - 1].x);
+            double ay = viewport.toScreenY(polyline[i - 1].y);
+            double dx = viewport.toScreenX(polyline[i].x) - ax;
+            double dy = viewport.toScreenY(polyline[i].y) - ay;
+            double length2 = dx * dx + dy * dy;
+            double s = length2 > 0 ? std::min(std::max(((px - ax) * dx + (py - ay) * dy) / length2, 0.0), 1.0) : 0.0;
+            best = std::min(best, std::hypot(px - ax - s * dx, py - ay - s * dy));
+        }
+        error = std::max(error, best);
+    }
+    return error;
+}
+
+/**
+ * @brief Бенчмарк перерисовки графика шириной 4K при сдвиге и масштабировании
+ *
+ * Печатает среднее и наибольшее время перерисовки и число вычислений функции на кадр
+ * для холодного кэша, серии сдвигов и серии масштабирований, а затем сравнивает
+ * равномерную и адаптивную выборку по числу вычислений и отклонению от плотной эталонной выборки.
+ * Затем замеряет обновление functions графиков через PlotEvaluator в пулах от 1 до max-threads потоков
+ * и прореживание ряда из series точек через MinMaxPyramid при сдвиге и масштабировании (бюджет кадра 60 fps).
+ * Наконец, сравнивает точечную и интервальную выборку на функциях с узкими пиками по числу вычислений
+ * и числу столбцов, где график расходится с эталонной выборкой из 256 точек на пиксель,
+ * и замеряет построение неявно заданных кривых при двух разрешениях и разном числе потоков,
+ * а также обновление тепловой карты из кэша плиток при сдвиге и масштабировании.
+ * В конце сравнивает адаптивную по длине дуги выборку параметрических и полярных кривых
+ * с равномерной по t: ошибку при том же числе точек ломаной и число точек, при котором
+ * равномерная выборка достигает той же ошибки, и замеряет программную растеризацию поверхности
+ * на сетке 512x512 при вращении камеры с уровнями детализации и без них, а также безоконный экспорт
+ * графиков в PNG: время растеризации и кодирования и число графиков в минуту.
+ * Использование: calculator_plot_bench [--width W] [--frames N] [--functions F] [--max-threads T] [--series S] [выражение]
+ */
+int main(int argc, char* argv[]) {
+    int width = 3840;
+    int frames = 200;
+    int functions = 8;
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+    size_t seriesSize = 10000000;
+    std::string text = "x sin(x * 40) + tan(x * 20) / 10";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--width" && i + 1 < argc)
+            width = std::atoi(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = std::atoi(argv[++i]);
+        else if (arg == "--functions" && i + 1 < argc)
+            functions = std::atoi(argv[++i]);
+        else if (arg == "--max-threads" && i + 1 < argc)
+            maxThreads = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--series" && i + 1 < argc)
+            seriesSize = std::strtoull(argv[++i], nullptr, 10);
+        else
+            text = arg;
+    }
+
+    SampleCache cache(Expression::parse(text));
+    PlotViewport viewport;
+    viewport.width = width;
+    viewport.height = width * 9 / 16;
+    std::vector<PlotPoint> points;
+    std::vector<float> vertices;
+
+    auto report = [&](const char* name, int count, auto step) {
+        uint64_t evaluationsBefore = cache.stats().evaluations;
+        double total = 0.0;
+        double worst = 0.0;
+        for (int i = 0; i < count; i++) {
+            step(i);
+            double ms = redrawMs(cache, viewport, points, vertices);
+            total += ms;
+            worst = std::max(worst, ms);
+        }
+        uint64_t evaluations = cache.stats().evaluations - evaluationsBefore;
+        std::cout << name << ": " << count << " frames, mean " << total / count << " ms, max " << worst
+            << " ms, " << evaluations / count << " evaluations/frame, " << points.size() << " samples\n";
+        return worst;
+    };
+
+    std::cout << "f(x) = " << text << ", " << width << " px\n";
+    report("cold", 1, [](int) {});
+    report("redraw", frames, [](int) {});
+    double panWorst = report("pan", frames, [&](int) { viewport.pan(width / 100.0, 0.0); });
+    double zoomWorst = report("zoom", frames, [&](int i) {
+        viewport.zoom((i / 20) % 2 == 0 ? 1.1 : 1.0 / 1.1, width / 2.0, viewport.height / 2.0);
+    });
+    SampleCacheStats stats = cache.stats();
+    std::cout << "total: " << stats.evaluations << " evaluated, " << stats.reusedSamples << " reused across zoom levels, "
+        << stats.chunkHits << " chunk hits, " << stats.chunkMisses << " chunk misses\n";
+    std::cout << "2 ms budget: " << (std::max(panWorst, zoomWorst) < 2.0 ? "met" : "exceeded") << "\n";
+
+    const char* shapes[] = { "tan x", "1 / (x - 1)", "x^3 / 50 - x", "sin(x * 20) * 5", text.c_str() };
+    PlotViewport view;
+    view.width = width;
+    view.height = width * 9 / 16;
+    std::cout << "\nuniform vs adaptive (evaluations per frame, p99 error in px):\n";
+    for (const char* shape : shapes) {
+        Expression f = Expression::parse(shape);
+        SampleCache uniformCache(f);
+        std::vector<PlotPoint> uniform;
+        uniformCache.sample(view.xMin, view.xMax, view.width, uniform);
+        std::vector<PlotPoint> adaptive;
+        AdaptiveSampleStats stats = AdaptiveSampler().sample(f, view, adaptive);
+        SampleCache referenceCache(f);
+        std::vector<PlotPoint> reference;
+        referenceCache.sample(view.xMin, view.xMax, view.width * 16, reference);
+        std::cout << "  " << shape << ": uniform " << uniformCache.stats().evaluations << " evals, error "
+            << screenError(uniform, reference, view) << " px; adaptive " << stats.evaluations << " evals, error "
+            << screenError(adaptive, reference, view) << " px, " << stats.breaks << " breaks\n";
+    }
+
+    std::cout << "\n" << functions << " functions, adaptive refresh while panning (" << frames << " frames):\n";
+    double baseline = 0.0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        PlotEvaluator evaluator(pool);
+        for (int f = 0; f < functions; f++)
+            evaluator.addFunction(Expression::parse("sin(x * " + std::to_string(10 + 7 * f) + ") * x / 2 + tan(x * "
+                + std::to_string(5 + f) + ") / 4"));
+        PlotViewport panned = view;
+        std::vector<PlotSeries> series;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            panned.pan(width / 50.0, 0.0);
+            evaluator.refresh(panned, true, series);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        if (threads == 1)
+            baseline = ms;
+        std::cout << "  " << threads << " threads: " << ms << " ms/refresh, speedup " << baseline / ms << "x\n";
+    }
+
+    std::cout << "\n" << seriesSize << "-point series, min/max decimation:\n";
+    std::vector<PlotPoint> samples(seriesSize);
+    std::mt19937_64 random(42);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    for (size_t i = 0; i < seriesSize; i++) {
+        double x = -10.0 + 20.0 * i / seriesSize;
+        samples[i] = { x, 3.0 * std::sin(x) + noise(random) };
+    }
+    auto buildStart = std::chrono::steady_clock::now();
+    MinMaxPyramid pyramid(std::move(samples));
+    std::cout << "  build: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count()
+        << " ms, " << pyramid.levels() << " levels\n";
+    std::vector<PlotPoint> decimated;
+    auto scanStart = std::chrono::steady_clock::now();
+    decimateMinMax(pyramid.points().data(), pyramid.points().size(), view, decimated);
+    std::cout << "  linear scan without pyramid: "
+        << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scanStart).count() << " ms, "
+        << decimated.size() << " points drawn\n";
+    ThreadPool decimationPool(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+    double decimationWorst = 0.0;
+    auto decimationReport = [&](const char* name, ThreadPool* pool, auto step) {
+        PlotViewport moving = view;
+        double total = 0.0;
+        double worst = 0.0;
+        for (int i = 0; i < frames; i++) {
+            step(moving, i);
+            auto start = std::chrono::steady_clock::now();
+            pyramid.decimate(moving, decimated, pool);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            total += ms;
+            worst = std::max(worst, ms);
+        }
+        decimationWorst = std::max(decimationWorst, worst);
+        std::cout << "  " << name << ": mean " << total / frames << " ms, max " << worst << " ms, "
+            << decimated.size() << " points drawn\n";
+    };
+    decimationReport("full view", nullptr, [](PlotViewport&, int) {});
+    decimationReport("pan", nullptr, [&](PlotViewport& v, int) { v.pan(width / 400.0, 0.0); });
+    decimationReport("zoom", nullptr, [&](PlotViewport& v, int i) {
+        v.zoom((i / 40) % 2 == 0 ? 1.15 : 1.0 / 1.15, width / 2.0, v.height / 2.0);
+    });
+    decimationReport("zoom, pool", &decimationPool, [&](PlotViewport& v, int i) {
+        v.zoom((i / 40) % 2 == 0 ? 1.15 : 1.0 / 1.15, width / 2.0, v.height / 2.0);
+    });
+    std::cout << "  16.6 ms budget: " << (decimationWorst < 16.6 ? "met" : "exceeded") << "\n";
+
+    const char* pathological[] = { "1 / ((x - 1.2345)^2 * 100000 + 0.01)", "x + 50 / (1 + ((x - 3.3) * 3000)^2)",
+        "sin(36000 / x)", "tan(x * 20)" };
+    std::cout << "\npoint vs interval sampling (evaluations, columns missed vs 256 samples/px):\n";
+    for (const char* shape : pathological) {
+        Expression f = Expression::parse(shape);
+        SampleCache referenceCache(f, 1 << 16);
+        std::vector<PlotPoint> reference;
+        referenceCache.sample(view.xMin, view.xMax, view.width * 256, reference);
+        SampleCache uniformCache(f);
+        std::vector<PlotPoint> uniform;
+        uniformCache.sample(view.xMin, view.xMax, view.width, uniform);
+        std::vector<PlotPoint> adaptive;
+        AdaptiveSampleStats adaptiveStats = AdaptiveSampler().sample(f, view, adaptive);
+        std::vector<PixelSpan> spans;
+        auto start = std::chrono::steady_clock::now();
+        IntervalPlotStats intervalStats = IntervalPlotter().plot(f, view, spans);
+        double intervalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::vector<std::vector<int>> covered(view.width);
+        for (const auto& span : spans) {
+            covered[span.column].push_back(span.rowBegin);
+            covered[span.column].push_back(span.rowEnd);
+        }
+        std::cout << "  " << shape << ": uniform " << uniformCache.stats().evaluations << " evals, "
+            << missedColumns(polylineCoverage(uniform, view), reference, view) << " missed; adaptive "
+            << adaptiveStats.evaluations << " evals, " << missedColumns(polylineCoverage(adaptive, view), reference, view)
+            << " missed; interval " << intervalStats.evaluations << " evals (" << intervalMs << " ms), "
+            << missedColumns(covered, reference, view) << " missed, " << intervalStats.pruned << " pruned; reference "
+            << referenceCache.stats().evaluations << " evals\n";
+    }
+
+    const char* relations[] = { "x^2 + y^2 = 25", "sin(x * 30) = cos(y * 30)", "y = tan(x * 20)" };
+    std::cout << "\nimplicit curves (evaluations vs grid nodes, ms per plot by threads):\n";
+    for (const char* text : relations) {
+        Expression relation = parseRelation(text);
+        for (int scale = 1; scale <= 2; scale++) {
+            PlotViewport area;
+            area.width = width / (3 - scale);
+            area.height = area.width * 9 / 16;
+            area.yMin = -10.0 * 9 / 16;
+            area.yMax = 10.0 * 9 / 16;
+            std::vector<ImplicitSegment> segments;
+            ImplicitPlotStats stats = ImplicitPlotter().plot(relation, area, segments);
+            std::cout << "  " << text << " at " << area.width << "x" << area.height << ": " << stats.evaluations
+                << " evals + " << stats.intervalEvaluations << " interval (grid " << static_cast<uint64_t>(area.width) * area.height
+                << "), " << stats.segments << " segments;";
+            for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+                ThreadPool pool(threads);
+                auto start = std::chrono::steady_clock::now();
+                const int repeats = 5;
+                for (int i = 0; i < repeats; i++)
+                    ImplicitPlotter().plot(relation, area, segments, &pool);
+                std::cout << " " << threads << "t " << std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count() / repeats << " ms";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << "\nheatmap tiles, f(x, y) = sin(x * 40) * cos(y * 40) + x * y / 50:\n";
+    Expression heat = Expression::parse("sin(x * 40) * cos(y * 40) + x * y / 50", { "x", "y" });
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        HeatmapTileCache tiles(heat);
+        std::vector<std::shared_ptr<const HeatmapTile>> visible;
+        PlotViewport area = view;
+        area.yMin = -10.0 * 9 / 16;
+        area.yMax = 10.0 * 9 / 16;
+        auto timed = [&]() {
+            auto start = std::chrono::steady_clock::now();
+            // Ёмкость задаётся так же, как в окне графиков (HeatmapLayer::rebuild)
+            tiles.setMaxTiles(HeatmapTileCache::capacityFor(area));
+            size_t built = tiles.update(area, visible, &pool);
+            return std::make_pair(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), built);
+        };
+        auto cold = timed();
+        double panTotal = 0.0;
+        double panWorst = 0.0;
+        size_t panBuilt = 0;
+        for (int i = 0; i < frames; i++) {
+            area.pan(width / 50.0, 0.0);
+            auto frame = timed();
+            panTotal += frame.first;
+            panWorst = std::max(panWorst, frame.first);
+            panBuilt += frame.second;
+        }
+        double zoomTotal = 0.0;
+        size_t zoomBuilt = 0;
+        for (int i = 0; i < frames; i++) {
+            area.zoom((i / 10) % 2 == 0 ? 1.15 : 1.0 / 1.15, width / 2.0, area.height / 2.0);
+            auto frame = timed();
+            zoomTotal += frame.first;
+            zoomBuilt += frame.second;
+        }
+        std::cout << "  " << threads << " threads: cold " << cold.first << " ms (" << cold.second << " tiles), pan mean "
+            << panTotal / frames << " ms, max " << panWorst << " ms, " << static_cast<double>(panBuilt) / frames
+            << " tiles/frame; zoom mean " << zoomTotal / frames << " ms, " << static_cast<double>(zoomBuilt) / frames
+            << " tiles/frame; " << tiles.stats().evaluations << " evaluations\n";
+    }
+
+    std::cout << "\nparametric curves, uniform in t vs arc-length adaptive (max distance to 4096x dense curve, px):\n";
+    struct CurveCase {
+        const char* spec;
+        bool polar;
+        double zoom;  ///< Увеличение относительно области -10..10 с центром в (4, 0)
+    };
+    const CurveCase curveCases[] = {
+        { "t / 36 - 5; t / 60 - 3", false, 1.0 },
+        { "5 cos(t * 7); 5 sin(t * 3)", false, 1.0 },
+        { "5 cos(t * 29); 5 sin(t * 31)", false, 1.0 },
+        { "(t / 60 - 3)^3 / 3; 3 sin(t * 2)", false, 1.0 },
+        { "5 cos(t * 4)", true, 1.0 },
+        { "t / 720; 0; 3600", true, 1.0 },
+        { "5 / cos t", true, 1.0 },
+        { "5 cos(t * 29); 5 sin(t * 31)", false, 8.0 },
+        { "t / 720; 0; 3600", true, 8.0 },
+    };
+    for (const CurveCase& curveCase : curveCases) {
+        ParametricCurve curve = curveCase.polar ? ParametricCurve::parsePolar(curveCase.spec) : ParametricCurve::parse(curveCase.spec);
+        PlotViewport plane = view;
+        plane.xMin = 4.0 - 10.0 / curveCase.zoom;
+        plane.xMax = 4.0 + 10.0 / curveCase.zoom;
+        plane.yMin = -10.0 * 9 / 16 / curveCase.zoom;
+        plane.yMax = 10.0 * 9 / 16 / curveCase.zoom;
+        if (curveCase.zoom == 1.0) {
+            plane.xMin = -10.0;
+            plane.xMax = 10.0;
+        }
+        std::vector<PlotPoint> adaptive;
+        auto start = std::chrono::steady_clock::now();
+        ParametricSampleStats stats = ParametricSampler().sample(curve, plane, adaptive);
+        double adaptiveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        auto uniformSample = [&](size_t count) {
+            std::vector<double> ts(count);
+            for (size_t i = 0; i < count; i++)
+                ts[i] = curve.tMin() + (curve.tMax() - curve.tMin()) * i / (count - 1);
+            std::vector<double> xs(count);
+            std::vector<double> ys(count);
+            curve.evaluateBatch(ts.data(), xs.data(), ys.data(), count);
+            std::vector<PlotPoint> points(count);
+            for (size_t i = 0; i < count; i++)
+                points[i] = { xs[i], ys[i] };
+            return points;
+        };
+        std::vector<PlotPoint> reference = uniformSample(static_cast<size_t>(ParametricSamplerOptions().initialSamples) * 4096);
+        double adaptiveError = curveError(adaptive, reference, plane);
+        double uniformError = curveError(uniformSample(static_cast<size_t>(stats.points)), reference, plane);
+        size_t matching = static_cast<size_t>(stats.points);
+        while (matching < reference.size() && curveError(uniformSample(matching), reference, plane) > adaptiveError)
+            matching = matching * 5 / 4;
+        std::cout << "  " << (curveCase.polar ? "r = " : "") << curveCase.spec;
+        if (curveCase.zoom != 1.0)
+            std::cout << " (zoom " << curveCase.zoom << "x)";
+        std::cout << ": adaptive " << stats.evaluations << " evals, " << stats.points << " points, error " << adaptiveError
+            << " px, " << stats.breaks << " breaks, " << adaptiveMs << " ms; uniform with as many points: error "
+            << uniformError << " px, same error needs ~" << matching << " points\n";
+    }
+    std::cout << "\nsurface z = sin(x * 30) * cos(y * 30) * 3 + x * y / 20, 512x512 grid, 1280x800 frame, orbiting camera:\n";
+    Expression surface = Expression::parse("sin(x * 30) * cos(y * 30) * 3 + x * y / 20", { "x", "y" });
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        auto buildStart = std::chrono::steady_clock::now();
+        SurfaceMesh mesh(surface, -10.0, 10.0, -10.0, 10.0, 512, &pool);
+        double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+        std::cout << "  " << threads << " threads: mesh " << buildMs << " ms\n";
+        SurfaceRenderOptions full;
+        full.tolerance = 0.0;
+        const std::pair<const char*, SurfaceRenderOptions> modes[] = { { "lod", SurfaceRenderOptions() }, { "full", full } };
+        for (const auto& mode : modes) {
+            SurfaceRenderer renderer(mode.second);
+            SurfaceFrame image;
+            image.width = 1280;
+            image.height = 800;
+            SurfaceCamera orbit;
+            double total = 0.0;
+            double worst = 0.0;
+            SurfaceRenderStats sum;
+            for (int i = 0; i < frames; i++) {
+                orbit.yaw += 360.0 / frames;
+                orbit.distance = 1.5 + 2.0 * (i % 2);
+                auto start = std::chrono::steady_clock::now();
+                SurfaceRenderStats stats = renderer.render(mesh, orbit, image, &pool);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                total += ms;
+                worst = std::max(worst, ms);
+                sum.triangles += stats.triangles;
+                sum.culled += stats.culled;
+                sum.backFaces += stats.backFaces;
+                sum.pixels += stats.pixels;
+            }
+            std::cout << "    " << mode.first << ": mean " << total / frames << " ms (" << 1000.0 * frames / total
+                << " fps), max " << worst << " ms; per frame " << sum.triangles / frames << " triangles, "
+                << sum.backFaces / frames << " back faces, " << sum.culled / frames << " patches culled, "
+                << sum.pixels / frames << " pixels\n";
+        }
+    }
+
+    std::cout << "\nheadless PNG export, 1920x1080, " << text << " + sin(x * 30) * 5 + x^2 / 10:\n";
+    TrueTypeFont font(kEmbeddedFontData, kEmbeddedFontSize);
+    GlyphCache glyphs(font);
+    PlotExporter exporter(glyphs);
+    const std::vector<Expression> exported = { Expression::parse(text), Expression::parse("sin(x * 30) * 5"),
+        Expression::parse("x^2 / 10") };
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        std::vector<double> renderMs(frames);
+        std::vector<double> encodeMs(frames);
+        std::vector<size_t> bytes(frames);
+        auto start = std::chrono::steady_clock::now();
+        // Как в пакетном режиме plot_export: графики строятся параллельно, каждый одним потоком
+        pool.parallelFor(0, static_cast<size_t>(frames), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                PlotViewport shifted;
+                shifted.pan(static_cast<double>(i) * 7.0, 0.0);
+                auto renderStart = std::chrono::steady_clock::now();
+                PlotCanvas canvas = exporter.render(exported, shifted);
+                auto encodeStart = std::chrono::steady_clock::now();
+                std::vector<uint8_t> png;
+                encodePng(canvas.pixels().data(), canvas.width(), canvas.height(), png);
+                auto end = std::chrono::steady_clock::now();
+                renderMs[i] = std::chrono::duration<double, std::milli>(encodeStart - renderStart).count();
+                encodeMs[i] = std::chrono::duration<double, std::milli>(end - encodeStart).count();
+                bytes[i] = png.size();
+            }
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double renderTotal = 0.0;
+        double encodeTotal = 0.0;
+        size_t bytesTotal = 0;
+        for (int i = 0; i < frames; i++) {
+            renderTotal += renderMs[i];
+            encodeTotal += encodeMs[i];
+            bytesTotal += bytes[i];
+        }
+        std::cout << "  " << threads << " threads: render " << renderTotal / frames << " ms, encode " << encodeTotal / frames
+            << " ms, " << bytesTotal / frames / 1024 << " KB per plot; " << frames / seconds * 60.0 << " plots per minute\n";
+    }
+    return 0;
+}
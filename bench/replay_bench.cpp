@@ -0,0 +1,89 @@
+#include "calculator_engine.h"
+#include "input_recorder.h"
+#include "latency_histogram.h"
+#include "memo_cache.h"
+#include "trace.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Драйвер воспроизведения записанных сеансов ввода
+ *
+ * Прогоняет сеансы через CalculatorEngine без окна и без пауз между нажатиями
+ * и печатает гистограмму задержки обработки одного нажатия.
+ * Использование: calculator_replay [--repeat N] [--memo ёмкость] [--trace файл.json] session...
+ * С --memo вычисления идут через MemoCache и печатается доля попаданий.
+ * Трасса записывается, только если сборка выполнена с опцией CALC_ENABLE_TRACING.
+ */
+int main(int argc, char* argv[]) {
+    int repeat = 1000;
+    size_t memoCapacity = 0;
+    std::string tracePath;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+            repeat = std::atoi(argv[++i]);
+        else if (arg == "--memo" && i + 1 < argc)
+            memoCapacity = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else
+            paths.push_back(arg);
+    }
+    if (paths.empty()) {
+        std::cerr << "Usage: calculator_replay [--repeat N] [--memo capacity] [--trace file.json] session..." << std::endl;
+        return 1;
+    }
+
+    for (const auto& path : paths) {
+        std::vector<RecordedInput> session;
+        try {
+            session = loadInputSession(path);
+        }
+        catch (const std::exception& ex) {
+            std::cerr << path << ": " << ex.what() << std::endl;
+            return 1;
+        }
+
+        LatencyHistogram histogram;
+        CalculatorEngine engine;
+        std::unique_ptr<MemoCache> memo;
+        if (memoCapacity > 0) {
+            memo = std::make_unique<MemoCache>(memoCapacity);
+            engine.setMemoCache(memo.get());
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; r++) {
+            engine.reset();
+            for (const auto& input : session) {
+                auto before = std::chrono::steady_clock::now();
+                engine.press(input.key);
+                auto after = std::chrono::steady_clock::now();
+                histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << path << ": " << session.size() << " events x " << repeat << " runs, "
+            << static_cast<uint64_t>(histogram.count() / seconds) << " events/s\n";
+        histogram.print(std::cout);
+        if (memo) {
+            CacheStats operations = memo->operationStats();
+            CacheStats conversions = memo->conversionStats();
+            std::cout << "memo: operations hit rate " << 100.0 * operations.hitRate() << "% (" << operations.hits
+                << "/" << operations.hits + operations.misses << "), conversions hit rate "
+                << 100.0 * conversions.hitRate() << "% (" << conversions.hits << "/"
+                << conversions.hits + conversions.misses << ")\n";
+        }
+    }
+    if (!tracePath.empty() && !traceWriteChromeJson(tracePath)) {
+        std::cerr << "Cannot write " << tracePath << std::endl;
+        return 1;
+    }
+    return 0;
+}
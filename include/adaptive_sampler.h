@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "expression.h"
+#include "plot_viewport.h"
+#include "sample_cache.h"
+
+/**
+ * @brief Параметры адаптивной выборки
+ */
+struct AdaptiveSamplerOptions {
+    int initialSpacing = 8;       ///< Шаг начальной равномерной сетки в пикселях
+    double tolerance = 0.25;      ///< Допустимое отклонение середины отрезка от хорды в пикселях
+    double curvatureWidth = 0.5;  ///< Наименьшая ширина отрезка в пикселях при уточнении по кривизне
+    double minWidth = 1.0 / 64;   ///< Наименьшая ширина отрезка в пикселях при поиске разрывов
+    int maxDepth = 12;            ///< Наибольшее число делений начального отрезка
+};
+
+/**
+ * @brief Счётчики последней адаптивной выборки
+ */
+struct AdaptiveSampleStats {
+    uint64_t evaluations = 0;   ///< Вычислено значений функции (без взятых из кэша)
+    uint64_t points = 0;        ///< Точек в результате
+    uint64_t breaks = 0;        ///< Найдено асимптот и границ области определения
+};
+
+/**
+ * @brief Адаптивная выборка функции одной переменной для построения графика
+ *
+ * Начинает с равномерной сетки с шагом в несколько пикселей и делит пополам отрезки,
+ * на которых середина отклоняется от хорды больше допуска в пикселях (кривизна),
+ * одна из точек не определена (граница области, tan 90, деление на ноль) или значения
+ * отличаются больше чем на высоту экрана (возможный полюс). Такие отрезки уточняются
+ * до minWidth; если скачок так и не исчез, между точками вставляется разрыв
+ * (точка с y = NaN), чтобы ломаная не соединяла ветви по разные стороны асимптоты.
+ * Середины всех отрезков одного прохода вычисляются одним пакетом.
+ */
+class AdaptiveSampler {
+public:
+    explicit AdaptiveSampler(AdaptiveSamplerOptions options = AdaptiveSamplerOptions()) : options_(options) {}
+
+    /**
+     * @brief Строит выборку для видимой области
+     *
+     * @param function Выражение одной переменной
+     * @param viewport Видимая область
+     * @param out Точки в порядке возрастания x; разрывы обозначены y = NaN
+     * @param coarse Кэш, из которого берётся начальная сетка, или nullptr
+     * @return Счётчики выборки
+     */
+    AdaptiveSampleStats sample(const Expression& function, const PlotViewport& viewport, std::vector<PlotPoint>& out,
+        SampleCache* coarse = nullptr) const;
+
+    const AdaptiveSamplerOptions& options() const { return options_; }
+
+private:
+    AdaptiveSamplerOptions options_;
+};
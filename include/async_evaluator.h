@@ -0,0 +1,46 @@
+#pragma once
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include "calculator_engine.h"
+#include "evaluation_control.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Вычисление, выполняемое пулом потоков
+ */
+struct AsyncEvaluation {
+    std::shared_ptr<EvaluationControl> control;  ///< Отмена и прогресс
+    std::shared_future<std::string> result;      ///< Новое содержимое дисплея
+
+    /**
+     * @brief Завершилось ли вычисление (успешно, с ошибкой или отменой)
+     */
+    bool ready() const { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+};
+
+/**
+ * @brief Выполняет вычисления калькулятора в пуле рабочих потоков
+ *
+ * Поток ввода ставит задачу, подготовленную CalculatorEngine::beginEvaluation(),
+ * и продолжает обрабатывать события, опрашивая готовность результата.
+ */
+class AsyncEvaluator {
+public:
+    /**
+     * @brief Создаёт пул рабочих потоков
+     * @param threads Число потоков; 0 — по числу аппаратных потоков
+     */
+    explicit AsyncEvaluator(size_t threads = 0) : pool_(threads) {}
+
+    /**
+     * @brief Ставит вычисление в очередь
+     * @param job Задача вычисления
+     * @return Описатель вычисления для опроса, отмены и получения результата
+     */
+    AsyncEvaluation submit(CalculatorEngine::EvaluationJob job);
+
+private:
+    ThreadPool pool_;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "baked_font.h"
+
+/**
+ * @brief Текстура атласа глифов, подготовленного glyph_baker при сборке
+ */
+class GlyphAtlas {
+public:
+    /**
+     * @brief Загружает атлас из данных, встроенных в исполняемый файл
+     *
+     * Требует активного OpenGL-контекста; файлы не читаются, глифы не растеризуются.
+     *
+     * @return false, если не удалось создать текстуру
+     */
+    bool load();
+
+    /**
+     * @brief Ищет глиф символа в атласе
+     * @param codepoint Код символа Юникода
+     * @return Метрики глифа или nullptr, если символ не был подготовлен
+     */
+    const BakedGlyph* find(sf::Uint32 codepoint) const;
+
+    const sf::Texture& texture() const { return texture_; }
+
+private:
+    sf::Texture texture_;
+};
+
+/**
+ * @brief Текст, отрисовываемый из готового атласа глифов
+ *
+ * Аналог sf::Text с фиксированным кеглем kBakedCharacterSize: первый вывод строки
+ * не вызывает растеризацию глифов. Базовая линия, как и у sf::Text, находится на высоте кегля.
+ */
+class AtlasText : public sf::Drawable, public sf::Transformable {
+public:
+    /**
+     * @brief Задаёт атлас глифов (должен жить дольше текста)
+     * @param atlas Атлас
+     */
+    void setAtlas(const GlyphAtlas& atlas);
+
+    /**
+     * @brief Задаёт строку и перестраивает вершины
+     * @param utf8 Строка в кодировке UTF-8
+     */
+    void setString(const std::string& utf8);
+
+    /**
+     * @brief Задаёт цвет текста
+     * @param color Цвет
+     */
+    void setFillColor(const sf::Color& color);
+
+    sf::FloatRect getLocalBounds() const { return bounds_; }
+    sf::FloatRect getGlobalBounds() const { return getTransform().transformRect(bounds_); }
+
+private:
+    void rebuild();
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    const GlyphAtlas* atlas_ = nullptr;
+    std::string string_;
+    sf::Color color_ = sf::Color::White;
+    sf::VertexArray vertices_{ sf::Triangles };
+    sf::FloatRect bounds_;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Метрики глифа, заранее растеризованного в атлас при сборке
+ */
+struct BakedGlyph {
+    uint32_t codepoint; ///< Код символа Юникода
+    int x;              ///< Левый край в атласе
+    int y;              ///< Верхний край в атласе
+    int width;          ///< Ширина изображения глифа
+    int height;         ///< Высота изображения глифа
+    int left;           ///< Смещение левого края от позиции пера
+    int top;            ///< Смещение верхнего края от базовой линии
+    float advance;      ///< Сдвиг пера после глифа
+};
+
+/**
+ * @brief Данные, сгенерированные glyph_baker из Sansation_Bold.ttf на этапе сборки
+ *
+ * Шрифт встраивается в исполняемый файл целиком, а глифы кнопок и дисплея
+ * растеризуются в атлас заранее, поэтому при запуске не нужны ни чтение файлов, ни FreeType.
+ */
+extern const uint8_t kEmbeddedFontData[];
+extern const size_t kEmbeddedFontSize;
+
+extern const unsigned kBakedCharacterSize;  ///< Кегль, при котором растеризован атлас
+extern const float kBakedLineSpacing;       ///< Межстрочный интервал при этом кегле
+extern const unsigned kGlyphAtlasWidth;
+extern const unsigned kGlyphAtlasHeight;
+extern const uint8_t kGlyphAtlasPixels[];   ///< Покрытие 0-255, kGlyphAtlasWidth * kGlyphAtlasHeight
+extern const BakedGlyph kBakedGlyphs[];     ///< Отсортированы по codepoint
+extern const size_t kBakedGlyphCount;
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Наибольшая длина кадра протокола calc-server без префикса длины
+ */
+constexpr uint32_t kMaxFrameSize = 1 << 16;
+
+/**
+ * @brief Результат запроса к calc-server
+ */
+enum class CalcStatus : uint8_t {
+    Ok = 0,     ///< Значение вычислено
+    Error = 1   ///< Выражение ошибочно; текст ошибки в ответе
+};
+
+/**
+ * @brief Ответ calc-server
+ */
+struct CalcResponse {
+    uint32_t id = 0;                    ///< Номер запроса, выбранный клиентом
+    CalcStatus status = CalcStatus::Ok;
+    double value = 0.0;                 ///< Значение при CalcStatus::Ok
+    std::string error;                  ///< Сообщение при CalcStatus::Error
+};
+
+/**
+ * @brief Дописывает кадр запроса
+ *
+ * Кадр: длина тела (uint32, little-endian), затем тело: номер запроса (uint32, little-endian)
+ * и текст выражения.
+ */
+void appendRequest(std::string& out, uint32_t id, std::string_view expression);
+
+/**
+ * @brief Дописывает кадр ответа
+ *
+ * Тело: номер запроса (uint32), статус (uint8), затем значение (double, 8 байт little-endian)
+ * или текст ошибки.
+ */
+void appendResponse(std::string& out, uint32_t id, CalcStatus status, double value, std::string_view error);
+
+/**
+ * @brief Выделяет первый кадр из начала буфера
+ *
+ * @param buffer Принятые байты
+ * @param payload Тело кадра (указывает внутрь buffer)
+ * @return Длина кадра вместе с префиксом или 0, если кадр ещё не принят целиком
+ * @throw std::runtime_error Если длина кадра больше kMaxFrameSize
+ */
+size_t nextFrame(std::string_view buffer, std::string_view& payload);
+
+/**
+ * @brief Разбирает тело запроса
+ * @return false, если тело короче номера запроса
+ */
+bool decodeRequest(std::string_view payload, uint32_t& id, std::string_view& expression);
+
+/**
+ * @brief Разбирает тело ответа
+ * @return false, если тело повреждено
+ */
+bool decodeResponse(std::string_view payload, CalcResponse& response);
+
+/**
+ * @brief Блокирующий клиент calc-server с конвейерной отправкой
+ *
+ * Запросы копятся в буфере и уходят одной записью при flush(), поэтому клиент может
+ * держать много запросов в пути; ответы приходят в порядке готовности и сопоставляются по номеру.
+ */
+class CalcClient {
+public:
+    /**
+     * @brief Подключается к серверу
+     * @param socketPath Путь Unix-сокета
+     * @throw std::runtime_error Если подключиться не удалось
+     */
+    explicit CalcClient(const std::string& socketPath);
+    ~CalcClient();
+
+    CalcClient(const CalcClient&) = delete;
+    CalcClient& operator=(const CalcClient&) = delete;
+
+    /**
+     * @brief Добавляет запрос в буфер отправки
+     */
+    void send(uint32_t id, std::string_view expression) { appendRequest(output_, id, expression); }
+
+    /**
+     * @brief Отправляет накопленные запросы
+     * @throw std::runtime_error При ошибке записи
+     */
+    void flush();
+
+    /**
+     * @brief Ожидает следующий ответ
+     * @throw std::runtime_error Если сервер закрыл соединение или прислал повреждённый кадр
+     */
+    CalcResponse receive();
+
+private:
+    int fd_ = -1;
+    std::string output_;
+    std::string input_;
+    size_t inputOffset_ = 0;
+};
+
+/**
+ * @brief Запрашивает метрики calc-server в формате Prometheus
+ *
+ * @param socketPath Путь Unix-сокета метрик
+ * @return Тело ответа
+ * @throw std::runtime_error Если сервер недоступен или ответ не получен
+ */
+std::string fetchMetrics(const std::string& socketPath);
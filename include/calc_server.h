@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "thread_pool.h"
+
+/**
+ * @brief Параметры calc-server
+ */
+struct CalcServerOptions {
+    std::string socketPath;        ///< Unix-сокет запросов
+    std::string metricsPath;       ///< Unix-сокет метрик Prometheus; пустой — без метрик
+    size_t threads = 0;            ///< Рабочих потоков; 0 — по числу аппаратных потоков
+    size_t batchSize = 64;         ///< Наибольшее число выражений в одной задаче пула
+};
+
+/**
+ * @brief Сервер вычисления выражений на Unix-сокете
+ *
+ * Один поток ввода-вывода обслуживает все соединения через epoll; запросы — кадры
+ * с префиксом длины (calc_protocol.h), клиент может отправлять их подряд, не дожидаясь ответов.
+ * Одинаковые выражения, которые уже вычисляются, не ставятся в очередь повторно:
+ * ответ на них рассылается всем ожидающим. Новые выражения, принятые за один проход
+ * цикла событий, делятся на пакеты до batchSize и вычисляются задачами ThreadPool;
+ * готовые пакеты передаются потоку ввода-вывода через eventfd. Соединение, которое не читает
+ * ответы, перестаёт читаться, пока не разберёт накопленный вывод.
+ * Когда кончаются дескрипторы, приём новых соединений приостанавливается до закрытия
+ * одного из соединений (или ненадолго), а не крутит цикл событий вхолостую.
+ * На сокете метрик на любой HTTP-запрос отдаются счётчики и гистограмма задержки в формате Prometheus.
+ */
+class CalcServer {
+public:
+    /**
+     * @brief Создаёт сокеты и рабочие потоки
+     * @throw std::runtime_error Если сокет не удалось создать
+     */
+    explicit CalcServer(const CalcServerOptions& options);
+    ~CalcServer();
+
+    CalcServer(const CalcServer&) = delete;
+    CalcServer& operator=(const CalcServer&) = delete;
+
+    /**
+     * @brief Обслуживает соединения до вызова stop()
+     */
+    void run();
+
+    /**
+     * @brief Просит run() завершиться; можно вызывать из любого потока и из обработчика сигнала
+     */
+    void stop() noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd = -1;
+        bool metrics = false;           ///< Соединение сокета метрик
+        bool closeAfterWrite = false;
+        bool peerClosed = false;        ///< Клиент закрыл свою сторону; ответы ещё досылаются
+        size_t waiting = 0;             ///< Запросов без ответа
+        bool flushPending = false;      ///< Уже стоит в очереди на отправку в этом проходе
+        uint32_t events = 0;            ///< Зарегистрированные в epoll события
+        std::string input;
+        std::string output;
+        size_t outputOffset = 0;
+    };
+
+    struct Waiter {
+        uint64_t connection;
+        uint32_t request;
+        Clock::time_point received;
+    };
+
+    struct Completion {
+        std::string expression;
+        bool ok;
+        double value;
+        std::string error;
+    };
+
+    static constexpr size_t kLatencyBuckets = 11;
+
+    void acceptAll(int listener, bool metrics);
+    void pauseAccept();
+    void resumeAccept();
+    void readConnection(uint64_t id);
+    void handleRequest(uint64_t id, uint32_t request, std::string_view expression, Clock::time_point received);
+    void submitPending();
+    void evaluateBatch(const std::vector<std::string>& expressions);
+    void deliverCompletions();
+    void flushConnection(uint64_t id);
+    void updateEvents(uint64_t id, Connection& connection);
+    void closeConnection(uint64_t id);
+    std::string metricsText() const;
+
+    CalcServerOptions options_;
+    int epoll_ = -1;
+    int listener_ = -1;
+    int metricsListener_ = -1;
+    int wake_ = -1;
+    std::atomic<bool> stopping_{ false };
+    bool acceptPaused_ = false;            ///< Слушающие сокеты сняты с epoll до освобождения дескриптора
+
+    uint64_t nextConnection_ = 16;
+    std::unordered_map<uint64_t, Connection> connections_;
+    std::unordered_map<std::string, std::vector<Waiter>> inFlight_;
+    std::vector<std::string> pending_;     ///< Новые выражения, ещё не отданные пулу
+    std::vector<uint64_t> toFlush_;
+
+    std::mutex completionMutex_;
+    std::vector<Completion> completions_;  ///< Готовые результаты от рабочих потоков
+
+    uint64_t requests_ = 0;
+    uint64_t coalesced_ = 0;
+    uint64_t errors_ = 0;
+    uint64_t protocolErrors_ = 0;
+    uint64_t batches_ = 0;
+    uint64_t accepted_ = 0;
+    uint64_t acceptPauses_ = 0;
+    std::array<uint64_t, kLatencyBuckets> latencyBuckets_{};
+    uint64_t latencyCount_ = 0;
+    double latencySum_ = 0.0;
+
+    std::unique_ptr<ThreadPool> pool_;     ///< Останавливается первым в деструкторе
+};
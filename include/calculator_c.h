@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * @file calculator_c.h
+ * @brief Стабильный C ABI математического ядра (библиотека calculator_math)
+ *
+ * Для встраивания в сервисы на других языках. Выражения передаются указателем и длиной,
+ * значения — массивами; пакетные функции обрабатывают массив за один вызов, поэтому
+ * стоимость перехода через границу делится на все элементы. Функции не бросают исключений
+ * и не передают владение памятью: ошибки возвращаются кодом calc_status, тексты ошибок
+ * пишутся в буфер вызывающего, а объекты освобождаются только парными функциями *_destroy.
+ * Вычисления после создания объектов память не выделяют (кроме первого вызова в потоке).
+ * Объект calc_expression неизменяем и может использоваться несколькими потоками сразу,
+ * calc_evaluator — одним потоком в каждый момент.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(CALC_C_API_BUILD)
+#define CALC_API __declspec(dllexport)
+#else
+#define CALC_API __declspec(dllimport)
+#endif
+#else
+#define CALC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Версия ABI; меняется только при несовместимых изменениях */
+#define CALC_ABI_VERSION 1
+
+/**
+ * @brief Код результата
+ *
+ * Значения с CALC_DIVISION_BY_ZERO по CALC_INCORRECT_TRIGONOMETRIC_OPERATION соответствуют MathError.
+ */
+typedef enum calc_status {
+    CALC_OK = 0,
+    CALC_DIVISION_BY_ZERO = 1,
+    CALC_INCORRECT_OPERATOR = 2,
+    CALC_FACTORIAL_DOMAIN = 3,
+    CALC_TANGENT_UNDEFINED = 4,
+    CALC_COTANGENT_UNDEFINED = 5,
+    CALC_INCORRECT_TRIGONOMETRIC_OPERATION = 6,
+    CALC_SYNTAX_ERROR = 100,        /**< Ошибка разбора выражения */
+    CALC_INVALID_ARGUMENT = 101,    /**< Нулевой указатель или недопустимое значение аргумента */
+    CALC_OUT_OF_MEMORY = 102
+} calc_status;
+
+/**
+ * @brief Операция; порядок совпадает с Operation
+ */
+typedef enum calc_operation {
+    CALC_ADD = 0,
+    CALC_SUBTRACT,
+    CALC_MULTIPLY,
+    CALC_DIVIDE,
+    CALC_POWER,
+    CALC_FACTORIAL,
+    CALC_SIN,
+    CALC_COS,
+    CALC_TAN,
+    CALC_COT
+} calc_operation;
+
+/** @brief Скомпилированное выражение над переменными */
+typedef struct calc_expression calc_expression;
+
+/** @brief Вычислитель строк выражений без переменных; переиспользует память между строками */
+typedef struct calc_evaluator calc_evaluator;
+
+/** @brief Версия ABI загруженной библиотеки (CALC_ABI_VERSION, с которой она собрана) */
+CALC_API int calc_abi_version(void);
+
+/**
+ * @brief Текст кода результата (статическая строка, не освобождается)
+ */
+CALC_API const char* calc_status_message(calc_status status);
+
+/**
+ * @brief Вычисляет операцию (семантика tryEvaluate)
+ *
+ * @param b Второй операнд (для унарных операций не используется)
+ * @param result Результат; не изменяется при ошибке
+ */
+CALC_API calc_status calc_evaluate_operation(calc_operation op, double a, double b, double* result);
+
+/**
+ * @brief Поэлементно вычисляет операцию над массивами (семантика evaluateVector)
+ *
+ * Ошибка элемента даёт NaN. result может совпадать с a или b.
+ *
+ * @param b Вторые операнды (для унарных операций может быть NULL)
+ * @return CALC_INVALID_ARGUMENT при нулевых массивах или неизвестной операции
+ */
+CALC_API calc_status calc_evaluate_vector(calc_operation op, const double* a, const double* b, double* result, size_t count);
+
+/**
+ * @brief Компилирует выражение
+ *
+ * @param text Текст (не обязан заканчиваться нулём)
+ * @param length Длина текста в байтах
+ * @param variables Имена переменных (строки с нулём на конце); их порядок задаёт порядок значений
+ * @param variable_count Число переменных
+ * @param expression Созданный объект; NULL при ошибке
+ * @param error Буфер для текста ошибки разбора или NULL
+ * @param error_size Размер буфера; текст обрезается и всегда заканчивается нулём
+ */
+CALC_API calc_status calc_expression_create(const char* text, size_t length, const char* const* variables,
+    size_t variable_count, calc_expression** expression, char* error, size_t error_size);
+
+/** @brief Освобождает выражение; NULL допускается */
+CALC_API void calc_expression_destroy(calc_expression* expression);
+
+/** @brief Число переменных выражения */
+CALC_API size_t calc_expression_variable_count(const calc_expression* expression);
+
+/**
+ * @brief Вычисляет выражение в одной точке
+ *
+ * @param variables Значения переменных (variable_count элементов; NULL, если переменных нет)
+ * @param result Результат; не изменяется при ошибке
+ * @return Код первой ошибки вычисления
+ */
+CALC_API calc_status calc_expression_evaluate(const calc_expression* expression, const double* variables, double* result);
+
+/**
+ * @brief Вычисляет выражение в count точках
+ *
+ * @param variables variables[k] — массив значений k-й переменной длиной count
+ * @param results Результаты (NaN при ошибке)
+ */
+CALC_API calc_status calc_expression_evaluate_batch(const calc_expression* expression, const double* const* variables,
+    double* results, size_t count);
+
+/** @brief Создаёт вычислитель строк; NULL при нехватке памяти */
+CALC_API calc_evaluator* calc_evaluator_create(void);
+
+/** @brief Освобождает вычислитель; NULL допускается */
+CALC_API void calc_evaluator_destroy(calc_evaluator* evaluator);
+
+/**
+ * @brief Вычисляет одну строку выражения без переменных
+ *
+ * @param result Результат; не изменяется при ошибке
+ * @param error Буфер для текста ошибки или NULL
+ * @param error_size Размер буфера
+ */
+CALC_API calc_status calc_evaluate_string(calc_evaluator* evaluator, const char* text, size_t length, double* result,
+    char* error, size_t error_size);
+
+/**
+ * @brief Вычисляет count строк выражений без переменных
+ *
+ * @param texts Указатели на тексты
+ * @param lengths Длины текстов
+ * @param results Результаты (NaN при ошибке)
+ * @param statuses Коды результатов строк или NULL
+ * @return Число строк с ошибкой; при недопустимых аргументах — count
+ */
+CALC_API size_t calc_evaluate_strings(calc_evaluator* evaluator, const char* const* texts, const size_t* lengths,
+    size_t count, double* results, calc_status* statuses);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <future>
+#include "calculator_math.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Запрос пакетного вычисления
+ */
+struct EvaluationRequest {
+    Operation op;  ///< Операция
+    double a;      ///< Первый операнд
+    double b;      ///< Второй операнд (для унарных операций не используется)
+};
+
+/**
+ * @brief Результат пакетного вычисления
+ */
+struct EvaluationResult {
+    double value;     ///< Результат (не определён при ошибке)
+    MathError error;  ///< MathError::None или код ошибки
+};
+
+/**
+ * @brief Общий пул потоков библиотеки
+ *
+ * Создаётся при первом обращении с числом потоков, равным числу аппаратных потоков.
+ * Потокобезопасен, может использоваться из любого числа потоков одновременно.
+ *
+ * @return Пул по умолчанию
+ */
+ThreadPool& defaultExecutor();
+
+/**
+ * @brief Асинхронное вычисление одной операции в общем пуле
+ *
+ * @param op Операция
+ * @param a Первый операнд
+ * @param b Второй операнд
+ * @return future результата; ошибка передаётся как std::runtime_error
+ */
+std::future<double> evaluateAsync(Operation op, double a, double b = 0.0);
+
+/**
+ * @brief Асинхронное вычисление одной операции в заданном пуле
+ *
+ * @param pool Пул потоков
+ * @param op Операция
+ * @param a Первый операнд
+ * @param b Второй операнд
+ * @return future результата; ошибка передаётся как std::runtime_error
+ */
+std::future<double> evaluateAsync(ThreadPool& pool, Operation op, double a, double b = 0.0);
+
+/**
+ * @brief Размер отрезка пакета, обрабатываемого одним потоком за раз
+ *
+ * Отрезок содержит не меньше нескольких тысяч элементов, чтобы накладные расходы
+ * распределения были малы, но на поток приходится несколько отрезков для выравнивания нагрузки.
+ * Размер кратен 8, поэтому границы отрезков в массиве результатов совпадают с границами
+ * кэш-линий и потоки не пишут в одну линию.
+ *
+ * @param count Размер пакета
+ * @param threads Число потоков
+ * @return Число элементов в отрезке
+ */
+size_t batchChunkSize(size_t count, size_t threads);
+
+/**
+ * @brief Пакетное вычисление в общем пуле
+ *
+ * Не бросает исключений из-за ошибок вычисления: они записываются в results[i].error.
+ *
+ * @param requests Массив запросов
+ * @param results Массив результатов того же размера
+ * @param count Число запросов
+ */
+void evaluateBatch(const EvaluationRequest* requests, EvaluationResult* results, size_t count);
+
+/**
+ * @brief Пакетное вычисление в заданном пуле
+ *
+ * @param pool Пул потоков
+ * @param requests Массив запросов
+ * @param results Массив результатов того же размера
+ * @param count Число запросов
+ */
+void evaluateBatch(ThreadPool& pool, const EvaluationRequest* requests, EvaluationResult* results, size_t count);
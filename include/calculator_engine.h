@@ -0,0 +1,80 @@
+#pragma once
+#include <functional>
+#include <string>
+
+class EvaluationControl;
+class MemoCache;
+
+/**
+ * @brief Конечный автомат состояния калькулятора без графического интерфейса
+ *
+ * Хранит выражение, отображаемое на дисплее, и изменяет его в ответ на нажатия кнопок.
+ * Не зависит от SFML, поэтому может использоваться в тестах и бенчмарках без окна.
+ */
+class CalculatorEngine {
+public:
+    /**
+     * @brief Вычисление, выполняемое вне потока ввода
+     *
+     * Получает управление вычислением для отмены и отчёта о прогрессе
+     * и возвращает новое содержимое дисплея ("Error" при ошибке).
+     */
+    using EvaluationJob = std::function<std::string(EvaluationControl&)>;
+
+    /**
+     * @brief Применяет нажатие кнопки к текущему выражению
+     *
+     * @param key Метка кнопки ("0"-"9", ".", "+", "-", "*", "/", "^", "=", "C", "x!",
+     *            "sin", "cos", "tan", "cot", "N-cc", "±")
+     */
+    void press(const std::string& key);
+
+    /**
+     * @brief Требует ли кнопка вычисления ("=", "x!", тригонометрия, "N-cc")
+     * @param key Метка кнопки
+     */
+    static bool isEvaluationKey(const std::string& key);
+
+    /**
+     * @brief Готовит вычисление для кнопки, не выполняя его
+     *
+     * Задача захватывает копию текущего выражения и может выполняться в другом потоке;
+     * результат применяется вызовом completeEvaluation(). press() для таких кнопок
+     * эквивалентен немедленному выполнению задачи.
+     *
+     * @param key Метка кнопки, для которой isEvaluationKey() истинно
+     * @return Задача вычисления
+     */
+    EvaluationJob beginEvaluation(const std::string& key);
+
+    /**
+     * @brief Применяет результат вычисления, подготовленного beginEvaluation()
+     * @param result Новое содержимое дисплея
+     */
+    void completeEvaluation(std::string result) { expression_ = std::move(result); }
+
+    /**
+     * @brief Текущее содержимое дисплея
+     * @return Выражение или результат вычисления ("Error" при ошибке)
+     */
+    const std::string& display() const { return expression_; }
+
+    /**
+     * @brief Сбрасывает состояние калькулятора
+     */
+    void reset() { expression_.clear(); }
+
+    /**
+     * @brief Включает кэширование результатов вычислений
+     *
+     * Кэш может разделяться несколькими движками и должен жить дольше них.
+     * Уже подготовленные задачи beginEvaluation() продолжают использовать прежний кэш.
+     *
+     * @param cache Кэш или nullptr, чтобы отключить кэширование
+     */
+    void setMemoCache(MemoCache* cache) { memo_ = cache; }
+
+private:
+    std::string expression_;
+    MemoCache* memo_ = nullptr;
+};
@@ -1,6 +1,97 @@
 #pragma once
+#include <cstddef>
 #include <string>
 
+class EvaluationControl;
+
+/**
+ * @brief Идентификатор операции для числовых и пакетных интерфейсов
+ *
+ * Унарные операции (Factorial, Sin, Cos, Tan, Cot) используют только первый операнд.
+ */
+enum class Operation {
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,
+    Factorial,
+    Sin,
+    Cos,
+    Tan,
+    Cot
+};
+
+/**
+ * @brief Ошибка вычисления, сообщаемая без исключений
+ */
+enum class MathError {
+    None,
+    DivisionByZero,
+    IncorrectOperator,
+    FactorialDomain,
+    TangentUndefined,
+    CotangentUndefined,
+    IncorrectTrigonometricOperation
+};
+
+/**
+ * @brief Вычисление операции без исключений
+ *
+ * Семантика совпадает с applyBinaryOperation, factorial и applyTrigonometricOperation;
+ * предназначена для горячих циклов и пакетной обработки.
+ *
+ * @param op Операция
+ * @param a Первый операнд (угол в градусах для тригонометрии)
+ * @param b Второй операнд (для унарных операций не используется)
+ * @param result Результат; не изменяется при ошибке
+ * @return MathError::None или код ошибки
+ */
+MathError tryEvaluate(Operation op, double a, double b, double& result) noexcept;
+
+/**
+ * @brief Поэлементное вычисление операции над массивами операндов
+ *
+ * Для каждого i вычисляет операцию над a[i] и b[i] с той же семантикой, что и tryEvaluate,
+ * но записывает NaN вместо кода ошибки. Для сложения, вычитания, умножения и деления операция
+ * выбирается один раз на весь массив, остальные операции вычисляются через tryEvaluate
+ * для каждого элемента.
+ * Массив result может совпадать с a или b.
+ *
+ * @param op Операция
+ * @param a Первые операнды
+ * @param b Вторые операнды (для унарных операций может быть nullptr)
+ * @param result Результаты
+ * @param count Число элементов
+ */
+void evaluateVector(Operation op, const double* a, const double* b, double* result, size_t count) noexcept;
+
+/**
+ * @brief Вычисление операции
+ *
+ * @param op Операция
+ * @param a Первый операнд
+ * @param b Второй операнд (для унарных операций не используется)
+ * @return Результат операции
+ * @throw std::runtime_error С тем же сообщением, что и у соответствующей строковой функции
+ */
+double evaluate(Operation op, double a, double b = 0.0);
+
+/**
+ * @brief Текст ошибки, совпадающий с сообщением исключения строковых функций
+ * @param error Код ошибки
+ */
+const char* mathErrorMessage(MathError error);
+
+/**
+ * @brief Разбор обозначения операции ("+", "-", "*", "/", "^", "!", "sin", "cos", "tan", "cot")
+ *
+ * @param name Обозначение операции
+ * @param op Результат разбора
+ * @return false, если обозначение не распознано
+ */
+bool parseOperation(const std::string& name, Operation& op);
+
 /**
  * @brief Реализация бинарной операции
  *
@@ -21,6 +112,17 @@ double applyBinaryOperation(double a, const std::string& op, double b);
  */
 double factorial(double x);
 
+/**
+ * @brief Вычисление факториала с отчётом о прогрессе и кооперативной отменой
+ *
+ * @param x Входное число (должно быть неотрицательным целым)
+ * @param control Управление вычислением
+ * @return Факториал числа
+ * @throw std::runtime_error Для отрицательных или нецелых чисел
+ * @throw EvaluationCancelled Если через control запрошена отмена
+ */
+double factorial(double x, EvaluationControl& control);
+
 /**
  * @brief Реализация конвертации между системами счисления
  *
@@ -33,6 +135,19 @@ double factorial(double x);
  */
 std::string convertBase(const std::string& numberStr, int fromBase, int toBase);
 
+/**
+ * @brief Конвертация между системами счисления с отчётом о прогрессе и кооперативной отменой
+ *
+ * @param numberStr Строковое представление числа
+ * @param fromBase Исходная система счисления (2-16)
+ * @param toBase Целевая система счисления (2-16)
+ * @param control Управление вычислением
+ * @return Строковое представление числа в новой системе
+ * @throw std::runtime_error При недопустимом основании системы или некорректных цифрах числа
+ * @throw EvaluationCancelled Если через control запрошена отмена
+ */
+std::string convertBase(const std::string& numberStr, int fromBase, int toBase, EvaluationControl& control);
+
 /**
  * @brief Реализация тригонометрических операций
  *
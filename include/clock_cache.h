@@ -0,0 +1,245 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Счётчики попаданий кэша
+ */
+struct CacheStats {
+    uint64_t hits = 0;       ///< Найдено в кэше
+    uint64_t misses = 0;     ///< Не найдено
+    uint64_t insertions = 0; ///< Добавлено записей
+    uint64_t evictions = 0;  ///< Вытеснено записей
+
+    /**
+     * @brief Доля попаданий среди всех поисков
+     * @return Значение от 0 до 1 (0, если поисков не было)
+     */
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
+/**
+ * @brief Ограниченный многопоточный кэш с вытеснением по алгоритму CLOCK
+ *
+ * Записи разбиты на сегменты по хэшу ключа, сегмент — на наборы по kWays ячеек.
+ * Чтение не берёт блокировок: каждая ячейка защищена счётчиком версий (seqlock),
+ * и читатель повторяет проверку версии после копирования данных. Запись сериализуется
+ * мьютексом своего сегмента. При заполненном наборе стрелка CLOCK обходит его ячейки,
+ * снимая бит обращения, и вытесняет первую ячейку, к которой не обращались с прошлого обхода.
+ *
+ * @tparam Key Ключ; тривиально копируемый, размер кратен 8 байтам, без неинициализированных байтов
+ * @tparam Value Значение; тривиально копируемое, размер кратен 8 байтам
+ */
+template <typename Key, typename Value>
+class ClockCache {
+    static_assert(std::is_trivially_copyable<Key>::value && sizeof(Key) % 8 == 0, "Key must be word-sized POD");
+    static_assert(std::is_trivially_copyable<Value>::value && sizeof(Value) % 8 == 0, "Value must be word-sized POD");
+
+public:
+    static constexpr size_t kWays = 8;
+
+    /**
+     * @brief Создаёт пустой кэш
+     *
+     * @param capacity Наибольшее число записей (округляется вверх до степени двойки)
+     * @param shards Число сегментов (округляется вверх до степени двойки)
+     */
+    explicit ClockCache(size_t capacity, size_t shards = 16) {
+        shards = roundUpPowerOfTwo(std::max<size_t>(shards, 1));
+        size_t setsPerShard = roundUpPowerOfTwo(std::max<size_t>(capacity / (shards * kWays), 1));
+        shardMask_ = shards - 1;
+        for (size_t i = 0; i < shards; i++)
+            shards_.emplace_back(new Shard(setsPerShard));
+    }
+
+    /**
+     * @brief Поиск записи без блокировок
+     *
+     * @param key Ключ
+     * @param hash Хэш ключа
+     * @param value Найденное значение
+     * @return true при попадании
+     */
+    bool find(const Key& key, uint64_t hash, Value& value) const {
+        Shard& shard = shardFor(hash);
+        Slot* set = shard.setFor(hash);
+        uint64_t tag = hash | 1;
+        for (size_t way = 0; way < kWays; way++) {
+            Slot& slot = set[way];
+            if (slot.tag.load(std::memory_order_relaxed) != tag)
+                continue;
+            uint32_t version = slot.version.load(std::memory_order_acquire);
+            if (version & 1)
+                continue;
+            uint64_t keyWords[kKeyWords];
+            uint64_t valueWords[kValueWords];
+            for (size_t i = 0; i < kKeyWords; i++)
+                keyWords[i] = slot.key[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < kValueWords; i++)
+                valueWords[i] = slot.value[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != version || std::memcmp(keyWords, &key, sizeof(Key)) != 0)
+                continue;
+            std::memcpy(&value, valueWords, sizeof(Value));
+            if (!slot.referenced.load(std::memory_order_relaxed))
+                slot.referenced.store(1, std::memory_order_relaxed);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Добавляет или обновляет запись
+     *
+     * @param key Ключ
+     * @param hash Хэш ключа (тот же, что и при поиске)
+     * @param value Значение
+     */
+    void insert(const Key& key, uint64_t hash, const Value& value) {
+        Shard& shard = shardFor(hash);
+        size_t setIndex = shard.setIndex(hash);
+        Slot* set = shard.slots.get() + setIndex * kWays;
+        uint64_t tag = hash | 1;
+        uint64_t keyWords[kKeyWords];
+        std::memcpy(keyWords, &key, sizeof(Key));
+
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+        Slot* target = nullptr;
+        for (size_t way = 0; way < kWays && !target; way++) {
+            if (set[way].tag.load(std::memory_order_relaxed) == tag && set[way].matches(keyWords))
+                target = &set[way];
+        }
+        for (size_t way = 0; way < kWays && !target; way++) {
+            if (set[way].tag.load(std::memory_order_relaxed) == 0)
+                target = &set[way];
+        }
+        if (!target) {
+            uint8_t& hand = shard.hands[setIndex];
+            while (set[hand].referenced.load(std::memory_order_relaxed)) {
+                set[hand].referenced.store(0, std::memory_order_relaxed);
+                hand = (hand + 1) % kWays;
+            }
+            target = &set[hand];
+            hand = (hand + 1) % kWays;
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t valueWords[kValueWords];
+        std::memcpy(valueWords, &value, sizeof(Value));
+        uint32_t version = target->version.load(std::memory_order_relaxed);
+        target->version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        target->tag.store(tag, std::memory_order_relaxed);
+        for (size_t i = 0; i < kKeyWords; i++)
+            target->key[i].store(keyWords[i], std::memory_order_relaxed);
+        for (size_t i = 0; i < kValueWords; i++)
+            target->value[i].store(valueWords[i], std::memory_order_relaxed);
+        target->referenced.store(0, std::memory_order_relaxed);
+        target->version.store(version + 2, std::memory_order_release);
+        shard.insertions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Удаляет все записи и обнуляет счётчики
+     *
+     * Безопасна при параллельных чтениях: читатель либо увидит старую запись, либо промах.
+     */
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->writeMutex);
+            for (size_t i = 0; i < shard->slotCount; i++) {
+                Slot& slot = shard->slots[i];
+                uint32_t version = slot.version.load(std::memory_order_relaxed);
+                slot.version.store(version + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.tag.store(0, std::memory_order_relaxed);
+                slot.version.store(version + 2, std::memory_order_release);
+            }
+            shard->hits = 0;
+            shard->misses = 0;
+            shard->insertions = 0;
+            shard->evictions = 0;
+        }
+    }
+
+    /**
+     * @brief Сумма счётчиков по всем сегментам
+     */
+    CacheStats stats() const {
+        CacheStats total;
+        for (const auto& shard : shards_) {
+            total.hits += shard->hits.load(std::memory_order_relaxed);
+            total.misses += shard->misses.load(std::memory_order_relaxed);
+            total.insertions += shard->insertions.load(std::memory_order_relaxed);
+            total.evictions += shard->evictions.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Наибольшее число записей
+     */
+    size_t capacity() const { return shards_.size() * shards_[0]->slotCount; }
+
+private:
+    static constexpr size_t kKeyWords = sizeof(Key) / 8;
+    static constexpr size_t kValueWords = sizeof(Value) / 8;
+
+    struct Slot {
+        std::atomic<uint32_t> version{ 0 };
+        std::atomic<uint8_t> referenced{ 0 };
+        std::atomic<uint64_t> tag{ 0 };
+        std::atomic<uint64_t> key[kKeyWords] = {};
+        std::atomic<uint64_t> value[kValueWords] = {};
+
+        bool matches(const uint64_t* keyWords) const {
+            for (size_t i = 0; i < kKeyWords; i++) {
+                if (key[i].load(std::memory_order_relaxed) != keyWords[i])
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    struct alignas(64) Shard {
+        explicit Shard(size_t sets)
+            : slotCount(sets * kWays), setMask(sets - 1), slots(new Slot[sets * kWays]), hands(sets, 0) {}
+
+        size_t setIndex(uint64_t hash) const { return static_cast<size_t>(hash >> 32) & setMask; }
+        Slot* setFor(uint64_t hash) const { return slots.get() + setIndex(hash) * kWays; }
+
+        size_t slotCount;
+        size_t setMask;
+        std::unique_ptr<Slot[]> slots;
+        std::vector<uint8_t> hands;
+        std::mutex writeMutex;
+        mutable std::atomic<uint64_t> hits{ 0 };
+        mutable std::atomic<uint64_t> misses{ 0 };
+        std::atomic<uint64_t> insertions{ 0 };
+        std::atomic<uint64_t> evictions{ 0 };
+    };
+
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    Shard& shardFor(uint64_t hash) const { return *shards_[static_cast<size_t>(hash) & shardMask_]; }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shardMask_ = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/**
+ * @brief Разбирает целый параметр командной строки
+ *
+ * Аргумент должен целиком быть десятичным числом без знака и лишних символов
+ * и лежать в пределах [minimum, maximum]. Тип пределов выводится только из value,
+ * поэтому их можно передавать обычными литералами.
+ *
+ * @param text Аргумент
+ * @param minimum Наименьшее допустимое значение
+ * @param maximum Наибольшее допустимое значение
+ * @param value Результат; не изменяется при ошибке
+ * @return false, если аргумент не такое число
+ */
+template <typename T>
+bool parseCount(const char* text, std::common_type_t<T> minimum, std::common_type_t<T> maximum, T& value) {
+    std::string_view view(text);
+    T parsed{};
+    auto result = std::from_chars(view.data(), view.data() + view.size(), parsed);
+    if (result.ec != std::errc() || result.ptr != view.data() + view.size() || parsed < minimum || parsed > maximum)
+        return false;
+    value = parsed;
+    return true;
+}
+
+/**
+ * @brief Разбирает конечное число с плавающей точкой из параметра командной строки
+ *
+ * В отличие от atof, аргумент должен быть числом целиком: "abc" и "2x" отвергаются.
+ *
+ * @param text Аргумент
+ * @param value Результат; не изменяется при ошибке
+ * @return false, если аргумент не конечное число
+ */
+inline bool parseNumber(const char* text, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed))
+        return false;
+    value = parsed;
+    return true;
+}
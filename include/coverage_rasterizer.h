@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Растеризатор многоугольников со сглаживанием по точной площади покрытия
+ *
+ * Каждый отрезок контура добавляет в буфер накопления долю площади, которую он отсекает
+ * в каждом пикселе; итоговое покрытие получается префиксной суммой по строке развёртки.
+ * Контуры должны быть замкнуты. Части контура левее и правее области прижимаются к её краю,
+ * поэтому покрытие внутри области остаётся точным; строки выше и ниже области отбрасываются.
+ */
+class CoverageRasterizer {
+public:
+    /**
+     * @brief Создаёт растеризатор для области заданного размера
+     * @param width Ширина в пикселях
+     * @param height Высота в пикселях
+     */
+    CoverageRasterizer(int width, int height);
+
+    /**
+     * @brief Добавляет отрезок контура
+     *
+     * @param x0 Абсцисса начала
+     * @param y0 Ордината начала (ось направлена вниз)
+     * @param x1 Абсцисса конца
+     * @param y1 Ордината конца
+     */
+    void addLine(float x0, float y0, float x1, float y1);
+
+    /**
+     * @brief Добавляет квадратичную кривую Безье, аппроксимированную отрезками
+     *
+     * @param x0 Абсцисса начала
+     * @param y0 Ордината начала
+     * @param cx Абсцисса контрольной точки
+     * @param cy Ордината контрольной точки
+     * @param x1 Абсцисса конца
+     * @param y1 Ордината конца
+     */
+    void addQuadratic(float x0, float y0, float cx, float cy, float x1, float y1);
+
+    /**
+     * @brief Переводит накопленные площади в покрытие 0-255
+     *
+     * @param out Буфер размером width * height, строки идут сверху вниз
+     */
+    void resolve(uint8_t* out) const;
+
+    /**
+     * @brief Обнуляет накопленные площади для повторного использования
+     */
+    void clear();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    int width_;
+    int height_;
+    int stride_;
+    std::vector<float> accumulation_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <stdexcept>
+
+/**
+ * @brief Исключение, которым прерывается отменённое вычисление
+ */
+class EvaluationCancelled : public std::runtime_error {
+public:
+    EvaluationCancelled() : std::runtime_error("Evaluation cancelled") {}
+};
+
+/**
+ * @brief Кооперативная отмена и отчёт о прогрессе долгого вычисления
+ *
+ * Вычисление периодически вызывает checkpoint(), сообщая долю выполненной работы;
+ * другой поток может в любой момент запросить отмену через cancel().
+ * Все методы потокобезопасны.
+ */
+class EvaluationControl {
+public:
+    /**
+     * @brief Запрашивает отмену вычисления
+     */
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Доля выполненной работы
+     * @return Значение от 0 до 1
+     */
+    float progress() const { return progress_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Сообщает прогресс и проверяет запрос отмены
+     *
+     * @param progress Доля выполненной работы от 0 до 1
+     * @throw EvaluationCancelled Если запрошена отмена
+     */
+    void checkpoint(float progress) {
+        progress_.store(progress, std::memory_order_relaxed);
+        if (cancelled())
+            throw EvaluationCancelled();
+    }
+
+private:
+    std::atomic<bool> cancelled_{ false };
+    std::atomic<float> progress_{ 0.0f };
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Параметры потокового конвейера
+ */
+struct PipelineOptions {
+    size_t lanes = 0;              ///< Параллельных цепочек разбор → вычисление → форматирование; 0 — по числу ядер
+    size_t batchBytes = 1 << 16;   ///< Наибольший объём ввода в одном пакете
+    size_t batchesPerLane = 4;     ///< Пакетов в обороте на цепочку: ограничивает память и задержку
+};
+
+/**
+ * @brief Счётчики потокового конвейера
+ */
+struct PipelineStats {
+    uint64_t lines = 0;            ///< Вычислено строк
+    uint64_t errors = 0;           ///< Строк с ошибкой
+    uint64_t batches = 0;          ///< Пакетов
+    double meanLatencyMs = 0.0;    ///< Среднее время от чтения пакета до записи его результатов
+    double maxLatencyMs = 0.0;     ///< Наибольшее время от чтения пакета до записи
+};
+
+/**
+ * @brief Вычисляет неограниченный поток выражений (по одному на строку) конвейером потоков
+ *
+ * Стадии работают в отдельных потоках: чтение → разбор → вычисление → форматирование → запись.
+ * Чтение нарезает ввод на пакеты целых строк и раздаёт их по кругу цепочкам разбора, вычисления
+ * и форматирования; запись забирает пакеты из цепочек в том же порядке, поэтому результаты идут
+ * в порядке строк. Стадии связаны неблокирующими очередями SpscRing, а пакеты после записи
+ * возвращаются чтению: когда свободных пакетов нет, чтение ждёт, так что память и задержка ограничены
+ * числом пакетов в обороте. Читается то, что уже доступно (readAvailable), а вывод сбрасывается,
+ * как только очередной пакет ещё не готов, поэтому на медленном потоке ответ не ждёт заполнения буфера.
+ *
+ * @param in Поток выражений
+ * @param out Поток результатов
+ * @param options Параметры
+ * @return Счётчики
+ * @throw std::runtime_error Если результаты не удалось записать
+ */
+PipelineStats runEvaluationPipeline(std::FILE* in, std::FILE* out, const PipelineOptions& options = PipelineOptions());
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "calculator_math.h"
+#include "interval.h"
+
+/**
+ * @brief Выражение над переменными, скомпилированное в обратную польскую запись
+ *
+ * Синтаксис: числа, переменные, константа pi, операции + - * / ^ (правоассоциативная),
+ * унарный минус, постфиксный факториал !, функции sin cos tan cot (угол в градусах)
+ * и скобки. Функция применяется к следующему операнду вместе со степенью и факториалом:
+ * "sin x^2" означает sin(x^2), "sin x * 2" — (sin x) * 2. Соседние операнды без знака
+ * перемножаются: "2x", "3 sin x". Подвыражения из одних констант вычисляются при разборе.
+ *
+ * Семантика операций совпадает с tryEvaluate; вычисление не бросает исключений,
+ * а ошибка любой операции (деление на ноль, tan 90, факториал дробного) даёт NaN.
+ */
+class Expression {
+public:
+    static constexpr size_t kMaxStackDepth = 64;
+
+    Expression() = default;
+
+    /**
+     * @brief Разбирает и компилирует выражение
+     *
+     * @param text Текст выражения
+     * @param variables Имена переменных; их порядок задаёт порядок значений при вычислении
+     * @return Скомпилированное выражение
+     * @throw std::runtime_error При синтаксической ошибке или неизвестном имени
+     */
+    static Expression parse(const std::string& text, const std::vector<std::string>& variables = { "x" });
+
+    /**
+     * @brief Разбирает выражение в этот объект, переиспользуя память прежней программы
+     *
+     * Для потоковой обработки множества выражений: в отличие от parse не выделяет память
+     * на каждое выражение. При ошибке объект остаётся пустым.
+     *
+     * @param text Текст выражения (может указывать прямо в буфер ввода)
+     * @param variables Имена переменных
+     * @throw std::runtime_error При синтаксической ошибке или неизвестном имени
+     */
+    void compile(std::string_view text, const std::vector<std::string>& variables);
+
+    /**
+     * @brief Вычисляет выражение в одной точке
+     *
+     * @param variables Значения переменных в порядке, заданном при разборе
+     * @param result Результат; не изменяется при ошибке
+     * @return MathError::None или код первой ошибки
+     */
+    MathError evaluate(const double* variables, double& result) const noexcept;
+
+    /**
+     * @brief Вычисляет выражение одной переменной
+     * @param x Значение переменной
+     * @return Результат или NaN при ошибке
+     */
+    double operator()(double x) const noexcept;
+
+    /**
+     * @brief Вычисляет выражение в наборе точек
+     *
+     * Точки обрабатываются блоками: каждая инструкция программы выполняется
+     * сразу для всего блока через evaluateVector, поэтому разбор программы
+     * не повторяется для каждой точки.
+     *
+     * @param variables variables[k] — массив значений k-й переменной
+     * @param result Результаты (NaN при ошибке)
+     * @param count Число точек
+     */
+    void evaluateBatch(const double* const* variables, double* result, size_t count) const;
+
+    /**
+     * @brief Вычисляет выражение одной переменной в наборе точек
+     *
+     * @param x Значения переменной
+     * @param result Результаты (NaN при ошибке)
+     * @param count Число точек
+     */
+    void evaluateBatch(const double* x, double* result, size_t count) const { evaluateBatch(&x, result, count); }
+
+    /**
+     * @brief Вычисляет выражение в наборе точек без выделения памяти
+     *
+     * То же, что evaluateBatch, но стек вычисления размещается в буфере вызывающего,
+     * который можно переиспользовать между вызовами.
+     *
+     * @param variables variables[k] — массив значений k-й переменной
+     * @param result Результаты (NaN при ошибке)
+     * @param count Число точек
+     * @param scratch Буфер не меньше batchScratchSize() элементов
+     */
+    void evaluateBatch(const double* const* variables, double* result, size_t count, double* scratch) const noexcept;
+
+    /**
+     * @brief Размер буфера для evaluateBatch с внешним стеком, в элементах double
+     */
+    size_t batchScratchSize() const;
+
+    /**
+     * @brief Вычисляет промежуток значений выражения на прямоугольнике значений переменных
+     *
+     * Каждая инструкция выполняется через evaluateInterval, поэтому результат содержит
+     * значения выражения во всех точках, где оно определено. Из-за повторных вхождений
+     * переменной промежуток может быть шире точного и сужается при делении области.
+     *
+     * @param variables Промежутки переменных в порядке, заданном при разборе
+     * @return Промежуток значений; пустой, если выражение не определено ни в одной точке
+     */
+    Interval evaluateInterval(const Interval* variables) const noexcept;
+
+    /**
+     * @brief Является ли выражение константой (не зависит от переменных)
+     */
+    bool isConstant() const { return program_.size() == 1 && program_[0].kind == Instruction::Constant; }
+
+    size_t variableCount() const { return variableCount_; }
+    const std::string& text() const { return text_; }
+
+private:
+    struct Instruction {
+        enum Kind {
+            Constant,
+            Variable,
+            Negate,
+            Unary,
+            Binary
+        };
+        Kind kind;
+        Operation op;
+        double value;
+        size_t index;
+    };
+
+    friend class ExpressionParser;
+
+    std::vector<Instruction> program_;
+    size_t stackDepth_ = 0;
+    size_t variableCount_ = 0;
+    std::string text_;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Переводит округлённый номер узла сетки из double в int64_t с проверкой диапазона
+ *
+ * Кэши адресуют узлы и плитки сетки целыми номерами. Далеко от нуля или на мелком уровне номер
+ * не помещается в int64_t, а приведение такого double не определено, поэтому номер
+ * проверяется до приведения.
+ *
+ * @param value Номер, уже округлённый floor или ceil
+ * @param limit Наибольший допустимый модуль номера, не больше 2^62
+ * @param index Результат; не изменяется при ошибке
+ * @return false, если value не конечно или больше limit по модулю
+ */
+inline bool toGridIndex(double value, double limit, int64_t& index) {
+    if (!(std::fabs(value) <= limit))
+        return false;
+    index = static_cast<int64_t>(value);
+    return true;
+}
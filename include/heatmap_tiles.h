@@ -0,0 +1,166 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "expression.h"
+#include "plot_viewport.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Плитка тепловой карты: kTileSize x kTileSize ячеек со стороной 2^level,
+ * левый нижний угол в точке (tx, ty) * kTileSize * 2^level
+ */
+struct HeatmapTileKey {
+    int level;
+    int64_t tx;
+    int64_t ty;
+
+    bool operator==(const HeatmapTileKey& other) const {
+        return level == other.level && tx == other.tx && ty == other.ty;
+    }
+};
+
+/**
+ * @brief Хеш ключа плитки для неупорядоченных контейнеров
+ */
+struct HeatmapTileKeyHash {
+    size_t operator()(const HeatmapTileKey& key) const {
+        // В беззнаковой арифметике переполнение при больших номерах плиток определено
+        uint64_t mixed = (static_cast<uint64_t>(key.tx) * 1000003 + static_cast<uint64_t>(key.ty)) * 128;
+        return std::hash<uint64_t>()(mixed + static_cast<uint64_t>(key.level));
+    }
+};
+
+/**
+ * @brief Значения функции в центрах ячеек плитки
+ */
+struct HeatmapTile {
+    HeatmapTileKey key;
+    std::vector<float> values;  ///< По строкам сверху вниз (от большего y к меньшему); NaN — не определено
+    float low;                  ///< Наименьшее определённое значение (NaN, если таких нет)
+    float high;                 ///< Наибольшее определённое значение (NaN, если таких нет)
+};
+
+/**
+ * @brief Счётчики кэша плиток
+ */
+struct HeatmapCacheStats {
+    uint64_t evaluations = 0;  ///< Вычислено значений функции
+    uint64_t tileHits = 0;     ///< Плиток, найденных в кэше
+    uint64_t tileMisses = 0;   ///< Плиток, которые пришлось построить
+};
+
+/**
+ * @brief Кэш плиток тепловой карты функции двух переменных
+ *
+ * Как у сервера картографических плиток, сетка плиток не зависит от положения окна:
+ * уровень выбирается по размеру пикселя, а плитка адресуется уровнем и номерами по x и y.
+ * При сдвиге строятся только открывшиеся плитки, при возврате к прежнему масштабу плитки
+ * берутся из кэша. Каждая плитка вычисляется одним пакетом Expression::evaluateBatch,
+ * недостающие плитки кадра строятся параллельно задачами пула. Плитки вытесняются
+ * по давности использования.
+ *
+ * Методы потокобезопасны.
+ */
+class HeatmapTileCache {
+public:
+    static constexpr int kTileSize = 256;
+
+    /**
+     * @brief Создаёт пустой кэш
+     *
+     * @param function Выражение переменных x и y
+     * @param maxTiles Наибольшее число хранимых плиток
+     */
+    explicit HeatmapTileCache(Expression function, size_t maxTiles = 128);
+
+    /**
+     * @brief Уровень для области: сторона ячейки 2^level ближе всего к ширине пикселя
+     */
+    static int levelFor(const PlotViewport& viewport);
+
+    /**
+     * @brief Ёмкость кэша для области: вдвое больше наибольшего числа плиток, покрывающих её при любом сдвиге
+     *
+     * Зависит от размера области в пикселях (и от масштаба только на крайних уровнях), поэтому
+     * при сдвиге и обычном масштабировании не меняется, а при изменении размера окна пересчитывается.
+     */
+    static size_t capacityFor(const PlotViewport& viewport);
+
+    /**
+     * @brief Ключи плиток уровня levelFor, покрывающих область
+     *
+     * Пусто, если область сетка не адресует: номер плитки вне ±2^54 (мелкий уровень далеко от нуля)
+     * или плиток больше 65536 (область во много раз шире крупнейшего уровня). Такая область не рисуется.
+     */
+    static void visibleTiles(const PlotViewport& viewport, std::vector<HeatmapTileKey>& keys);
+
+    /**
+     * @brief Границы плитки в координатах графика
+     */
+    static void tileBounds(const HeatmapTileKey& key, double& xMin, double& xMax, double& yMin, double& yMax);
+
+    /**
+     * @brief Возвращает плитки, покрывающие область, строя недостающие
+     *
+     * @param viewport Видимая область
+     * @param tiles Плитки области
+     * @param pool Пул для параллельного построения или nullptr
+     * @return Число построенных плиток
+     */
+    size_t update(const PlotViewport& viewport, std::vector<std::shared_ptr<const HeatmapTile>>& tiles,
+        ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Вычисляет плитку и помещает её в кэш
+     */
+    std::shared_ptr<const HeatmapTile> buildTile(const HeatmapTileKey& key);
+
+    /**
+     * @brief Плитка из кэша или nullptr
+     */
+    std::shared_ptr<const HeatmapTile> find(const HeatmapTileKey& key) const;
+
+    /**
+     * @brief Меняет наибольшее число хранимых плиток; лишние вытесняются по давности использования
+     */
+    void setMaxTiles(size_t maxTiles);
+
+    HeatmapCacheStats stats() const;
+    const Expression& function() const { return function_; }
+    size_t size() const;
+
+    /**
+     * @brief Удаляет все плитки
+     */
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const HeatmapTile> tile;
+        uint64_t lastUse = 0;
+    };
+
+    void evictLocked();
+
+    Expression function_;
+    size_t maxTiles_;
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<HeatmapTileKey, Entry, HeatmapTileKeyHash> tiles_;
+    mutable uint64_t useClock_ = 0;
+    mutable HeatmapCacheStats stats_;
+};
+
+/**
+ * @brief Раскрашивает значения палитрой от тёмно-фиолетового (low) до жёлтого (high)
+ *
+ * @param values Значения
+ * @param count Число значений
+ * @param low Значение, соответствующее началу палитры
+ * @param high Значение, соответствующее концу палитры
+ * @param rgba Результат, 4 байта на значение; неопределённые значения прозрачны
+ */
+void colorizeHeatmap(const float* values, size_t count, float low, float high, uint8_t* rgba);
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "expression.h"
+#include "plot_viewport.h"
+#include "sample_cache.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Отрезок линии уровня в координатах графика
+ */
+struct ImplicitSegment {
+    PlotPoint a;
+    PlotPoint b;
+};
+
+/**
+ * @brief Параметры построения неявно заданной кривой
+ *
+ * Размеры задаются в пикселях и должны быть степенями двойки, причём leafCell <= coarseCell <= tileSize.
+ */
+struct ImplicitPlotOptions {
+    int tileSize = 64;           ///< Сторона плитки — единицы параллельной работы
+    int coarseCell = 32;         ///< Сторона ячейки начальной сетки
+    int leafCell = 1;            ///< Сторона ячейки, в которой строятся отрезки
+    bool intervalCheck = true;   ///< Делить и ячейки без смены знака, если промежуток значений содержит 0
+};
+
+/**
+ * @brief Счётчики последнего построения
+ */
+struct ImplicitPlotStats {
+    uint64_t evaluations = 0;          ///< Вычислено значений f(x, y)
+    uint64_t intervalEvaluations = 0;  ///< Вычислено промежутков значений на ячейках
+    uint64_t refined = 0;              ///< Разделено ячеек
+    uint64_t leaves = 0;               ///< Ячеек наименьшего размера, дошедших до marching squares
+    size_t segments = 0;               ///< Отрезков в результате
+};
+
+/**
+ * @brief Разбирает отношение вида "левая = правая" в выражение f(x, y) = левая - правая
+ *
+ * @param text Текст отношения, например "x^2 + y^2 = 25"
+ * @return Выражение переменных x и y, нули которого образуют кривую
+ * @throw std::runtime_error Если знак = отсутствует или встречается больше одного раза, либо при ошибке в части
+ */
+Expression parseRelation(const std::string& text);
+
+/**
+ * @brief Построение кривой f(x, y) = 0 на адаптивном квадродереве
+ *
+ * Экран делится на плитки, которые обрабатываются независимыми задачами пула.
+ * В плитке значения вычисляются в узлах начальной сетки одним пакетом; ячейка делится
+ * на четыре, только если f меняет знак в её углах (или промежуток значений f на ней
+ * содержит 0, что находит замкнутые кривые меньше ячейки). Новые узлы каждого уровня
+ * тоже вычисляются пакетом. В ячейках наименьшего размера отрезки строятся методом
+ * marching squares с линейной интерполяцией по рёбрам. Поэтому число вычислений
+ * пропорционально длине кривой, а не площади экрана. В ячейках, где промежуток значений
+ * неограничен или задевает неопределённые точки (смена знака на полюсе), отрезки не строятся.
+ */
+class ImplicitPlotter {
+public:
+    explicit ImplicitPlotter(ImplicitPlotOptions options = ImplicitPlotOptions());
+
+    /**
+     * @brief Строит кривую для видимой области
+     *
+     * @param relation Выражение переменных x и y
+     * @param viewport Видимая область
+     * @param out Отрезки кривой
+     * @param pool Пул для параллельной обработки плиток или nullptr
+     * @return Счётчики построения
+     */
+    ImplicitPlotStats plot(const Expression& relation, const PlotViewport& viewport, std::vector<ImplicitSegment>& out,
+        ThreadPool* pool = nullptr) const;
+
+    const ImplicitPlotOptions& options() const { return options_; }
+
+private:
+    struct Tile;
+
+    void plotTile(Tile& tile) const;
+
+    ImplicitPlotOptions options_;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Одно нажатие кнопки в записанном сеансе ввода
+ */
+struct RecordedInput {
+    uint64_t timestampUs;  ///< Время от начала сеанса в микросекундах
+    std::string key;       ///< Метка нажатой кнопки
+};
+
+/**
+ * @brief Записывает нажатия кнопок реального сеанса в текстовый файл
+ *
+ * Каждая строка файла имеет вид "<микросекунды> <метка>".
+ * Файл читается функцией loadInputSession() и воспроизводится драйвером calculator_replay.
+ */
+class InputRecorder {
+public:
+    /**
+     * @brief Открывает файл сеанса для записи
+     * @param path Путь к файлу
+     * @throw std::runtime_error Если файл не удалось открыть
+     */
+    explicit InputRecorder(const std::string& path);
+
+    /**
+     * @brief Записывает нажатие с текущей отметкой времени
+     * @param key Метка нажатой кнопки
+     */
+    void record(const std::string& key);
+
+private:
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Загружает записанный сеанс ввода
+ *
+ * @param path Путь к файлу сеанса
+ * @return Нажатия в порядке записи
+ * @throw std::runtime_error Если файл не удалось открыть или строка имеет неверный формат
+ */
+std::vector<RecordedInput> loadInputSession(const std::string& path);
@@ -0,0 +1,45 @@
+#pragma once
+#include <limits>
+#include "calculator_math.h"
+
+/**
+ * @brief Замкнутый промежуток значений [lo, hi] для интервальной арифметики
+ *
+ * Промежуток-результат операции гарантированно содержит все значения, которые
+ * tryEvaluate вернул бы для операндов из промежутков-аргументов, включая округление
+ * почти целых результатов. Пустой промежуток (оба конца NaN) означает, что операция
+ * не определена ни в одной точке, а флаг partial — что она не определена в части точек
+ * (ошибка tryEvaluate или NaN, например степень отрицательного числа с дробным показателем).
+ */
+struct Interval {
+    double lo = 0.0;
+    double hi = 0.0;
+    bool partial = false;  ///< Часть точек вне области определения
+
+    static Interval point(double value) { return { value, value, false }; }
+    static Interval empty() {
+        return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), true };
+    }
+    static Interval whole(bool partial = false) {
+        return { -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), partial };
+    }
+
+    bool isEmpty() const { return !(lo <= hi); }
+    bool isPoint() const { return lo == hi; }
+    bool contains(double value) const { return lo <= value && value <= hi; }
+};
+
+/**
+ * @brief Интервальная версия операции калькулятора
+ *
+ * Поддерживает все операции Operation с той же областью определения, что и tryEvaluate:
+ * деление на промежуток, задевающий (-1e-6, 1e-6), факториал только в целых неотрицательных точках,
+ * tan и cot вне полюсов (угол в градусах). Границы расширяются наружу на погрешность
+ * округления, поэтому результат может быть немного шире точного.
+ *
+ * @param op Операция
+ * @param a Первый операнд
+ * @param b Второй операнд (для унарных операций не используется)
+ * @return Промежуток, содержащий все значения операции
+ */
+Interval evaluateInterval(Operation op, const Interval& a, const Interval& b = Interval::point(0.0)) noexcept;
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "expression.h"
+#include "plot_viewport.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Отрезок отмеченных пикселей в одном столбце экрана
+ */
+struct PixelSpan {
+    int column;    ///< Номер столбца
+    int rowBegin;  ///< Первая строка (сверху)
+    int rowEnd;    ///< Строка после последней
+};
+
+/**
+ * @brief Параметры интервального построения
+ */
+struct IntervalPlotOptions {
+    int blockWidth = 64;         ///< Ширина начального блока в пикселях (единица параллельной работы)
+    double minWidth = 1.0 / 8;   ///< Наименьшая ширина отрезка в пикселях
+    int maxDepth = 24;           ///< Наибольшее число делений начального блока
+};
+
+/**
+ * @brief Счётчики последнего интервального построения
+ */
+struct IntervalPlotStats {
+    uint64_t evaluations = 0;  ///< Вычислено промежутков и значений функции
+    uint64_t pruned = 0;       ///< Отрезков, на которых кривой заведомо нет на экране
+    uint64_t pixels = 0;       ///< Отмечено пикселей
+};
+
+/**
+ * @brief Гарантированное построение графика интервальной арифметикой
+ *
+ * Для отрезка оси x вычисляется промежуток значений функции (Expression::evaluateInterval).
+ * Если он пуст или не пересекает экран, отрезок отбрасывается целиком; иначе отрезок
+ * делится пополам по границам пикселей, пока не уляжется в один столбец и одну строку,
+ * не сравняется с размахом значений на концах или не станет уже minWidth. Каждый пиксель,
+ * через который проходит график, оказывается отмеченным, поэтому узкие пики, пропущенные
+ * точечной выборкой, не теряются, а области без графика отбрасываются за одно вычисление.
+ */
+class IntervalPlotter {
+public:
+    explicit IntervalPlotter(IntervalPlotOptions options = IntervalPlotOptions()) : options_(options) {}
+
+    /**
+     * @brief Отмечает пиксели, которые могут содержать график
+     *
+     * @param function Выражение одной переменной
+     * @param viewport Видимая область
+     * @param out Отрезки пикселей по возрастанию столбца и строки, без перекрытий
+     * @param pool Пул для параллельной обработки блоков или nullptr
+     * @return Счётчики построения
+     */
+    IntervalPlotStats plot(const Expression& function, const PlotViewport& viewport, std::vector<PixelSpan>& out,
+        ThreadPool* pool = nullptr) const;
+
+    const IntervalPlotOptions& options() const { return options_; }
+
+private:
+    struct Block;
+
+    void refine(Block& block, double p0, double p1, int depth) const;
+
+    IntervalPlotOptions options_;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Гистограмма задержек с логарифмическими корзинами
+ *
+ * Значения в наносекундах раскладываются по корзинам вида [2^k, 2^(k+1)),
+ * каждая из которых делится на kSubBuckets равных частей, что даёт относительную
+ * погрешность перцентилей не хуже 1/kSubBuckets. Запись значения не выделяет память.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kBuckets = 64 * kSubBuckets;
+
+    LatencyHistogram() { reset(); }
+
+    /**
+     * @brief Добавляет одно измерение
+     * @param nanoseconds Задержка в наносекундах
+     */
+    void record(uint64_t nanoseconds) {
+        counts_[bucketIndex(nanoseconds)]++;
+        count_++;
+        sum_ += nanoseconds;
+        if (nanoseconds < min_)
+            min_ = nanoseconds;
+        if (nanoseconds > max_)
+            max_ = nanoseconds;
+    }
+
+    /**
+     * @brief Очищает все накопленные измерения
+     */
+    void reset() {
+        counts_.fill(0);
+        count_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    /**
+     * @brief Оценка перцентиля по верхней границе корзины
+     *
+     * @param p Перцентиль от 0 до 100
+     * @return Значение в наносекундах, не меньшее p процентов измерений
+     */
+    uint64_t percentile(double p) const {
+        if (count_ == 0)
+            return 0;
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * count_ + 0.5);
+        if (target == 0)
+            target = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += counts_[i];
+            if (seen >= target) {
+                uint64_t upper = bucketUpperBound(i);
+                return upper < max_ ? upper : max_;
+            }
+        }
+        return max_;
+    }
+
+    /**
+     * @brief Печатает сводку и ненулевые корзины гистограммы
+     * @param out Поток вывода
+     */
+    void print(std::ostream& out) const {
+        out << "count=" << count() << " min=" << min() << "ns mean=" << static_cast<uint64_t>(mean())
+            << "ns p50=" << percentile(50) << "ns p90=" << percentile(90) << "ns p99=" << percentile(99)
+            << "ns p99.9=" << percentile(99.9) << "ns max=" << max() << "ns\n";
+        for (int i = 0; i < kBuckets; i++) {
+            if (counts_[i] == 0)
+                continue;
+            out << "  <= " << bucketUpperBound(i) << "ns: " << counts_[i] << "\n";
+        }
+    }
+
+private:
+    static int bucketIndex(uint64_t value) {
+        if (value < kSubBuckets)
+            return static_cast<int>(value);
+        int msb = 0;
+        while ((value >> msb) > 1)
+            msb++;
+        int sub = static_cast<int>((value >> (msb - kSubBucketBits)) & (kSubBuckets - 1));
+        return (msb - kSubBucketBits + 1) * kSubBuckets + sub;
+    }
+
+    static uint64_t bucketUpperBound(int index) {
+        if (index < kSubBuckets)
+            return static_cast<uint64_t>(index);
+        int msb = index / kSubBuckets + kSubBucketBits - 1;
+        uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+        uint64_t width = 1ull << (msb - kSubBucketBits);
+        return (1ull << msb) + (sub + 1) * width - 1;
+    }
+
+    std::array<uint64_t, kBuckets> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "expression.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Записывает число с 15 значащими цифрами без лишних нулей
+ *
+ * 15 цифр точно представимы в double, поэтому шум округления (sin 30 = 0.49999999999999994)
+ * не попадает в вывод. Форматирование через to_chars, без локали и потоков.
+ *
+ * @param value Число
+ * @param buffer Буфер не меньше kNumberBufferSize символов
+ * @return Число записанных символов (без завершающего нуля)
+ */
+size_t formatNumber(double value, char* buffer) noexcept;
+
+constexpr size_t kNumberBufferSize = 32;
+
+/**
+ * @brief Читает из файла то, что уже доступно, не дожидаясь заполнения буфера
+ *
+ * Читает напрямую из дескриптора файла, поэтому на канале или терминале возвращает
+ * уже пришедшие данные, а не ждёт size байт, как fread.
+ *
+ * @return Число прочитанных байтов; 0 — конец файла или ошибка
+ */
+size_t readAvailable(std::FILE* file, char* buffer, size_t size);
+
+/**
+ * @brief Чтение строк крупными блоками без копирования каждой строки
+ *
+ * Строки возвращаются как string_view прямо в буфер блока и действительны до следующего вызова next.
+ * В начало буфера переносится только незавершённый хвост блока. Завершающий '\r' отбрасывается.
+ * Блок читается через readAvailable, поэтому строки приходят сразу, даже если блок не заполнен.
+ */
+class LineReader {
+public:
+    /**
+     * @param file Открытый файл (например, stdin)
+     * @param blockSize Размер блока чтения в байтах
+     */
+    explicit LineReader(std::FILE* file, size_t blockSize = 1 << 20);
+
+    /**
+     * @brief Следующая строка
+     * @return false, если файл закончился
+     */
+    bool next(std::string_view& line);
+
+    /**
+     * @brief Есть ли следующая строка в буфере (next не будет ждать ввода)
+     */
+    bool lineReady() const;
+
+private:
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;  ///< Начало непрочитанных данных
+    size_t end_ = 0;    ///< Конец прочитанных из файла данных
+    bool eof_ = false;
+};
+
+/**
+ * @brief Вычисление выражений без переменных по одному на строку
+ *
+ * Переиспользует одну скомпилированную программу (Expression::compile), поэтому
+ * в установившемся режиме память на строку не выделяется. Результат записывается
+ * с 15 значащими цифрами; пустая строка даёт пустую, ошибка — "error: <сообщение>".
+ */
+class LineEvaluator {
+public:
+    /**
+     * @brief Вычисляет выражение строки и дописывает в out результат и перевод строки
+     * @return false, если строка содержит ошибку
+     */
+    bool evaluateLine(std::string_view line, std::string& out);
+
+    /**
+     * @brief Вычисляет выражение строки
+     *
+     * @param line Текст выражения
+     * @param result Результат
+     * @param error Сообщение об ошибке, если она есть
+     * @return false при синтаксической ошибке или ошибке вычисления
+     */
+    bool evaluate(std::string_view line, double& result, std::string& error);
+
+private:
+    Expression expression_;
+};
+
+/**
+ * @brief Счётчики пакетного вычисления
+ */
+struct LineBatchStats {
+    size_t lines = 0;   ///< Вычислено строк
+    size_t errors = 0;  ///< Строк с ошибкой
+};
+
+/**
+ * @brief Параллельно вычисляет выражения текста по одному на строку и записывает результаты в порядке строк
+ *
+ * Текст делится на отрезки около chunkSize байт по границам строк. Отрезки окна (по четыре на поток пула)
+ * разбираются задачами пула, у каждой свой LineEvaluator и свой буфер вывода; затем буферы окна
+ * записываются в out по порядку отдельной задачей, пока вычисляется следующее окно. Поэтому память
+ * на вывод ограничена двумя окнами, а запись не останавливает вычисление. Функция ждёт задачу записи,
+ * поэтому её нельзя вызывать из задачи того же пула.
+ *
+ * @param text Текст (например, отображённый в память файл)
+ * @param out Файл результатов
+ * @param pool Пул потоков или nullptr для вычисления в вызывающем потоке
+ * @param chunkSize Примерный размер отрезка в байтах
+ * @return Счётчики
+ * @throw std::runtime_error Если результаты не удалось записать
+ */
+LineBatchStats evaluateLines(std::string_view text, std::FILE* out, ThreadPool* pool = nullptr, size_t chunkSize = 1 << 20);
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Файл, отображённый в память только для чтения
+ *
+ * Содержимое читается страницами по мере обращения, без копирования в буфер процесса;
+ * система предупреждается о последовательном чтении. Пустой файл даёт пустое содержимое.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Отображает файл целиком
+     * @throw std::runtime_error Если файл не удалось открыть или отобразить
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "calculator_math.h"
+#include "clock_cache.h"
+
+class EvaluationControl;
+
+/**
+ * @brief Кэш результатов дорогих функций calculator_math
+ *
+ * Запоминает результаты tryEvaluate (включая коды ошибок) по идентификатору операции
+ * и битовому представлению операндов, а также результаты convertBase для чисел
+ * не длиннее kMaxCachedDigits символов. Кэш необязателен: функции calculator_math
+ * о нём не знают, а вызывающий код обращается к нему явно, поэтому без кэша
+ * дополнительных расходов нет. Все методы потокобезопасны.
+ */
+class MemoCache {
+public:
+    static constexpr size_t kMaxCachedDigits = 40;
+
+    /**
+     * @brief Создаёт пустой кэш
+     * @param capacity Наибольшее число записей каждого вида
+     */
+    explicit MemoCache(size_t capacity = 65536);
+
+    /**
+     * @brief Вычисление операции через кэш без исключений
+     *
+     * @param op Операция
+     * @param a Первый операнд
+     * @param b Второй операнд (для унарных операций не учитывается)
+     * @param result Результат; не изменяется при ошибке
+     * @return MathError::None или код ошибки
+     */
+    MathError tryEvaluate(Operation op, double a, double b, double& result);
+
+    /**
+     * @brief Вычисление операции через кэш
+     *
+     * @throw std::runtime_error С тем же сообщением, что и у evaluate()
+     */
+    double evaluate(Operation op, double a, double b = 0.0);
+
+    /**
+     * @brief Факториал через кэш с поддержкой отмены
+     *
+     * При промахе вычисление выполняется factorial(x, control); отменённое вычисление не запоминается.
+     *
+     * @throw std::runtime_error Для отрицательных или нецелых чисел
+     * @throw EvaluationCancelled Если через control запрошена отмена
+     */
+    double factorial(double x, EvaluationControl& control);
+
+    /**
+     * @brief Конвертация между системами счисления через кэш
+     *
+     * Ошибочные запросы не запоминаются.
+     *
+     * @param control Управление вычислением или nullptr
+     * @throw std::runtime_error Как и convertBase()
+     * @throw EvaluationCancelled Если через control запрошена отмена
+     */
+    std::string convertBase(const std::string& numberStr, int fromBase, int toBase, EvaluationControl* control = nullptr);
+
+    /**
+     * @brief Счётчики числовых операций
+     */
+    CacheStats operationStats() const { return operations_.stats(); }
+
+    /**
+     * @brief Счётчики конвертаций
+     */
+    CacheStats conversionStats() const { return conversions_.stats(); }
+
+    /**
+     * @brief Удаляет все записи и обнуляет счётчики
+     */
+    void clear();
+
+private:
+    struct OperationKey {
+        uint64_t op;
+        uint64_t a;
+        uint64_t b;
+    };
+
+    struct OperationValue {
+        double result;
+        uint64_t error;
+    };
+
+    struct ConversionKey {
+        uint32_t fromBase;
+        uint32_t toBase;
+        uint64_t length;
+        char digits[kMaxCachedDigits];
+    };
+
+    struct ConversionValue {
+        char text[72];
+    };
+
+    static OperationKey makeKey(Operation op, double a, double b, uint64_t& hash);
+    bool findOperation(const OperationKey& key, uint64_t hash, double& result, MathError& error) const;
+    void storeOperation(const OperationKey& key, uint64_t hash, double result, MathError error);
+
+    ClockCache<OperationKey, OperationValue> operations_;
+    ClockCache<ConversionKey, ConversionValue> conversions_;
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "expression.h"
+#include "plot_viewport.h"
+#include "sample_cache.h"
+
+/**
+ * @brief Кривая (x(t), y(t)) или r(t) в полярных координатах, t ∈ [tMin, tMax]
+ *
+ * Параметр в выражениях обозначается t; для полярной кривой t — угол в градусах,
+ * как у тригонометрических операций калькулятора.
+ */
+class ParametricCurve {
+public:
+    /**
+     * @brief Параметрическая кривая
+     *
+     * @param x Выражение x(t)
+     * @param y Выражение y(t)
+     * @param tMin Начало диапазона параметра
+     * @param tMax Конец диапазона параметра
+     * @throw std::runtime_error При ошибке в выражении или пустом диапазоне
+     */
+    static ParametricCurve parametric(const std::string& x, const std::string& y, double tMin, double tMax);
+
+    /**
+     * @brief Полярная кривая: x = r cos t, y = r sin t
+     *
+     * @param r Выражение r(t)
+     * @param tMin Начальный угол в градусах
+     * @param tMax Конечный угол в градусах
+     * @throw std::runtime_error При ошибке в выражении или пустом диапазоне
+     */
+    static ParametricCurve polar(const std::string& r, double tMin = 0.0, double tMax = 360.0);
+
+    /**
+     * @brief Разбирает запись "x(t); y(t)" или "x(t); y(t); tMin; tMax" (по умолчанию t ∈ [0, 360])
+     * @throw std::runtime_error При неверном числе частей или ошибке в части
+     */
+    static ParametricCurve parse(const std::string& spec);
+
+    /**
+     * @brief Разбирает запись "r(t)" или "r(t); tMin; tMax" (по умолчанию t ∈ [0, 360])
+     * @throw std::runtime_error При неверном числе частей или ошибке в части
+     */
+    static ParametricCurve parsePolar(const std::string& spec);
+
+    /**
+     * @brief Вычисляет точки кривой пакетом
+     *
+     * Координаты полярной кривой получаются из r(t), cos t и sin t через evaluateVector.
+     *
+     * @param t Значения параметра
+     * @param x Абсциссы (NaN, если точка не определена)
+     * @param y Ординаты (NaN, если точка не определена)
+     * @param count Число точек
+     */
+    void evaluateBatch(const double* t, double* x, double* y, size_t count) const;
+
+    /**
+     * @brief Точка кривой при значении параметра (NaN-координаты, если не определена)
+     */
+    PlotPoint operator()(double t) const;
+
+    double tMin() const { return tMin_; }
+    double tMax() const { return tMax_; }
+    bool isPolar() const { return polar_; }
+
+private:
+    Expression x_;  ///< x(t) или r(t) для полярной кривой
+    Expression y_;
+    bool polar_ = false;
+    double tMin_ = 0.0;
+    double tMax_ = 360.0;
+};
+
+/**
+ * @brief Параметры выборки параметрической кривой
+ */
+struct ParametricSamplerOptions {
+    int initialSamples = 256;     ///< Отрезков начальной равномерной сетки по t
+    double tolerance = 0.25;      ///< Допустимое расстояние середины отрезка от хорды в пикселях
+    double minLength = 0.5;       ///< Отрезок короче этого (в пикселях по ломаной) не делится из-за изгиба
+    int maxDepth = 16;            ///< Наибольшее число делений отрезка начальной сетки
+};
+
+/**
+ * @brief Счётчики последней выборки кривой
+ */
+struct ParametricSampleStats {
+    uint64_t evaluations = 0;  ///< Вычислено точек кривой
+    uint64_t points = 0;       ///< Точек в результате
+    uint64_t breaks = 0;       ///< Разрывов (неопределённые точки и скачки больше высоты экрана)
+};
+
+/**
+ * @brief Адаптивная выборка параметрической кривой по длине дуги на экране
+ *
+ * Начинает с равномерной сетки по t и делит пополам отрезки, середина которых на экране
+ * отстоит от хорды больше допуска: петли и крутые повороты получают много точек,
+ * а длинные прямые участки — ни одной лишней, сколько бы пикселей они ни занимали.
+ * Деление по изгибу прекращается, когда ломаная на отрезке короче minLength пикселей.
+ * Отрезки с неопределённой точкой или скачком больше высоты экрана уточняются до maxDepth,
+ * после чего между точками вставляется разрыв. Отрезки целиком за одним краем экрана не делятся.
+ * Середины всех отрезков одного прохода вычисляются одним пакетом.
+ */
+class ParametricSampler {
+public:
+    explicit ParametricSampler(ParametricSamplerOptions options = ParametricSamplerOptions()) : options_(options) {}
+
+    /**
+     * @brief Строит ломаную для видимой области
+     *
+     * @param curve Кривая
+     * @param viewport Видимая область
+     * @param out Точки в порядке возрастания t; разрывы обозначены точкой с NaN-координатами
+     * @return Счётчики выборки
+     */
+    ParametricSampleStats sample(const ParametricCurve& curve, const PlotViewport& viewport, std::vector<PlotPoint>& out) const;
+
+    const ParametricSamplerOptions& options() const { return options_; }
+
+private:
+    ParametricSamplerOptions options_;
+};
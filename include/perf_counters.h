@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Кольцевой буфер последних N измерений
+ *
+ * Добавление измерения — одна запись в массив без выделения памяти,
+ * статистика (среднее, перцентили) считается только по запросу.
+ *
+ * @tparam N Число хранимых измерений
+ */
+template <size_t N>
+class RingCounter {
+public:
+    /**
+     * @brief Добавляет измерение, вытесняя самое старое при заполнении буфера
+     * @param value Значение измерения
+     */
+    void push(uint64_t value) {
+        values_[next_] = value;
+        next_ = (next_ + 1) % N;
+        if (size_ < N)
+            size_++;
+    }
+
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Последнее добавленное измерение
+     * @return Значение или 0, если буфер пуст
+     */
+    uint64_t last() const { return size_ ? values_[(next_ + N - 1) % N] : 0; }
+
+    /**
+     * @brief Среднее по хранимым измерениям
+     */
+    double mean() const {
+        if (size_ == 0)
+            return 0.0;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size_; i++)
+            sum += values_[i];
+        return static_cast<double>(sum) / size_;
+    }
+
+    /**
+     * @brief Перцентиль по хранимым измерениям
+     * @param p Перцентиль от 0 до 100
+     * @return Значение перцентиля или 0, если буфер пуст
+     */
+    uint64_t percentile(double p) const {
+        if (size_ == 0)
+            return 0;
+        std::array<uint64_t, N> sorted;
+        std::copy(values_.begin(), values_.begin() + size_, sorted.begin());
+        size_t rank = static_cast<size_t>(p / 100.0 * (size_ - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + size_);
+        return sorted[rank];
+    }
+
+    /**
+     * @brief Удаляет все измерения
+     */
+    void clear() {
+        size_ = 0;
+        next_ = 0;
+    }
+
+private:
+    std::array<uint64_t, N> values_{};
+    size_t next_ = 0;
+    size_t size_ = 0;
+};
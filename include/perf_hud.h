@@ -0,0 +1,65 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include "perf_counters.h"
+
+/**
+ * @brief Оверлей с показателями производительности окна калькулятора
+ *
+ * Показывает время кадра, число вызовов отрисовки, время последнего вычисления
+ * и перцентили задержки от ввода до показа кадра. Все методы вызываются из потока отрисовки.
+ * Пока оверлей выключен, вызывающий код не собирает измерения, и оверлей ничего не стоит.
+ */
+class PerfHud {
+public:
+    /**
+     * @brief Создаёт выключенный оверлей
+     * @param font Шрифт подписей (должен жить дольше оверлея)
+     */
+    explicit PerfHud(const sf::Font& font);
+
+    /**
+     * @brief Включает или выключает оверлей, сбрасывая накопленные измерения
+     * @param enabled Новое состояние
+     */
+    void setEnabled(bool enabled);
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Учитывает показанный кадр
+     * @param frameNs Время кадра в наносекундах
+     * @param drawCalls Число вызовов отрисовки в кадре
+     */
+    void recordFrame(uint64_t frameNs, unsigned drawCalls);
+
+    /**
+     * @brief Запоминает время вычисления последнего пакета нажатий
+     * @param evaluationNs Время в наносекундах
+     */
+    void recordEvaluation(uint64_t evaluationNs) { lastEvaluationNs_ = evaluationNs; }
+
+    /**
+     * @brief Учитывает задержку от получения ввода до показа кадра с его результатом
+     * @param latencyNs Задержка в наносекундах
+     */
+    void recordInputLatency(uint64_t latencyNs) { inputLatency_.push(latencyNs); }
+
+    /**
+     * @brief Рисует оверлей
+     * @param target Цель отрисовки
+     * @return Число выполненных вызовов отрисовки
+     */
+    unsigned draw(sf::RenderTarget& target);
+
+private:
+    static constexpr size_t kHistory = 240;
+
+    bool enabled_ = false;
+    RingCounter<kHistory> frameTimes_;
+    RingCounter<kHistory> inputLatency_;
+    unsigned lastDrawCalls_ = 0;
+    uint64_t lastEvaluationNs_ = 0;
+    unsigned framesSinceUpdate_ = 0;
+    sf::RectangleShape background_;
+    sf::Text text_;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+#include "truetype_font.h"
+
+/**
+ * @brief Цвет RGBA, 8 бит на канал
+ */
+struct RgbaColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a = 255;
+};
+
+/**
+ * @brief Кэш растеризованных глифов шрифта по символу и кеглю
+ *
+ * Методы потокобезопасны: один кэш используется всеми графиками пакетного экспорта.
+ */
+class GlyphCache {
+public:
+    /**
+     * @param font Шрифт; должен жить дольше кэша
+     */
+    explicit GlyphCache(const TrueTypeFont& font) : font_(font) {}
+
+    /**
+     * @brief Изображение глифа символа при заданном кегле (растеризуется при первом запросе)
+     */
+    std::shared_ptr<const GlyphBitmap> glyph(uint32_t codepoint, float pixelSize);
+
+    /**
+     * @brief Ширина строки ASCII в пикселях
+     */
+    float measure(const std::string& text, float pixelSize);
+
+    const TrueTypeFont& font() const { return font_; }
+
+private:
+    const TrueTypeFont& font_;
+    std::mutex mutex_;
+    std::map<std::pair<uint32_t, int>, std::shared_ptr<const GlyphBitmap>> glyphs_;
+};
+
+/**
+ * @brief Безоконный холст RGBA для сглаженных линий и текста
+ *
+ * Команды рисования только запоминаются: линии одного цвета собираются в слой
+ * из контуров отрезков и изломов, текст — в слой глифов. render() делит изображение
+ * на горизонтальные полосы и обрабатывает их независимыми задачами пула: в полосе
+ * слои по порядку растеризуются CoverageRasterizer по точной площади покрытия
+ * и смешиваются с фоном. Не зависит от оконной и графической подсистемы.
+ */
+class PlotCanvas {
+public:
+    /**
+     * @brief Создаёт холст, залитый фоном
+     *
+     * @param width Ширина в пикселях
+     * @param height Высота в пикселях
+     * @param background Цвет фона
+     */
+    PlotCanvas(int width, int height, RgbaColor background);
+
+    /**
+     * @brief Добавляет отрезок толщиной width пикселей
+     */
+    void strokeLine(float x0, float y0, float x1, float y1, float width, RgbaColor color);
+
+    /**
+     * @brief Добавляет ломаную; точки с NaN-координатой разрывают её
+     *
+     * @param xy Координаты точек парами (x, y) в пикселях
+     * @param count Число точек
+     * @param width Толщина в пикселях
+     * @param color Цвет
+     */
+    void strokePolyline(const float* xy, size_t count, float width, RgbaColor color);
+
+    /**
+     * @brief Добавляет строку ASCII, левый край которой в x, а базовая линия в baseline
+     */
+    void drawText(GlyphCache& glyphs, const std::string& text, float x, float baseline, float pixelSize, RgbaColor color);
+
+    /**
+     * @brief Растеризует накопленные команды и очищает их
+     *
+     * @param pool Пул для параллельной обработки полос или nullptr
+     * @param bandHeight Высота полосы в строках
+     */
+    void render(ThreadPool* pool = nullptr, int bandHeight = 64);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    /**
+     * @brief Пиксели RGBA по строкам сверху вниз
+     */
+    const std::vector<uint8_t>& pixels() const { return pixels_; }
+
+private:
+    struct Edge {
+        float x0;
+        float y0;
+        float x1;
+        float y1;
+    };
+
+    struct PlacedGlyph {
+        std::shared_ptr<const GlyphBitmap> bitmap;
+        int x;
+        int y;  ///< Верхний край изображения
+    };
+
+    struct Layer {
+        RgbaColor color;
+        std::vector<Edge> edges;
+        std::vector<PlacedGlyph> glyphs;
+        float yMin;
+        float yMax;
+    };
+
+    Layer& layerFor(RgbaColor color, bool text);
+    void addPolygon(const float* corners, int count, Layer& layer);
+    void strokeRun(const std::vector<float>& run, float width, Layer& layer);
+    void renderBand(int rowBegin, int rowEnd);
+
+    int width_;
+    int height_;
+    std::vector<uint8_t> pixels_;
+    std::vector<Layer> layers_;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "plot_viewport.h"
+#include "sample_cache.h"
+#include "thread_pool.h"
+
+class ColumnAccumulator;
+
+/**
+ * @brief Прореживание упорядоченной по x выборки до не более чем четырёх точек на столбец пикселей
+ *
+ * В каждом столбце остаются первая, наименьшая, наибольшая и последняя точки в исходном порядке,
+ * поэтому нарисованная ломаная совпадает с ломаной по всем точкам с точностью до пикселя.
+ * Точка с y = NaN (разрыв) сохраняется, а столбец по разные стороны от неё прореживается отдельно.
+ *
+ * @param points Точки по возрастанию x
+ * @param count Число точек
+ * @param viewport Видимая область (определяет ширину столбца)
+ * @param out Прореженные точки (дописываются в конец)
+ */
+void decimateMinMax(const PlotPoint* points, size_t count, const PlotViewport& viewport, std::vector<PlotPoint>& out);
+
+/**
+ * @brief Пирамида уровней детализации для прореживания очень больших выборок
+ *
+ * Уровень 0 объединяет по kBaseBucket точек, каждый следующий — по две корзины предыдущего;
+ * корзина хранит первую, последнюю, наименьшую и наибольшую точки. Когда на столбец
+ * приходится много точек, столбец собирается из корзин подходящего уровня,
+ * и время прореживания зависит от ширины экрана, а не от размера выборки.
+ * Корзины на границе столбцов и корзины с разрывами раскрываются до более мелких уровней.
+ * Пирамида неизменяема после построения и может читаться из нескольких потоков.
+ */
+class MinMaxPyramid {
+public:
+    static constexpr size_t kBaseBucket = 64;
+
+    /**
+     * @brief Строит пирамиду
+     * @param points Точки; сортируются по x, если ещё не упорядочены
+     */
+    explicit MinMaxPyramid(std::vector<PlotPoint> points);
+
+    /**
+     * @brief Прореживает видимую часть выборки
+     *
+     * @param viewport Видимая область
+     * @param out Прореженные точки, включая по одной точке за каждой границей области
+     * @param pool Пул для параллельной обработки полос столбцов или nullptr
+     */
+    void decimate(const PlotViewport& viewport, std::vector<PlotPoint>& out, ThreadPool* pool = nullptr) const;
+
+    const std::vector<PlotPoint>& points() const { return points_; }
+    size_t levels() const { return levels_.size(); }
+
+private:
+    struct Bucket {
+        PlotPoint first;
+        PlotPoint last;
+        PlotPoint low;
+        PlotPoint high;
+        bool gap;  ///< Внутри есть точка с y = NaN
+    };
+
+    void addRange(size_t begin, size_t end, ColumnAccumulator& columns) const;
+    void addBucket(size_t level, size_t index, size_t begin, size_t end, ColumnAccumulator& columns) const;
+    void decimateRange(size_t begin, size_t end, const PlotViewport& viewport, std::vector<PlotPoint>& out) const;
+
+    std::vector<PlotPoint> points_;
+    std::vector<std::vector<Bucket>> levels_;
+};
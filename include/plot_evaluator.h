@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "adaptive_sampler.h"
+#include "plot_viewport.h"
+#include "sample_cache.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Выборка одной функции для текущей области
+ */
+struct PlotSeries {
+    std::vector<PlotPoint> points;  ///< Точки по возрастанию x; разрывы обозначены y = NaN
+    uint64_t evaluations = 0;       ///< Вычислено значений функции при последнем обновлении
+};
+
+/**
+ * @brief Счётчики последнего обновления
+ */
+struct PlotRefreshStats {
+    uint64_t evaluations = 0;  ///< Вычислено значений всех функций
+    size_t chunksBuilt = 0;    ///< Построено отрезков кэшей
+    size_t tiles = 0;          ///< Задач адаптивной выборки (функция x полоса)
+};
+
+/**
+ * @brief Параллельное вычисление графиков нескольких функций
+ *
+ * Область по x делится на полосы шириной tileWidth пикселей. Сначала все недостающие
+ * отрезки кэшей всех функций строятся как независимые задачи пула, затем каждая пара
+ * (функция, полоса) адаптивно уточняется отдельной задачей. Задачи разбираются потоками
+ * пула с перехватом, поэтому время обновления определяется общим объёмом работы
+ * и числом ядер, а не числом функций. У каждой функции собственный SampleCache.
+ */
+class PlotEvaluator {
+public:
+    /**
+     * @brief Создаёт вычислитель без функций
+     *
+     * @param pool Пул потоков (должен жить дольше вычислителя)
+     * @param tileWidth Ширина полосы в пикселях
+     */
+    explicit PlotEvaluator(ThreadPool& pool, int tileWidth = 256);
+
+    /**
+     * @brief Добавляет функцию
+     * @param function Выражение одной переменной
+     */
+    void addFunction(Expression function);
+
+    /**
+     * @brief Обновляет выборки всех функций для области
+     *
+     * @param viewport Видимая область
+     * @param adaptive true — адаптивная выборка, false — равномерная из кэша
+     * @param series Результат, по одному элементу на функцию
+     * @return Счётчики обновления
+     */
+    PlotRefreshStats refresh(const PlotViewport& viewport, bool adaptive, std::vector<PlotSeries>& series);
+
+    size_t size() const { return caches_.size(); }
+    SampleCache& cache(size_t index) { return *caches_[index]; }
+    const AdaptiveSampler& sampler() const { return sampler_; }
+
+private:
+    ThreadPool& pool_;
+    int tileWidth_;
+    AdaptiveSampler sampler_;
+    std::vector<std::unique_ptr<SampleCache>> caches_;
+};
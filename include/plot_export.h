@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "expression.h"
+#include "plot_canvas.h"
+#include "plot_viewport.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Параметры безоконного экспорта графика
+ */
+struct PlotExportOptions {
+    int width = 1920;    ///< Ширина изображения в пикселях
+    int height = 1080;   ///< Высота изображения в пикселях
+    float scale = 1.0f;  ///< Множитель толщины линий и кегля подписей для изображений высокого разрешения
+};
+
+/**
+ * @brief Строит графики функций в изображение без окна и OpenGL
+ *
+ * Раскладка повторяет окно графиков: сетка с шагом gridStep, оси, подписи делений
+ * шрифтом Sansation_Bold, кривые цветами палитры окна. Кривые строятся AdaptiveSampler
+ * (разрывы у асимптот сохраняются) и рисуются сглаженными ломаными на PlotCanvas.
+ * Объект не изменяется при экспорте, поэтому один экспортёр может строить графики из нескольких потоков.
+ */
+class PlotExporter {
+public:
+    /**
+     * @param glyphs Кэш глифов шрифта подписей; должен жить дольше экспортёра
+     * @param options Размер и масштаб изображения
+     */
+    PlotExporter(GlyphCache& glyphs, PlotExportOptions options = PlotExportOptions()) : glyphs_(glyphs), options_(options) {}
+
+    /**
+     * @brief Рисует графики в новый холст
+     *
+     * @param functions Выражения переменной x
+     * @param viewport Видимая область; размер в пикселях берётся из параметров экспорта
+     * @param pool Пул для выборки кривых и растеризации полос или nullptr
+     */
+    PlotCanvas render(const std::vector<Expression>& functions, PlotViewport viewport, ThreadPool* pool = nullptr) const;
+
+    /**
+     * @brief Рисует графики и записывает их в файл PNG
+     * @throw std::runtime_error Если файл не удалось записать
+     */
+    void exportPng(const std::vector<Expression>& functions, const PlotViewport& viewport, const std::string& path,
+        ThreadPool* pool = nullptr) const;
+
+    const PlotExportOptions& options() const { return options_; }
+
+private:
+    GlyphCache& glyphs_;
+    PlotExportOptions options_;
+};
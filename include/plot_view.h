@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/**
+ * @brief Параметры окна построения графиков
+ */
+struct PlotWindowOptions {
+    std::vector<std::string> functions;  ///< Выражения y = f(x)
+    std::vector<std::string> relations;  ///< Неявно заданные кривые "левая = правая" от x и y
+    std::vector<std::string> series;     ///< Файлы рядов данных (строки "x y")
+    std::vector<std::string> parametric; ///< Параметрические кривые "x(t); y(t)[; tMin; tMax]"
+    std::vector<std::string> polar;      ///< Полярные кривые "r(t)[; tMin; tMax]", t в градусах
+    std::string heatmap;                 ///< Выражение f(x, y) для тепловой карты (пусто — без карты)
+    std::string surface;                 ///< Выражение f(x, y) для поверхности z = f(x, y) (открывает трёхмерное окно)
+    int width = 1280;                    ///< Начальная ширина окна
+    int height = 800;                    ///< Начальная высота окна
+};
+
+/**
+ * @brief Открывает окно графиков и обрабатывает его события до закрытия
+ *
+ * Перетаскивание мышью сдвигает график, колесо масштабирует относительно указателя,
+ * R возвращает исходную область, A переключает адаптивную и равномерную выборку, I включает
+ * гарантированное интервальное построение (IntervalPlotter), Escape закрывает окно.
+ * Значения функций берутся из SampleCache, поэтому при сдвиге и масштабировании вычисляются
+ * только новые точки; адаптивная выборка уточняет их у изгибов и асимптот.
+ * Несколько функций вычисляются параллельно полосами в общем пуле потоков (PlotEvaluator).
+ * Перед выводом каждая кривая прореживается до четырёх точек на столбец пикселей (MinMaxPyramid
+ * для рядов данных), а вершины передаются в sf::VertexBuffer с режимом Stream.
+ * Неявно заданные кривые строятся ImplicitPlotter плитками в том же пуле.
+ * Параметрические и полярные кривые выбираются ParametricSampler по длине дуги на экране.
+ * Тепловая карта строится из плиток HeatmapTileCache и догружается в текстуру по мере появления новых плиток.
+ * Если задана поверхность, вместо графиков открывается трёхмерное окно: SurfaceRenderer рисует её
+ * программно в текстуру, перетаскивание вращает камеру, колесо приближает, B переключает
+ * отсечение нелицевых граней, R возвращает исходный вид.
+ *
+ * @param options Параметры окна
+ * @return Код завершения (0 при успехе, -1 при ошибке разбора выражения, чтения ряда или загрузки шрифта)
+ */
+int runPlotWindow(const PlotWindowOptions& options);
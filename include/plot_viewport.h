@@ -0,0 +1,88 @@
+#pragma once
+#include <cmath>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Видимая область графика и её отображение в пиксели
+ *
+ * Ось y экрана направлена вниз, ось y графика — вверх.
+ */
+struct PlotViewport {
+    double xMin = -10.0;
+    double xMax = 10.0;
+    double yMin = -10.0;
+    double yMax = 10.0;
+    int width = 800;   ///< Ширина области в пикселях
+    int height = 600;  ///< Высота области в пикселях
+
+    double toScreenX(double x) const { return (x - xMin) / (xMax - xMin) * width; }
+    double toScreenY(double y) const { return (yMax - y) / (yMax - yMin) * height; }
+    double toWorldX(double px) const { return xMin + px / width * (xMax - xMin); }
+    double toWorldY(double py) const { return yMax - py / height * (yMax - yMin); }
+
+    /**
+     * @brief Сдвигает область на заданное число пикселей
+     * @param dx Сдвиг вправо
+     * @param dy Сдвиг вниз
+     */
+    void pan(double dx, double dy) {
+        double sx = dx / width * (xMax - xMin);
+        double sy = dy / height * (yMax - yMin);
+        xMin -= sx;
+        xMax -= sx;
+        yMin += sy;
+        yMax += sy;
+    }
+
+    /**
+     * @brief Масштабирует область относительно точки экрана
+     *
+     * @param factor Во сколько раз уменьшается видимый диапазон (больше 1 — приближение)
+     * @param px Абсцисса неподвижной точки в пикселях
+     * @param py Ордината неподвижной точки в пикселях
+     */
+    void zoom(double factor, double px, double py) {
+        double cx = toWorldX(px);
+        double cy = toWorldY(py);
+        xMin = cx + (xMin - cx) / factor;
+        xMax = cx + (xMax - cx) / factor;
+        yMin = cy + (yMin - cy) / factor;
+        yMax = cy + (yMax - cy) / factor;
+    }
+};
+
+/**
+ * @brief Шаг координатной сетки вида 1, 2 или 5, умноженное на степень десяти
+ *
+ * @param span Длина видимого диапазона
+ * @param targetLines Желаемое число линий сетки
+ * @return Шаг, дающий не больше примерно targetLines линий
+ */
+inline double gridStep(double span, int targetLines) {
+    double raw = span / targetLines;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    double normalized = raw / magnitude;
+    if (normalized <= 1.0)
+        return magnitude;
+    if (normalized <= 2.0)
+        return 2.0 * magnitude;
+    if (normalized <= 5.0)
+        return 5.0 * magnitude;
+    return 10.0 * magnitude;
+}
+
+/**
+ * @brief Короткая запись числа для подписей осей
+ *
+ * @param value Значение на оси
+ * @param step Шаг сетки; значения меньше его миллиардной доли записываются как 0
+ */
+inline std::string formatTick(double value, double step) {
+    if (std::fabs(value) < step * 1e-9)
+        value = 0.0;
+    std::ostringstream out;
+    out.precision(6);
+    out << value;
+    return out.str();
+}
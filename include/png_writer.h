@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Контрольная сумма CRC-32 (как в PNG и zlib)
+ *
+ * @param data Данные
+ * @param size Размер данных в байтах
+ * @param crc Сумма предыдущих частей для продолжения подсчёта
+ */
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+/**
+ * @brief Контрольная сумма Adler-32 потока zlib
+ */
+uint32_t adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+/**
+ * @brief Сжимает данные в поток zlib
+ *
+ * Один блок deflate с фиксированными кодами Хаффмана; повторы ищутся хеш-цепочками
+ * в окне 32 КБ. Однотонный фон графика сжимается повторами максимальной длины.
+ *
+ * @param data Данные
+ * @param size Размер данных в байтах
+ * @param out Поток zlib (дописывается в конец)
+ */
+void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+/**
+ * @brief Кодирует изображение RGBA 8 бит на канал в PNG
+ *
+ * Для каждой строки выбирается фильтр PNG с наименьшей суммой модулей результата: Up или Sub,
+ * а для шумных строк (градиенты) также Paeth и None. Не зависит от графической подсистемы.
+ *
+ * @param rgba Пиксели по строкам сверху вниз, 4 байта на пиксель
+ * @param width Ширина
+ * @param height Высота
+ * @param out Файл PNG целиком (буфер заменяется)
+ */
+void encodePng(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+/**
+ * @brief Кодирует изображение в PNG и записывает в файл
+ * @throw std::runtime_error Если файл не удалось записать
+ */
+void writePng(const std::string& path, const uint8_t* rgba, int width, int height);
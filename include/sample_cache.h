@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "expression.h"
+
+/**
+ * @brief Точка графика в координатах функции
+ */
+struct PlotPoint {
+    double x;
+    double y;  ///< NaN, если функция в точке не определена
+};
+
+/**
+ * @brief Отрезок сетки выборки: kChunkSamples точек x = (chunk * kChunkSamples + i) * 2^level
+ */
+struct SampleChunkKey {
+    int level;
+    int64_t chunk;
+
+    bool operator==(const SampleChunkKey& other) const { return level == other.level && chunk == other.chunk; }
+};
+
+/**
+ * @brief Счётчики кэша выборок
+ */
+struct SampleCacheStats {
+    uint64_t evaluations = 0;     ///< Вычислено значений функции
+    uint64_t reusedSamples = 0;   ///< Значений, взятых из отрезков соседних уровней при масштабировании
+    uint64_t chunkHits = 0;       ///< Отрезков, найденных в кэше
+    uint64_t chunkMisses = 0;     ///< Отрезков, которые пришлось построить
+};
+
+/**
+ * @brief Кэш значений функции одной переменной на иерархии равномерных сеток
+ *
+ * Шаг сетки уровня level равен 2^level, поэтому точки не зависят от положения окна просмотра:
+ * при сдвиге вычисляются только отрезки сетки, открывшиеся у края, а при масштабировании
+ * новый отрезок берёт значения из отрезков соседнего уровня (каждая вторая точка
+ * более мелкой сетки совпадает с точкой более крупной). Отрезки вытесняются
+ * по давности использования.
+ *
+ * Методы потокобезопасны: buildChunk() можно вызывать параллельно для разных отрезков.
+ */
+class SampleCache {
+public:
+    static constexpr int kChunkSamples = 256;
+
+    /**
+     * @brief Создаёт пустой кэш для функции
+     *
+     * @param function Выражение одной переменной
+     * @param maxChunks Наибольшее число хранимых отрезков
+     */
+    explicit SampleCache(Expression function, size_t maxChunks = 4096);
+
+    /**
+     * @brief Строит выборку для диапазона, подгружая недостающие отрезки
+     *
+     * @param xMin Левая граница диапазона
+     * @param xMax Правая граница диапазона
+     * @param pixels Ширина графика в пикселях; шаг выборки не больше (xMax - xMin) / pixels
+     * @param out Точки в порядке возрастания x, с одной точкой за каждой границей диапазона
+     */
+    void sample(double xMin, double xMax, int pixels, std::vector<PlotPoint>& out);
+
+    /**
+     * @brief Уровень сетки для диапазона: наибольший, шаг которого не превышает ширину пикселя
+     */
+    static int levelFor(double xMin, double xMax, int pixels);
+
+    /**
+     * @brief Отрезки уровня, покрывающие диапазон, которых нет в кэше
+     *
+     * @param level Уровень сетки
+     * @param xMin Левая граница диапазона
+     * @param xMax Правая граница диапазона
+     * @param missing Куда добавляются ключи недостающих отрезков
+     */
+    void findMissing(int level, double xMin, double xMax, std::vector<SampleChunkKey>& missing) const;
+
+    /**
+     * @brief Строит отрезок и помещает его в кэш
+     *
+     * Значения, уже известные на соседних уровнях, копируются, остальные вычисляются одним пакетом.
+     *
+     * @param key Ключ отрезка
+     */
+    void buildChunk(const SampleChunkKey& key);
+
+    /**
+     * @brief Собирает точки диапазона из отрезков кэша
+     *
+     * Отсутствующие отрезки пропускаются; вызывается после построения недостающих.
+     * Диапазон, который сетка уровня не адресует (слишком далеко от нуля для её шага или
+     * шире кэша), не кэшируется: findMissing() для него ничего не возвращает, а точки
+     * вычисляются здесь же равномерно, не чаще шага уровня.
+     */
+    void collect(int level, double xMin, double xMax, std::vector<PlotPoint>& out) const;
+
+    SampleCacheStats stats() const;
+    const Expression& function() const { return function_; }
+    size_t size() const;
+
+    /**
+     * @brief Удаляет все отрезки
+     */
+    void clear();
+
+private:
+    struct KeyHash {
+        size_t operator()(const SampleChunkKey& key) const {
+            return std::hash<int64_t>()(key.chunk * 64 + key.level);
+        }
+    };
+
+    struct Chunk {
+        std::vector<double> values;
+        mutable uint64_t lastUse = 0;
+    };
+
+    std::shared_ptr<const Chunk> findChunk(const SampleChunkKey& key) const;
+    void collectDirect(int level, double xMin, double xMax, std::vector<PlotPoint>& out) const;
+    void evictLocked();
+
+    Expression function_;
+    size_t maxChunks_;
+    mutable std::mutex mutex_;
+    std::unordered_map<SampleChunkKey, std::shared_ptr<const Chunk>, KeyHash> chunks_;
+    mutable uint64_t useClock_ = 0;
+    mutable SampleCacheStats stats_;
+};
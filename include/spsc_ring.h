@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ожидание с нарастающей паузой: короткое вращение, уступка процессора, затем сон
+ *
+ * Пока данные идут непрерывно, поток ждёт вращением и не засыпает; на пустом потоке ввода
+ * он быстро переходит ко сну и не занимает ядро.
+ */
+class Backoff {
+public:
+    void pause() {
+        if (count_ < kSpins) {
+            count_++;
+            return;
+        }
+        if (count_ < kSpins + kYields) {
+            count_++;
+            std::this_thread::yield();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    void reset() { count_ = 0; }
+
+private:
+    static constexpr int kSpins = 64;
+    static constexpr int kYields = 64;
+    int count_ = 0;
+};
+
+/**
+ * @brief Неблокирующая кольцевая очередь ограниченной ёмкости для одного писателя и одного читателя
+ *
+ * Индексы писателя и читателя лежат в разных кэш-линиях, и каждая сторона хранит последнее
+ * прочитанное значение чужого индекса, поэтому обращение к общей кэш-линии нужно лишь тогда,
+ * когда очередь кажется полной (или пустой). Блокирующие push и pop ждут через Backoff:
+ * заполненная очередь останавливает писателя, так что быстрая стадия не уходит дальше медленной.
+ *
+ * @tparam T Тип элемента (перемещаемый, конструируемый по умолчанию)
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Ёмкость (округляется вверх до степени двойки)
+     */
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Добавляет элемент, если есть место (только поток-писатель)
+     * @return false, если очередь заполнена
+     */
+    bool tryPush(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_)
+                return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Забирает элемент, если он есть (только поток-читатель)
+     * @return false, если очередь пуста
+     */
+    bool tryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_)
+                return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Добавляет элемент, ожидая места
+     */
+    void push(T value) {
+        Backoff backoff;
+        while (!tryPush(std::move(value)))
+            backoff.pause();
+    }
+
+    /**
+     * @brief Забирает элемент, ожидая его появления
+     */
+    T pop() {
+        T value;
+        Backoff backoff;
+        while (!tryPop(value))
+            backoff.pause();
+        return value;
+    }
+
+    /**
+     * @brief Пуста ли очередь (приблизительно, для стороны читателя)
+     */
+    bool empty() const { return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    size_t cachedTail_ = 0;  ///< Последний прочитанный читателем индекс писателя
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+    size_t cachedHead_ = 0;  ///< Последний прочитанный писателем индекс читателя
+};
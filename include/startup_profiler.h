@@ -0,0 +1,95 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Замер фаз запуска приложения
+ *
+ * Фазы отмечаются вызовом mark() по завершении; продолжительность фазы отсчитывается
+ * от предыдущей отметки того же потока выполнения (или от создания профилировщика).
+ * Отметки могут ставиться из разных потоков.
+ */
+class StartupProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Отмеченная фаза
+     */
+    struct Phase {
+        std::string name;
+        Clock::time_point begin;
+        Clock::time_point end;
+        std::thread::id thread;  ///< Поток, поставивший отметку
+    };
+
+    StartupProfiler() : start_(Clock::now()) {}
+
+    /**
+     * @brief Отмечает завершение фазы
+     *
+     * @param phase Название фазы
+     * @param since Момент начала фазы; по умолчанию — последняя отметка этого же потока
+     * @return Момент отметки
+     */
+    Clock::time_point mark(const std::string& phase, Clock::time_point since = Clock::time_point()) {
+        auto now = Clock::now();
+        std::thread::id thread = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (since == Clock::time_point()) {
+            // Отметки фоновых потоков не должны сокращать фазы основного потока и наоборот
+            since = start_;
+            for (auto it = phases_.rbegin(); it != phases_.rend(); ++it) {
+                if (it->thread == thread) {
+                    since = it->end;
+                    break;
+                }
+            }
+        }
+        phases_.push_back(Phase{ phase, since, now, thread });
+        return now;
+    }
+
+    /**
+     * @brief Момент создания профилировщика
+     */
+    Clock::time_point start() const { return start_; }
+
+    /**
+     * @brief Время от создания профилировщика до момента
+     * @param point Момент времени
+     * @return Миллисекунды
+     */
+    double sinceStartMs(Clock::time_point point) const {
+        return std::chrono::duration<double, std::milli>(point - start_).count();
+    }
+
+    /**
+     * @brief Печатает фазы в порядке отметок
+     * @param out Поток вывода
+     */
+    void report(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& phase : phases_) {
+            out << phase.name << ": " << std::chrono::duration<double, std::milli>(phase.end - phase.begin).count()
+                << " ms (done at " << sinceStartMs(phase.end) << " ms)\n";
+        }
+    }
+
+    /**
+     * @brief Фазы в порядке отметок
+     */
+    std::vector<Phase> phases() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return phases_;
+    }
+
+private:
+    Clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "expression.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Поверхность z = f(x, y), вычисленная на сетке и разбитая на участки для уровней детализации
+ *
+ * Область определения переводится в квадрат [-1, 1] x [-1, 1], а значения — в отрезок [-0.5, 0.5]
+ * (по 1-му и 99-му перцентилям, выбросы у полюсов обрезаются). Цвет вершины задаётся высотой
+ * (палитра colorizeHeatmap) и освещением по нормали. Для каждого участка из kPatchCells x kPatchCells
+ * ячеек заранее считается геометрическая ошибка каждого уровня: наибольшее отклонение отброшенных
+ * вершин от треугольников с шагом 2^level.
+ */
+class SurfaceMesh {
+public:
+    static constexpr int kPatchCells = 32;
+    static constexpr int kLevels = 6;  ///< Шаги сетки 1, 2, 4, ..., kPatchCells
+
+    /**
+     * @brief Вычисляет поверхность на сетке
+     *
+     * @param function Выражение переменных x и y
+     * @param xMin Левая граница по x
+     * @param xMax Правая граница по x
+     * @param yMin Нижняя граница по y
+     * @param yMax Верхняя граница по y
+     * @param resolution Число ячеек сетки по каждой оси (округляется вверх до кратного kPatchCells)
+     * @param pool Пул для параллельного вычисления строк или nullptr
+     */
+    SurfaceMesh(const Expression& function, double xMin, double xMax, double yMin, double yMax, int resolution = 512,
+        ThreadPool* pool = nullptr);
+
+    int resolution() const { return resolution_; }
+    int patchCount() const { return resolution_ / kPatchCells; }
+
+    /**
+     * @brief Нормированная высота в узле (i по x, j по y); NaN, если функция не определена
+     */
+    float height(int i, int j) const { return heights_[static_cast<size_t>(j) * (resolution_ + 1) + i]; }
+
+    /**
+     * @brief Цвет узла, 4 байта RGBA
+     */
+    const uint8_t* color(int i, int j) const { return &colors_[(static_cast<size_t>(j) * (resolution_ + 1) + i) * 4]; }
+
+    /**
+     * @brief Геометрическая ошибка участка (px, py) на уровне level в нормированных единицах
+     */
+    float patchError(int px, int py, int level) const { return errors_[(static_cast<size_t>(py) * patchCount() + px) * kLevels + level]; }
+
+    /**
+     * @brief Наименьшая и наибольшая высота участка; false, если на участке нет определённых точек
+     */
+    bool patchRange(int px, int py, float& zMin, float& zMax) const;
+
+    /**
+     * @brief Значения функции, переведённые в -0.5 и 0.5
+     */
+    double low() const { return low_; }
+    double high() const { return high_; }
+
+private:
+    int resolution_;
+    double low_ = 0.0;
+    double high_ = 0.0;
+    std::vector<float> heights_;
+    std::vector<uint8_t> colors_;
+    std::vector<float> errors_;
+    std::vector<float> ranges_;  ///< Пары (zMin, zMax) участков
+};
+
+/**
+ * @brief Камера, вращающаяся вокруг центра поверхности
+ */
+struct SurfaceCamera {
+    double yaw = -60.0;     ///< Поворот вокруг оси z в градусах
+    double pitch = 35.0;    ///< Угол над плоскостью xy в градусах (от -89 до 89)
+    double distance = 3.5;  ///< Расстояние до центра в нормированных единицах
+    double fov = 45.0;      ///< Вертикальный угол обзора в градусах
+};
+
+/**
+ * @brief Параметры программной растеризации
+ */
+struct SurfaceRenderOptions {
+    double tolerance = 0.5;     ///< Допустимая экранная ошибка уровня детализации в пикселях
+    bool cullBackFaces = true;  ///< Отбрасывать треугольники, повёрнутые к камере нижней стороной
+    int bandHeight = 16;        ///< Высота полосы экрана — единицы параллельной растеризации
+};
+
+/**
+ * @brief Счётчики последнего кадра
+ */
+struct SurfaceRenderStats {
+    uint64_t patches = 0;    ///< Участков в поле зрения
+    uint64_t culled = 0;     ///< Участков, отброшенных отсечением по пирамиде видимости
+    uint64_t triangles = 0;  ///< Треугольников, переданных растеризатору
+    uint64_t backFaces = 0;  ///< Треугольников, отброшенных как нелицевые
+    uint64_t pixels = 0;     ///< Пикселей, прошедших тест глубины
+};
+
+/**
+ * @brief Кадр программной растеризации
+ */
+struct SurfaceFrame {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgba;  ///< По строкам сверху вниз; пиксели без поверхности прозрачны
+    std::vector<float> depth;   ///< 1 / глубина; 0 — пусто
+};
+
+/**
+ * @brief Программный растеризатор поверхности для машин без видеокарты
+ *
+ * Для каждого участка выбирается самый грубый уровень, ошибка которого на экране
+ * (ошибка / расстояние до участка * фокусное расстояние) не превышает допуска, поэтому
+ * далёкие и плоские участки рисуются крупными треугольниками, а близкие изгибы — подробно.
+ * Вершины на краю участка, соседствующего с более грубым, проецируются на ребро соседа,
+ * так что трещин между уровнями нет. Участки вне пирамиды видимости отбрасываются целиком,
+ * треугольники обрезаются ближней плоскостью и отбрасываются по ориентации на экране.
+ * Вершины участков преобразуются параллельно, затем экран делится на полосы,
+ * каждая полоса растеризуется своей задачей пула с собственной частью буфера глубины,
+ * а цвет интерполируется по Гуро.
+ */
+class SurfaceRenderer {
+public:
+    explicit SurfaceRenderer(SurfaceRenderOptions options = SurfaceRenderOptions()) : options_(options) {}
+
+    /**
+     * @brief Рисует поверхность в кадр
+     *
+     * @param mesh Поверхность
+     * @param camera Камера
+     * @param frame Кадр; буферы заменяются, размер задаётся width и height кадра
+     * @param pool Пул для параллельной растеризации или nullptr
+     * @return Счётчики кадра
+     */
+    SurfaceRenderStats render(const SurfaceMesh& mesh, const SurfaceCamera& camera, SurfaceFrame& frame,
+        ThreadPool* pool = nullptr) const;
+
+    const SurfaceRenderOptions& options() const { return options_; }
+
+private:
+    SurfaceRenderOptions options_;
+};
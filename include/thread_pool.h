@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Пул рабочих потоков с перехватом задач (work stealing)
+ *
+ * У каждого рабочего потока своя очередь. Задачи, поставленные из рабочего потока,
+ * попадают в его же очередь и выполняются им в порядке LIFO, пока данные ещё в кэше;
+ * задачи извне распределяются по очередям по кругу. Освободившийся поток забирает
+ * самые старые задачи из чужих очередей. Деструктор дожидается выполнения
+ * уже поставленных задач и завершает потоки.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Запускает рабочие потоки
+     * @param threads Число потоков; 0 — по числу аппаратных потоков
+     */
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ставит задачу в очередь
+     * @param task Задача
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Ставит задачу в очередь и возвращает future её результата
+     *
+     * @param f Вызываемый объект без аргументов
+     * @return future результата; исключение задачи передаётся через него
+     */
+    template <typename F>
+    auto submit(F f) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+        std::future<Result> result = task->get_future();
+        post([task]() { (*task)(); });
+        return result;
+    }
+
+    /**
+     * @brief Выполняет body(begin, end) для диапазона, разбитого на отрезки по grain элементов
+     *
+     * Отрезки разбираются рабочими потоками и вызывающим потоком динамически, поэтому
+     * неравномерная стоимость элементов выравнивается, а вызов из рабочего потока пула
+     * не приводит к взаимной блокировке. Возвращает управление после обработки всего диапазона;
+     * первое исключение из body пробрасывается вызывающему.
+     *
+     * @param begin Начало диапазона
+     * @param end Конец диапазона
+     * @param grain Число элементов в отрезке (не меньше 1)
+     * @param body Обработчик отрезка body(size_t begin, size_t end)
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F body) {
+        if (begin >= end)
+            return;
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1 || workers_.empty()) {
+            body(begin, end);
+            return;
+        }
+
+        struct Shared {
+            std::atomic<size_t> next{ 0 };
+            std::atomic<size_t> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::exception_ptr error;
+        };
+        auto shared = std::make_shared<Shared>();
+        auto run = [shared, begin, end, grain, chunks, &body]() {
+            size_t chunk;
+            while ((chunk = shared->next.fetch_add(1, std::memory_order_relaxed)) < chunks) {
+                size_t chunkBegin = begin + chunk * grain;
+                try {
+                    body(chunkBegin, std::min(end, chunkBegin + grain));
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    if (!shared->error)
+                        shared->error = std::current_exception();
+                }
+                if (shared->done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    shared->finished.notify_all();
+                }
+            }
+        };
+        size_t helpers = std::min(workers_.size(), chunks - 1);
+        for (size_t i = 0; i < helpers; i++)
+            post(run);
+        run();
+
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->finished.wait(lock, [&]() { return shared->done.load(std::memory_order_acquire) == chunks; });
+        if (shared->error)
+            std::rethrow_exception(shared->error);
+    }
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool tryPop(size_t index, std::function<void()>& task);
+    bool trySteal(size_t index, std::function<void()>& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_{ 0 };
+    std::atomic<size_t> nextQueue_{ 0 };
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
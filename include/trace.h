@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Трассировка в формате Chrome trace event (chrome://tracing, Perfetto)
+ *
+ * Пробы CALC_TRACE_SCOPE записывают продолжительность области видимости в буфер текущего потока.
+ * Запись не использует блокировок: каждый поток пишет только в свой буфер фиксированного размера,
+ * при переполнении новые события отбрасываются. Без определения CALC_ENABLE_TRACING
+ * (опция CMake CALC_ENABLE_TRACING) макросы раскрываются в пустые выражения.
+ */
+
+/**
+ * @brief Текущее время для трассировки в наносекундах
+ */
+inline uint64_t traceNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Добавляет завершённое событие в буфер текущего потока
+ *
+ * @param name Имя события (строковый литерал, указатель сохраняется без копирования)
+ * @param startNs Время начала в наносекундах
+ * @param endNs Время окончания в наносекундах
+ */
+void traceRecord(const char* name, uint64_t startNs, uint64_t endNs);
+
+/**
+ * @brief Задаёт имя текущего потока, отображаемое в просмотрщике трассы
+ * @param name Имя потока (строковый литерал)
+ */
+void traceSetThreadName(const char* name);
+
+/**
+ * @brief Записывает события всех потоков в файл JSON формата Chrome trace event
+ *
+ * Вызывается после завершения потоков, которые пишут события.
+ *
+ * @param path Путь к файлу
+ * @return false, если файл не удалось записать
+ */
+bool traceWriteChromeJson(const std::string& path);
+
+/**
+ * @brief Область видимости, продолжительность которой записывается как событие трассы
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name_(name), startNs_(traceNowNs()) {}
+    ~TraceScope() { traceRecord(name_, startNs_, traceNowNs()); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t startNs_;
+};
+
+#define CALC_TRACE_CONCAT_IMPL(a, b) a##b
+#define CALC_TRACE_CONCAT(a, b) CALC_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef CALC_ENABLE_TRACING
+#define CALC_TRACE_SCOPE(name) TraceScope CALC_TRACE_CONCAT(calcTraceScope, __LINE__)(name)
+#define CALC_TRACE_THREAD_NAME(name) traceSetThreadName(name)
+#else
+#define CALC_TRACE_SCOPE(name) ((void)0)
+#define CALC_TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Неблокирующий тройной буфер для передачи снимков состояния между двумя потоками
+ *
+ * Один поток-писатель заполняет буфер writeBuffer() и публикует его вызовом publish(),
+ * один поток-читатель забирает последний опубликованный снимок через acquire().
+ * Ни одна из операций не ждёт другой поток: писатель никогда не перезаписывает снимок,
+ * который читает читатель, а читатель всегда получает самый свежий из опубликованных.
+ *
+ * @tparam T Тип снимка (должен быть копируемым или перемещаемым)
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle_(1), back_(0), front_(2) {}
+
+    /**
+     * @brief Буфер, который писатель заполняет перед публикацией
+     * @return Ссылка на буфер, принадлежащий писателю
+     */
+    T& writeBuffer() { return slots_[back_]; }
+
+    /**
+     * @brief Публикует заполненный буфер для читателя
+     *
+     * Буфер писателя меняется местами со средним, после чего писатель получает
+     * во владение предыдущий средний буфер.
+     */
+    void publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | kDirty), std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+    }
+
+    /**
+     * @brief Забирает последний опубликованный снимок, если он появился
+     * @return true, если с прошлого вызова был опубликован новый снимок
+     */
+    bool acquire() {
+        if ((middle_.load(std::memory_order_relaxed) & kDirty) == 0)
+            return false;
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndexMask;
+        return true;
+    }
+
+    /**
+     * @brief Снимок, принадлежащий читателю
+     * @return Ссылка на последний полученный через acquire() снимок
+     */
+    const T& readBuffer() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kDirty = 0x4;
+
+    T slots_[3];
+    std::atomic<uint8_t> middle_;
+    uint8_t back_;
+    uint8_t front_;
+};
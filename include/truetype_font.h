@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Растровое изображение одного глифа
+ */
+struct GlyphBitmap {
+    int width = 0;               ///< Ширина в пикселях
+    int height = 0;              ///< Высота в пикселях
+    int left = 0;                ///< Смещение левого края от позиции пера
+    int top = 0;                 ///< Смещение верхнего края от базовой линии (отрицательное — выше неё)
+    float advance = 0.0f;        ///< Сдвиг пера после глифа
+    std::vector<uint8_t> pixels; ///< Покрытие 0-255, строки сверху вниз
+};
+
+/**
+ * @brief Минимальный разборщик шрифтов TrueType (таблицы head, hhea, hmtx, maxp, cmap, loca, glyf)
+ *
+ * Не зависит от FreeType и графической подсистемы: используется при сборке для подготовки
+ * атласа глифов и в безоконном экспорте графиков. Данные шрифта не копируются
+ * и должны жить дольше объекта.
+ */
+class TrueTypeFont {
+public:
+    /**
+     * @brief Разбирает шрифт в памяти
+     *
+     * @param data Содержимое файла .ttf
+     * @param size Размер данных в байтах
+     * @throw std::runtime_error Если данные не являются поддерживаемым шрифтом TrueType
+     */
+    TrueTypeFont(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Индекс глифа для символа Юникода
+     * @param codepoint Код символа
+     * @return Индекс глифа или 0 (глиф .notdef), если символа нет в шрифте
+     */
+    int glyphIndex(uint32_t codepoint) const;
+
+    /**
+     * @brief Растеризует глиф со сглаживанием
+     *
+     * @param glyph Индекс глифа
+     * @param pixelSize Размер кегля в пикселях (высота эма)
+     * @return Изображение глифа и его метрики
+     */
+    GlyphBitmap rasterize(int glyph, float pixelSize) const;
+
+    /**
+     * @brief Ширина строки при заданном кегле
+     * @param codepoints Символы строки
+     * @param pixelSize Размер кегля в пикселях
+     * @return Сумма сдвигов пера
+     */
+    float measure(const std::vector<uint32_t>& codepoints, float pixelSize) const;
+
+    int unitsPerEm() const { return unitsPerEm_; }
+    int ascent() const { return ascent_; }
+    int descent() const { return descent_; }
+    int lineGap() const { return lineGap_; }
+
+private:
+    struct OutlinePoint {
+        float x;
+        float y;
+        bool onCurve;
+    };
+
+    uint32_t findTable(const char* tag) const;
+    int advanceWidth(int glyph) const;
+    void appendOutline(int glyph, const float transform[6], int depth,
+        std::vector<std::vector<OutlinePoint>>& contours) const;
+
+    const uint8_t* data_;
+    size_t size_;
+    uint32_t glyf_ = 0;
+    uint32_t loca_ = 0;
+    uint32_t hmtx_ = 0;
+    uint32_t cmap_ = 0;
+    int numGlyphs_ = 0;
+    int numHMetrics_ = 0;
+    int indexToLocFormat_ = 0;
+    int unitsPerEm_ = 0;
+    int ascent_ = 0;
+    int descent_ = 0;
+    int lineGap_ = 0;
+};
@@ -0,0 +1,132 @@
+#include "adaptive_sampler.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Причина деления отрезка
+ */
+enum class Refinement {
+    None,
+    Curvature,
+    Discontinuity
+};
+
+/**
+ * @brief Решает, нужно ли делить отрезок [a, b] с серединой m
+ */
+static Refinement classify(const PlotPoint& a, const PlotPoint& m, const PlotPoint& b, const PlotViewport& viewport,
+    double tolerance) {
+    bool fa = std::isfinite(a.y);
+    bool fm = std::isfinite(m.y);
+    bool fb = std::isfinite(b.y);
+    if (!fa && !fm && !fb)
+        return Refinement::None;
+    if (!fa || !fm || !fb)
+        return Refinement::Discontinuity;
+    double sa = viewport.toScreenY(a.y);
+    double sm = viewport.toScreenY(m.y);
+    double sb = viewport.toScreenY(b.y);
+    if (std::fabs(sa - sb) > viewport.height || std::fabs(sa - sm) > viewport.height)
+        return Refinement::Discontinuity;
+    // Кривизна за пределами экрана не видна
+    if ((sa < 0 && sm < 0 && sb < 0) || (sa > viewport.height && sm > viewport.height && sb > viewport.height))
+        return Refinement::None;
+    if (std::fabs(sm - 0.5 * (sa + sb)) > tolerance)
+        return Refinement::Curvature;
+    return Refinement::None;
+}
+
+AdaptiveSampleStats AdaptiveSampler::sample(const Expression& function, const PlotViewport& viewport,
+    std::vector<PlotPoint>& out, SampleCache* coarse) const {
+    CALC_TRACE_SCOPE("AdaptiveSampler::sample");
+    AdaptiveSampleStats stats;
+    double pixel = (viewport.xMax - viewport.xMin) / viewport.width;
+    int initialPoints = std::max(2, viewport.width / std::max(options_.initialSpacing, 1));
+
+    std::vector<PlotPoint> points;
+    if (coarse) {
+        uint64_t before = coarse->stats().evaluations;
+        coarse->sample(viewport.xMin, viewport.xMax, initialPoints, points);
+        stats.evaluations += coarse->stats().evaluations - before;
+    }
+    else {
+        double step = (viewport.xMax - viewport.xMin) / initialPoints;
+        std::vector<double> xs(initialPoints + 3);
+        for (size_t i = 0; i < xs.size(); i++)
+            xs[i] = viewport.xMin + (static_cast<double>(i) - 1.0) * step;
+        std::vector<double> ys(xs.size());
+        function.evaluateBatch(xs.data(), ys.data(), xs.size());
+        stats.evaluations += xs.size();
+        for (size_t i = 0; i < xs.size(); i++)
+            points.push_back({ xs[i], ys[i] });
+    }
+
+    // Первый проход делит все отрезки начальной сетки, следующие — только отмеченные
+    std::vector<char> active(points.size() > 0 ? points.size() - 1 : 0, 1);
+    std::vector<PlotPoint> next;
+    std::vector<char> nextActive;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (int depth = 0; depth <= options_.maxDepth; depth++) {
+        xs.clear();
+        for (size_t i = 0; i + 1 < points.size(); i++) {
+            if (active[i])
+                xs.push_back(0.5 * (points[i].x + points[i + 1].x));
+        }
+        if (xs.empty())
+            break;
+        ys.resize(xs.size());
+        function.evaluateBatch(xs.data(), ys.data(), xs.size());
+        stats.evaluations += xs.size();
+
+        next.clear();
+        nextActive.clear();
+        size_t k = 0;
+        for (size_t i = 0; i + 1 < points.size(); i++) {
+            next.push_back(points[i]);
+            if (!active[i]) {
+                nextActive.push_back(0);
+                continue;
+            }
+            PlotPoint middle{ xs[k], ys[k] };
+            k++;
+            Refinement refinement = classify(points[i], middle, points[i + 1], viewport, options_.tolerance);
+            double halfWidth = (middle.x - points[i].x) / pixel;
+            bool split = (refinement == Refinement::Curvature && halfWidth >= options_.curvatureWidth) ||
+                (refinement == Refinement::Discontinuity && halfWidth >= options_.minWidth);
+            next.push_back(middle);
+            nextActive.push_back(split);
+            nextActive.push_back(split);
+        }
+        next.push_back(points.back());
+        points.swap(next);
+        active.swap(nextActive);
+    }
+
+    out.clear();
+    out.reserve(points.size() + 16);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < points.size(); i++) {
+        if (i > 0) {
+            const PlotPoint& a = points[i - 1];
+            const PlotPoint& b = points[i];
+            bool fa = std::isfinite(a.y);
+            bool fb = std::isfinite(b.y);
+            double sa = fa ? viewport.toScreenY(a.y) : 0.0;
+            double sb = fb ? viewport.toScreenY(b.y) : 0.0;
+            // Скачок важен, только если соединяющий отрезок пересёк бы экран
+            if (fa && fb && std::fabs(sa - sb) > viewport.height && std::min(sa, sb) < viewport.height &&
+                std::max(sa, sb) > 0.0) {
+                out.push_back({ 0.5 * (a.x + b.x), nan });
+                stats.breaks++;
+            }
+            else if (fa != fb)
+                stats.breaks++;
+        }
+        out.push_back(points[i]);
+    }
+    stats.points = out.size();
+    return stats;
+}
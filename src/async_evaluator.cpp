@@ -0,0 +1,14 @@
+#include "async_evaluator.h"
+
+AsyncEvaluation AsyncEvaluator::submit(CalculatorEngine::EvaluationJob job) {
+    AsyncEvaluation evaluation;
+    evaluation.control = std::make_shared<EvaluationControl>();
+    std::shared_ptr<EvaluationControl> control = evaluation.control;
+    evaluation.result = pool_.submit([job, control]() {
+        control->checkpoint(0.0f);
+        std::string result = job(*control);
+        control->checkpoint(1.0f);
+        return result;
+    }).share();
+    return evaluation;
+}
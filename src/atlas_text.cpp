@@ -0,0 +1,105 @@
+#include "atlas_text.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+bool GlyphAtlas::load() {
+    std::vector<sf::Uint8> rgba(static_cast<size_t>(kGlyphAtlasWidth) * kGlyphAtlasHeight * 4);
+    for (size_t i = 0; i < static_cast<size_t>(kGlyphAtlasWidth) * kGlyphAtlasHeight; i++) {
+        rgba[i * 4 + 0] = 255;
+        rgba[i * 4 + 1] = 255;
+        rgba[i * 4 + 2] = 255;
+        rgba[i * 4 + 3] = kGlyphAtlasPixels[i];
+    }
+    if (!texture_.create(kGlyphAtlasWidth, kGlyphAtlasHeight))
+        return false;
+    texture_.update(rgba.data());
+    texture_.setSmooth(false);
+    return true;
+}
+
+const BakedGlyph* GlyphAtlas::find(sf::Uint32 codepoint) const {
+    const BakedGlyph* end = kBakedGlyphs + kBakedGlyphCount;
+    const BakedGlyph* glyph = std::lower_bound(kBakedGlyphs, end, codepoint,
+        [](const BakedGlyph& g, sf::Uint32 c) { return g.codepoint < c; });
+    return (glyph != end && glyph->codepoint == codepoint) ? glyph : nullptr;
+}
+
+void AtlasText::setAtlas(const GlyphAtlas& atlas) {
+    atlas_ = &atlas;
+    rebuild();
+}
+
+void AtlasText::setString(const std::string& utf8) {
+    if (utf8 == string_)
+        return;
+    string_ = utf8;
+    rebuild();
+}
+
+void AtlasText::setFillColor(const sf::Color& color) {
+    color_ = color;
+    for (size_t i = 0; i < vertices_.getVertexCount(); i++)
+        vertices_[i].color = color;
+}
+
+void AtlasText::rebuild() {
+    vertices_.clear();
+    bounds_ = sf::FloatRect();
+    if (!atlas_)
+        return;
+
+    std::vector<sf::Uint32> codepoints;
+    sf::Utf8::toUtf32(string_.begin(), string_.end(), std::back_inserter(codepoints));
+
+    float penX = 0.0f;
+    float baseline = static_cast<float>(kBakedCharacterSize);
+    float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+    bool first = true;
+    for (sf::Uint32 codepoint : codepoints) {
+        const BakedGlyph* glyph = atlas_->find(codepoint);
+        if (!glyph)
+            glyph = atlas_->find('?');
+        if (!glyph)
+            continue;
+        if (glyph->width > 0 && glyph->height > 0) {
+            float left = penX + glyph->left;
+            float top = baseline + glyph->top;
+            float right = left + glyph->width;
+            float bottom = top + glyph->height;
+            float u0 = static_cast<float>(glyph->x);
+            float v0 = static_cast<float>(glyph->y);
+            float u1 = u0 + glyph->width;
+            float v1 = v0 + glyph->height;
+            vertices_.append(sf::Vertex(sf::Vector2f(left, top), color_, sf::Vector2f(u0, v0)));
+            vertices_.append(sf::Vertex(sf::Vector2f(right, top), color_, sf::Vector2f(u1, v0)));
+            vertices_.append(sf::Vertex(sf::Vector2f(left, bottom), color_, sf::Vector2f(u0, v1)));
+            vertices_.append(sf::Vertex(sf::Vector2f(left, bottom), color_, sf::Vector2f(u0, v1)));
+            vertices_.append(sf::Vertex(sf::Vector2f(right, top), color_, sf::Vector2f(u1, v0)));
+            vertices_.append(sf::Vertex(sf::Vector2f(right, bottom), color_, sf::Vector2f(u1, v1)));
+            if (first) {
+                minX = left;
+                minY = top;
+                maxX = right;
+                maxY = bottom;
+                first = false;
+            }
+            else {
+                minX = std::min(minX, left);
+                minY = std::min(minY, top);
+                maxX = std::max(maxX, right);
+                maxY = std::max(maxY, bottom);
+            }
+        }
+        penX += glyph->advance;
+    }
+    bounds_ = sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void AtlasText::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (!atlas_ || vertices_.getVertexCount() == 0)
+        return;
+    states.transform *= getTransform();
+    states.texture = &atlas_->texture();
+    target.draw(vertices_, states);
+}
@@ -0,0 +1,186 @@
+#include "calc_protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void appendUint32(std::string& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; i++)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.append(bytes, 4);
+}
+
+static uint32_t readUint32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return value;
+}
+
+void appendRequest(std::string& out, uint32_t id, std::string_view expression) {
+    appendUint32(out, static_cast<uint32_t>(4 + expression.size()));
+    appendUint32(out, id);
+    out.append(expression);
+}
+
+void appendResponse(std::string& out, uint32_t id, CalcStatus status, double value, std::string_view error) {
+    bool ok = status == CalcStatus::Ok;
+    appendUint32(out, static_cast<uint32_t>(5 + (ok ? 8 : error.size())));
+    appendUint32(out, id);
+    out.push_back(static_cast<char>(status));
+    if (ok) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendUint32(out, static_cast<uint32_t>(bits));
+        appendUint32(out, static_cast<uint32_t>(bits >> 32));
+    }
+    else
+        out.append(error);
+}
+
+size_t nextFrame(std::string_view buffer, std::string_view& payload) {
+    if (buffer.size() < 4)
+        return 0;
+    uint32_t length = readUint32(buffer.data());
+    if (length > kMaxFrameSize)
+        throw std::runtime_error("Frame too large: " + std::to_string(length) + " bytes");
+    if (buffer.size() - 4 < length)
+        return 0;
+    payload = buffer.substr(4, length);
+    return 4 + static_cast<size_t>(length);
+}
+
+bool decodeRequest(std::string_view payload, uint32_t& id, std::string_view& expression) {
+    if (payload.size() < 4)
+        return false;
+    id = readUint32(payload.data());
+    expression = payload.substr(4);
+    return true;
+}
+
+bool decodeResponse(std::string_view payload, CalcResponse& response) {
+    if (payload.size() < 5)
+        return false;
+    response.id = readUint32(payload.data());
+    uint8_t status = static_cast<uint8_t>(payload[4]);
+    if (status == static_cast<uint8_t>(CalcStatus::Ok)) {
+        if (payload.size() != 13)
+            return false;
+        uint64_t bits = readUint32(payload.data() + 5) | static_cast<uint64_t>(readUint32(payload.data() + 9)) << 32;
+        response.status = CalcStatus::Ok;
+        std::memcpy(&response.value, &bits, sizeof(bits));
+        response.error.clear();
+        return true;
+    }
+    if (status != static_cast<uint8_t>(CalcStatus::Error))
+        return false;
+    response.status = CalcStatus::Error;
+    response.value = 0.0;
+    response.error.assign(payload.substr(5));
+    return true;
+}
+
+/**
+ * @brief Открывает блокирующее соединение с Unix-сокетом
+ */
+static int connectUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path too long: " + path);
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Cannot create socket: ") + std::strerror(errno));
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Cannot connect to " + path + ": " + std::strerror(error));
+    }
+    return fd;
+}
+
+static void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Cannot send request: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+/**
+ * @brief Читает доступные байты; 0 — соединение закрыто
+ */
+static size_t readSome(int fd, char* buffer, size_t size) {
+    for (;;) {
+        ssize_t read = recv(fd, buffer, size, 0);
+        if (read >= 0)
+            return static_cast<size_t>(read);
+        if (errno != EINTR)
+            throw std::runtime_error(std::string("Cannot receive response: ") + std::strerror(errno));
+    }
+}
+
+CalcClient::CalcClient(const std::string& socketPath) : fd_(connectUnix(socketPath)) {}
+
+CalcClient::~CalcClient() {
+    close(fd_);
+}
+
+void CalcClient::flush() {
+    writeAll(fd_, output_.data(), output_.size());
+    output_.clear();
+}
+
+CalcResponse CalcClient::receive() {
+    for (;;) {
+        std::string_view payload;
+        size_t length = nextFrame(std::string_view(input_).substr(inputOffset_), payload);
+        if (length > 0) {
+            CalcResponse response;
+            if (!decodeResponse(payload, response))
+                throw std::runtime_error("Malformed response");
+            inputOffset_ += length;
+            return response;
+        }
+        // Необработанный хвост переносится в начало, чтобы буфер не рос
+        input_.erase(0, inputOffset_);
+        inputOffset_ = 0;
+        size_t size = input_.size();
+        input_.resize(size + 65536);
+        size_t read = readSome(fd_, &input_[size], 65536);
+        input_.resize(size + read);
+        if (read == 0)
+            throw std::runtime_error("Server closed the connection");
+    }
+}
+
+std::string fetchMetrics(const std::string& socketPath) {
+    int fd = connectUnix(socketPath);
+    std::string response;
+    try {
+        static const char kRequest[] = "GET /metrics HTTP/1.0\r\n\r\n";
+        writeAll(fd, kRequest, sizeof(kRequest) - 1);
+        char buffer[4096];
+        size_t read;
+        while ((read = readSome(fd, buffer, sizeof(buffer))) > 0)
+            response.append(buffer, read);
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    size_t body = response.find("\r\n\r\n");
+    if (response.compare(0, 12, "HTTP/1.0 200") != 0 || body == std::string::npos)
+        throw std::runtime_error("Malformed metrics response");
+    return response.substr(body + 4);
+}
@@ -0,0 +1,479 @@
+#include "calc_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "calc_protocol.h"
+#include "line_evaluator.h"
+
+/**
+ * @brief Метки epoll для сокетов сервера; соединения нумеруются с 16
+ */
+static const uint64_t kListenerId = 1;
+static const uint64_t kMetricsListenerId = 2;
+static const uint64_t kWakeId = 3;
+
+/**
+ * @brief Объём неотправленного вывода, при котором соединение перестаёт читаться
+ */
+static const size_t kMaxPendingOutput = 1 << 20;
+
+/**
+ * @brief Наибольший размер HTTP-запроса к сокету метрик
+ */
+static const size_t kMaxMetricsRequest = 8192;
+
+/**
+ * @brief Сколько полных буферов читается из соединения за один проход цикла событий
+ *
+ * Остаток дочитывается после следующего epoll_wait (события по уровню), чтобы один быстрый
+ * клиент не задерживал остальные соединения.
+ */
+static const int kMaxReadsPerPass = 4;
+
+/**
+ * @brief Через сколько миллисекунд приостановленный из-за нехватки дескрипторов приём повторяется
+ */
+static const int kAcceptRetryMs = 100;
+
+/**
+ * @brief Верхние границы корзин гистограммы задержки, секунды
+ */
+static const double kLatencyBounds[] = { 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.1, 1.0 };
+
+static std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/**
+ * @brief Создаёт неблокирующий слушающий Unix-сокет; оставшийся от прошлого запуска сокет удаляется
+ */
+static int listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path too long: " + path);
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw systemError("Cannot create socket");
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::runtime_error error = systemError("Cannot listen on " + path);
+        close(fd);
+        throw error;
+    }
+    return fd;
+}
+
+static bool addToEpoll(int epoll, int fd, uint64_t id, uint32_t events) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    return epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+static void watch(int epoll, int fd, uint64_t id) {
+    if (!addToEpoll(epoll, fd, id, EPOLLIN))
+        throw systemError("Cannot watch socket");
+}
+
+CalcServer::CalcServer(const CalcServerOptions& options) : options_(options) {
+    options_.batchSize = std::max<size_t>(options_.batchSize, 1);
+    try {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_ < 0)
+            throw systemError("Cannot create epoll");
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_ < 0)
+            throw systemError("Cannot create eventfd");
+        watch(epoll_, wake_, kWakeId);
+        listener_ = listenUnix(options_.socketPath);
+        watch(epoll_, listener_, kListenerId);
+        if (!options_.metricsPath.empty()) {
+            metricsListener_ = listenUnix(options_.metricsPath);
+            watch(epoll_, metricsListener_, kMetricsListenerId);
+        }
+    }
+    catch (...) {
+        for (int fd : { metricsListener_, listener_, wake_, epoll_ }) {
+            if (fd >= 0)
+                close(fd);
+        }
+        throw;
+    }
+    pool_ = std::make_unique<ThreadPool>(options_.threads);
+}
+
+CalcServer::~CalcServer() {
+    // Задачи пула пишут в eventfd, поэтому пул останавливается до закрытия дескрипторов
+    pool_.reset();
+    for (auto& entry : connections_)
+        close(entry.second.fd);
+    close(listener_);
+    unlink(options_.socketPath.c_str());
+    if (metricsListener_ >= 0) {
+        close(metricsListener_);
+        unlink(options_.metricsPath.c_str());
+    }
+    close(wake_);
+    close(epoll_);
+}
+
+void CalcServer::stop() noexcept {
+    stopping_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t written = write(wake_, &one, sizeof(one));
+    (void)written;
+}
+
+void CalcServer::run() {
+    epoll_event events[64];
+    while (!stopping_.load(std::memory_order_acquire)) {
+        int count = epoll_wait(epoll_, events, 64, acceptPaused_ ? kAcceptRetryMs : -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw systemError("epoll_wait failed");
+        }
+        if (count == 0 && acceptPaused_)
+            resumeAccept();
+        for (int i = 0; i < count; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == kListenerId)
+                acceptAll(listener_, false);
+            else if (id == kMetricsListenerId)
+                acceptAll(metricsListener_, true);
+            else if (id == kWakeId) {
+                uint64_t value;
+                ssize_t read = ::read(wake_, &value, sizeof(value));
+                (void)read;
+            }
+            else {
+                // Закрытое с обеих сторон соединение ответов уже не примет
+                if (events[i].events & (EPOLLHUP | EPOLLERR))
+                    closeConnection(id);
+                else if (events[i].events & EPOLLIN)
+                    readConnection(id);
+                if (events[i].events & EPOLLOUT)
+                    flushConnection(id);
+            }
+        }
+        // Всё принятое за проход уходит в пул пакетами, готовое — клиентам одной записью на соединение
+        submitPending();
+        deliverCompletions();
+        for (uint64_t id : toFlush_)
+            flushConnection(id);
+        toFlush_.clear();
+    }
+}
+
+void CalcServer::acceptAll(int listener, bool metrics) {
+    while (!acceptPaused_) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // Клиент, отключившийся до приёма, не мешает принимать остальных
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            // Дескрипторы кончились (EMFILE, ENFILE) или не хватает памяти: слушающий сокет
+            // остаётся готовым, поэтому без паузы цикл событий вращался бы вхолостую
+            pauseAccept();
+            return;
+        }
+        uint64_t id = nextConnection_++;
+        if (!addToEpoll(epoll_, fd, id, EPOLLIN)) {
+            close(fd);
+            pauseAccept();
+            return;
+        }
+        Connection& connection = connections_[id];
+        connection.fd = fd;
+        connection.metrics = metrics;
+        connection.events = EPOLLIN;
+        accepted_++;
+    }
+}
+
+void CalcServer::pauseAccept() {
+    acceptPaused_ = true;
+    acceptPauses_++;
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, listener_, nullptr);
+    if (metricsListener_ >= 0)
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, metricsListener_, nullptr);
+}
+
+void CalcServer::resumeAccept() {
+    if (!addToEpoll(epoll_, listener_, kListenerId, EPOLLIN))
+        return;
+    if (metricsListener_ >= 0 && !addToEpoll(epoll_, metricsListener_, kMetricsListenerId, EPOLLIN)) {
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, listener_, nullptr);
+        return;
+    }
+    acceptPaused_ = false;
+}
+
+void CalcServer::readConnection(uint64_t id) {
+    auto found = connections_.find(id);
+    if (found == connections_.end())
+        return;
+    Connection& connection = found->second;
+    bool closed = false;
+    bool failed = false;
+    char buffer[65536];
+    for (int reads = 0; reads < kMaxReadsPerPass;) {
+        ssize_t read = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (read > 0) {
+            connection.input.append(buffer, static_cast<size_t>(read));
+            if (static_cast<size_t>(read) < sizeof(buffer))
+                break;
+            reads++;
+            continue;
+        }
+        if (read < 0 && errno == EINTR)
+            continue;
+        if (read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        closed = true;
+        failed = read < 0;
+        break;
+    }
+    if (failed) {
+        closeConnection(id);
+        return;
+    }
+
+    if (connection.metrics) {
+        if (connection.input.find("\r\n\r\n") != std::string::npos || connection.input.find("\n\n") != std::string::npos) {
+            std::string body = metricsText();
+            connection.output = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            connection.input.clear();
+            connection.closeAfterWrite = true;
+            flushConnection(id);
+        }
+        else if (closed || connection.input.size() > kMaxMetricsRequest)
+            closeConnection(id);
+        return;
+    }
+
+    Clock::time_point received = Clock::now();
+    size_t offset = 0;
+    try {
+        std::string_view payload;
+        size_t length;
+        while ((length = nextFrame(std::string_view(connection.input).substr(offset), payload)) > 0) {
+            offset += length;
+            uint32_t request;
+            std::string_view expression;
+            if (!decodeRequest(payload, request, expression))
+                throw std::runtime_error("Malformed request");
+            handleRequest(id, request, expression, received);
+        }
+    }
+    catch (const std::runtime_error&) {
+        protocolErrors_++;
+        closeConnection(id);
+        return;
+    }
+    connection.input.erase(0, offset);
+    if (closed) {
+        // Клиент закончил отправку: соединение закрывается после ответа на все его запросы
+        connection.peerClosed = true;
+        connection.closeAfterWrite = connection.waiting == 0;
+        flushConnection(id);
+    }
+}
+
+void CalcServer::handleRequest(uint64_t id, uint32_t request, std::string_view expression, Clock::time_point received) {
+    requests_++;
+    connections_[id].waiting++;
+    auto entry = inFlight_.try_emplace(std::string(expression));
+    entry.first->second.push_back({ id, request, received });
+    if (entry.second)
+        pending_.push_back(entry.first->first);
+    else
+        coalesced_++;
+}
+
+void CalcServer::submitPending() {
+    if (pending_.empty())
+        return;
+    // Пакеты делятся между рабочими потоками, но не превышают batchSize
+    size_t threads = std::max<size_t>(pool_->size(), 1);
+    size_t batch = std::min(options_.batchSize, (pending_.size() + threads - 1) / threads);
+    for (size_t begin = 0; begin < pending_.size(); begin += batch) {
+        size_t end = std::min(pending_.size(), begin + batch);
+        std::vector<std::string> expressions(std::make_move_iterator(pending_.begin() + begin),
+            std::make_move_iterator(pending_.begin() + end));
+        pool_->post([this, expressions = std::move(expressions)]() { evaluateBatch(expressions); });
+        batches_++;
+    }
+    pending_.clear();
+}
+
+void CalcServer::evaluateBatch(const std::vector<std::string>& expressions) {
+    LineEvaluator evaluator;
+    std::vector<Completion> results;
+    results.reserve(expressions.size());
+    for (const std::string& expression : expressions) {
+        Completion completion{ expression, false, 0.0, std::string() };
+        completion.ok = evaluator.evaluate(expression, completion.value, completion.error);
+        results.push_back(std::move(completion));
+    }
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        wasEmpty = completions_.empty();
+        std::move(results.begin(), results.end(), std::back_inserter(completions_));
+    }
+    // Поток ввода-вывода забирает все готовые результаты сразу, поэтому будить его достаточно один раз
+    if (wasEmpty) {
+        uint64_t one = 1;
+        ssize_t written = write(wake_, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void CalcServer::deliverCompletions() {
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        completions.swap(completions_);
+    }
+    if (completions.empty())
+        return;
+    Clock::time_point now = Clock::now();
+    for (const Completion& completion : completions) {
+        auto entry = inFlight_.find(completion.expression);
+        if (entry == inFlight_.end())
+            continue;
+        for (const Waiter& waiter : entry->second) {
+            double seconds = std::chrono::duration<double>(now - waiter.received).count();
+            size_t bucket = 0;
+            while (bucket < kLatencyBuckets && seconds > kLatencyBounds[bucket])
+                bucket++;
+            if (bucket < kLatencyBuckets)
+                latencyBuckets_[bucket]++;
+            latencyCount_++;
+            latencySum_ += seconds;
+            if (!completion.ok)
+                errors_++;
+            auto found = connections_.find(waiter.connection);
+            if (found == connections_.end())
+                continue;
+            Connection& connection = found->second;
+            connection.waiting--;
+            if (connection.peerClosed && connection.waiting == 0)
+                connection.closeAfterWrite = true;
+            appendResponse(connection.output, waiter.request, completion.ok ? CalcStatus::Ok : CalcStatus::Error,
+                completion.value, completion.error);
+            if (!connection.flushPending) {
+                connection.flushPending = true;
+                toFlush_.push_back(waiter.connection);
+            }
+        }
+        inFlight_.erase(entry);
+    }
+}
+
+void CalcServer::flushConnection(uint64_t id) {
+    auto found = connections_.find(id);
+    if (found == connections_.end())
+        return;
+    Connection& connection = found->second;
+    connection.flushPending = false;
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t written = send(connection.fd, connection.output.data() + connection.outputOffset,
+            connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (written > 0) {
+            connection.outputOffset += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        closeConnection(id);
+        return;
+    }
+    if (connection.outputOffset == connection.output.size()) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+        if (connection.closeAfterWrite) {
+            closeConnection(id);
+            return;
+        }
+    }
+    updateEvents(id, connection);
+}
+
+void CalcServer::updateEvents(uint64_t id, Connection& connection) {
+    size_t unsent = connection.output.size() - connection.outputOffset;
+    uint32_t events = 0;
+    if (unsent < kMaxPendingOutput && !connection.peerClosed && !connection.closeAfterWrite)
+        events |= EPOLLIN;
+    if (unsent > 0)
+        events |= EPOLLOUT;
+    if (events == connection.events)
+        return;
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.events = events;
+}
+
+void CalcServer::closeConnection(uint64_t id) {
+    auto found = connections_.find(id);
+    if (found == connections_.end())
+        return;
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, found->second.fd, nullptr);
+    close(found->second.fd);
+    connections_.erase(found);
+    // Освободился дескриптор: приостановленный приём возобновляется
+    if (acceptPaused_)
+        resumeAccept();
+}
+
+std::string CalcServer::metricsText() const {
+    std::ostringstream out;
+    auto counter = [&out](const char* name, const char* help, uint64_t value) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n" << name << ' ' << value << '\n';
+    };
+    auto gauge = [&out](const char* name, const char* help, uint64_t value) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " gauge\n" << name << ' ' << value << '\n';
+    };
+    counter("calc_requests_total", "Evaluation requests received.", requests_);
+    counter("calc_coalesced_requests_total", "Requests answered by an identical request already in flight.", coalesced_);
+    counter("calc_errors_total", "Requests answered with an evaluation error.", errors_);
+    counter("calc_protocol_errors_total", "Connections closed because of malformed frames.", protocolErrors_);
+    counter("calc_batches_total", "Evaluation batches submitted to the worker pool.", batches_);
+    counter("calc_connections_accepted_total", "Connections accepted on both sockets.", accepted_);
+    counter("calc_accept_pauses_total", "Times accepting was paused because descriptors ran out.", acceptPauses_);
+    gauge("calc_connections", "Open connections.", connections_.size());
+    gauge("calc_in_flight_expressions", "Distinct expressions being evaluated.", inFlight_.size());
+    gauge("calc_worker_threads", "Worker pool threads.", pool_->size());
+    out << "# HELP calc_request_duration_seconds Time from receiving a request to queueing its response.\n"
+        << "# TYPE calc_request_duration_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kLatencyBuckets; i++) {
+        cumulative += latencyBuckets_[i];
+        out << "calc_request_duration_seconds_bucket{le=\"" << kLatencyBounds[i] << "\"} " << cumulative << '\n';
+    }
+    out << "calc_request_duration_seconds_bucket{le=\"+Inf\"} " << latencyCount_ << '\n'
+        << "calc_request_duration_seconds_sum " << latencySum_ << '\n'
+        << "calc_request_duration_seconds_count " << latencyCount_ << '\n';
+    return out.str();
+}
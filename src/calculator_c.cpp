@@ -0,0 +1,244 @@
+#include "calculator_c.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "calculator_math.h"
+#include "expression.h"
+
+struct calc_expression {
+    Expression expression;
+};
+
+struct calc_evaluator {
+    Expression expression;
+};
+
+static const std::vector<std::string> kNoVariables;
+
+static_assert(static_cast<int>(CALC_TANGENT_UNDEFINED) == static_cast<int>(MathError::TangentUndefined),
+    "calc_status must mirror MathError");
+static_assert(static_cast<int>(CALC_INCORRECT_TRIGONOMETRIC_OPERATION) ==
+                  static_cast<int>(MathError::IncorrectTrigonometricOperation),
+    "calc_status must mirror MathError");
+static_assert(static_cast<int>(CALC_COT) == static_cast<int>(Operation::Cot), "calc_operation must mirror Operation");
+
+static calc_status toStatus(MathError error) {
+    return static_cast<calc_status>(static_cast<int>(error));
+}
+
+static bool validOperation(calc_operation op) {
+    return op >= CALC_ADD && op <= CALC_COT;
+}
+
+/**
+ * @brief Копирует сообщение в буфер вызывающего, обрезая его и завершая нулём
+ */
+static void copyMessage(const char* message, char* buffer, size_t size) {
+    if (buffer == nullptr || size == 0)
+        return;
+    size_t length = std::min(std::strlen(message), size - 1);
+    std::memcpy(buffer, message, length);
+    buffer[length] = '\0';
+}
+
+/**
+ * @brief Код и текст перехваченного исключения; вызывается только из блока catch
+ */
+static calc_status currentError(char* error, size_t errorSize) {
+    try {
+        throw;
+    }
+    catch (const std::bad_alloc&) {
+        copyMessage("Out of memory", error, errorSize);
+        return CALC_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& ex) {
+        copyMessage(ex.what(), error, errorSize);
+        return CALC_SYNTAX_ERROR;
+    }
+    catch (...) {
+        copyMessage("Unknown error", error, errorSize);
+        return CALC_SYNTAX_ERROR;
+    }
+}
+
+/**
+ * @brief Стек пакетного вычисления потока: растёт до размера самого глубокого выражения и переиспользуется
+ */
+static double* batchScratch(size_t size) {
+    thread_local std::vector<double> scratch;
+    if (scratch.size() < size)
+        scratch.resize(size);
+    return scratch.data();
+}
+
+extern "C" {
+
+int calc_abi_version(void) {
+    return CALC_ABI_VERSION;
+}
+
+const char* calc_status_message(calc_status status) {
+    switch (status) {
+    case CALC_OK:
+        return "OK";
+    case CALC_DIVISION_BY_ZERO:
+    case CALC_INCORRECT_OPERATOR:
+    case CALC_FACTORIAL_DOMAIN:
+    case CALC_TANGENT_UNDEFINED:
+    case CALC_COTANGENT_UNDEFINED:
+    case CALC_INCORRECT_TRIGONOMETRIC_OPERATION:
+        return mathErrorMessage(static_cast<MathError>(static_cast<int>(status)));
+    case CALC_SYNTAX_ERROR:
+        return "Syntax error";
+    case CALC_INVALID_ARGUMENT:
+        return "Invalid argument";
+    case CALC_OUT_OF_MEMORY:
+        return "Out of memory";
+    }
+    return "Unknown status";
+}
+
+calc_status calc_evaluate_operation(calc_operation op, double a, double b, double* result) {
+    if (result == nullptr || !validOperation(op))
+        return CALC_INVALID_ARGUMENT;
+    return toStatus(tryEvaluate(static_cast<Operation>(op), a, b, *result));
+}
+
+calc_status calc_evaluate_vector(calc_operation op, const double* a, const double* b, double* result, size_t count) {
+    if (count == 0)
+        return CALC_OK;
+    bool unary = op == CALC_FACTORIAL || op >= CALC_SIN;
+    if (a == nullptr || result == nullptr || (!unary && b == nullptr) || !validOperation(op))
+        return CALC_INVALID_ARGUMENT;
+    evaluateVector(static_cast<Operation>(op), a, b, result, count);
+    return CALC_OK;
+}
+
+calc_status calc_expression_create(const char* text, size_t length, const char* const* variables,
+    size_t variable_count, calc_expression** expression, char* error, size_t error_size) {
+    if (expression == nullptr)
+        return CALC_INVALID_ARGUMENT;
+    *expression = nullptr;
+    if ((text == nullptr && length > 0) || (variables == nullptr && variable_count > 0)) {
+        copyMessage("Invalid argument", error, error_size);
+        return CALC_INVALID_ARGUMENT;
+    }
+    try {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < variable_count; i++) {
+            if (variables[i] == nullptr) {
+                copyMessage("Invalid argument", error, error_size);
+                return CALC_INVALID_ARGUMENT;
+            }
+            names.emplace_back(variables[i]);
+        }
+        calc_expression* created = new calc_expression;
+        try {
+            created->expression.compile(std::string_view(text != nullptr ? text : "", length), names);
+        }
+        catch (...) {
+            delete created;
+            throw;
+        }
+        *expression = created;
+        copyMessage("", error, error_size);
+        return CALC_OK;
+    }
+    catch (...) {
+        return currentError(error, error_size);
+    }
+}
+
+void calc_expression_destroy(calc_expression* expression) {
+    delete expression;
+}
+
+size_t calc_expression_variable_count(const calc_expression* expression) {
+    return expression != nullptr ? expression->expression.variableCount() : 0;
+}
+
+calc_status calc_expression_evaluate(const calc_expression* expression, const double* variables, double* result) {
+    if (expression == nullptr || result == nullptr || (variables == nullptr && expression->expression.variableCount() > 0))
+        return CALC_INVALID_ARGUMENT;
+    return toStatus(expression->expression.evaluate(variables, *result));
+}
+
+calc_status calc_expression_evaluate_batch(const calc_expression* expression, const double* const* variables,
+    double* results, size_t count) {
+    if (expression == nullptr || (results == nullptr && count > 0))
+        return CALC_INVALID_ARGUMENT;
+    size_t variableCount = expression->expression.variableCount();
+    if (variableCount > 0 && variables == nullptr)
+        return CALC_INVALID_ARGUMENT;
+    for (size_t k = 0; k < variableCount; k++) {
+        if (variables[k] == nullptr && count > 0)
+            return CALC_INVALID_ARGUMENT;
+    }
+    if (count == 0)
+        return CALC_OK;
+    try {
+        double* scratch = batchScratch(expression->expression.batchScratchSize());
+        expression->expression.evaluateBatch(variables, results, count, scratch);
+        return CALC_OK;
+    }
+    catch (...) {
+        return currentError(nullptr, 0);
+    }
+}
+
+calc_evaluator* calc_evaluator_create(void) {
+    return new (std::nothrow) calc_evaluator;
+}
+
+void calc_evaluator_destroy(calc_evaluator* evaluator) {
+    delete evaluator;
+}
+
+calc_status calc_evaluate_string(calc_evaluator* evaluator, const char* text, size_t length, double* result,
+    char* error, size_t error_size) {
+    if (evaluator == nullptr || result == nullptr || (text == nullptr && length > 0)) {
+        copyMessage("Invalid argument", error, error_size);
+        return CALC_INVALID_ARGUMENT;
+    }
+    try {
+        evaluator->expression.compile(std::string_view(text != nullptr ? text : "", length), kNoVariables);
+    }
+    catch (...) {
+        return currentError(error, error_size);
+    }
+    MathError code = evaluator->expression.evaluate(nullptr, *result);
+    copyMessage(code == MathError::None ? "" : mathErrorMessage(code), error, error_size);
+    return toStatus(code);
+}
+
+size_t calc_evaluate_strings(calc_evaluator* evaluator, const char* const* texts, const size_t* lengths,
+    size_t count, double* results, calc_status* statuses) {
+    if (count == 0)
+        return 0;
+    if (evaluator == nullptr || texts == nullptr || lengths == nullptr || results == nullptr) {
+        if (statuses != nullptr) {
+            for (size_t i = 0; i < count; i++)
+                statuses[i] = CALC_INVALID_ARGUMENT;
+        }
+        return count;
+    }
+    size_t failures = 0;
+    for (size_t i = 0; i < count; i++) {
+        double value = std::numeric_limits<double>::quiet_NaN();
+        calc_status status = calc_evaluate_string(evaluator, texts[i], lengths[i], &value, nullptr, 0);
+        results[i] = status == CALC_OK ? value : std::numeric_limits<double>::quiet_NaN();
+        if (statuses != nullptr)
+            statuses[i] = status;
+        if (status != CALC_OK)
+            failures++;
+    }
+    return failures;
+}
+
+}
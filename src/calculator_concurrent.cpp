@@ -0,0 +1,53 @@
+#include "calculator_concurrent.h"
+#include "trace.h"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Границы размера отрезка пакета в элементах
+ */
+static const size_t kMinChunk = 2048;
+static const size_t kMaxChunk = 65536;
+
+ThreadPool& defaultExecutor() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::future<double> evaluateAsync(Operation op, double a, double b) {
+    return evaluateAsync(defaultExecutor(), op, a, b);
+}
+
+std::future<double> evaluateAsync(ThreadPool& pool, Operation op, double a, double b) {
+    return pool.submit([op, a, b]() { return evaluate(op, a, b); });
+}
+
+size_t batchChunkSize(size_t count, size_t threads) {
+    size_t perThread = count / (std::max<size_t>(threads, 1) * 4);
+    size_t chunk = std::min(kMaxChunk, std::max(kMinChunk, perThread));
+    return (chunk + 7) & ~static_cast<size_t>(7);
+}
+
+/**
+ * @brief Последовательная обработка отрезка пакета
+ */
+static void evaluateRange(const EvaluationRequest* requests, EvaluationResult* results, size_t begin, size_t end) {
+    CALC_TRACE_SCOPE("evaluateBatch chunk");
+    for (size_t i = begin; i < end; i++) {
+        const EvaluationRequest& request = requests[i];
+        EvaluationResult& result = results[i];
+        result.value = 0.0;
+        result.error = tryEvaluate(request.op, request.a, request.b, result.value);
+    }
+}
+
+void evaluateBatch(const EvaluationRequest* requests, EvaluationResult* results, size_t count) {
+    evaluateBatch(defaultExecutor(), requests, results, count);
+}
+
+void evaluateBatch(ThreadPool& pool, const EvaluationRequest* requests, EvaluationResult* results, size_t count) {
+    CALC_TRACE_SCOPE("evaluateBatch");
+    pool.parallelFor(0, count, batchChunkSize(count, pool.size()), [=](size_t begin, size_t end) {
+        evaluateRange(requests, results, begin, end);
+    });
+}
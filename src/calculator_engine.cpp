@@ -0,0 +1,147 @@
+#include "calculator_engine.h"
+#include "calculator_math.h"
+#include "trace.h"
+#include "evaluation_control.h"
+#include "memo_cache.h"
+#include <stdexcept>
+
+/**
+ * @brief Вычисляет новое содержимое дисплея для кнопки вычисления
+ *
+ * @param expression Выражение на момент нажатия
+ * @param key Метка кнопки
+ * @param control Управление вычислением
+ * @param memo Кэш результатов или nullptr
+ * @return Новое содержимое дисплея ("Error" при ошибке)
+ * @throw EvaluationCancelled Если вычисление отменено
+ */
+static std::string evaluateKey(const std::string& expression, const std::string& key, EvaluationControl& control,
+    MemoCache* memo) {
+    if (key == "=") {
+        try {
+            size_t opPos = std::string::npos;
+            for (size_t i = 1; i < expression.size(); ++i) {
+                char c = expression[i];
+                if (c == '+' || c == '-' || c == '*' || c == '/' || c == '^') {
+                    if (c == '-') {
+                        continue;  
+                    }
+                    opPos = i;
+                    break;
+                }
+            }
+            if (opPos != std::string::npos) {
+                std::string left = expression.substr(0, opPos);
+                std::string right = expression.substr(opPos + 1);
+                char op = expression[opPos];
+                double a = std::stod(left);
+                double b = std::stod(right);
+                Operation parsed;
+                double result = memo && parseOperation(std::string(1, op), parsed)
+                    ? memo->evaluate(parsed, a, b) : applyBinaryOperation(a, std::string(1, op), b);
+                return std::to_string(result);
+            }
+            return expression;
+        }
+        catch (const std::exception& ex) {
+            return "Error";
+        }
+    }
+    else if (key == "x!") {
+        try {
+            double val = std::stod(expression);
+            double res = memo ? memo->factorial(val, control) : factorial(val, control);
+            return std::to_string(res);
+        }
+        catch (const EvaluationCancelled&) {
+            throw;
+        }
+        catch (const std::exception& ex) {
+            return "Error";
+        }
+    }
+    else if (key == "sin" || key == "cos" ||
+        key == "tan" || key == "cot") {
+        try {
+            double angle = std::stod(expression);
+            Operation parsed;
+            double res = memo && parseOperation(key, parsed)
+                ? memo->evaluate(parsed, angle) : applyTrigonometricOperation(angle, key);
+            return std::to_string(res);
+        }
+        catch (const std::exception& ex) {
+            return "Error";
+        }
+    }
+    else if (key.find("-cc") != std::string::npos) {
+        try {
+            size_t pos = key.find("-cc");
+            int targetBase = std::stoi(key.substr(0, pos));
+            return memo ? memo->convertBase(expression, 10, targetBase, &control)
+                : convertBase(expression, 10, targetBase, control);
+        }
+        catch (const EvaluationCancelled&) {
+            throw;
+        }
+        catch (const std::exception& ex) {
+            return "Error";
+        }
+    }
+    return expression;
+}
+
+bool CalculatorEngine::isEvaluationKey(const std::string& key) {
+    return key == "=" || key == "x!" || key == "sin" || key == "cos" || key == "tan" || key == "cot" ||
+        key.find("-cc") != std::string::npos;
+}
+
+CalculatorEngine::EvaluationJob CalculatorEngine::beginEvaluation(const std::string& key) {
+    if (expression_ == "Error")
+        expression_ = "";
+    std::string expression = expression_;
+    MemoCache* memo = memo_;
+    return [expression, key, memo](EvaluationControl& control) {
+        CALC_TRACE_SCOPE("CalculatorEngine evaluation");
+        return evaluateKey(expression, key, control, memo);
+    };
+}
+
+void CalculatorEngine::press(const std::string& key) {
+    CALC_TRACE_SCOPE("CalculatorEngine::press");
+    if (expression_ == "Error" && key != "C") {
+        expression_ = "";
+    }
+    if (key == "C") {
+        expression_ = "";
+    }
+    else if (isEvaluationKey(key)) {
+        EvaluationControl control;
+        completeEvaluation(beginEvaluation(key)(control));
+    }
+    else if (key == "±") {
+        if (expression_.empty()) {
+            expression_ = "-";
+        }
+        else {
+            if (expression_[0] == '-') {
+                expression_ = expression_.substr(1);
+            }
+            else {
+                expression_ = "-" + expression_;
+            }
+        }
+    }
+    else if (key == "+" || key == "-" || key == "*" || key == "/" || key == "^") {
+        std::string operators = "+-*/^";
+        if (expression_.empty() ||
+            operators.find(expression_.back()) != std::string::npos) {
+            expression_ = "Error";
+        }
+        else {
+            expression_ += key;
+        }
+    }
+    else {
+        expression_ += key;
+    }
+}
@@ -1,8 +1,11 @@
 #include "calculator_math.h"
+#include "trace.h"
+#include "evaluation_control.h"
 #include <stdexcept>
 #include <cmath>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 
 /**
  * @brief Округляет число до ближайшего целого, если оно очень близко к целому.
@@ -20,34 +23,201 @@ static double roundIfInteger(double value) {
     return value;
 }
 
-double applyBinaryOperation(double a, const std::string& op, double b) {
-    double result;
-    if (op == "+")
-        result = a + b;
-    else if (op == "-")
-        result = a - b;
-    else if (op == "*")
-        result = a * b;
-    else if (op == "/") {
+/**
+ * @brief Число итераций между проверками отмены в долгих циклах
+ */
+static const int kCheckpointInterval = 4096;
+
+/**
+ * @brief Общая реализация факториала с необязательным управлением вычислением
+ *
+ * После переполнения результат остаётся бесконечностью, поэтому цикл на этом завершается.
+ *
+ * @param x Входное число
+ * @param control Управление вычислением или nullptr (тогда функция не бросает исключений)
+ * @param result Факториал числа
+ * @return Код ошибки
+ */
+static MathError factorialKernel(double x, EvaluationControl* control, double& result) {
+    if (x < 0 || std::floor(x) != x)
+        return MathError::FactorialDomain;
+    result = 1;
+    for (double i = 1; i <= x && !std::isinf(result); i++) {
+        result *= i;
+        if (control && std::fmod(i, kCheckpointInterval) == 0)
+            control->checkpoint(static_cast<float>(i / x));
+    }
+    result = roundIfInteger(result);
+    return MathError::None;
+}
+
+/**
+ * @brief Реализация тригонометрических операций без исключений
+ *
+ * @param value Угол в градусах
+ * @param op Операция (Sin, Cos, Tan, Cot)
+ * @param result Результат вычисления
+ * @return Код ошибки
+ */
+static MathError trigonometricKernel(double value, Operation op, double& result) {
+    double rad = value * 3.14159265358979323846 / 180.0;
+    switch (op) {
+    case Operation::Sin:
+        result = std::sin(rad);
+        break;
+    case Operation::Cos:
+        result = std::cos(rad);
+        break;
+    case Operation::Tan:
+        if (std::fabs(std::cos(rad)) < 1e-6)
+            return MathError::TangentUndefined;
+        result = std::tan(rad);
+        break;
+    case Operation::Cot:
+        if (std::fabs(std::sin(rad)) < 1e-6)
+            return MathError::CotangentUndefined;
+        result = std::cos(rad) / std::sin(rad);
+        break;
+    default:
+        return MathError::IncorrectTrigonometricOperation;
+    }
+    result = roundIfInteger(result);
+    return MathError::None;
+}
+
+MathError tryEvaluate(Operation op, double a, double b, double& result) noexcept {
+    switch (op) {
+    case Operation::Add:
+        result = roundIfInteger(a + b);
+        return MathError::None;
+    case Operation::Subtract:
+        result = roundIfInteger(a - b);
+        return MathError::None;
+    case Operation::Multiply:
+        result = roundIfInteger(a * b);
+        return MathError::None;
+    case Operation::Divide:
         if (std::fabs(b) < 1e-6)
-            throw std::runtime_error("Division by zero");
-        result = a / b;
+            return MathError::DivisionByZero;
+        result = roundIfInteger(a / b);
+        return MathError::None;
+    case Operation::Power:
+        result = roundIfInteger(std::pow(a, b));
+        return MathError::None;
+    case Operation::Factorial:
+        return factorialKernel(a, nullptr, result);
+    case Operation::Sin:
+    case Operation::Cos:
+    case Operation::Tan:
+    case Operation::Cot:
+        return trigonometricKernel(a, op, result);
     }
-    else if (op == "^")
-        result = std::pow(a, b);
-    else
-        throw std::runtime_error("Incorrect operator");
-    return roundIfInteger(result);
+    return MathError::IncorrectOperator;
 }
 
-double factorial(double x) {
-    if (x < 0 || std::floor(x) != x)
-        throw std::runtime_error("The factorial is defined only for non-negative integers.");
-    double result = 1;
-    for (int i = 1; i <= static_cast<int>(x); i++) {
-        result *= i;
+void evaluateVector(Operation op, const double* a, const double* b, double* result, size_t count) noexcept {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    switch (op) {
+    case Operation::Add:
+        for (size_t i = 0; i < count; i++)
+            result[i] = roundIfInteger(a[i] + b[i]);
+        return;
+    case Operation::Subtract:
+        for (size_t i = 0; i < count; i++)
+            result[i] = roundIfInteger(a[i] - b[i]);
+        return;
+    case Operation::Multiply:
+        for (size_t i = 0; i < count; i++)
+            result[i] = roundIfInteger(a[i] * b[i]);
+        return;
+    case Operation::Divide:
+        for (size_t i = 0; i < count; i++)
+            result[i] = std::fabs(b[i]) < 1e-6 ? nan : roundIfInteger(a[i] / b[i]);
+        return;
+    default:
+        break;
+    }
+    for (size_t i = 0; i < count; i++) {
+        double value = 0.0;
+        result[i] = tryEvaluate(op, a[i], b ? b[i] : 0.0, value) == MathError::None ? value : nan;
+    }
+}
+
+const char* mathErrorMessage(MathError error) {
+    switch (error) {
+    case MathError::None:
+        return "";
+    case MathError::DivisionByZero:
+        return "Division by zero";
+    case MathError::IncorrectOperator:
+        return "Incorrect operator";
+    case MathError::FactorialDomain:
+        return "The factorial is defined only for non-negative integers.";
+    case MathError::TangentUndefined:
+        return "Tangent is not defined for this angle.";
+    case MathError::CotangentUndefined:
+        return "Cotangent is not defined for this angle.";
+    case MathError::IncorrectTrigonometricOperation:
+        return "Incorrect trigonometric operation";
+    }
+    return "Unknown error";
+}
+
+double evaluate(Operation op, double a, double b) {
+    CALC_TRACE_SCOPE("evaluate");
+    double result = 0.0;
+    MathError error = tryEvaluate(op, a, b, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
+}
+
+bool parseOperation(const std::string& name, Operation& op) {
+    static const struct {
+        const char* name;
+        Operation op;
+    } names[] = {
+        { "+", Operation::Add }, { "-", Operation::Subtract }, { "*", Operation::Multiply },
+        { "/", Operation::Divide }, { "^", Operation::Power }, { "!", Operation::Factorial },
+        { "sin", Operation::Sin }, { "cos", Operation::Cos }, { "tan", Operation::Tan }, { "cot", Operation::Cot }
+    };
+    for (const auto& entry : names) {
+        if (name == entry.name) {
+            op = entry.op;
+            return true;
+        }
     }
-    return roundIfInteger(result);
+    return false;
+}
+
+double applyBinaryOperation(double a, const std::string& op, double b) {
+    CALC_TRACE_SCOPE("applyBinaryOperation");
+    Operation parsed;
+    if (!parseOperation(op, parsed) || parsed > Operation::Power)
+        throw std::runtime_error(mathErrorMessage(MathError::IncorrectOperator));
+    double result = 0.0;
+    MathError error = tryEvaluate(parsed, a, b, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
+}
+
+double factorial(double x) {
+    CALC_TRACE_SCOPE("factorial");
+    double result = 0.0;
+    MathError error = factorialKernel(x, nullptr, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
+}
+
+double factorial(double x, EvaluationControl& control) {
+    CALC_TRACE_SCOPE("factorial");
+    double result = 0.0;
+    MathError error = factorialKernel(x, &control, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
 }
 
 /**
@@ -72,7 +242,16 @@ static int charToVal(char c) {
     throw std::runtime_error("Incorrect digit in number");
 }
 
-std::string convertBase(const std::string& numberStr, int fromBase, int toBase) {
+/**
+ * @brief Общая реализация конвертации систем счисления с необязательным управлением вычислением
+ *
+ * @param numberStr Строковое представление числа
+ * @param fromBase Исходная система счисления
+ * @param toBase Целевая система счисления
+ * @param control Управление вычислением или nullptr
+ * @return Строковое представление числа в новой системе
+ */
+static std::string convertBaseImpl(const std::string& numberStr, int fromBase, int toBase, EvaluationControl* control) {
     if (fromBase < 2 || fromBase > 16 || toBase < 2 || toBase > 16)
         throw std::runtime_error("The base of the system should be from 2 to 16");
     bool isNegative = false;
@@ -87,6 +266,8 @@ std::string convertBase(const std::string& numberStr, int fromBase, int toBase)
         if (digit >= fromBase)
             throw std::runtime_error("The number does not correspond to the base of the system");
         num = num * fromBase + digit;
+        if (control && index % kCheckpointInterval == 0)
+            control->checkpoint(static_cast<float>(index) / numberStr.size());
     }
     if (isNegative)
         num = -num;
@@ -107,27 +288,24 @@ std::string convertBase(const std::string& numberStr, int fromBase, int toBase)
     return result;
 }
 
+std::string convertBase(const std::string& numberStr, int fromBase, int toBase) {
+    CALC_TRACE_SCOPE("convertBase");
+    return convertBaseImpl(numberStr, fromBase, toBase, nullptr);
+}
+
+std::string convertBase(const std::string& numberStr, int fromBase, int toBase, EvaluationControl& control) {
+    CALC_TRACE_SCOPE("convertBase");
+    return convertBaseImpl(numberStr, fromBase, toBase, &control);
+}
+
 double applyTrigonometricOperation(double value, const std::string& op) {
-    double rad = value * 3.14159265358979323846 / 180.0;
-    double result;
-    if (op == "sin") {
-        result = std::sin(rad);
-    }
-    else if (op == "cos") {
-        result = std::cos(rad);
-    }
-    else if (op == "tan") {
-        if (std::fabs(std::cos(rad)) < 1e-6)
-            throw std::runtime_error("Tangent is not defined for this angle.");
-        result = std::tan(rad);
-    }
-    else if (op == "cot") {
-        if (std::fabs(std::sin(rad)) < 1e-6)
-            throw std::runtime_error("Cotangent is not defined for this angle.");
-        result = std::cos(rad) / std::sin(rad);
-    }
-    else {
-        throw std::runtime_error("Incorrect trigonometric operation");
-    }
-    return roundIfInteger(result);
+    CALC_TRACE_SCOPE("applyTrigonometricOperation");
+    Operation parsed;
+    if (!parseOperation(op, parsed) || parsed < Operation::Sin)
+        throw std::runtime_error(mathErrorMessage(MathError::IncorrectTrigonometricOperation));
+    double result = 0.0;
+    MathError error = trigonometricKernel(value, parsed, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
 }
@@ -0,0 +1,110 @@
+#include "coverage_rasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+CoverageRasterizer::CoverageRasterizer(int width, int height)
+    : width_(width), height_(height), stride_(width + 2),
+      accumulation_(static_cast<size_t>(width + 2) * height + 2, 0.0f) {
+}
+
+void CoverageRasterizer::addLine(float x0, float y0, float x1, float y1) {
+    if (y0 == y1)
+        return;
+    float maxX = static_cast<float>(width_);
+    // Отрезок, пересекающий левый или правый край, делится: внешняя часть прижимается к краю вертикально
+    for (float edge : { 0.0f, maxX }) {
+        if ((x0 < edge && x1 > edge) || (x0 > edge && x1 < edge)) {
+            float y = y0 + (edge - x0) / (x1 - x0) * (y1 - y0);
+            addLine(x0, y0, edge, y);
+            addLine(edge, y, x1, y1);
+            return;
+        }
+    }
+    float dir = 1.0f;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.0f;
+    }
+    x0 = std::min(std::max(x0, 0.0f), maxX);
+    x1 = std::min(std::max(x1, 0.0f), maxX);
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    if (y0 < 0.0f)
+        x -= y0 * dxdy;
+    int yStart = std::max(0, static_cast<int>(y0));
+    int yEnd = std::min(height_, static_cast<int>(std::ceil(y1)));
+    for (int y = yStart; y < yEnd; y++) {
+        float* row = accumulation_.data() + static_cast<size_t>(y) * stride_;
+        float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+        float xNext = x + dxdy * dy;
+        float d = dy * dir;
+        float left = std::min(x, xNext);
+        float right = std::max(x, xNext);
+        float leftFloor = std::floor(left);
+        int leftIndex = static_cast<int>(leftFloor);
+        float rightCeil = std::ceil(right);
+        int rightIndex = static_cast<int>(rightCeil);
+        if (rightIndex <= leftIndex + 1) {
+            // Отрезок не выходит за пределы одного пикселя строки
+            float middle = 0.5f * (x + xNext) - leftFloor;
+            row[leftIndex] += d - d * middle;
+            row[leftIndex + 1] += d * middle;
+        }
+        else {
+            float inverseWidth = 1.0f / (right - left);
+            float leftFraction = left - leftFloor;
+            float firstArea = 0.5f * inverseWidth * (1.0f - leftFraction) * (1.0f - leftFraction);
+            float rightFraction = right - rightCeil + 1.0f;
+            float lastArea = 0.5f * inverseWidth * rightFraction * rightFraction;
+            row[leftIndex] += d * firstArea;
+            if (rightIndex == leftIndex + 2) {
+                row[leftIndex + 1] += d * (1.0f - firstArea - lastArea);
+            }
+            else {
+                float secondArea = inverseWidth * (1.5f - leftFraction);
+                row[leftIndex + 1] += d * (secondArea - firstArea);
+                for (int xi = leftIndex + 2; xi < rightIndex - 1; xi++)
+                    row[xi] += d * inverseWidth;
+                float beforeLast = secondArea + (rightIndex - leftIndex - 3) * inverseWidth;
+                row[rightIndex - 1] += d * (1.0f - beforeLast - lastArea);
+            }
+            row[rightIndex] += d * lastArea;
+        }
+        x = xNext;
+    }
+}
+
+void CoverageRasterizer::clear() {
+    std::fill(accumulation_.begin(), accumulation_.end(), 0.0f);
+}
+
+void CoverageRasterizer::addQuadratic(float x0, float y0, float cx, float cy, float x1, float y1) {
+    float ddx = x0 - 2.0f * cx + x1;
+    float ddy = y0 - 2.0f * cy + y1;
+    float deviation = std::sqrt(ddx * ddx + ddy * ddy);
+    int segments = std::max(1, static_cast<int>(std::ceil(std::sqrt(deviation * 2.0f))));
+    float px = x0;
+    float py = y0;
+    for (int i = 1; i <= segments; i++) {
+        float t = static_cast<float>(i) / segments;
+        float u = 1.0f - t;
+        float nx = u * u * x0 + 2.0f * u * t * cx + t * t * x1;
+        float ny = u * u * y0 + 2.0f * u * t * cy + t * t * y1;
+        addLine(px, py, nx, ny);
+        px = nx;
+        py = ny;
+    }
+}
+
+void CoverageRasterizer::resolve(uint8_t* out) const {
+    for (int y = 0; y < height_; y++) {
+        const float* row = accumulation_.data() + static_cast<size_t>(y) * stride_;
+        float sum = 0.0f;
+        for (int x = 0; x < width_; x++) {
+            sum += row[x];
+            float coverage = std::min(std::fabs(sum), 1.0f);
+            out[static_cast<size_t>(y) * width_ + x] = static_cast<uint8_t>(coverage * 255.0f + 0.5f);
+        }
+    }
+}
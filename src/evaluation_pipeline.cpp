@@ -0,0 +1,215 @@
+#include "evaluation_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "expression.h"
+#include "line_evaluator.h"
+#include "spsc_ring.h"
+
+/**
+ * @brief Пакет строк, проходящий через все стадии; буферы переиспользуются между оборотами
+ */
+struct PipelineBatch {
+    std::string text;                       ///< Целые строки ввода
+    std::vector<std::string_view> lines;    ///< Строки в text
+    std::vector<Expression> programs;       ///< Разобранные выражения строк
+    std::vector<double> values;             ///< Результаты
+    std::vector<std::string> errors;        ///< Сообщения об ошибках (пустые, если ошибки нет)
+    std::string output;                     ///< Отформатированные результаты
+    uint64_t errorCount = 0;
+    std::chrono::steady_clock::time_point readTime;
+};
+
+/**
+ * @brief Очереди одной цепочки: вход разбора, вычисления, форматирования и выход к записи
+ */
+struct PipelineLane {
+    explicit PipelineLane(size_t capacity) : parse(capacity), evaluate(capacity), format(capacity), write(capacity) {}
+
+    SpscRing<PipelineBatch*> parse;
+    SpscRing<PipelineBatch*> evaluate;
+    SpscRing<PipelineBatch*> format;
+    SpscRing<PipelineBatch*> write;
+};
+
+static const std::vector<std::string> kNoVariables;
+
+static bool isBlank(std::string_view line) {
+    return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+static void parseBatch(PipelineBatch& batch) {
+    batch.lines.clear();
+    std::string_view text(batch.text);
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        std::string_view line = text.substr(0, newline);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        batch.lines.push_back(line);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+    }
+    size_t count = batch.lines.size();
+    if (batch.programs.size() < count)
+        batch.programs.resize(count);
+    if (batch.errors.size() < count)
+        batch.errors.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        batch.errors[i].clear();
+        if (isBlank(batch.lines[i]))
+            continue;
+        try {
+            batch.programs[i].compile(batch.lines[i], kNoVariables);
+        }
+        catch (const std::runtime_error& ex) {
+            batch.errors[i] = ex.what();
+        }
+    }
+}
+
+static void evaluateBatch(PipelineBatch& batch) {
+    size_t count = batch.lines.size();
+    batch.values.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!batch.errors[i].empty() || isBlank(batch.lines[i]))
+            continue;
+        MathError error = batch.programs[i].evaluate(nullptr, batch.values[i]);
+        if (error != MathError::None)
+            batch.errors[i] = mathErrorMessage(error);
+    }
+}
+
+/**
+ * @brief Форматирует результаты так же, как LineEvaluator::evaluateLine
+ */
+static void formatBatch(PipelineBatch& batch) {
+    batch.output.clear();
+    batch.errorCount = 0;
+    char buffer[kNumberBufferSize];
+    for (size_t i = 0; i < batch.lines.size(); i++) {
+        if (!batch.errors[i].empty()) {
+            batch.output.append("error: ");
+            batch.output.append(batch.errors[i]);
+            batch.errorCount++;
+        }
+        else if (!isBlank(batch.lines[i]))
+            batch.output.append(buffer, formatNumber(batch.values[i], buffer));
+        batch.output.push_back('\n');
+    }
+}
+
+PipelineStats runEvaluationPipeline(std::FILE* in, std::FILE* out, const PipelineOptions& options) {
+    size_t lanes = options.lanes != 0 ? options.lanes : std::max<size_t>(1, std::thread::hardware_concurrency() / 3);
+    size_t perLane = std::max<size_t>(options.batchesPerLane, 1);
+    size_t batchBytes = std::max<size_t>(options.batchBytes, 64);
+    size_t total = lanes * perLane;
+    // Ёмкость каждой очереди вмещает все пакеты, поэтому ждать приходится только свободного пакета
+    std::vector<std::unique_ptr<PipelineLane>> lanesRings;
+    for (size_t l = 0; l < lanes; l++)
+        lanesRings.push_back(std::make_unique<PipelineLane>(total));
+    SpscRing<PipelineBatch*> free(total);
+    std::vector<std::unique_ptr<PipelineBatch>> batches;
+    for (size_t b = 0; b < total; b++) {
+        batches.push_back(std::make_unique<PipelineBatch>());
+        batches.back()->text.reserve(batchBytes * 2);
+        free.push(batches.back().get());
+    }
+
+    // Чтение: пакеты из целых строк по кругу в цепочки; nullptr в каждой цепочке — конец ввода
+    std::thread reader([&]() {
+        std::string carry;
+        size_t lane = 0;
+        bool eof = false;
+        while (!eof) {
+            PipelineBatch* batch = free.pop();
+            batch->text.swap(carry);
+            carry.clear();
+            for (;;) {
+                size_t size = batch->text.size();
+                batch->text.resize(size + batchBytes);
+                size_t read = readAvailable(in, &batch->text[size], batchBytes);
+                batch->text.resize(size + read);
+                if (read == 0) {
+                    eof = true;
+                    break;
+                }
+                size_t last = batch->text.rfind('\n');
+                if (last != std::string::npos) {
+                    carry.assign(batch->text, last + 1, std::string::npos);
+                    batch->text.resize(last + 1);
+                    break;
+                }
+            }
+            if (batch->text.empty()) {
+                free.push(batch);
+                continue;
+            }
+            batch->readTime = std::chrono::steady_clock::now();
+            lanesRings[lane]->parse.push(batch);
+            lane = (lane + 1) % lanes;
+        }
+        for (size_t l = 0; l < lanes; l++)
+            lanesRings[(lane + l) % lanes]->parse.push(nullptr);
+    });
+
+    auto stage = [](SpscRing<PipelineBatch*>& input, SpscRing<PipelineBatch*>& output, void (*work)(PipelineBatch&)) {
+        return std::thread([&input, &output, work]() {
+            for (;;) {
+                PipelineBatch* batch = input.pop();
+                if (batch != nullptr)
+                    work(*batch);
+                output.push(batch);
+                if (batch == nullptr)
+                    return;
+            }
+        });
+    };
+    std::vector<std::thread> workers;
+    for (auto& lane : lanesRings) {
+        workers.push_back(stage(lane->parse, lane->evaluate, parseBatch));
+        workers.push_back(stage(lane->evaluate, lane->format, evaluateBatch));
+        workers.push_back(stage(lane->format, lane->write, formatBatch));
+    }
+
+    // Запись в вызывающем потоке: цепочки опрашиваются в том же порядке, в каком их заполняло чтение
+    PipelineStats stats;
+    bool failed = false;
+    double latencySum = 0.0;
+    for (size_t lane = 0;; lane = (lane + 1) % lanes) {
+        SpscRing<PipelineBatch*>& ring = lanesRings[lane]->write;
+        PipelineBatch* batch;
+        if (!ring.tryPop(batch)) {
+            // Следующий пакет ещё не готов: уже записанное выводится, чтобы задержка не росла
+            if (std::fflush(out) != 0)
+                failed = true;
+            batch = ring.pop();
+        }
+        if (batch == nullptr)
+            break;
+        if (!failed && std::fwrite(batch->output.data(), 1, batch->output.size(), out) != batch->output.size())
+            failed = true;
+        double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batch->readTime).count();
+        latencySum += latency;
+        stats.maxLatencyMs = std::max(stats.maxLatencyMs, latency);
+        stats.lines += batch->lines.size();
+        stats.errors += batch->errorCount;
+        stats.batches++;
+        free.push(batch);
+    }
+    reader.join();
+    for (auto& worker : workers)
+        worker.join();
+    if (std::fflush(out) != 0)
+        failed = true;
+    if (failed)
+        throw std::runtime_error("Cannot write results");
+    if (stats.batches > 0)
+        stats.meanLatencyMs = latencySum / stats.batches;
+    return stats;
+}
@@ -0,0 +1,385 @@
+#include "expression.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Число точек, обрабатываемых одной инструкцией при пакетном вычислении
+ */
+static const size_t kBatchBlock = 256;
+
+/**
+ * @brief Разбор выражения методом рекурсивного спуска с генерацией обратной польской записи
+ */
+class ExpressionParser {
+public:
+    ExpressionParser(std::string_view text, const std::vector<std::string>& variables, Expression& out)
+        : text_(text), variables_(variables), out_(out) {}
+
+    void run() {
+        parseSum();
+        skipSpaces();
+        if (pos_ < text_.size())
+            fail(std::string("Unexpected character '") + text_[pos_] + "'");
+        if (out_.program_.empty())
+            fail("Empty expression");
+    }
+
+private:
+    using Instruction = Expression::Instruction;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(message + " at position " + std::to_string(pos_ + 1));
+    }
+
+    void skipSpaces() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+            pos_++;
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Начинается ли в текущей позиции операнд (для неявного умножения)
+     */
+    bool atOperand() {
+        skipSpaces();
+        if (pos_ >= text_.size())
+            return false;
+        char c = text_[pos_];
+        return std::isdigit(static_cast<unsigned char>(c)) || c == '.' || c == '(' ||
+            std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    void push(size_t delta) {
+        depth_ += delta;
+        if (depth_ > Expression::kMaxStackDepth)
+            fail("Expression is too deeply nested");
+        out_.stackDepth_ = std::max(out_.stackDepth_, depth_);
+    }
+
+    void emitConstant(double value) {
+        push(1);
+        out_.program_.push_back({ Instruction::Constant, Operation::Add, value, 0 });
+    }
+
+    /**
+     * @brief Добавляет унарную операцию, вычисляя её сразу над константой
+     *
+     * Операция с ошибкой не сворачивается, чтобы код ошибки вернуло вычисление.
+     */
+    void emitUnary(Instruction::Kind kind, Operation op) {
+        auto& program = out_.program_;
+        if (program.back().kind == Instruction::Constant) {
+            double& value = program.back().value;
+            double result = -value;
+            if (kind == Instruction::Negate || tryEvaluate(op, value, 0.0, result) == MathError::None) {
+                value = result;
+                return;
+            }
+        }
+        program.push_back({ kind, op, 0.0, 0 });
+    }
+
+    /**
+     * @brief Добавляет бинарную операцию, вычисляя её сразу над двумя константами
+     */
+    void emitBinary(Operation op) {
+        auto& program = out_.program_;
+        depth_--;
+        size_t n = program.size();
+        double result = 0.0;
+        if (program[n - 1].kind == Instruction::Constant && program[n - 2].kind == Instruction::Constant &&
+            tryEvaluate(op, program[n - 2].value, program[n - 1].value, result) == MathError::None) {
+            program.pop_back();
+            program.back().value = result;
+            return;
+        }
+        program.push_back({ Instruction::Binary, op, 0.0, 0 });
+    }
+
+    void parseSum() {
+        parseProduct();
+        for (;;) {
+            if (accept('+')) {
+                parseProduct();
+                emitBinary(Operation::Add);
+            }
+            else if (accept('-')) {
+                parseProduct();
+                emitBinary(Operation::Subtract);
+            }
+            else
+                return;
+        }
+    }
+
+    void parseProduct() {
+        parseUnary();
+        for (;;) {
+            if (accept('*')) {
+                parseUnary();
+                emitBinary(Operation::Multiply);
+            }
+            else if (accept('/')) {
+                parseUnary();
+                emitBinary(Operation::Divide);
+            }
+            else if (atOperand()) {
+                parsePower();
+                emitBinary(Operation::Multiply);
+            }
+            else
+                return;
+        }
+    }
+
+    void parseUnary() {
+        if (accept('-')) {
+            parseUnary();
+            emitUnary(Instruction::Negate, Operation::Subtract);
+        }
+        else if (accept('+'))
+            parseUnary();
+        else
+            parsePower();
+    }
+
+    void parsePower() {
+        parsePostfix();
+        if (accept('^')) {
+            parseUnary();
+            emitBinary(Operation::Power);
+        }
+    }
+
+    void parsePostfix() {
+        parsePrimary();
+        while (accept('!'))
+            emitUnary(Instruction::Unary, Operation::Factorial);
+    }
+
+    void parsePrimary() {
+        skipSpaces();
+        if (pos_ >= text_.size())
+            fail("Unexpected end of expression");
+        char c = text_[pos_];
+        if (accept('(')) {
+            parseSum();
+            if (!accept(')'))
+                fail("Missing closing parenthesis");
+            return;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            // from_chars не требует завершающего нуля, поэтому строку можно разбирать прямо в буфере ввода
+            const char* begin = text_.data() + pos_;
+            double value = 0.0;
+            auto parsed = std::from_chars(begin, text_.data() + text_.size(), value);
+            if (parsed.ec == std::errc::invalid_argument)
+                fail("Invalid number");
+            bool hex = c == '0' && pos_ + 1 < text_.size() && (text_[pos_ + 1] == 'x' || text_[pos_ + 1] == 'X');
+            if (hex || parsed.ec == std::errc::result_out_of_range) {
+                // Шестнадцатеричные числа и переполнение (бесконечность, как раньше) разбирает strtod
+                std::string digits(text_.substr(pos_, hex ? std::string_view::npos : static_cast<size_t>(parsed.ptr - begin)));
+                char* end = nullptr;
+                value = std::strtod(digits.c_str(), &end);
+                parsed.ptr = begin + (end - digits.c_str());
+            }
+            pos_ += parsed.ptr - begin;
+            emitConstant(value);
+            return;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = pos_;
+            while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_'))
+                pos_++;
+            std::string name(text_.substr(start, pos_ - start));
+            for (size_t i = 0; i < variables_.size(); i++) {
+                if (name == variables_[i]) {
+                    push(1);
+                    out_.program_.push_back({ Instruction::Variable, Operation::Add, 0.0, i });
+                    return;
+                }
+            }
+            Operation op;
+            if (parseOperation(name, op) && op >= Operation::Sin) {
+                parseUnaryOperand();
+                emitUnary(Instruction::Unary, op);
+                return;
+            }
+            if (name == "pi") {
+                emitConstant(3.14159265358979323846);
+                return;
+            }
+            pos_ = start;
+            fail("Unknown identifier '" + name + "'");
+        }
+        fail(std::string("Unexpected character '") + c + "'");
+    }
+
+    /**
+     * @brief Операнд функции: унарный минус, степень и факториал, но не умножение
+     */
+    void parseUnaryOperand() {
+        if (accept('-')) {
+            parseUnaryOperand();
+            emitUnary(Instruction::Negate, Operation::Subtract);
+        }
+        else
+            parsePower();
+    }
+
+    std::string_view text_;
+    const std::vector<std::string>& variables_;
+    Expression& out_;
+    size_t pos_ = 0;
+    size_t depth_ = 0;
+};
+
+Expression Expression::parse(const std::string& text, const std::vector<std::string>& variables) {
+    CALC_TRACE_SCOPE("Expression::parse");
+    Expression expression;
+    expression.compile(text, variables);
+    return expression;
+}
+
+void Expression::compile(std::string_view text, const std::vector<std::string>& variables) {
+    text_.assign(text.data(), text.size());
+    program_.clear();
+    stackDepth_ = 0;
+    variableCount_ = variables.size();
+    try {
+        ExpressionParser(text_, variables, *this).run();
+    }
+    catch (...) {
+        program_.clear();
+        throw;
+    }
+}
+
+MathError Expression::evaluate(const double* variables, double& result) const noexcept {
+    double stack[kMaxStackDepth];
+    size_t top = 0;
+    for (const auto& instruction : program_) {
+        switch (instruction.kind) {
+        case Instruction::Constant:
+            stack[top++] = instruction.value;
+            break;
+        case Instruction::Variable:
+            stack[top++] = variables[instruction.index];
+            break;
+        case Instruction::Negate:
+            stack[top - 1] = -stack[top - 1];
+            break;
+        case Instruction::Unary: {
+            MathError error = tryEvaluate(instruction.op, stack[top - 1], 0.0, stack[top - 1]);
+            if (error != MathError::None)
+                return error;
+            break;
+        }
+        case Instruction::Binary: {
+            top--;
+            MathError error = tryEvaluate(instruction.op, stack[top - 1], stack[top], stack[top - 1]);
+            if (error != MathError::None)
+                return error;
+            break;
+        }
+        }
+    }
+    result = stack[0];
+    return MathError::None;
+}
+
+Interval Expression::evaluateInterval(const Interval* variables) const noexcept {
+    Interval stack[kMaxStackDepth];
+    size_t top = 0;
+    for (const auto& instruction : program_) {
+        switch (instruction.kind) {
+        case Instruction::Constant:
+            stack[top++] = Interval::point(instruction.value);
+            break;
+        case Instruction::Variable:
+            stack[top++] = variables[instruction.index];
+            break;
+        case Instruction::Negate:
+            stack[top - 1] = { -stack[top - 1].hi, -stack[top - 1].lo, stack[top - 1].partial };
+            break;
+        case Instruction::Unary:
+            stack[top - 1] = ::evaluateInterval(instruction.op, stack[top - 1]);
+            break;
+        case Instruction::Binary:
+            top--;
+            stack[top - 1] = ::evaluateInterval(instruction.op, stack[top - 1], stack[top]);
+            break;
+        }
+        if (stack[top - 1].isEmpty())
+            return Interval::empty();
+    }
+    return stack[0];
+}
+
+double Expression::operator()(double x) const noexcept {
+    double result = 0.0;
+    if (evaluate(&x, result) != MathError::None)
+        return std::numeric_limits<double>::quiet_NaN();
+    return result;
+}
+
+void Expression::evaluateBatch(const double* const* variables, double* result, size_t count) const {
+    std::vector<double> stack(isConstant() ? 0 : batchScratchSize());
+    evaluateBatch(variables, result, count, stack.data());
+}
+
+size_t Expression::batchScratchSize() const {
+    return stackDepth_ * kBatchBlock;
+}
+
+void Expression::evaluateBatch(const double* const* variables, double* result, size_t count, double* stack) const noexcept {
+    CALC_TRACE_SCOPE("Expression::evaluateBatch");
+    if (isConstant()) {
+        std::fill(result, result + count, program_[0].value);
+        return;
+    }
+    for (size_t begin = 0; begin < count; begin += kBatchBlock) {
+        size_t n = std::min(kBatchBlock, count - begin);
+        size_t top = 0;
+        for (const auto& instruction : program_) {
+            double* next = stack + top * kBatchBlock;
+            double* last = next - kBatchBlock;
+            switch (instruction.kind) {
+            case Instruction::Constant:
+                std::fill(next, next + n, instruction.value);
+                top++;
+                break;
+            case Instruction::Variable:
+                std::copy(variables[instruction.index] + begin, variables[instruction.index] + begin + n, next);
+                top++;
+                break;
+            case Instruction::Negate:
+                for (size_t i = 0; i < n; i++)
+                    last[i] = -last[i];
+                break;
+            case Instruction::Unary:
+                evaluateVector(instruction.op, last, nullptr, last, n);
+                break;
+            case Instruction::Binary:
+                evaluateVector(instruction.op, last - kBatchBlock, last, last - kBatchBlock, n);
+                top--;
+                break;
+            }
+        }
+        std::copy(stack, stack + n, result + begin);
+    }
+}
@@ -0,0 +1,231 @@
+#include "heatmap_tiles.h"
+#include "grid_index.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Наименьший и наибольший уровень (сторона ячейки от 2^-60 до 2^60)
+ */
+static const int kMinLevel = -60;
+static const int kMaxLevel = 60;
+
+/**
+ * @brief Наименьшая ёмкость кэша
+ */
+static const size_t kMinTiles = 16;
+
+/**
+ * @brief Наибольший модуль номера плитки: номер, умноженный на kTileSize, не переполняет int64_t
+ */
+static const double kMaxTileIndex = 18014398509481984.0;  // 2^54
+
+/**
+ * @brief Наибольшее число плиток области
+ *
+ * Плитка на экране не уже kTileSize / √2 пикселей, поэтому столько плиток бывает
+ * только на крайнем уровне, когда область во много раз шире сетки.
+ */
+static const double kMaxVisibleTiles = 65536.0;
+
+HeatmapTileCache::HeatmapTileCache(Expression function, size_t maxTiles)
+    : function_(std::move(function)), maxTiles_(std::max(maxTiles, kMinTiles)) {
+}
+
+int HeatmapTileCache::levelFor(const PlotViewport& viewport) {
+    double pixelWidth = (viewport.xMax - viewport.xMin) / std::max(viewport.width, 1);
+    if (!(pixelWidth > 0.0))
+        return kMinLevel;
+    int level = static_cast<int>(std::lround(std::log2(pixelWidth)));
+    return std::min(kMaxLevel, std::max(kMinLevel, level));
+}
+
+size_t HeatmapTileCache::capacityFor(const PlotViewport& viewport) {
+    int width = std::max(viewport.width, 1);
+    int height = std::max(viewport.height, 1);
+    double pixelWidth = (viewport.xMax - viewport.xMin) / width;
+    double pixelHeight = (viewport.yMax - viewport.yMin) / height;
+    if (!(pixelWidth > 0.0) || !(pixelHeight > 0.0))
+        return kMinTiles;
+    // levelFor округляет ширину пикселя до степени двойки, поэтому плитка на экране не уже kTileSize / √2 пикселей;
+    // уже она бывает только на крайних уровнях, и тогда берётся её настоящая ширина
+    double span = std::ldexp(static_cast<double>(kTileSize), levelFor(viewport));
+    double scale = std::min(1.0, kTileSize / std::sqrt(2.0) / (span / pixelWidth));
+    double tileWidth = span / pixelWidth * scale;
+    double tileHeight = span / pixelHeight * scale;
+    size_t columns = static_cast<size_t>(std::min(std::ceil(width / tileWidth), kMaxVisibleTiles)) + 1;
+    size_t rows = static_cast<size_t>(std::min(std::ceil(height / tileHeight), kMaxVisibleTiles)) + 1;
+    return std::max(kMinTiles, 2 * columns * rows);
+}
+
+void HeatmapTileCache::visibleTiles(const PlotViewport& viewport, std::vector<HeatmapTileKey>& keys) {
+    keys.clear();
+    int level = levelFor(viewport);
+    double span = std::ldexp(static_cast<double>(kTileSize), level);
+    int64_t firstX;
+    int64_t lastX;
+    int64_t firstY;
+    int64_t lastY;
+    if (!toGridIndex(std::floor(viewport.xMin / span), kMaxTileIndex, firstX) ||
+        !toGridIndex(std::ceil(viewport.xMax / span) - 1.0, kMaxTileIndex, lastX) ||
+        !toGridIndex(std::floor(viewport.yMin / span), kMaxTileIndex, firstY) ||
+        !toGridIndex(std::ceil(viewport.yMax / span) - 1.0, kMaxTileIndex, lastY))
+        return;
+    if (static_cast<double>(lastX - firstX + 1) * static_cast<double>(lastY - firstY + 1) > kMaxVisibleTiles)
+        return;
+    for (int64_t ty = lastY; ty >= firstY; ty--) {
+        for (int64_t tx = firstX; tx <= lastX; tx++)
+            keys.push_back({ level, tx, ty });
+    }
+}
+
+void HeatmapTileCache::tileBounds(const HeatmapTileKey& key, double& xMin, double& xMax, double& yMin, double& yMax) {
+    double span = std::ldexp(static_cast<double>(kTileSize), key.level);
+    xMin = key.tx * span;
+    xMax = (key.tx + 1) * span;
+    yMin = key.ty * span;
+    yMax = (key.ty + 1) * span;
+}
+
+std::shared_ptr<const HeatmapTile> HeatmapTileCache::find(const HeatmapTileKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tiles_.find(key);
+    if (it == tiles_.end())
+        return nullptr;
+    it->second.lastUse = ++useClock_;
+    return it->second.tile;
+}
+
+std::shared_ptr<const HeatmapTile> HeatmapTileCache::buildTile(const HeatmapTileKey& key) {
+    CALC_TRACE_SCOPE("HeatmapTileCache::buildTile");
+    const size_t count = static_cast<size_t>(kTileSize) * kTileSize;
+    double step = std::ldexp(1.0, key.level);
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (int j = 0; j < kTileSize; j++) {
+        double y = (static_cast<double>((key.ty + 1) * kTileSize - j) - 0.5) * step;
+        for (int i = 0; i < kTileSize; i++) {
+            xs[static_cast<size_t>(j) * kTileSize + i] = (static_cast<double>(key.tx * kTileSize + i) + 0.5) * step;
+            ys[static_cast<size_t>(j) * kTileSize + i] = y;
+        }
+    }
+    std::vector<double> results(count);
+    const double* variables[] = { xs.data(), ys.data() };
+    function_.evaluateBatch(variables, results.data(), count);
+
+    auto tile = std::make_shared<HeatmapTile>();
+    tile->key = key;
+    tile->values.resize(count);
+    tile->low = std::numeric_limits<float>::quiet_NaN();
+    tile->high = std::numeric_limits<float>::quiet_NaN();
+    for (size_t k = 0; k < count; k++) {
+        float value = static_cast<float>(results[k]);
+        tile->values[k] = value;
+        if (!std::isfinite(value))
+            continue;
+        if (!(value >= tile->low))
+            tile->low = value;
+        if (!(value <= tile->high))
+            tile->high = value;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tiles_[key] = { tile, ++useClock_ };
+    stats_.tileMisses++;
+    stats_.evaluations += count;
+    evictLocked();
+    return tile;
+}
+
+size_t HeatmapTileCache::update(const PlotViewport& viewport, std::vector<std::shared_ptr<const HeatmapTile>>& tiles,
+    ThreadPool* pool) {
+    CALC_TRACE_SCOPE("HeatmapTileCache::update");
+    std::vector<HeatmapTileKey> keys;
+    visibleTiles(viewport, keys);
+    tiles.assign(keys.size(), nullptr);
+    std::vector<size_t> missing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t use = ++useClock_;
+        for (size_t k = 0; k < keys.size(); k++) {
+            auto it = tiles_.find(keys[k]);
+            if (it == tiles_.end()) {
+                missing.push_back(k);
+                continue;
+            }
+            it->second.lastUse = use;
+            tiles[k] = it->second.tile;
+            stats_.tileHits++;
+        }
+    }
+    auto build = [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; m++)
+            tiles[missing[m]] = buildTile(keys[missing[m]]);
+    };
+    if (pool && missing.size() > 1)
+        pool->parallelFor(0, missing.size(), 1, build);
+    else
+        build(0, missing.size());
+    return missing.size();
+}
+
+void HeatmapTileCache::evictLocked() {
+    if (tiles_.size() <= maxTiles_)
+        return;
+    std::vector<uint64_t> uses;
+    uses.reserve(tiles_.size());
+    for (const auto& entry : tiles_)
+        uses.push_back(entry.second.lastUse);
+    size_t evict = tiles_.size() - maxTiles_ * 3 / 4;
+    std::nth_element(uses.begin(), uses.begin() + (evict - 1), uses.end());
+    uint64_t cutoff = uses[evict - 1];
+    for (auto it = tiles_.begin(); it != tiles_.end();) {
+        if (it->second.lastUse <= cutoff)
+            it = tiles_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void HeatmapTileCache::setMaxTiles(size_t maxTiles) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxTiles_ = std::max(maxTiles, kMinTiles);
+    evictLocked();
+}
+
+HeatmapCacheStats HeatmapTileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t HeatmapTileCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tiles_.size();
+}
+
+void HeatmapTileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tiles_.clear();
+}
+
+void colorizeHeatmap(const float* values, size_t count, float low, float high, uint8_t* rgba) {
+    // Опорные цвета палитры, близкой к viridis
+    static const uint8_t kStops[5][3] = {
+        { 68, 1, 84 }, { 59, 82, 139 }, { 33, 145, 140 }, { 94, 201, 98 }, { 253, 231, 37 }
+    };
+    float scale = high > low ? 4.0f / (high - low) : 0.0f;
+    for (size_t k = 0; k < count; k++) {
+        uint8_t* pixel = rgba + 4 * k;
+        if (!std::isfinite(values[k])) {
+            pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+            continue;
+        }
+        float t = std::min(std::max((values[k] - low) * scale, 0.0f), 4.0f);
+        int stop = std::min(static_cast<int>(t), 3);
+        float f = t - stop;
+        for (int c = 0; c < 3; c++)
+            pixel[c] = static_cast<uint8_t>(kStops[stop][c] + f * (kStops[stop + 1][c] - kStops[stop][c]) + 0.5f);
+        pixel[3] = 255;
+    }
+}
@@ -0,0 +1,300 @@
+#include "implicit_plotter.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+Expression parseRelation(const std::string& text) {
+    size_t equals = text.find('=');
+    if (equals == std::string::npos || text.find('=', equals + 1) != std::string::npos)
+        throw std::runtime_error("Relation must contain exactly one '='");
+    std::string lhs = text.substr(0, equals);
+    std::string rhs = text.substr(equals + 1);
+    const std::vector<std::string> variables = { "x", "y" };
+    // Части разбираются отдельно, чтобы позиция в сообщении об ошибке относилась к тексту части
+    Expression::parse(lhs, variables);
+    Expression::parse(rhs, variables);
+    return Expression::parse("(" + lhs + ") - (" + rhs + ")", variables);
+}
+
+static bool isPowerOfTwo(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+ImplicitPlotter::ImplicitPlotter(ImplicitPlotOptions options) : options_(options) {
+    if (!isPowerOfTwo(options_.tileSize) || !isPowerOfTwo(options_.coarseCell) || !isPowerOfTwo(options_.leafCell) ||
+        options_.leafCell > options_.coarseCell || options_.coarseCell > options_.tileSize)
+        throw std::runtime_error("Invalid implicit plot options");
+}
+
+/**
+ * @brief Состояние обработки одной плитки
+ */
+struct ImplicitPlotter::Tile {
+    const Expression& relation;
+    const PlotViewport& viewport;
+    int left;  ///< Левый край плитки в пикселях
+    int top;   ///< Верхний край плитки в пикселях
+    std::vector<ImplicitSegment> segments;
+    ImplicitPlotStats stats;
+};
+
+/**
+ * @brief Квадратная ячейка сетки плитки: левый верхний узел и сторона в узлах
+ */
+struct QuadCell {
+    int i;
+    int j;
+    int size;
+};
+
+/**
+ * @brief Значения f в узлах сетки одной плитки; узлы вычисляются пакетами по мере надобности
+ */
+class NodeGrid {
+public:
+    NodeGrid(const Expression& relation, const PlotViewport& viewport, int left, int top, int step, int nodes)
+        : relation_(relation), viewport_(viewport), left_(left), top_(top), step_(step), stride_(nodes + 1),
+          values_(static_cast<size_t>(stride_) * stride_, std::numeric_limits<double>::quiet_NaN()),
+          known_(values_.size(), 0) {}
+
+    double x(double i) const { return viewport_.toWorldX(left_ + i * step_); }
+    double y(double j) const { return viewport_.toWorldY(top_ + j * step_); }
+    double value(int i, int j) const { return values_[static_cast<size_t>(j) * stride_ + i]; }
+
+    void need(int i, int j) {
+        size_t index = static_cast<size_t>(j) * stride_ + i;
+        if (known_[index])
+            return;
+        known_[index] = 1;
+        pending_.push_back(index);
+    }
+
+    /**
+     * @brief Вычисляет все запрошенные узлы одним пакетом
+     * @return Число вычисленных узлов
+     */
+    size_t flush() {
+        size_t count = pending_.size();
+        if (count == 0)
+            return 0;
+        xs_.resize(count);
+        ys_.resize(count);
+        results_.resize(count);
+        for (size_t k = 0; k < count; k++) {
+            xs_[k] = x(static_cast<double>(pending_[k] % stride_));
+            ys_[k] = y(static_cast<double>(pending_[k] / stride_));
+        }
+        const double* variables[] = { xs_.data(), ys_.data() };
+        relation_.evaluateBatch(variables, results_.data(), count);
+        for (size_t k = 0; k < count; k++)
+            values_[pending_[k]] = results_[k];
+        pending_.clear();
+        return count;
+    }
+
+private:
+    const Expression& relation_;
+    const PlotViewport& viewport_;
+    int left_;
+    int top_;
+    int step_;
+    int stride_;
+    std::vector<double> values_;
+    std::vector<char> known_;
+    std::vector<size_t> pending_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> results_;
+};
+
+/**
+ * @brief Меняет ли f знак среди определённых значений в углах
+ */
+static bool signChange(const double* corners) {
+    bool positive = false;
+    bool negative = false;
+    for (int k = 0; k < 4; k++) {
+        if (std::isnan(corners[k]))
+            continue;
+        positive = positive || corners[k] > 0.0;
+        negative = negative || corners[k] <= 0.0;
+    }
+    return positive && negative;
+}
+
+/**
+ * @brief Точка пересечения ребра с нулём по линейной интерполяции, в пикселях плитки
+ */
+static void crossing(double ia, double ja, double va, double ib, double jb, double vb, double& i, double& j) {
+    double t = va / (va - vb);
+    i = ia + t * (ib - ia);
+    j = ja + t * (jb - ja);
+}
+
+/**
+ * @brief Marching squares в ячейке наименьшего размера
+ *
+ * Рёбра нумеруются по часовой стрелке от верхнего; в седловой ячейке (четыре пересечения)
+ * пары рёбер выбираются по знаку среднего значения в углах.
+ */
+static void march(const Expression& relation, const NodeGrid& grid, const QuadCell& cell, const double* corners,
+    std::vector<ImplicitSegment>& out, ImplicitPlotStats& stats) {
+    for (int k = 0; k < 4; k++) {
+        if (!std::isfinite(corners[k]))
+            return;
+    }
+    const double ci[4] = { static_cast<double>(cell.i), cell.i + 1.0, cell.i + 1.0, static_cast<double>(cell.i) };
+    const double cj[4] = { static_cast<double>(cell.j), static_cast<double>(cell.j), cell.j + 1.0, cell.j + 1.0 };
+    double pi[4];
+    double pj[4];
+    bool crosses[4];
+    int count = 0;
+    for (int e = 0; e < 4; e++) {
+        int a = e;
+        int b = (e + 1) % 4;
+        crosses[e] = (corners[a] > 0.0) != (corners[b] > 0.0);
+        if (crosses[e]) {
+            crossing(ci[a], cj[a], corners[a], ci[b], cj[b], corners[b], pi[e], pj[e]);
+            count++;
+        }
+    }
+    int pairs[2][2];
+    int segments = 0;
+    if (count == 2) {
+        int first = -1;
+        for (int e = 0; e < 4; e++) {
+            if (!crosses[e])
+                continue;
+            if (first < 0)
+                first = e;
+            else {
+                pairs[0][0] = first;
+                pairs[0][1] = e;
+            }
+        }
+        segments = 1;
+    }
+    else if (count == 4) {
+        bool centerPositive = corners[0] + corners[1] + corners[2] + corners[3] > 0.0;
+        if ((corners[0] > 0.0) == centerPositive) {
+            pairs[0][0] = 0;
+            pairs[0][1] = 1;
+            pairs[1][0] = 2;
+            pairs[1][1] = 3;
+        }
+        else {
+            pairs[0][0] = 3;
+            pairs[0][1] = 0;
+            pairs[1][0] = 1;
+            pairs[1][1] = 2;
+        }
+        segments = 2;
+    }
+    if (segments == 0)
+        return;
+    // Смена знака на полюсе (tan, деление на ноль) — не ноль функции: промежуток значений на такой
+    // ячейке неограничен или содержит неопределённые точки
+    Interval box[2] = { { grid.x(cell.i), grid.x(cell.i + 1), false }, { grid.y(cell.j + 1), grid.y(cell.j), false } };
+    Interval range = relation.evaluateInterval(box);
+    stats.intervalEvaluations++;
+    if (range.partial || !std::isfinite(range.lo) || !std::isfinite(range.hi))
+        return;
+    for (int s = 0; s < segments; s++) {
+        int a = pairs[s][0];
+        int b = pairs[s][1];
+        out.push_back({ { grid.x(pi[a]), grid.y(pj[a]) }, { grid.x(pi[b]), grid.y(pj[b]) } });
+    }
+}
+
+void ImplicitPlotter::plotTile(Tile& tile) const {
+    const int step = options_.leafCell;
+    const int nodes = options_.tileSize / step;
+    NodeGrid grid(tile.relation, tile.viewport, tile.left, tile.top, step, nodes);
+
+    std::vector<QuadCell> cells;
+    std::vector<QuadCell> next;
+    const int coarse = options_.coarseCell / step;
+    for (int j = 0; j < nodes; j += coarse) {
+        for (int i = 0; i < nodes; i += coarse) {
+            cells.push_back({ i, j, coarse });
+            grid.need(i, j);
+            grid.need(i + coarse, j);
+            grid.need(i, j + coarse);
+            grid.need(i + coarse, j + coarse);
+        }
+    }
+    tile.stats.evaluations += grid.flush();
+
+    while (!cells.empty()) {
+        next.clear();
+        for (const QuadCell& cell : cells) {
+            int s = cell.size;
+            // Углы по часовой стрелке от левого верхнего
+            double corners[4] = { grid.value(cell.i, cell.j), grid.value(cell.i + s, cell.j),
+                grid.value(cell.i + s, cell.j + s), grid.value(cell.i, cell.j + s) };
+            if (s == 1) {
+                tile.stats.leaves++;
+                march(tile.relation, grid, cell, corners, tile.segments, tile.stats);
+                continue;
+            }
+            bool split = signChange(corners);
+            if (!split && options_.intervalCheck) {
+                Interval box[2] = { { grid.x(cell.i), grid.x(cell.i + s), false },
+                    { grid.y(cell.j + s), grid.y(cell.j), false } };
+                Interval range = tile.relation.evaluateInterval(box);
+                tile.stats.intervalEvaluations++;
+                split = !range.isEmpty() && range.lo <= 0.0 && range.hi >= 0.0;
+            }
+            if (!split)
+                continue;
+            tile.stats.refined++;
+            int h = s / 2;
+            next.push_back({ cell.i, cell.j, h });
+            next.push_back({ cell.i + h, cell.j, h });
+            next.push_back({ cell.i, cell.j + h, h });
+            next.push_back({ cell.i + h, cell.j + h, h });
+            grid.need(cell.i + h, cell.j);
+            grid.need(cell.i, cell.j + h);
+            grid.need(cell.i + h, cell.j + h);
+            grid.need(cell.i + s, cell.j + h);
+            grid.need(cell.i + h, cell.j + s);
+        }
+        tile.stats.evaluations += grid.flush();
+        cells.swap(next);
+    }
+}
+
+ImplicitPlotStats ImplicitPlotter::plot(const Expression& relation, const PlotViewport& viewport,
+    std::vector<ImplicitSegment>& out, ThreadPool* pool) const {
+    CALC_TRACE_SCOPE("ImplicitPlotter::plot");
+    out.clear();
+    int columns = (viewport.width + options_.tileSize - 1) / options_.tileSize;
+    int rows = (viewport.height + options_.tileSize - 1) / options_.tileSize;
+    std::vector<Tile> tiles;
+    tiles.reserve(static_cast<size_t>(columns) * rows);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++)
+            tiles.push_back({ relation, viewport, c * options_.tileSize, r * options_.tileSize, {}, {} });
+    }
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++)
+            plotTile(tiles[t]);
+    };
+    if (pool && tiles.size() > 1)
+        pool->parallelFor(0, tiles.size(), 1, run);
+    else
+        run(0, tiles.size());
+
+    ImplicitPlotStats stats;
+    for (const auto& tile : tiles) {
+        stats.evaluations += tile.stats.evaluations;
+        stats.intervalEvaluations += tile.stats.intervalEvaluations;
+        stats.refined += tile.stats.refined;
+        stats.leaves += tile.stats.leaves;
+        out.insert(out.end(), tile.segments.begin(), tile.segments.end());
+    }
+    stats.segments = out.size();
+    return stats;
+}
@@ -0,0 +1,32 @@
+#include "input_recorder.h"
+#include <sstream>
+#include <stdexcept>
+
+InputRecorder::InputRecorder(const std::string& path)
+    : out_(path), start_(std::chrono::steady_clock::now()) {
+    if (!out_)
+        throw std::runtime_error("Cannot open input session file for writing");
+}
+
+void InputRecorder::record(const std::string& key) {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    out_ << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << ' ' << key << '\n';
+}
+
+std::vector<RecordedInput> loadInputSession(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open input session file");
+    std::vector<RecordedInput> session;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+        std::istringstream fields(line);
+        RecordedInput input;
+        if (!(fields >> input.timestampUs >> input.key))
+            throw std::runtime_error("Incorrect input session line");
+        session.push_back(input);
+    }
+    return session;
+}
@@ -0,0 +1,178 @@
+#include "interval.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Порог деления на ноль и сдвиг округления почти целых значений, как в tryEvaluate
+ */
+static const double kEpsilon = 1e-6;
+
+/**
+ * @brief Полуширина окрестности полюса tan и cot в градусах, где tryEvaluate сообщает об ошибке, с запасом
+ */
+static const double kPoleWindow = 1e-4;
+
+static const double kInfinity = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief Расширяет промежуток наружу на погрешность округления результата
+ */
+static Interval widen(double lo, double hi, bool partial) {
+    if (std::isnan(lo) || std::isnan(hi))
+        return Interval::whole(true);
+    return { lo - (kEpsilon + std::fabs(lo) * 1e-15), hi + (kEpsilon + std::fabs(hi) * 1e-15), partial };
+}
+
+/**
+ * @brief Наименьший промежуток, содержащий четыре значения; NaN среди них (0 * inf, inf - inf) даёт всю прямую
+ */
+static Interval corners(double a, double b, double c, double d, bool partial) {
+    if (std::isnan(a) || std::isnan(b) || std::isnan(c) || std::isnan(d))
+        return Interval::whole(partial);
+    return widen(std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d)), partial);
+}
+
+/**
+ * @brief Объединение двух промежутков (пустые не учитываются)
+ */
+static Interval hull(const Interval& a, const Interval& b) {
+    if (a.isEmpty())
+        return b;
+    if (b.isEmpty())
+        return a;
+    return { std::min(a.lo, b.lo), std::max(a.hi, b.hi), a.partial || b.partial };
+}
+
+/**
+ * @brief Есть ли в [lo, hi] точка вида phase + k * period
+ */
+static bool containsPhase(double lo, double hi, double phase, double period) {
+    return std::ceil((lo - phase) / period) <= std::floor((hi - phase) / period);
+}
+
+/**
+ * @brief Значение операции в точке, где она заведомо определена
+ */
+static double at(Operation op, double a, double b = 0.0) {
+    double result = std::numeric_limits<double>::quiet_NaN();
+    tryEvaluate(op, a, b, result);
+    return result;
+}
+
+static Interval divide(const Interval& a, const Interval& b, bool partial) {
+    Interval result = Interval::empty();
+    if (b.lo <= -kEpsilon) {
+        double hi = std::min(b.hi, -kEpsilon);
+        result = hull(result, corners(a.lo / b.lo, a.lo / hi, a.hi / b.lo, a.hi / hi, partial));
+    }
+    if (b.hi >= kEpsilon) {
+        double lo = std::max(b.lo, kEpsilon);
+        result = hull(result, corners(a.lo / lo, a.lo / b.hi, a.hi / lo, a.hi / b.hi, partial));
+    }
+    if (b.lo < kEpsilon && b.hi > -kEpsilon)
+        result.partial = true;
+    return result;
+}
+
+static Interval power(const Interval& a, const Interval& b, bool partial) {
+    double bl = b.lo;
+    double bh = b.hi;
+    if (!b.isPoint()) {
+        // При a >= 0 степень монотонна по каждому аргументу, поэтому крайние значения — в углах
+        if (a.lo < 0.0)
+            return Interval::whole(true);
+        return corners(std::pow(a.lo, bl), std::pow(a.lo, bh), std::pow(a.hi, bl), std::pow(a.hi, bh), partial);
+    }
+    double n = bl;
+    if (n == 0.0)
+        return widen(1.0, 1.0, partial);
+    if (!std::isfinite(n) || std::floor(n) != n) {
+        // Дробный показатель определён только для a >= 0
+        if (a.hi < 0.0)
+            return Interval::empty();
+        double lo = std::max(a.lo, 0.0);
+        double x = std::pow(lo, n);
+        double y = std::pow(a.hi, n);
+        return corners(x, y, x, y, partial || a.lo < 0.0);
+    }
+    double x = std::pow(a.lo, n);
+    double y = std::pow(a.hi, n);
+    bool containsZero = a.lo <= 0.0 && a.hi >= 0.0;
+    bool even = std::fmod(n, 2.0) == 0.0;
+    if (containsZero && n > 0.0 && even)
+        return widen(0.0, std::max(x, y), partial);
+    if (containsZero && n < 0.0)
+        return even ? widen(std::min(x, y), kInfinity, partial) : Interval::whole(partial);
+    // На промежутке одного знака целая степень монотонна
+    return corners(x, y, x, y, partial);
+}
+
+static Interval factorialInterval(const Interval& a, bool partial) {
+    double first = std::ceil(std::max(a.lo, 0.0));
+    double last = std::floor(a.hi);
+    if (first > last)
+        return Interval::empty();
+    partial = partial || !(a.isPoint() && first == a.lo);
+    return widen(at(Operation::Factorial, first), std::isinf(last) ? kInfinity : at(Operation::Factorial, last), partial);
+}
+
+static Interval trigonometric(Operation op, const Interval& a, bool partial) {
+    if (!std::isfinite(a.lo) || !std::isfinite(a.hi)) {
+        if (op == Operation::Sin || op == Operation::Cos)
+            return widen(-1.0, 1.0, partial);
+        return Interval::whole(true);
+    }
+    switch (op) {
+    case Operation::Sin:
+    case Operation::Cos: {
+        if (a.hi - a.lo >= 360.0)
+            return widen(-1.0, 1.0, partial);
+        double top = op == Operation::Sin ? 90.0 : 0.0;
+        double x = at(op, a.lo);
+        double y = at(op, a.hi);
+        double lo = containsPhase(a.lo, a.hi, top + 180.0, 360.0) ? -1.0 : std::min(x, y);
+        double hi = containsPhase(a.lo, a.hi, top, 360.0) ? 1.0 : std::max(x, y);
+        return widen(lo, hi, partial);
+    }
+    case Operation::Tan:
+    case Operation::Cot: {
+        // На каждой ветви tan возрастает, а cot убывает; промежуток с полюсом занимает всю прямую
+        double pole = op == Operation::Tan ? 90.0 : 0.0;
+        if (a.hi - a.lo >= 180.0 || containsPhase(a.lo - kPoleWindow, a.hi + kPoleWindow, pole, 180.0))
+            return Interval::whole(true);
+        double x = at(op, a.lo);
+        double y = at(op, a.hi);
+        return corners(x, y, x, y, partial);
+    }
+    default:
+        return Interval::whole(true);
+    }
+}
+
+Interval evaluateInterval(Operation op, const Interval& a, const Interval& b) noexcept {
+    bool unary = op == Operation::Factorial || op == Operation::Sin || op == Operation::Cos ||
+        op == Operation::Tan || op == Operation::Cot;
+    if (a.isEmpty() || (!unary && b.isEmpty()))
+        return Interval::empty();
+    bool partial = a.partial || (!unary && b.partial);
+    switch (op) {
+    case Operation::Add:
+        return widen(a.lo + b.lo, a.hi + b.hi, partial);
+    case Operation::Subtract:
+        return widen(a.lo - b.hi, a.hi - b.lo, partial);
+    case Operation::Multiply:
+        return corners(a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi, partial);
+    case Operation::Divide:
+        return divide(a, b, partial);
+    case Operation::Power:
+        return power(a, b, partial);
+    case Operation::Factorial:
+        return factorialInterval(a, partial);
+    case Operation::Sin:
+    case Operation::Cos:
+    case Operation::Tan:
+    case Operation::Cot:
+        return trigonometric(op, a, partial);
+    }
+    return Interval::empty();
+}
@@ -0,0 +1,101 @@
+#include "interval_plotter.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Состояние обработки одного начального блока
+ */
+struct IntervalPlotter::Block {
+    const Expression& function;
+    const PlotViewport& viewport;
+    std::vector<PixelSpan> spans;
+    IntervalPlotStats stats;
+};
+
+void IntervalPlotter::refine(Block& block, double p0, double p1, int depth) const {
+    const PlotViewport& viewport = block.viewport;
+    Interval x{ viewport.toWorldX(p0), viewport.toWorldX(p1), false };
+    Interval y = block.function.evaluateInterval(&x);
+    block.stats.evaluations++;
+    if (y.isEmpty() || y.hi < viewport.yMin || y.lo > viewport.yMax) {
+        block.stats.pruned++;
+        return;
+    }
+
+    int lastRow = viewport.height - 1;
+    int rowBegin = std::min(std::max(static_cast<int>(std::floor(viewport.toScreenY(std::min(y.hi, viewport.yMax)))), 0), lastRow);
+    int rowEnd = std::min(std::max(static_cast<int>(std::floor(viewport.toScreenY(std::max(y.lo, viewport.yMin)))), 0), lastRow) + 1;
+    int firstColumn = std::max(static_cast<int>(std::floor(p0)), 0);
+    int lastColumn = std::min(static_cast<int>(std::ceil(p1)) - 1, viewport.width - 1);
+    double width = p1 - p0;
+    bool leaf = (firstColumn == lastColumn && rowEnd - rowBegin <= 1) || width <= options_.minWidth || depth >= options_.maxDepth;
+    if (!leaf && firstColumn == lastColumn) {
+        // Внутри столбца деление уже не сузит отметку, если промежуток почти совпадает с размахом
+        // значений на концах: непрерывная ломаная всё равно проходит через эти строки.
+        // Отметка остаётся надёжной в любом случае — правило влияет только на её точность
+        double a = block.function(x.lo);
+        double b = block.function(x.hi);
+        block.stats.evaluations += 2;
+        if (!y.partial && std::isfinite(a) && std::isfinite(b)) {
+            double span = std::fabs(viewport.toScreenY(a) - viewport.toScreenY(b));
+            leaf = rowEnd - rowBegin <= span + 2.0;
+        }
+    }
+    if (leaf) {
+        for (int column = firstColumn; column <= lastColumn; column++)
+            block.spans.push_back({ column, rowBegin, rowEnd });
+        return;
+    }
+    // Пока отрезок шире пикселя, делим по границе столбцов, чтобы половины не делили столбцы между собой
+    double mid = 0.5 * (p0 + p1);
+    if (width > 1.0) {
+        double boundary = std::round(mid);
+        if (boundary > p0 && boundary < p1)
+            mid = boundary;
+    }
+    refine(block, p0, mid, depth + 1);
+    refine(block, mid, p1, depth + 1);
+}
+
+IntervalPlotStats IntervalPlotter::plot(const Expression& function, const PlotViewport& viewport,
+    std::vector<PixelSpan>& out, ThreadPool* pool) const {
+    CALC_TRACE_SCOPE("IntervalPlotter::plot");
+    out.clear();
+    int blockWidth = std::max(options_.blockWidth, 1);
+    size_t count = static_cast<size_t>((viewport.width + blockWidth - 1) / blockWidth);
+    std::vector<Block> blocks;
+    blocks.reserve(count);
+    for (size_t b = 0; b < count; b++)
+        blocks.push_back({ function, viewport, {}, {} });
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            double p0 = static_cast<double>(b * blockWidth);
+            double p1 = std::min(p0 + blockWidth, static_cast<double>(viewport.width));
+            refine(blocks[b], p0, p1, 0);
+        }
+    };
+    if (pool && count > 1)
+        pool->parallelFor(0, count, 1, run);
+    else
+        run(0, count);
+
+    IntervalPlotStats stats;
+    for (auto& block : blocks) {
+        stats.evaluations += block.stats.evaluations;
+        stats.pruned += block.stats.pruned;
+        // Блоки не пересекаются по столбцам, поэтому слияние внутри блока даёт общий порядок
+        std::sort(block.spans.begin(), block.spans.end(), [](const PixelSpan& a, const PixelSpan& b) {
+            return a.column != b.column ? a.column < b.column : a.rowBegin < b.rowBegin;
+        });
+        for (const auto& span : block.spans) {
+            if (!out.empty() && out.back().column == span.column && span.rowBegin <= out.back().rowEnd)
+                out.back().rowEnd = std::max(out.back().rowEnd, span.rowEnd);
+            else
+                out.push_back(span);
+        }
+    }
+    for (const auto& span : out)
+        stats.pixels += static_cast<uint64_t>(span.rowEnd - span.rowBegin);
+    return stats;
+}
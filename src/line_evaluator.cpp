@@ -0,0 +1,191 @@
+#include "line_evaluator.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+size_t formatNumber(double value, char* buffer) noexcept {
+    auto result = std::to_chars(buffer, buffer + kNumberBufferSize, value, std::chars_format::general, 15);
+    return static_cast<size_t>(result.ptr - buffer);
+}
+
+size_t readAvailable(std::FILE* file, char* buffer, size_t size) {
+#ifdef _WIN32
+    int read = _read(_fileno(file), buffer, static_cast<unsigned>(std::min<size_t>(size, 1 << 30)));
+    return read > 0 ? static_cast<size_t>(read) : 0;
+#else
+    ssize_t result;
+    do
+        result = read(fileno(file), buffer, size);
+    while (result < 0 && errno == EINTR);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+#endif
+}
+
+LineReader::LineReader(std::FILE* file, size_t blockSize) : file_(file), buffer_(std::max<size_t>(blockSize, 64)) {}
+
+bool LineReader::next(std::string_view& line) {
+    for (;;) {
+        const char* data = buffer_.data();
+        const void* newline = std::memchr(data + begin_, '\n', end_ - begin_);
+        if (newline != nullptr || (eof_ && begin_ < end_)) {
+            size_t stop = newline != nullptr ? static_cast<size_t>(static_cast<const char*>(newline) - data) : end_;
+            size_t length = stop - begin_;
+            if (length > 0 && data[begin_ + length - 1] == '\r')
+                length--;
+            line = std::string_view(data + begin_, length);
+            begin_ = newline != nullptr ? stop + 1 : end_;
+            return true;
+        }
+        if (eof_)
+            return false;
+        // Незавершённая строка переносится в начало; буфер растёт, только если строка длиннее блока
+        size_t pending = end_ - begin_;
+        std::memmove(buffer_.data(), buffer_.data() + begin_, pending);
+        begin_ = 0;
+        end_ = pending;
+        if (end_ == buffer_.size())
+            buffer_.resize(buffer_.size() * 2);
+        size_t read = readAvailable(file_, buffer_.data() + end_, buffer_.size() - end_);
+        end_ += read;
+        if (read == 0)
+            eof_ = true;
+    }
+}
+
+bool LineReader::lineReady() const {
+    return eof_ || std::memchr(buffer_.data() + begin_, '\n', end_ - begin_) != nullptr;
+}
+
+static const std::vector<std::string> kNoVariables;
+
+bool LineEvaluator::evaluate(std::string_view line, double& result, std::string& error) {
+    try {
+        expression_.compile(line, kNoVariables);
+    }
+    catch (const std::runtime_error& ex) {
+        error = ex.what();
+        return false;
+    }
+    MathError code = expression_.evaluate(nullptr, result);
+    if (code != MathError::None) {
+        error = mathErrorMessage(code);
+        return false;
+    }
+    return true;
+}
+
+bool LineEvaluator::evaluateLine(std::string_view line, std::string& out) {
+    if (line.find_first_not_of(" \t") == std::string_view::npos) {
+        out.push_back('\n');
+        return true;
+    }
+    double result = 0.0;
+    std::string error;
+    if (!evaluate(line, result, error)) {
+        out.append("error: ");
+        out.append(error);
+        out.push_back('\n');
+        return false;
+    }
+    char buffer[kNumberBufferSize];
+    out.append(buffer, formatNumber(result, buffer));
+    out.push_back('\n');
+    return true;
+}
+
+/**
+ * @brief Вычисляет строки отрезка текста в собственный буфер
+ */
+static LineBatchStats evaluateChunk(std::string_view chunk, std::string& out) {
+    LineEvaluator evaluator;
+    LineBatchStats stats;
+    out.clear();
+    // Оценка размера вывода: результат обычно не длиннее выражения
+    out.reserve(chunk.size() + chunk.size() / 4);
+    while (!chunk.empty()) {
+        size_t newline = chunk.find('\n');
+        std::string_view line = chunk.substr(0, newline);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (!evaluator.evaluateLine(line, out))
+            stats.errors++;
+        stats.lines++;
+        chunk.remove_prefix(newline == std::string_view::npos ? chunk.size() : newline + 1);
+    }
+    return stats;
+}
+
+LineBatchStats evaluateLines(std::string_view text, std::FILE* out, ThreadPool* pool, size_t chunkSize) {
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    std::vector<size_t> bounds = { 0 };
+    while (bounds.back() < text.size()) {
+        size_t end = bounds.back() + chunkSize;
+        if (end >= text.size())
+            end = text.size();
+        else {
+            size_t newline = text.find('\n', end - 1);
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        bounds.push_back(end);
+    }
+    const size_t chunks = bounds.size() - 1;
+    const size_t window = pool != nullptr ? std::max<size_t>(pool->size(), 1) * 4 : 1;
+
+    std::vector<std::string> buffers[2] = { std::vector<std::string>(window), std::vector<std::string>(window) };
+    std::vector<LineBatchStats> chunkStats(window);
+    LineBatchStats total;
+    std::future<bool> writing;
+    auto writeAll = [out](const std::vector<std::string>* buffers, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const std::string& buffer = (*buffers)[i];
+            if (std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size())
+                return false;
+        }
+        return true;
+    };
+    auto finishWriting = [&]() {
+        if (writing.valid() && !writing.get())
+            throw std::runtime_error("Cannot write results");
+    };
+    try {
+        for (size_t first = 0, index = 0; first < chunks; first += window, index ^= 1) {
+            size_t count = std::min(window, chunks - first);
+            std::vector<std::string>& current = buffers[index];
+            auto body = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    std::string_view chunk = text.substr(bounds[first + i], bounds[first + i + 1] - bounds[first + i]);
+                    chunkStats[i] = evaluateChunk(chunk, current[i]);
+                }
+            };
+            if (pool != nullptr)
+                pool->parallelFor(0, count, 1, body);
+            else
+                body(0, count);
+            for (size_t i = 0; i < count; i++) {
+                total.lines += chunkStats[i].lines;
+                total.errors += chunkStats[i].errors;
+            }
+            // Предыдущее окно должно быть записано, прежде чем писать это и переиспользовать его буферы
+            finishWriting();
+            if (pool != nullptr)
+                writing = pool->submit([&writeAll, &current, count]() { return writeAll(&current, count); });
+            else if (!writeAll(&current, count))
+                throw std::runtime_error("Cannot write results");
+        }
+        finishWriting();
+    }
+    catch (...) {
+        if (writing.valid())
+            writing.wait();
+        throw;
+    }
+    return total;
+}
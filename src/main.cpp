@@ -1,10 +1,24 @@
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <vector>
-#include "calculator_math.h"
+#include "calculator_engine.h"
+#include "async_evaluator.h"
+#include "input_recorder.h"
+#include "triple_buffer.h"
+#include "perf_hud.h"
+#include "atlas_text.h"
+#include "trace.h"
+#include "startup_profiler.h"
+#include "plot_view.h"
 #include <iostream>
 #include <stdexcept>
 #include <cmath>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <deque>
+#include <optional>
 
 /**
  * @brief Структура, представляющая графическую кнопку калькулятора
@@ -12,33 +26,463 @@
  */
 struct Button {
     sf::RectangleShape shape;
-    sf::Text text;
+    AtlasText text;
     std::string label;
 };
 
+/**
+ * @brief Кнопки калькулятора, разделённые на основные и второстепенные
+ *
+ * Второстепенные кнопки (тригонометрия и перевод систем счисления) в ленивом режиме
+ * строятся фоновым потоком после показа первого кадра. Поток публикует их флагом
+ * secondaryReady; после этого вектор не изменяется и читается без блокировок.
+ */
+struct ButtonPanels {
+    std::vector<Button> primary;
+    std::vector<Button> secondary;
+    std::atomic<bool> secondaryReady{ false };
+
+    /**
+     * @brief Ищет кнопку под указателем среди уже построенных
+     * @param pos Координаты указателя
+     * @return Кнопка или nullptr
+     */
+    const Button* buttonAt(const sf::Vector2f& pos) const {
+        for (const auto& btn : primary) {
+            if (btn.shape.getGlobalBounds().contains(pos))
+                return &btn;
+        }
+        if (secondaryReady.load(std::memory_order_acquire)) {
+            for (const auto& btn : secondary) {
+                if (btn.shape.getGlobalBounds().contains(pos))
+                    return &btn;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Рисует уже построенные кнопки
+     * @param target Цель отрисовки
+     * @return Число вызовов отрисовки
+     */
+    unsigned draw(sf::RenderTarget& target) const {
+        unsigned drawCalls = 0;
+        auto drawAll = [&](const std::vector<Button>& buttons) {
+            for (const auto& btn : buttons) {
+                target.draw(btn.shape);
+                target.draw(btn.text);
+            }
+            drawCalls += 2 * static_cast<unsigned>(buttons.size());
+        };
+        drawAll(primary);
+        if (secondaryReady.load(std::memory_order_acquire))
+            drawAll(secondary);
+        return drawCalls;
+    }
+};
+
+/**
+ * @brief Геометрия сетки кнопок
+ */
+struct ButtonLayout {
+    int cols;
+    int margin;
+    int gridTop;
+    float btnWidth;
+    float btnHeight;
+};
+
+/**
+ * @brief Состояние замера запуска, общее для потоков ввода, отрисовки и фоновой инициализации
+ */
+struct StartupState {
+    StartupProfiler profiler;
+    bool report = false;
+    std::atomic<int> pendingSteps{ 2 };  ///< Первый кадр и построение второстепенных кнопок
+};
+
+/**
+ * @brief Снимок состояния интерфейса, передаваемый из потока ввода в поток отрисовки
+ */
+struct UiSnapshot {
+    std::string displayText;
+    bool hudEnabled = false;
+    std::chrono::steady_clock::time_point inputTime;  ///< Момент получения пакета ввода
+    uint64_t evaluationNs = 0;                        ///< Время применения пакета к CalculatorEngine
+    std::shared_ptr<const EvaluationControl> evaluation;  ///< Выполняющееся вычисление или nullptr
+};
+
+/**
+ * @brief Применяет нажатия к CalculatorEngine, вынося вычисления в пул рабочих потоков
+ *
+ * Пока вычисление выполняется, поток ввода не блокируется: новые нажатия откладываются
+ * и применяются после его завершения, а "C" отменяет вычисление.
+ */
+struct KeyDispatcher {
+    CalculatorEngine engine;
+    AsyncEvaluator evaluator;
+    std::optional<AsyncEvaluation> pending;
+    std::chrono::steady_clock::time_point pendingSince;  ///< Момент получения ввода, запустившего вычисление
+    std::deque<std::string> deferred;
+
+    /**
+     * @brief Применяет нажатие или ставит вычисление в пул
+     * @param key Метка кнопки
+     * @param inputTime Момент получения ввода
+     */
+    void press(const std::string& key, std::chrono::steady_clock::time_point inputTime) {
+        if (pending) {
+            if (key == "C") {
+                cancel();
+                engine.press(key);
+            }
+            else
+                deferred.push_back(key);
+            return;
+        }
+        if (CalculatorEngine::isEvaluationKey(key)) {
+            pending = evaluator.submit(engine.beginEvaluation(key));
+            pendingSince = inputTime;
+        }
+        else
+            engine.press(key);
+    }
+
+    /**
+     * @brief Применяет результат завершившегося вычисления и отложенные нажатия
+     * @return true, если вычисление завершилось и дисплей изменился
+     */
+    bool poll() {
+        if (!pending || !pending->ready())
+            return false;
+        try {
+            engine.completeEvaluation(pending->result.get());
+        }
+        catch (const std::exception& ex) {
+            engine.completeEvaluation("Error");
+        }
+        pending.reset();
+        while (!pending && !deferred.empty()) {
+            std::string key = deferred.front();
+            deferred.pop_front();
+            press(key, pendingSince);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Отменяет выполняющееся вычисление и отложенные нажатия
+     */
+    void cancel() {
+        if (pending)
+            pending->control->cancel();
+        pending.reset();
+        deferred.clear();
+    }
+};
+
+/**
+ * @brief Сопоставляет введённый с клавиатуры символ метке кнопки калькулятора
+ *
+ * @param c Символ в кодировке UTF-32
+ * @return Метка кнопки или пустая строка, если символ не соответствует ни одной кнопке
+ */
+static std::string keyForChar(sf::Uint32 c) {
+    if ((c >= '0' && c <= '9') || c == '.' || c == '+' || c == '-' || c == '*' || c == '/' || c == '^')
+        return std::string(1, static_cast<char>(c));
+    if (c == '=' || c == '\r' || c == '\n')
+        return "=";
+    if (c == '!')
+        return "x!";
+    return "";
+}
+
+/**
+ * @brief Переводит событие окна в последовательность нажатий кнопок калькулятора
+ *
+ * Нажатия накапливаются в пакете, который применяется к выражению одной транзакцией
+ * за кадр, поэтому серия быстрых щелчков или вставка из буфера обмена
+ * приводят к одному обновлению дисплея.
+ *
+ * @param event Событие окна
+ * @param panels Кнопки калькулятора
+ * @param batch Пакет нажатий, в который добавляются метки
+ * @return false, если событие требует завершения приложения
+ */
+static bool collectKeys(const sf::Event& event, const ButtonPanels& panels, std::vector<std::string>& batch) {
+    if (event.type == sf::Event::Closed)
+        return false;
+
+    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+        const Button* btn = panels.buttonAt(sf::Vector2f(event.mouseButton.x, event.mouseButton.y));
+        if (btn) {
+            if (btn->label == "Exit")
+                return false;
+            batch.push_back(btn->label);
+        }
+    }
+    else if (event.type == sf::Event::KeyPressed) {
+        if (event.key.code == sf::Keyboard::Escape)
+            batch.push_back("C");
+        else if (event.key.code == sf::Keyboard::V && event.key.control) {
+            sf::String pasted = sf::Clipboard::getString();
+            for (sf::Uint32 c : pasted) {
+                std::string key = keyForChar(c);
+                if (!key.empty())
+                    batch.push_back(key);
+            }
+        }
+    }
+    else if (event.type == sf::Event::TextEntered) {
+        std::string key = keyForChar(event.text.unicode);
+        if (!key.empty())
+            batch.push_back(key);
+    }
+    return true;
+}
+
+/**
+ * @brief Создаёт кнопку в заданной ячейке сетки
+ *
+ * Не обращается к OpenGL (текст берёт глифы из готового атласа), поэтому может вызываться из любого потока.
+ *
+ * @param label Метка кнопки
+ * @param index Номер ячейки сетки
+ * @param layout Геометрия сетки
+ * @param atlas Атлас глифов
+ * @return Готовая кнопка
+ */
+static Button makeButton(const std::string& label, size_t index, const ButtonLayout& layout, const GlyphAtlas& atlas) {
+    int row = index / layout.cols;
+    int col = index % layout.cols;
+    float posX = layout.margin + col * (layout.btnWidth + layout.margin);
+    float posY = layout.gridTop + layout.margin + row * (layout.btnHeight + layout.margin);
+
+    Button btn;
+    btn.label = label;
+    btn.shape.setSize(sf::Vector2f(layout.btnWidth, layout.btnHeight));
+    btn.shape.setFillColor(sf::Color(100, 100, 100));
+    btn.shape.setPosition(posX, posY);
+
+    btn.text.setAtlas(atlas);
+    btn.text.setString(btn.label);
+    btn.text.setFillColor(sf::Color::White);
+
+    sf::FloatRect textRect = btn.text.getLocalBounds();
+    btn.text.setOrigin(textRect.left + textRect.width / 2.0f,
+        textRect.top + textRect.height / 2.0f);
+    btn.text.setPosition(posX + layout.btnWidth / 2.0f, posY + layout.btnHeight / 2.0f);
+    return btn;
+}
+
+/**
+ * @brief Относится ли кнопка к второстепенным (тригонометрия и перевод систем счисления)
+ * @param label Метка кнопки
+ */
+static bool isSecondaryLabel(const std::string& label) {
+    return label == "sin" || label == "cos" || label == "tan" || label == "cot" ||
+        label.find("-cc") != std::string::npos;
+}
+
+/**
+ * @brief Отмечает завершение одного из шагов запуска
+ *
+ * Последний из шагов (первый кадр и построение всех кнопок) фиксирует время до готовности
+ * к работе и при необходимости печатает отчёт о фазах запуска.
+ *
+ * @param startup Состояние замера запуска
+ */
+static void finishStartupStep(StartupState& startup) {
+    if (startup.pendingSteps.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    startup.profiler.mark("time to interactive", startup.profiler.start());
+    if (startup.report)
+        startup.profiler.report(std::cout);
+}
+
+/**
+ * @brief Цикл потока отрисовки
+ *
+ * Активирует OpenGL-контекст окна в текущем потоке и рисует кадры, пока не сброшен флаг running.
+ * Текст дисплея обновляется только при появлении нового снимка состояния,
+ * поэтому ожидание вертикальной синхронизации в window.display() не задерживает обработку ввода.
+ * Пока выполняется асинхронное вычисление, рядом с дисплеем вращается индикатор с процентом выполнения.
+ * Измерения для оверлея производительности собираются, только пока он включён.
+ *
+ * @param window Окно, в которое выполняется отрисовка
+ * @param display Текст дисплея (принадлежит потоку отрисовки)
+ * @param panels Кнопки калькулятора
+ * @param atlas Атлас глифов для индикатора вычисления
+ * @param hud Оверлей производительности (принадлежит потоку отрисовки)
+ * @param snapshots Буфер снимков состояния от потока ввода
+ * @param running Флаг работы потока
+ * @param startup Состояние замера запуска
+ */
+static void renderLoop(sf::RenderWindow& window, AtlasText& display, const ButtonPanels& panels,
+    const GlyphAtlas& atlas, PerfHud& hud, TripleBuffer<UiSnapshot>& snapshots, const std::atomic<bool>& running, StartupState& startup) {
+    CALC_TRACE_THREAD_NAME("render");
+    auto renderStart = StartupProfiler::Clock::now();
+    bool firstFrame = true;
+    std::shared_ptr<const EvaluationControl> evaluation;
+    int shownPercent = -1;
+    AtlasText progressText;
+    progressText.setAtlas(atlas);
+    progressText.setFillColor(sf::Color(180, 180, 180));
+    sf::CircleShape spinnerDot(3.0f);
+    spinnerDot.setOrigin(3.0f, 3.0f);
+    sf::Clock spinnerClock;
+    window.setActive(true);
+    auto lastPresent = std::chrono::steady_clock::now();
+    bool latencyPending = false;
+    while (running.load(std::memory_order_acquire)) {
+        if (snapshots.acquire()) {
+            const UiSnapshot& snapshot = snapshots.readBuffer();
+            CALC_TRACE_SCOPE("layout display");
+            display.setString(snapshot.displayText);
+            if (snapshot.evaluation != evaluation)
+                spinnerClock.restart();
+            evaluation = snapshot.evaluation;
+            hud.setEnabled(snapshot.hudEnabled);
+            if (hud.enabled()) {
+                hud.recordEvaluation(snapshot.evaluationNs);
+                latencyPending = true;
+            }
+        }
+        unsigned drawCalls = 1;
+        {
+            CALC_TRACE_SCOPE("draw");
+            window.clear(sf::Color::Black);
+            window.draw(display);
+            drawCalls += panels.draw(window);
+            // Индикатор показывается только для вычислений дольше 100 мс, чтобы не мигать на быстрых
+            if (evaluation && spinnerClock.getElapsedTime() > sf::milliseconds(100)) {
+                int percent = static_cast<int>(evaluation->progress() * 100.0f);
+                if (percent != shownPercent) {
+                    progressText.setString(std::to_string(percent) + "%  Esc");
+                    progressText.setPosition(440.0f - progressText.getLocalBounds().width, 10.0f);
+                    shownPercent = percent;
+                }
+                window.draw(progressText);
+                const float pi = 3.14159265f;
+                float phase = spinnerClock.getElapsedTime().asSeconds() * 2.0f * pi;
+                for (int i = 0; i < 8; i++) {
+                    float angle = phase + i * pi / 4.0f;
+                    spinnerDot.setPosition(470.0f + 12.0f * std::cos(angle), 32.0f + 12.0f * std::sin(angle));
+                    spinnerDot.setFillColor(sf::Color(255, 255, 255, static_cast<sf::Uint8>(40 + i * 30)));
+                    window.draw(spinnerDot);
+                }
+                drawCalls += 9;
+            }
+            drawCalls += hud.draw(window);
+        }
+        {
+            CALC_TRACE_SCOPE("window.display");
+            window.display();
+        }
+        if (firstFrame) {
+            startup.profiler.mark("first frame", renderStart);
+            finishStartupStep(startup);
+            firstFrame = false;
+        }
+
+        // Время кадра отсчитывается от каждого показа, даже при выключенном HUD: иначе первый кадр
+        // после включения включал бы всё время, пока HUD был выключен
+        auto now = std::chrono::steady_clock::now();
+        if (hud.enabled()) {
+            hud.recordFrame(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastPresent).count(), drawCalls);
+            if (latencyPending) {
+                auto latency = now - snapshots.readBuffer().inputTime;
+                hud.recordInputLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+                latencyPending = false;
+            }
+        }
+        lastPresent = now;
+    }
+    window.setActive(false);
+}
+
 /**
 * @brief Главная функция приложения калькулятора
 * Инициализирует графический интерфейс, обрабатывает пользовательский ввод и выполняет математические операции.
+* Параметры командной строки:
+* --record <файл> записывает нажатия кнопок сеанса для calculator_replay;
+* --startup-report печатает продолжительность фаз запуска и время до готовности к работе;
+* --lazy-ui показывает окно с основными кнопками сразу, а второстепенные строит в фоновом потоке;
+* --exit-after-startup завершает работу, как только приложение готово к работе (для бенчмарка запуска);
+* --plot <выражение> открывает вместо калькулятора окно графика y = f(x) (можно указать несколько раз);
+* --implicit <отношение> добавляет в окно графика кривую вида "x^2 + y^2 = 25" (можно указать несколько раз);
+* --heatmap <выражение> рисует под графиками тепловую карту f(x, y);
+* --series <файл> добавляет в окно графика ряд данных из строк "x y" (можно указать несколько раз);
+* --parametric "<x(t)>; <y(t)>[; tMin; tMax]" добавляет параметрическую кривую (можно указать несколько раз);
+* --polar "<r(t)>[; tMin; tMax]" добавляет полярную кривую, угол t в градусах (можно указать несколько раз);
+* --surface <выражение> открывает трёхмерное окно поверхности z = f(x, y) с программной растеризацией.
+* Клавиша F3 включает и выключает оверлей производительности.
 * @return int Код завершения программы (0 - успешное выполнение)
 */
-int main() {
+int main(int argc, char* argv[]) {
+    StartupState startup;
+    std::unique_ptr<InputRecorder> recorder;
+    bool lazyUi = false;
+    bool exitAfterStartup = false;
+    PlotWindowOptions plotOptions;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--startup-report")
+            startup.report = true;
+        else if (arg == "--lazy-ui")
+            lazyUi = true;
+        else if (arg == "--exit-after-startup")
+            exitAfterStartup = true;
+        else if (arg == "--plot" && i + 1 < argc)
+            plotOptions.functions.push_back(argv[++i]);
+        else if (arg == "--implicit" && i + 1 < argc)
+            plotOptions.relations.push_back(argv[++i]);
+        else if (arg == "--heatmap" && i + 1 < argc)
+            plotOptions.heatmap = argv[++i];
+        else if (arg == "--series" && i + 1 < argc)
+            plotOptions.series.push_back(argv[++i]);
+        else if (arg == "--parametric" && i + 1 < argc)
+            plotOptions.parametric.push_back(argv[++i]);
+        else if (arg == "--polar" && i + 1 < argc)
+            plotOptions.polar.push_back(argv[++i]);
+        else if (arg == "--surface" && i + 1 < argc)
+            plotOptions.surface = argv[++i];
+        else if (arg == "--record" && i + 1 < argc) {
+            try {
+                recorder = std::make_unique<InputRecorder>(argv[++i]);
+            }
+            catch (const std::exception& ex) {
+                std::cerr << ex.what() << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    if (!plotOptions.functions.empty() || !plotOptions.relations.empty() || !plotOptions.series.empty() ||
+        !plotOptions.heatmap.empty() || !plotOptions.parametric.empty() || !plotOptions.polar.empty() ||
+        !plotOptions.surface.empty())
+        return runPlotWindow(plotOptions);
+
     const int windowWidth = 500;
     const int windowHeight = 700;
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Calculator");
+    startup.profiler.mark("window creation");
 
     sf::Font font;
-    if (!font.loadFromFile("Sansation_Bold.ttf")) {
-        std::cerr << "Ошибка загрузки шрифта Sansation_Bold.ttf" << std::endl;
+    GlyphAtlas atlas;
+    if (!font.loadFromMemory(kEmbeddedFontData, kEmbeddedFontSize) || !atlas.load()) {
+        std::cerr << "Ошибка загрузки встроенного шрифта Sansation_Bold.ttf" << std::endl;
         return -1;
     }
+    startup.profiler.mark("font load");
 
-    sf::Text display;
-    display.setFont(font);
-    display.setCharacterSize(24);
+    AtlasText display;
+    display.setAtlas(atlas);
     display.setFillColor(sf::Color::White);
     display.setPosition(10, 10);
 
-    std::string expression;
+    KeyDispatcher dispatcher;
     std::vector<std::string> buttonLabels = {
         "7", "8", "9", "+", "-",
         "4", "5", "6", "*", "/",
@@ -49,162 +493,123 @@ int main() {
         "±", "Exit"
     };
 
-    std::vector<Button> buttons;
-    const int margin = 10;   
+    ButtonLayout layout;
+    layout.cols = 5;
+    layout.margin = 10;
     const int displayHeight = 50;
-    const int gridTop = displayHeight + 20; 
-    const int gridHeight = windowHeight - gridTop - margin;
+    layout.gridTop = displayHeight + 20;
+    const int gridHeight = windowHeight - layout.gridTop - layout.margin;
+    int rows = (buttonLabels.size() + layout.cols - 1) / layout.cols;
+    layout.btnWidth = (windowWidth - (layout.cols + 1) * layout.margin) / static_cast<float>(layout.cols);
+    layout.btnHeight = (gridHeight - (rows + 1) * layout.margin) / static_cast<float>(rows);
+
+    ButtonPanels panels;
+    for (size_t i = 0; i < buttonLabels.size(); i++) {
+        if (!lazyUi || !isSecondaryLabel(buttonLabels[i]))
+            panels.primary.push_back(makeButton(buttonLabels[i], i, layout, atlas));
+    }
+    std::thread secondaryBuilder;
+    if (lazyUi) {
+        startup.profiler.mark("primary button construction");
+        secondaryBuilder = std::thread([&]() {
+            auto begin = StartupProfiler::Clock::now();
+            for (size_t i = 0; i < buttonLabels.size(); i++) {
+                if (isSecondaryLabel(buttonLabels[i]))
+                    panels.secondary.push_back(makeButton(buttonLabels[i], i, layout, atlas));
+            }
+            panels.secondaryReady.store(true, std::memory_order_release);
+            startup.profiler.mark("secondary button construction (background)", begin);
+            finishStartupStep(startup);
+        });
+    }
+    else {
+        startup.profiler.mark("button construction");
+        finishStartupStep(startup);
+    }
 
-    const int cols = 5;
-    int rows = (buttonLabels.size() + cols - 1) / cols;  
+    PerfHud hud(font);
+    TripleBuffer<UiSnapshot> snapshots;
+    std::atomic<bool> running(true);
+    window.setVerticalSyncEnabled(true);
+    window.setActive(false);
+    std::thread renderThread(renderLoop, std::ref(window), std::ref(display), std::cref(panels), std::cref(atlas),
+        std::ref(hud), std::ref(snapshots), std::cref(running), std::ref(startup));
 
-    float btnWidth = (windowWidth - (cols + 1) * margin) / static_cast<float>(cols);
-    float btnHeight = (gridHeight - (rows + 1) * margin) / static_cast<float>(rows);
+    CALC_TRACE_THREAD_NAME("input");
+    bool quit = false;
+    sf::Event event;
+    if (exitAfterStartup) {
+        while (startup.pendingSteps.load(std::memory_order_acquire) > 0) {
+            while (window.pollEvent(event)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        quit = true;
+    }
+    bool hudEnabled = false;
+    auto publish = [&](std::chrono::steady_clock::time_point inputTime, uint64_t evaluationNs) {
+        UiSnapshot& snapshot = snapshots.writeBuffer();
+        snapshot.displayText = dispatcher.engine.display();
+        snapshot.hudEnabled = hudEnabled;
+        snapshot.inputTime = inputTime;
+        snapshot.evaluationNs = evaluationNs;
+        snapshot.evaluation = dispatcher.pending ? dispatcher.pending->control : nullptr;
+        snapshots.publish();
+    };
 
-    for (size_t i = 0; i < buttonLabels.size(); i++) {
-        int row = i / cols;
-        int col = i % cols;
-        float posX = margin + col * (btnWidth + margin);
-        float posY = gridTop + margin + row * (btnHeight + margin);
-
-        Button btn;
-        btn.label = buttonLabels[i];
-        btn.shape.setSize(sf::Vector2f(btnWidth, btnHeight));
-        btn.shape.setFillColor(sf::Color(100, 100, 100));
-        btn.shape.setPosition(posX, posY);
-
-        btn.text.setFont(font);
-        btn.text.setString(btn.label);
-        btn.text.setCharacterSize(24);
-        btn.text.setFillColor(sf::Color::White);
-
-        sf::FloatRect textRect = btn.text.getLocalBounds();
-        btn.text.setOrigin(textRect.left + textRect.width / 2.0f,
-            textRect.top + textRect.height / 2.0f);
-        btn.text.setPosition(posX + btnWidth / 2.0f, posY + btnHeight / 2.0f);
-
-        buttons.push_back(btn);
-    }
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mousePos(event.mouseButton.x, event.mouseButton.y);
-                    for (auto& btn : buttons) {
-                        if (btn.shape.getGlobalBounds().contains(mousePos)) {
-                            std::string key = btn.label;
-                            if (key == "Exit") {
-                                window.close();
-                                continue;
-                            }
-                            if (expression == "Error" && key != "C") {
-                                expression = "";
-                            }
-                            if (key == "C") {
-                                expression = "";
-                            }
-                            else if (key == "=") {
-                                try {
-                                    size_t opPos = std::string::npos;
-                                    for (size_t i = 1; i < expression.size(); ++i) {
-                                        char c = expression[i];
-                                        if (c == '+' || c == '-' || c == '*' || c == '/' || c == '^') {
-                                            if (c == '-') {
-                                                continue;  
-                                            }
-                                            opPos = i;
-                                            break;
-                                        }
-                                    }
-                                    if (opPos != std::string::npos) {
-                                        std::string left = expression.substr(0, opPos);
-                                        std::string right = expression.substr(opPos + 1);
-                                        char op = expression[opPos];
-                                        double a = std::stod(left);
-                                        double b = std::stod(right);
-                                        double result = applyBinaryOperation(a, std::string(1, op), b);
-                                        expression = std::to_string(result);
-                                    }
-                                }
-                                catch (const std::exception& ex) {
-                                    expression = "Error";
-                                }
-                            }
-                            else if (key == "x!") {
-                                try {
-                                    double val = std::stod(expression);
-                                    double res = factorial(val);
-                                    expression = std::to_string(res);
-                                }
-                                catch (const std::exception& ex) {
-                                    expression = "Error";
-                                }
-                            }
-                            else if (key == "sin" || key == "cos" ||
-                                key == "tan" || key == "cot") {
-                                try {
-                                    double angle = std::stod(expression);
-                                    double res = applyTrigonometricOperation(angle, key);
-                                    expression = std::to_string(res);
-                                }
-                                catch (const std::exception& ex) {
-                                    expression = "Error";
-                                }
-                            }
-                            else if (key.find("-cc") != std::string::npos) {
-                                try {
-                                    size_t pos = key.find("-cc");
-                                    int targetBase = std::stoi(key.substr(0, pos));
-                                    expression = convertBase(expression, 10, targetBase);
-                                }
-                                catch (const std::exception& ex) {
-                                    expression = "Error";
-                                }
-                            }
-                            else if (key == "±") {
-                                if (expression.empty()) {
-                                    expression = "-";
-                                }
-                                else {
-                                    if (expression[0] == '-') {
-                                        expression = expression.substr(1);
-                                    }
-                                    else {
-                                        expression = "-" + expression;
-                                    }
-                                }
-                            }
-                            else if (key == "+" || key == "-" || key == "*" || key == "/" || key == "^") {
-                                std::string operators = "+-*/^";
-                                if (expression.empty() ||
-                                    operators.find(expression.back()) != std::string::npos) {
-                                    expression = "Error";
-                                }
-                                else {
-                                    expression += key;
-                                }
-                            }
-                            else {
-                                expression += key;
-                            }
-                            display.setString(expression);
-                        }
-                    }
+    std::vector<std::string> batch;
+    while (!quit) {
+        // Пока идёт вычисление, поток ввода не засыпает в waitEvent, а опрашивает его готовность
+        if (dispatcher.pending) {
+            if (!window.pollEvent(event)) {
+                if (dispatcher.poll()) {
+                    auto now = std::chrono::steady_clock::now();
+                    publish(dispatcher.pendingSince, hudEnabled ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now - dispatcher.pendingSince).count() : 0);
                 }
+                else
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
             }
         }
-        window.clear(sf::Color::Black);
-        window.draw(display);
-        for (auto& btn : buttons) {
-            window.draw(btn.shape);
-            window.draw(btn.text);
+        else if (!window.waitEvent(event))
+            break;
+
+        auto inputTime = std::chrono::steady_clock::now();
+        CALC_TRACE_SCOPE("input batch");
+        bool hudToggled = false;
+        batch.clear();
+        do {
+            CALC_TRACE_SCOPE("poll/collect event");
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                hudEnabled = !hudEnabled;
+                hudToggled = true;
+            }
+            else if (!collectKeys(event, panels, batch))
+                quit = true;
+        } while (!quit && window.pollEvent(event));
+
+        if (quit || (batch.empty() && !hudToggled))
+            continue;
+        CALC_TRACE_SCOPE("dispatch batch");
+        auto evaluationStart = std::chrono::steady_clock::now();
+        for (const auto& key : batch) {
+            if (recorder)
+                recorder->record(key);
+            dispatcher.press(key, inputTime);
         }
-        window.display();
+        publish(inputTime, hudEnabled ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - evaluationStart).count() : 0);
     }
+    dispatcher.cancel();
+    running.store(false, std::memory_order_release);
+    renderThread.join();
+    if (secondaryBuilder.joinable())
+        secondaryBuilder.join();
+    window.close();
+#ifdef CALC_ENABLE_TRACING
+    if (!traceWriteChromeJson("calculator_trace.json"))
+        std::cerr << "Cannot write calculator_trace.json" << std::endl;
+#endif
     return 0;
 }
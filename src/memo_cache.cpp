@@ -0,0 +1,132 @@
+#include "memo_cache.h"
+#include "evaluation_control.h"
+#include "trace.h"
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Перемешивание битов слова (финализатор splitmix64)
+ */
+static uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+static uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+MemoCache::MemoCache(size_t capacity) : operations_(capacity), conversions_(capacity) {
+}
+
+MemoCache::OperationKey MemoCache::makeKey(Operation op, double a, double b, uint64_t& hash) {
+    OperationKey key;
+    key.op = static_cast<uint64_t>(op);
+    key.a = doubleBits(a);
+    key.b = op >= Operation::Factorial ? 0 : doubleBits(b);
+    hash = mix(mix(mix(key.op) ^ key.a) ^ key.b);
+    return key;
+}
+
+bool MemoCache::findOperation(const OperationKey& key, uint64_t hash, double& result, MathError& error) const {
+    OperationValue value;
+    if (!operations_.find(key, hash, value))
+        return false;
+    result = value.result;
+    error = static_cast<MathError>(value.error);
+    return true;
+}
+
+void MemoCache::storeOperation(const OperationKey& key, uint64_t hash, double result, MathError error) {
+    OperationValue value;
+    value.result = result;
+    value.error = static_cast<uint64_t>(error);
+    operations_.insert(key, hash, value);
+}
+
+MathError MemoCache::tryEvaluate(Operation op, double a, double b, double& result) {
+    uint64_t hash;
+    OperationKey key = makeKey(op, a, b, hash);
+    double cached = 0.0;
+    MathError error = MathError::None;
+    if (!findOperation(key, hash, cached, error)) {
+        error = ::tryEvaluate(op, a, b, cached);
+        storeOperation(key, hash, cached, error);
+    }
+    if (error == MathError::None)
+        result = cached;
+    return error;
+}
+
+double MemoCache::evaluate(Operation op, double a, double b) {
+    double result = 0.0;
+    MathError error = tryEvaluate(op, a, b, result);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return result;
+}
+
+double MemoCache::factorial(double x, EvaluationControl& control) {
+    uint64_t hash;
+    OperationKey key = makeKey(Operation::Factorial, x, 0.0, hash);
+    double result = 0.0;
+    MathError error = MathError::None;
+    if (findOperation(key, hash, result, error)) {
+        if (error != MathError::None)
+            throw std::runtime_error(mathErrorMessage(error));
+        return result;
+    }
+    try {
+        result = ::factorial(x, control);
+    }
+    catch (const EvaluationCancelled&) {
+        throw;
+    }
+    catch (const std::runtime_error&) {
+        storeOperation(key, hash, 0.0, MathError::FactorialDomain);
+        throw;
+    }
+    storeOperation(key, hash, result, MathError::None);
+    return result;
+}
+
+std::string MemoCache::convertBase(const std::string& numberStr, int fromBase, int toBase, EvaluationControl* control) {
+    if (numberStr.size() > kMaxCachedDigits)
+        return control ? ::convertBase(numberStr, fromBase, toBase, *control) : ::convertBase(numberStr, fromBase, toBase);
+    CALC_TRACE_SCOPE("MemoCache::convertBase");
+    ConversionKey key;
+    std::memset(&key, 0, sizeof(key));
+    key.fromBase = static_cast<uint32_t>(fromBase);
+    key.toBase = static_cast<uint32_t>(toBase);
+    key.length = numberStr.size();
+    std::memcpy(key.digits, numberStr.data(), numberStr.size());
+    uint64_t hash = mix((static_cast<uint64_t>(key.fromBase) << 32 | key.toBase) ^ mix(key.length));
+    for (size_t i = 0; i < sizeof(key.digits) / 8; i++) {
+        uint64_t word;
+        std::memcpy(&word, key.digits + i * 8, sizeof(word));
+        hash = mix(hash ^ word);
+    }
+
+    ConversionValue value;
+    if (conversions_.find(key, hash, value))
+        return value.text;
+    std::string result = control ? ::convertBase(numberStr, fromBase, toBase, *control)
+        : ::convertBase(numberStr, fromBase, toBase);
+    if (result.size() < sizeof(value.text)) {
+        std::memset(&value, 0, sizeof(value));
+        std::memcpy(value.text, result.data(), result.size());
+        conversions_.insert(key, hash, value);
+    }
+    return result;
+}
+
+void MemoCache::clear() {
+    operations_.clear();
+    conversions_.clear();
+}
@@ -0,0 +1,254 @@
+#include "parametric_sampler.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Делит запись на части по ';'
+ */
+static std::vector<std::string> splitSpec(const std::string& spec) {
+    std::vector<std::string> parts;
+    size_t begin = 0;
+    while (true) {
+        size_t end = spec.find(';', begin);
+        parts.push_back(spec.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+        if (end == std::string::npos)
+            return parts;
+        begin = end + 1;
+    }
+}
+
+/**
+ * @brief Значение константного выражения (границы диапазона параметра)
+ */
+static double parseBound(const std::string& text) {
+    double value = 0.0;
+    MathError error = Expression::parse(text, {}).evaluate(nullptr, value);
+    if (error != MathError::None)
+        throw std::runtime_error(mathErrorMessage(error));
+    return value;
+}
+
+static void checkRange(double tMin, double tMax) {
+    if (!(tMin < tMax) || !std::isfinite(tMin) || !std::isfinite(tMax))
+        throw std::runtime_error("Invalid parameter range");
+}
+
+ParametricCurve ParametricCurve::parametric(const std::string& x, const std::string& y, double tMin, double tMax) {
+    checkRange(tMin, tMax);
+    ParametricCurve curve;
+    curve.x_ = Expression::parse(x, { "t" });
+    curve.y_ = Expression::parse(y, { "t" });
+    curve.tMin_ = tMin;
+    curve.tMax_ = tMax;
+    return curve;
+}
+
+ParametricCurve ParametricCurve::polar(const std::string& r, double tMin, double tMax) {
+    checkRange(tMin, tMax);
+    ParametricCurve curve;
+    curve.x_ = Expression::parse(r, { "t" });
+    curve.polar_ = true;
+    curve.tMin_ = tMin;
+    curve.tMax_ = tMax;
+    return curve;
+}
+
+ParametricCurve ParametricCurve::parse(const std::string& spec) {
+    std::vector<std::string> parts = splitSpec(spec);
+    if (parts.size() == 2)
+        return parametric(parts[0], parts[1], 0.0, 360.0);
+    if (parts.size() == 4)
+        return parametric(parts[0], parts[1], parseBound(parts[2]), parseBound(parts[3]));
+    throw std::runtime_error("Parametric curve must be 'x; y' or 'x; y; tMin; tMax'");
+}
+
+ParametricCurve ParametricCurve::parsePolar(const std::string& spec) {
+    std::vector<std::string> parts = splitSpec(spec);
+    if (parts.size() == 1)
+        return polar(parts[0]);
+    if (parts.size() == 3)
+        return polar(parts[0], parseBound(parts[1]), parseBound(parts[2]));
+    throw std::runtime_error("Polar curve must be 'r' or 'r; tMin; tMax'");
+}
+
+void ParametricCurve::evaluateBatch(const double* t, double* x, double* y, size_t count) const {
+    if (!polar_) {
+        x_.evaluateBatch(t, x, count);
+        y_.evaluateBatch(t, y, count);
+        return;
+    }
+    std::vector<double> r(count);
+    x_.evaluateBatch(t, r.data(), count);
+    evaluateVector(Operation::Cos, t, nullptr, x, count);
+    evaluateVector(Operation::Multiply, r.data(), x, x, count);
+    evaluateVector(Operation::Sin, t, nullptr, y, count);
+    evaluateVector(Operation::Multiply, r.data(), y, y, count);
+}
+
+PlotPoint ParametricCurve::operator()(double t) const {
+    PlotPoint point;
+    evaluateBatch(&t, &point.x, &point.y, 1);
+    return point;
+}
+
+/**
+ * @brief Точка кривой вместе со значением параметра
+ */
+struct CurveSample {
+    double t;
+    PlotPoint point;
+};
+
+/**
+ * @brief Причина деления отрезка кривой
+ */
+enum class CurveRefinement {
+    None,
+    Curvature,
+    Discontinuity
+};
+
+static bool defined(const PlotPoint& point) {
+    return std::isfinite(point.x) && std::isfinite(point.y);
+}
+
+/**
+ * @brief Расстояние от точки p до отрезка ab на плоскости
+ */
+static double segmentDistance(double px, double py, double ax, double ay, double bx, double by) {
+    double dx = bx - ax;
+    double dy = by - ay;
+    double length2 = dx * dx + dy * dy;
+    double s = length2 > 0.0 ? std::min(std::max(((px - ax) * dx + (py - ay) * dy) / length2, 0.0), 1.0) : 0.0;
+    return std::hypot(px - (ax + s * dx), py - (ay + s * dy));
+}
+
+/**
+ * @brief Решает, нужно ли делить отрезок кривой с серединой m, и возвращает длину ломаной a-m-b в пикселях
+ */
+static CurveRefinement classify(const PlotPoint& a, const PlotPoint& m, const PlotPoint& b, const PlotViewport& viewport,
+    double tolerance, double& length) {
+    length = 0.0;
+    bool fa = defined(a);
+    bool fm = defined(m);
+    bool fb = defined(b);
+    if (!fa && !fm && !fb)
+        return CurveRefinement::None;
+    if (!fa || !fm || !fb)
+        return CurveRefinement::Discontinuity;
+    double ax = viewport.toScreenX(a.x);
+    double ay = viewport.toScreenY(a.y);
+    double mx = viewport.toScreenX(m.x);
+    double my = viewport.toScreenY(m.y);
+    double bx = viewport.toScreenX(b.x);
+    double by = viewport.toScreenY(b.y);
+    // Изгибы за пределами экрана не видны
+    if ((ax < 0 && mx < 0 && bx < 0) || (ax > viewport.width && mx > viewport.width && bx > viewport.width) ||
+        (ay < 0 && my < 0 && by < 0) || (ay > viewport.height && my > viewport.height && by > viewport.height))
+        return CurveRefinement::None;
+    double first = std::hypot(mx - ax, my - ay);
+    double second = std::hypot(bx - mx, by - my);
+    length = first + second;
+    if (first > viewport.height || second > viewport.height)
+        return CurveRefinement::Discontinuity;
+    if (segmentDistance(mx, my, ax, ay, bx, by) > tolerance)
+        return CurveRefinement::Curvature;
+    return CurveRefinement::None;
+}
+
+ParametricSampleStats ParametricSampler::sample(const ParametricCurve& curve, const PlotViewport& viewport,
+    std::vector<PlotPoint>& out) const {
+    CALC_TRACE_SCOPE("ParametricSampler::sample");
+    ParametricSampleStats stats;
+    int segments = std::max(options_.initialSamples, 1);
+    std::vector<double> ts(segments + 1);
+    for (int i = 0; i <= segments; i++)
+        ts[i] = curve.tMin() + (curve.tMax() - curve.tMin()) * i / segments;
+    std::vector<double> xs(ts.size());
+    std::vector<double> ys(ts.size());
+    curve.evaluateBatch(ts.data(), xs.data(), ys.data(), ts.size());
+    stats.evaluations += ts.size();
+    std::vector<CurveSample> samples(ts.size());
+    for (size_t i = 0; i < ts.size(); i++)
+        samples[i] = { ts[i], { xs[i], ys[i] } };
+
+    // Первый проход делит все отрезки начальной сетки, следующие — только отмеченные
+    std::vector<char> active(samples.size() - 1, 1);
+    std::vector<CurveSample> next;
+    std::vector<char> nextActive;
+    for (int depth = 0; depth <= options_.maxDepth; depth++) {
+        ts.clear();
+        for (size_t i = 0; i + 1 < samples.size(); i++) {
+            if (active[i])
+                ts.push_back(0.5 * (samples[i].t + samples[i + 1].t));
+        }
+        if (ts.empty())
+            break;
+        xs.resize(ts.size());
+        ys.resize(ts.size());
+        curve.evaluateBatch(ts.data(), xs.data(), ys.data(), ts.size());
+        stats.evaluations += ts.size();
+
+        next.clear();
+        nextActive.clear();
+        size_t k = 0;
+        for (size_t i = 0; i + 1 < samples.size(); i++) {
+            next.push_back(samples[i]);
+            if (!active[i]) {
+                nextActive.push_back(0);
+                continue;
+            }
+            CurveSample middle{ ts[k], { xs[k], ys[k] } };
+            k++;
+            double length = 0.0;
+            CurveRefinement refinement = classify(samples[i].point, middle.point, samples[i + 1].point, viewport,
+                options_.tolerance, length);
+            bool split = refinement == CurveRefinement::Discontinuity ||
+                (refinement == CurveRefinement::Curvature && length >= options_.minLength);
+            // Середина почти прямого, невидимого или неопределённого отрезка в ломаную не входит
+            if (refinement == CurveRefinement::None) {
+                nextActive.push_back(0);
+                continue;
+            }
+            next.push_back(middle);
+            nextActive.push_back(split);
+            nextActive.push_back(split);
+        }
+        next.push_back(samples.back());
+        samples.swap(next);
+        active.swap(nextActive);
+    }
+
+    out.clear();
+    out.reserve(samples.size() + 16);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (i > 0) {
+            const PlotPoint& a = samples[i - 1].point;
+            const PlotPoint& b = samples[i].point;
+            bool fa = defined(a);
+            bool fb = defined(b);
+            if (fa && fb) {
+                double ax = viewport.toScreenX(a.x);
+                double ay = viewport.toScreenY(a.y);
+                double bx = viewport.toScreenX(b.x);
+                double by = viewport.toScreenY(b.y);
+                // Скачок важен, только если соединяющий отрезок пересёк бы экран
+                bool crosses = std::min(ax, bx) < viewport.width && std::max(ax, bx) > 0.0 &&
+                    std::min(ay, by) < viewport.height && std::max(ay, by) > 0.0;
+                if (std::hypot(bx - ax, by - ay) > viewport.height && crosses) {
+                    out.push_back({ nan, nan });
+                    stats.breaks++;
+                }
+            }
+            else if (fa != fb)
+                stats.breaks++;
+        }
+        out.push_back(samples[i].point);
+    }
+    stats.points = out.size();
+    return stats;
+}
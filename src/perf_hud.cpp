@@ -0,0 +1,62 @@
+#include "perf_hud.h"
+#include "trace.h"
+#include <cstdio>
+
+/**
+ * @brief Число кадров между обновлениями текста оверлея
+ *
+ * Текст перестраивается не каждый кадр, чтобы сам оверлей не искажал время кадра.
+ */
+static const unsigned kFramesPerUpdate = 15;
+
+PerfHud::PerfHud(const sf::Font& font) {
+    background_.setFillColor(sf::Color(0, 0, 0, 180));
+    background_.setPosition(290, 5);
+    text_.setFont(font);
+    text_.setCharacterSize(14);
+    text_.setFillColor(sf::Color::Green);
+    text_.setPosition(295, 8);
+}
+
+void PerfHud::setEnabled(bool enabled) {
+    if (enabled == enabled_)
+        return;
+    enabled_ = enabled;
+    frameTimes_.clear();
+    inputLatency_.clear();
+    lastEvaluationNs_ = 0;
+    framesSinceUpdate_ = kFramesPerUpdate;
+}
+
+void PerfHud::recordFrame(uint64_t frameNs, unsigned drawCalls) {
+    frameTimes_.push(frameNs);
+    lastDrawCalls_ = drawCalls;
+    framesSinceUpdate_++;
+}
+
+unsigned PerfHud::draw(sf::RenderTarget& target) {
+    if (!enabled_)
+        return 0;
+    if (framesSinceUpdate_ >= kFramesPerUpdate) {
+        CALC_TRACE_SCOPE("layout hud");
+        framesSinceUpdate_ = 0;
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+            "frame %.2f ms (p99 %.2f)\n"
+            "draw calls %u\n"
+            "eval %.1f us\n"
+            "input p50 %.2f ms\n"
+            "input p99 %.2f ms",
+            frameTimes_.mean() / 1e6, frameTimes_.percentile(99) / 1e6,
+            lastDrawCalls_,
+            lastEvaluationNs_ / 1e3,
+            inputLatency_.percentile(50) / 1e6, inputLatency_.percentile(99) / 1e6);
+        text_.setString(buffer);
+        sf::FloatRect bounds = text_.getGlobalBounds();
+        background_.setSize(sf::Vector2f(bounds.left + bounds.width + 5, bounds.top + bounds.height + 5) -
+            background_.getPosition());
+    }
+    target.draw(background_);
+    target.draw(text_);
+    return 2;
+}
@@ -0,0 +1,331 @@
+#include "plot_canvas.h"
+#include <algorithm>
+#include <cmath>
+#include "coverage_rasterizer.h"
+
+std::shared_ptr<const GlyphBitmap> GlyphCache::glyph(uint32_t codepoint, float pixelSize) {
+    std::pair<uint32_t, int> key(codepoint, static_cast<int>(std::lround(pixelSize * 64.0f)));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = glyphs_.find(key);
+        if (found != glyphs_.end())
+            return found->second;
+    }
+    // Растеризация вне блокировки: другие потоки не ждут; при гонке остаётся первый результат
+    auto bitmap = std::make_shared<const GlyphBitmap>(font_.rasterize(font_.glyphIndex(codepoint), pixelSize));
+    std::lock_guard<std::mutex> lock(mutex_);
+    return glyphs_.emplace(key, bitmap).first->second;
+}
+
+float GlyphCache::measure(const std::string& text, float pixelSize) {
+    float width = 0.0f;
+    for (unsigned char c : text)
+        width += glyph(c, pixelSize)->advance;
+    return width;
+}
+
+PlotCanvas::PlotCanvas(int width, int height, RgbaColor background)
+    : width_(width), height_(height), pixels_(static_cast<size_t>(width) * height * 4) {
+    for (size_t i = 0; i < pixels_.size(); i += 4) {
+        pixels_[i] = background.r;
+        pixels_[i + 1] = background.g;
+        pixels_[i + 2] = background.b;
+        pixels_[i + 3] = background.a;
+    }
+}
+
+PlotCanvas::Layer& PlotCanvas::layerFor(RgbaColor color, bool text) {
+    if (!layers_.empty()) {
+        Layer& last = layers_.back();
+        bool sameColor = last.color.r == color.r && last.color.g == color.g && last.color.b == color.b &&
+            last.color.a == color.a;
+        if (sameColor && last.glyphs.empty() == !text && last.edges.empty() == text)
+            return last;
+    }
+    Layer layer;
+    layer.color = color;
+    layer.yMin = static_cast<float>(height_);
+    layer.yMax = 0.0f;
+    layers_.push_back(std::move(layer));
+    return layers_.back();
+}
+
+void PlotCanvas::addPolygon(const float* corners, int count, Layer& layer) {
+    for (int i = 0; i < count; i++) {
+        int j = (i + 1) % count;
+        layer.edges.push_back({ corners[i * 2], corners[i * 2 + 1], corners[j * 2], corners[j * 2 + 1] });
+        layer.yMin = std::min(layer.yMin, corners[i * 2 + 1]);
+        layer.yMax = std::max(layer.yMax, corners[i * 2 + 1]);
+    }
+}
+
+/**
+ * @brief Обрезает отрезок прямоугольником (алгоритм Лианга — Барски)
+ * @return false, если отрезок целиком вне прямоугольника
+ */
+static bool clipSegment(float& x0, float& y0, float& x1, float& y1, float xMin, float yMin, float xMax, float yMax) {
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    const float p[4] = { -dx, dx, -dy, dy };
+    const float q[4] = { x0 - xMin, xMax - x0, y0 - yMin, yMax - y0 };
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f)
+                return false;
+            continue;
+        }
+        float t = q[i] / p[i];
+        if (p[i] < 0.0f)
+            t0 = std::max(t0, t);
+        else
+            t1 = std::min(t1, t);
+        if (t0 > t1)
+            return false;
+    }
+    float sx = x0;
+    float sy = y0;
+    x0 = sx + t0 * dx;
+    y0 = sy + t0 * dy;
+    x1 = sx + t1 * dx;
+    y1 = sy + t1 * dy;
+    return true;
+}
+
+void PlotCanvas::strokeLine(float x0, float y0, float x1, float y1, float width, RgbaColor color) {
+    float xy[4] = { x0, y0, x1, y1 };
+    strokePolyline(xy, 2, width, color);
+}
+
+/**
+ * @brief Прореживает участок ломаной: точка пропускается, если все пропущенные с последней оставленной
+ * лежат ближе tolerance к хорде
+ *
+ * Адаптивная выборка у полюсов даёт точки через доли пикселя; без прореживания
+ * на каждую приходилось бы по контуру с кромкой сглаживания.
+ */
+static void simplifyRun(std::vector<float>& run, float tolerance) {
+    const size_t kMaxSkipped = 32;
+    size_t count = run.size() / 2;
+    if (count < 3)
+        return;
+    size_t kept = 1;
+    size_t anchor = 0;
+    for (size_t i = 2; i < count; i++) {
+        float ax = run[anchor * 2];
+        float ay = run[anchor * 2 + 1];
+        float dx = run[i * 2] - ax;
+        float dy = run[i * 2 + 1] - ay;
+        float length = std::sqrt(dx * dx + dy * dy);
+        bool fits = i - anchor - 1 <= kMaxSkipped && length > 0.0f;
+        for (size_t k = anchor + 1; fits && k < i; k++) {
+            float distance = std::fabs((run[k * 2] - ax) * dy - (run[k * 2 + 1] - ay) * dx) / length;
+            fits = distance <= tolerance;
+        }
+        if (!fits) {
+            // Точка i - 1 становится опорной
+            anchor = i - 1;
+            run[kept * 2] = run[anchor * 2];
+            run[kept * 2 + 1] = run[anchor * 2 + 1];
+            kept++;
+        }
+    }
+    run[kept * 2] = run[(count - 1) * 2];
+    run[kept * 2 + 1] = run[(count - 1) * 2 + 1];
+    run.resize((kept + 1) * 2);
+}
+
+void PlotCanvas::strokeRun(const std::vector<float>& run, float width, Layer& layer) {
+    float half = width * 0.5f;
+    size_t count = run.size() / 2;
+    float previousNx = 0.0f;
+    float previousNy = 0.0f;
+    for (size_t i = 1; i < count; i++) {
+        float x0 = run[(i - 1) * 2];
+        float y0 = run[(i - 1) * 2 + 1];
+        float x1 = run[i * 2];
+        float y1 = run[i * 2 + 1];
+        float dx = x1 - x0;
+        float dy = y1 - y0;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < 1e-6f) {
+            dx = 1.0f;
+            dy = 0.0f;
+        }
+        else {
+            dx /= length;
+            dy /= length;
+        }
+        float nx = -dy * half;
+        float ny = dx * half;
+        // Концы ломаной продлеваются на полтолщины (квадратные концы)
+        float startX = i == 1 ? dx * half : 0.0f;
+        float startY = i == 1 ? dy * half : 0.0f;
+        float endX = i + 1 == count ? dx * half : 0.0f;
+        float endY = i + 1 == count ? dy * half : 0.0f;
+        const float quad[8] = {
+            x0 - startX + nx, y0 - startY + ny,
+            x1 + endX + nx, y1 + endY + ny,
+            x1 + endX - nx, y1 + endY - ny,
+            x0 - startX - nx, y0 - startY - ny,
+        };
+        addPolygon(quad, 4, layer);
+        if (i > 1) {
+            // Излом заполняется треугольником с внешней стороны; он касается соседних
+            // контуров по общим рёбрам, поэтому покрытие кромки не удваивается
+            float side = previousNx * dx + previousNy * dy > 0.0f ? -1.0f : 1.0f;
+            float wedge[6] = { x0, y0, x0 + side * previousNx, y0 + side * previousNy, x0 + side * nx, y0 + side * ny };
+            float area = (wedge[2] - wedge[0]) * (wedge[5] - wedge[1]) - (wedge[4] - wedge[0]) * (wedge[3] - wedge[1]);
+            // Все контуры обходятся в одном направлении (отрицательная площадь, как у прямоугольников отрезков)
+            if (area > 0.0f) {
+                std::swap(wedge[2], wedge[4]);
+                std::swap(wedge[3], wedge[5]);
+            }
+            addPolygon(wedge, 3, layer);
+        }
+        previousNx = nx;
+        previousNy = ny;
+    }
+}
+
+void PlotCanvas::strokePolyline(const float* xy, size_t count, float width, RgbaColor color) {
+    Layer& layer = layerFor(color, false);
+    // Отрезки обрезаются холстом с запасом на толщину, чтобы не копить огромные координаты у полюсов;
+    // отрезок, вышедший за запас, завершает участок ломаной
+    float margin = width + 2.0f;
+    std::vector<float> run;
+    auto flush = [&]() {
+        simplifyRun(run, 0.05f);
+        if (run.size() >= 4)
+            strokeRun(run, width, layer);
+        run.clear();
+    };
+    for (size_t i = 1; i < count; i++) {
+        float x0 = xy[(i - 1) * 2];
+        float y0 = xy[(i - 1) * 2 + 1];
+        float x1 = xy[i * 2];
+        float y1 = xy[i * 2 + 1];
+        if (std::isnan(x0) || std::isnan(y0) || std::isnan(x1) || std::isnan(y1)) {
+            flush();
+            continue;
+        }
+        float cx0 = x0;
+        float cy0 = y0;
+        float cx1 = x1;
+        float cy1 = y1;
+        if (!clipSegment(cx0, cy0, cx1, cy1, -margin, -margin, width_ + margin, height_ + margin)) {
+            flush();
+            continue;
+        }
+        if (run.empty() || cx0 != x0 || cy0 != y0) {
+            flush();
+            run.push_back(cx0);
+            run.push_back(cy0);
+        }
+        run.push_back(cx1);
+        run.push_back(cy1);
+        if (cx1 != x1 || cy1 != y1)
+            flush();
+    }
+    flush();
+}
+
+void PlotCanvas::drawText(GlyphCache& glyphs, const std::string& text, float x, float baseline, float pixelSize,
+    RgbaColor color) {
+    Layer& layer = layerFor(color, true);
+    float pen = x;
+    int base = static_cast<int>(std::lround(baseline));
+    for (unsigned char c : text) {
+        std::shared_ptr<const GlyphBitmap> bitmap = glyphs.glyph(c, pixelSize);
+        if (bitmap->width > 0 && bitmap->height > 0) {
+            PlacedGlyph placed{ bitmap, static_cast<int>(std::lround(pen)) + bitmap->left, base + bitmap->top };
+            layer.yMin = std::min(layer.yMin, static_cast<float>(placed.y));
+            layer.yMax = std::max(layer.yMax, static_cast<float>(placed.y + bitmap->height));
+            layer.glyphs.push_back(std::move(placed));
+        }
+        pen += bitmap->advance;
+    }
+}
+
+/**
+ * @brief Смешивает цвет с пикселем с долей coverage / 255 * alpha
+ */
+static inline void blendPixel(uint8_t* pixel, const RgbaColor& color, int coverage) {
+    int alpha = coverage * color.a / 255;
+    if (alpha == 0)
+        return;
+    pixel[0] = static_cast<uint8_t>(pixel[0] + ((color.r - pixel[0]) * alpha + 127) / 255);
+    pixel[1] = static_cast<uint8_t>(pixel[1] + ((color.g - pixel[1]) * alpha + 127) / 255);
+    pixel[2] = static_cast<uint8_t>(pixel[2] + ((color.b - pixel[2]) * alpha + 127) / 255);
+    pixel[3] = static_cast<uint8_t>(pixel[3] + ((255 - pixel[3]) * alpha + 127) / 255);
+}
+
+void PlotCanvas::renderBand(int rowBegin, int rowEnd) {
+    int rows = rowEnd - rowBegin;
+    CoverageRasterizer rasterizer(width_, rows);
+    std::vector<uint8_t> coverage(static_cast<size_t>(width_) * rows);
+    float top = static_cast<float>(rowBegin);
+    float bottom = static_cast<float>(rowEnd);
+    for (const Layer& layer : layers_) {
+        if (layer.yMax <= top || layer.yMin >= bottom)
+            continue;
+        if (!layer.glyphs.empty()) {
+            for (const PlacedGlyph& placed : layer.glyphs) {
+                const GlyphBitmap& bitmap = *placed.bitmap;
+                int yBegin = std::max(placed.y, rowBegin);
+                int yEnd = std::min(placed.y + bitmap.height, rowEnd);
+                int xBegin = std::max(placed.x, 0);
+                int xEnd = std::min(placed.x + bitmap.width, width_);
+                for (int y = yBegin; y < yEnd; y++) {
+                    const uint8_t* source = &bitmap.pixels[static_cast<size_t>(y - placed.y) * bitmap.width];
+                    uint8_t* target = &pixels_[(static_cast<size_t>(y) * width_) * 4];
+                    for (int x = xBegin; x < xEnd; x++)
+                        blendPixel(target + x * 4, layer.color, source[x - placed.x]);
+                }
+            }
+            continue;
+        }
+        bool touched = false;
+        float xMin = static_cast<float>(width_);
+        float xMax = 0.0f;
+        for (const Edge& edge : layer.edges) {
+            if (std::max(edge.y0, edge.y1) <= top || std::min(edge.y0, edge.y1) >= bottom)
+                continue;
+            rasterizer.addLine(edge.x0, edge.y0 - top, edge.x1, edge.y1 - top);
+            xMin = std::min(xMin, std::min(edge.x0, edge.x1));
+            xMax = std::max(xMax, std::max(edge.x0, edge.x1));
+            touched = true;
+        }
+        if (!touched)
+            continue;
+        rasterizer.resolve(coverage.data());
+        rasterizer.clear();
+        int xBegin = std::max(0, static_cast<int>(std::floor(xMin)));
+        int xEnd = std::min(width_, static_cast<int>(std::ceil(xMax)) + 1);
+        for (int y = 0; y < rows; y++) {
+            const uint8_t* source = &coverage[static_cast<size_t>(y) * width_];
+            uint8_t* target = &pixels_[(static_cast<size_t>(rowBegin + y) * width_) * 4];
+            for (int x = xBegin; x < xEnd; x++) {
+                if (source[x] != 0)
+                    blendPixel(target + x * 4, layer.color, source[x]);
+            }
+        }
+    }
+}
+
+void PlotCanvas::render(ThreadPool* pool, int bandHeight) {
+    bandHeight = std::max(1, bandHeight);
+    size_t bands = static_cast<size_t>((height_ + bandHeight - 1) / bandHeight);
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; band++) {
+            int rowBegin = static_cast<int>(band) * bandHeight;
+            renderBand(rowBegin, std::min(height_, rowBegin + bandHeight));
+        }
+    };
+    if (pool != nullptr)
+        pool->parallelFor(0, bands, 1, body);
+    else
+        body(0, bands);
+    layers_.clear();
+}
@@ -0,0 +1,230 @@
+#include "plot_decimation.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Накопитель первой, последней, наименьшей и наибольшей точек текущего столбца пикселей
+ */
+class ColumnAccumulator {
+public:
+    ColumnAccumulator(const PlotViewport& viewport, std::vector<PlotPoint>& out)
+        : xMin_(viewport.xMin), inversePixel_(viewport.width / (viewport.xMax - viewport.xMin)), out_(out) {}
+
+    int64_t column(double x) const { return static_cast<int64_t>(std::floor((x - xMin_) * inversePixel_)); }
+
+    void add(const PlotPoint& point) {
+        if (std::isnan(point.y)) {
+            flush();
+            out_.push_back(point);
+            return;
+        }
+        int64_t c = column(point.x);
+        if (!any_ || c != column_) {
+            flush();
+            start(point, c);
+            return;
+        }
+        last_ = point;
+        if (point.y < low_.y)
+            low_ = point;
+        if (point.y > high_.y)
+            high_ = point;
+    }
+
+    /**
+     * @brief Добавляет корзину без разрывов, целиком лежащую в одном столбце
+     */
+    void add(const PlotPoint& first, const PlotPoint& last, const PlotPoint& low, const PlotPoint& high) {
+        int64_t c = column(first.x);
+        if (!any_ || c != column_) {
+            flush();
+            start(first, c);
+        }
+        last_ = last;
+        if (low.y < low_.y)
+            low_ = low;
+        if (high.y > high_.y)
+            high_ = high;
+    }
+
+    bool inOneColumn(double xFirst, double xLast) const { return column(xFirst) == column(xLast); }
+
+    void flush() {
+        if (!any_)
+            return;
+        any_ = false;
+        const PlotPoint* a = &low_;
+        const PlotPoint* b = &high_;
+        if (b->x < a->x)
+            std::swap(a, b);
+        emit(first_);
+        emit(*a);
+        emit(*b);
+        emit(last_);
+    }
+
+private:
+    void start(const PlotPoint& point, int64_t c) {
+        any_ = true;
+        column_ = c;
+        first_ = last_ = low_ = high_ = point;
+        emitted_ = out_.size();
+    }
+
+    void emit(const PlotPoint& point) {
+        if (out_.size() > emitted_ && out_.back().x == point.x && out_.back().y == point.y)
+            return;
+        out_.push_back(point);
+    }
+
+    double xMin_;
+    double inversePixel_;
+    std::vector<PlotPoint>& out_;
+    bool any_ = false;
+    int64_t column_ = 0;
+    size_t emitted_ = 0;
+    PlotPoint first_{};
+    PlotPoint last_{};
+    PlotPoint low_{};
+    PlotPoint high_{};
+};
+
+void decimateMinMax(const PlotPoint* points, size_t count, const PlotViewport& viewport, std::vector<PlotPoint>& out) {
+    CALC_TRACE_SCOPE("decimateMinMax");
+    ColumnAccumulator columns(viewport, out);
+    for (size_t i = 0; i < count; i++)
+        columns.add(points[i]);
+    columns.flush();
+}
+
+MinMaxPyramid::MinMaxPyramid(std::vector<PlotPoint> points) : points_(std::move(points)) {
+    CALC_TRACE_SCOPE("MinMaxPyramid build");
+    auto byX = [](const PlotPoint& a, const PlotPoint& b) { return a.x < b.x; };
+    if (!std::is_sorted(points_.begin(), points_.end(), byX))
+        std::stable_sort(points_.begin(), points_.end(), byX);
+
+    std::vector<Bucket> base;
+    for (size_t begin = 0; begin < points_.size(); begin += kBaseBucket) {
+        size_t end = std::min(points_.size(), begin + kBaseBucket);
+        Bucket bucket{ points_[begin], points_[end - 1], points_[begin], points_[begin], false };
+        bool haveValue = false;
+        for (size_t i = begin; i < end; i++) {
+            const PlotPoint& point = points_[i];
+            if (std::isnan(point.y)) {
+                bucket.gap = true;
+                continue;
+            }
+            if (!haveValue || point.y < bucket.low.y)
+                bucket.low = point;
+            if (!haveValue || point.y > bucket.high.y)
+                bucket.high = point;
+            haveValue = true;
+        }
+        base.push_back(bucket);
+    }
+    if (base.size() <= 1)
+        return;
+    levels_.push_back(std::move(base));
+    while (levels_.back().size() > 1) {
+        const std::vector<Bucket>& below = levels_.back();
+        std::vector<Bucket> level;
+        for (size_t i = 0; i < below.size(); i += 2) {
+            if (i + 1 == below.size()) {
+                level.push_back(below[i]);
+                continue;
+            }
+            const Bucket& a = below[i];
+            const Bucket& b = below[i + 1];
+            level.push_back({ a.first, b.last, b.low.y < a.low.y ? b.low : a.low, b.high.y > a.high.y ? b.high : a.high,
+                a.gap || b.gap });
+        }
+        levels_.push_back(std::move(level));
+    }
+}
+
+void MinMaxPyramid::addBucket(size_t level, size_t index, size_t begin, size_t end, ColumnAccumulator& columns) const {
+    const Bucket& bucket = levels_[level][index];
+    if (!bucket.gap && columns.inOneColumn(bucket.first.x, bucket.last.x)) {
+        columns.add(bucket.first, bucket.last, bucket.low, bucket.high);
+        return;
+    }
+    if (level == 0) {
+        for (size_t i = begin; i < end; i++)
+            columns.add(points_[i]);
+        return;
+    }
+    size_t half = kBaseBucket << (level - 1);
+    addBucket(level - 1, 2 * index, begin, std::min(end, begin + half), columns);
+    if (begin + half < end)
+        addBucket(level - 1, 2 * index + 1, begin + half, end, columns);
+}
+
+void MinMaxPyramid::addRange(size_t begin, size_t end, ColumnAccumulator& columns) const {
+    double pixels = std::max(1.0, static_cast<double>(columns.column(points_[end - 1].x) - columns.column(points_[begin].x)));
+    double perColumn = (end - begin) / pixels;
+    if (levels_.empty() || perColumn < 2.0 * kBaseBucket) {
+        for (size_t i = begin; i < end; i++)
+            columns.add(points_[i]);
+        return;
+    }
+    // Самый крупный уровень, корзина которого не больше половины столбца
+    size_t level = 0;
+    while (level + 1 < levels_.size() && static_cast<double>(kBaseBucket << (level + 1)) <= perColumn / 2)
+        level++;
+    size_t size = kBaseBucket << level;
+    size_t i = begin;
+    while (i < end) {
+        if (i % size == 0 && i + size <= end) {
+            addBucket(level, i / size, i, i + size, columns);
+            i += size;
+        }
+        else
+            columns.add(points_[i++]);
+    }
+}
+
+void MinMaxPyramid::decimateRange(size_t begin, size_t end, const PlotViewport& viewport, std::vector<PlotPoint>& out) const {
+    if (begin >= end)
+        return;
+    ColumnAccumulator columns(viewport, out);
+    addRange(begin, end, columns);
+    columns.flush();
+}
+
+void MinMaxPyramid::decimate(const PlotViewport& viewport, std::vector<PlotPoint>& out, ThreadPool* pool) const {
+    CALC_TRACE_SCOPE("MinMaxPyramid::decimate");
+    out.clear();
+    if (points_.empty())
+        return;
+    auto lowerBound = [&](double x) {
+        return static_cast<size_t>(std::lower_bound(points_.begin(), points_.end(), x,
+            [](const PlotPoint& point, double value) { return point.x < value; }) - points_.begin());
+    };
+    size_t lo = lowerBound(viewport.xMin);
+    lo = lo > 0 ? lo - 1 : 0;
+    size_t hi = std::min(points_.size(), static_cast<size_t>(std::upper_bound(points_.begin(), points_.end(), viewport.xMax,
+        [](double value, const PlotPoint& point) { return value < point.x; }) - points_.begin()) + 1);
+
+    size_t bands = pool ? std::min<size_t>(pool->size() * 4, viewport.width / 64 + 1) : 1;
+    if (bands <= 1 || hi - lo < 4 * kBaseBucket) {
+        decimateRange(lo, hi, viewport, out);
+        return;
+    }
+    // Границы полос совпадают с границами столбцов, поэтому столбец целиком попадает в одну полосу
+    int columnsPerBand = static_cast<int>((viewport.width + bands - 1) / bands);
+    double pixel = (viewport.xMax - viewport.xMin) / viewport.width;
+    std::vector<size_t> edges(bands + 1);
+    edges[0] = lo;
+    edges[bands] = hi;
+    for (size_t b = 1; b < bands; b++)
+        edges[b] = std::min(hi, std::max(lo, lowerBound(viewport.xMin + b * columnsPerBand * pixel)));
+    std::vector<std::vector<PlotPoint>> parts(bands);
+    pool->parallelFor(0, bands, 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++)
+            decimateRange(edges[b], edges[b + 1], viewport, parts[b]);
+    });
+    for (const auto& part : parts)
+        out.insert(out.end(), part.begin(), part.end());
+}
@@ -0,0 +1,91 @@
+#include "plot_evaluator.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+PlotEvaluator::PlotEvaluator(ThreadPool& pool, int tileWidth) : pool_(pool), tileWidth_(std::max(tileWidth, 16)) {
+}
+
+void PlotEvaluator::addFunction(Expression function) {
+    caches_.push_back(std::make_unique<SampleCache>(std::move(function)));
+}
+
+PlotRefreshStats PlotEvaluator::refresh(const PlotViewport& viewport, bool adaptive, std::vector<PlotSeries>& series) {
+    CALC_TRACE_SCOPE("PlotEvaluator::refresh");
+    PlotRefreshStats stats;
+    series.resize(caches_.size());
+    std::vector<uint64_t> before(caches_.size());
+    for (size_t f = 0; f < caches_.size(); f++) {
+        before[f] = caches_[f]->stats().evaluations;
+        series[f].evaluations = 0;
+    }
+
+    // Все полосы одной ширины, чтобы уровень сетки начальной выборки совпадал у всех полос
+    double pixel = (viewport.xMax - viewport.xMin) / viewport.width;
+    size_t tiles = static_cast<size_t>((viewport.width + tileWidth_ - 1) / tileWidth_);
+    double tileSpan = tileWidth_ * pixel;
+    double spanEnd = viewport.xMin + tiles * tileSpan;
+    int level = adaptive
+        ? SampleCache::levelFor(0.0, tileSpan, std::max(2, tileWidth_ / std::max(sampler_.options().initialSpacing, 1)))
+        : SampleCache::levelFor(viewport.xMin, viewport.xMax, viewport.width);
+
+    struct ChunkTask {
+        size_t function;
+        SampleChunkKey key;
+    };
+    std::vector<ChunkTask> chunkTasks;
+    std::vector<SampleChunkKey> missing;
+    for (size_t f = 0; f < caches_.size(); f++) {
+        missing.clear();
+        caches_[f]->findMissing(level, viewport.xMin, adaptive ? spanEnd : viewport.xMax, missing);
+        for (const auto& key : missing)
+            chunkTasks.push_back({ f, key });
+    }
+    pool_.parallelFor(0, chunkTasks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            caches_[chunkTasks[i].function]->buildChunk(chunkTasks[i].key);
+    });
+    stats.chunksBuilt = chunkTasks.size();
+
+    if (!adaptive) {
+        pool_.parallelFor(0, caches_.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; f++)
+                caches_[f]->collect(level, viewport.xMin, viewport.xMax, series[f].points);
+        });
+    }
+    else {
+        std::vector<std::vector<PlotPoint>> tilePoints(caches_.size() * tiles);
+        std::vector<uint64_t> tileEvaluations(tilePoints.size(), 0);
+        pool_.parallelFor(0, tilePoints.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; task++) {
+                size_t f = task / tiles;
+                size_t t = task % tiles;
+                PlotViewport tile = viewport;
+                tile.xMin = viewport.xMin + t * tileSpan;
+                tile.xMax = viewport.xMin + (t + 1) * tileSpan;
+                tile.width = tileWidth_;
+                tileEvaluations[task] = sampler_.sample(caches_[f]->function(), tile, tilePoints[task], caches_[f].get()).evaluations;
+            }
+        });
+        for (size_t f = 0; f < caches_.size(); f++) {
+            std::vector<PlotPoint>& points = series[f].points;
+            points.clear();
+            for (size_t t = 0; t < tiles; t++) {
+                double tileMin = viewport.xMin + t * tileSpan;
+                double tileMax = viewport.xMin + (t + 1) * tileSpan;
+                for (const auto& point : tilePoints[f * tiles + t]) {
+                    if ((t == 0 || point.x >= tileMin) && (t + 1 == tiles || point.x < tileMax))
+                        points.push_back(point);
+                }
+                series[f].evaluations += tileEvaluations[f * tiles + t];
+            }
+        }
+        stats.tiles = tilePoints.size();
+    }
+
+    for (size_t f = 0; f < caches_.size(); f++) {
+        series[f].evaluations += caches_[f]->stats().evaluations - before[f];
+        stats.evaluations += series[f].evaluations;
+    }
+    return stats;
+}
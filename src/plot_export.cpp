@@ -0,0 +1,95 @@
+#include "plot_export.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "adaptive_sampler.h"
+#include "png_writer.h"
+
+/**
+ * @brief Цвета графиков по порядку функций (как в окне графиков)
+ */
+static const RgbaColor kPlotColors[] = {
+    { 90, 170, 255 }, { 255, 120, 90 }, { 120, 220, 120 },
+    { 230, 200, 80 }, { 200, 120, 230 }, { 90, 220, 220 }
+};
+
+static const RgbaColor kBackgroundColor = { 20, 20, 20 };
+static const RgbaColor kGridColor = { 45, 45, 45 };
+static const RgbaColor kAxisColor = { 150, 150, 150 };
+
+PlotCanvas PlotExporter::render(const std::vector<Expression>& functions, PlotViewport viewport, ThreadPool* pool) const {
+    viewport.width = options_.width;
+    viewport.height = options_.height;
+    const float scale = options_.scale;
+    const float w = static_cast<float>(viewport.width);
+    const float h = static_cast<float>(viewport.height);
+
+    // Выборки кривых независимы и строятся параллельно; рисуются по порядку функций
+    std::vector<std::vector<float>> curves(functions.size());
+    AdaptiveSamplerOptions samplerOptions;
+    samplerOptions.initialSpacing = std::max(1, static_cast<int>(std::lround(8.0f * scale)));
+    AdaptiveSampler sampler(samplerOptions);
+    auto sampleCurves = [&](size_t begin, size_t end) {
+        std::vector<PlotPoint> points;
+        for (size_t f = begin; f < end; f++) {
+            sampler.sample(functions[f], viewport, points);
+            std::vector<float>& xy = curves[f];
+            xy.reserve(points.size() * 2);
+            for (const PlotPoint& point : points) {
+                xy.push_back(static_cast<float>(viewport.toScreenX(point.x)));
+                xy.push_back(std::isfinite(point.y) ? static_cast<float>(viewport.toScreenY(point.y))
+                                                    : std::numeric_limits<float>::quiet_NaN());
+            }
+        }
+    };
+    if (pool != nullptr)
+        pool->parallelFor(0, functions.size(), 1, sampleCurves);
+    else
+        sampleCurves(0, functions.size());
+
+    PlotCanvas canvas(viewport.width, viewport.height, kBackgroundColor);
+    double xStep = gridStep(viewport.xMax - viewport.xMin, 10);
+    double yStep = gridStep(viewport.yMax - viewport.yMin, 8);
+    float axisX = static_cast<float>(std::min(std::max(viewport.toScreenX(0.0), 0.0), static_cast<double>(w - 1)));
+    float axisY = static_cast<float>(std::min(std::max(viewport.toScreenY(0.0), 0.0), static_cast<double>(h - 1)));
+    // Линии толщиной в пиксель проходят через центры пикселей, чтобы не размываться на два ряда
+    auto snap = [](float v) { return std::floor(v) + 0.5f; };
+    for (double x = std::ceil(viewport.xMin / xStep) * xStep; x <= viewport.xMax; x += xStep) {
+        float px = snap(static_cast<float>(viewport.toScreenX(x)));
+        canvas.strokeLine(px, 0.0f, px, h, scale, kGridColor);
+    }
+    for (double y = std::ceil(viewport.yMin / yStep) * yStep; y <= viewport.yMax; y += yStep) {
+        float py = snap(static_cast<float>(viewport.toScreenY(y)));
+        canvas.strokeLine(0.0f, py, w, py, scale, kGridColor);
+    }
+    canvas.strokeLine(snap(axisX), 0.0f, snap(axisX), h, scale, kAxisColor);
+    canvas.strokeLine(0.0f, snap(axisY), w, snap(axisY), scale, kAxisColor);
+
+    const float labelSize = 14.0f * scale;
+    const TrueTypeFont& font = glyphs_.font();
+    const float ascent = static_cast<float>(font.ascent()) * labelSize / font.unitsPerEm();
+    for (double x = std::ceil(viewport.xMin / xStep) * xStep; x <= viewport.xMax; x += xStep) {
+        float px = static_cast<float>(viewport.toScreenX(x));
+        float top = std::min(axisY + 3.0f * scale, h - 20.0f * scale);
+        canvas.drawText(glyphs_, formatTick(x, xStep), px + 3.0f * scale, top + ascent, labelSize, kAxisColor);
+    }
+    for (double y = std::ceil(viewport.yMin / yStep) * yStep; y <= viewport.yMax; y += yStep) {
+        if (std::fabs(y) <= yStep * 1e-9)
+            continue;
+        float py = static_cast<float>(viewport.toScreenY(y));
+        float left = std::min(axisX + 3.0f * scale, w - 60.0f * scale);
+        canvas.drawText(glyphs_, formatTick(y, yStep), left, py - 18.0f * scale + ascent, labelSize, kAxisColor);
+    }
+
+    const size_t colors = sizeof(kPlotColors) / sizeof(kPlotColors[0]);
+    for (size_t f = 0; f < curves.size(); f++)
+        canvas.strokePolyline(curves[f].data(), curves[f].size() / 2, 2.0f * scale, kPlotColors[f % colors]);
+    canvas.render(pool);
+    return canvas;
+}
+
+void PlotExporter::exportPng(const std::vector<Expression>& functions, const PlotViewport& viewport, const std::string& path,
+    ThreadPool* pool) const {
+    PlotCanvas canvas = render(functions, viewport, pool);
+    writePng(path, canvas.pixels().data(), canvas.width(), canvas.height());
+}
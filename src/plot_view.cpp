@@ -0,0 +1,616 @@
+#include "plot_view.h"
+#include "atlas_text.h"
+#include "calculator_concurrent.h"
+#include "heatmap_tiles.h"
+#include "implicit_plotter.h"
+#include "interval_plotter.h"
+#include "parametric_sampler.h"
+#include "plot_decimation.h"
+#include "plot_evaluator.h"
+#include "plot_viewport.h"
+#include "surface_renderer.h"
+#include "trace.h"
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <stdexcept>
+
+/**
+ * @brief Цвета графиков по порядку функций
+ */
+static const sf::Color kPlotColors[] = {
+    sf::Color(90, 170, 255), sf::Color(255, 120, 90), sf::Color(120, 220, 120),
+    sf::Color(230, 200, 80), sf::Color(200, 120, 230), sf::Color(90, 220, 220)
+};
+
+/**
+ * @brief Читает ряд данных: по строке "x y" на точку, нечисловая строка y (например, nan) — разрыв
+ */
+static std::vector<PlotPoint> loadSeries(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open series file " + path);
+    std::vector<PlotPoint> points;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        PlotPoint point;
+        std::string y;
+        if (!(fields >> point.x >> y))
+            throw std::runtime_error("Invalid series line: " + line);
+        // strtod возвращает 0 для нечислового текста ("NA", "-"), поэтому ячейка, разобранная не целиком, — разрыв
+        char* end = nullptr;
+        point.y = std::strtod(y.c_str(), &end);
+        if (end == y.c_str() || *end != '\0')
+            point.y = std::numeric_limits<double>::quiet_NaN();
+        points.push_back(point);
+    }
+    return points;
+}
+
+/**
+ * @brief Непрерывный участок ломаной в общем буфере вершин
+ */
+struct CurveStrip {
+    size_t first;
+    size_t count;
+};
+
+/**
+ * @brief Тепловая карта f(x, y): плитки из HeatmapTileCache в атласе видеопамяти
+ *
+ * Атлас — одна текстура, разбитая на ячейки размером с плитку. Плитка раскрашивается
+ * и загружается в свободную (или давно не видимую) ячейку только при первом появлении
+ * на экране, поэтому при сдвиге и масштабировании передаются лишь новые плитки.
+ */
+struct HeatmapLayer {
+    std::unique_ptr<HeatmapTileCache> cache;
+    std::vector<std::shared_ptr<const HeatmapTile>> tiles;
+    sf::Texture atlas;
+    unsigned slotsPerRow = 0;
+    std::vector<HeatmapTileKey> slotKeys;
+    std::vector<uint64_t> slotUse;
+    std::unordered_map<HeatmapTileKey, unsigned, HeatmapTileKeyHash> resident;
+    std::vector<uint8_t> rgba;
+    sf::VertexArray quads{ sf::Quads };
+    float low = 0.0f;
+    float high = 0.0f;
+    bool rangeKnown = false;
+    uint64_t frame = 0;
+    size_t built = 0;
+    size_t uploaded = 0;
+
+    bool create(Expression function) {
+        cache = std::make_unique<HeatmapTileCache>(std::move(function));
+        const unsigned size = std::min(4096u, sf::Texture::getMaximumSize());
+        if (!atlas.create(size, size))
+            return false;
+        atlas.setSmooth(true);
+        slotsPerRow = size / HeatmapTileCache::kTileSize;
+        slotKeys.assign(slotsPerRow * slotsPerRow, HeatmapTileKey{ 0, 0, 0 });
+        slotUse.assign(slotKeys.size(), 0);
+        rgba.resize(static_cast<size_t>(HeatmapTileCache::kTileSize) * HeatmapTileCache::kTileSize * 4);
+        return true;
+    }
+
+    /**
+     * @brief Ячейка атласа для плитки; новая плитка раскрашивается и загружается
+     * @return false, если все ячейки заняты плитками текущего кадра
+     */
+    bool slotFor(const HeatmapTile& tile, unsigned& slot) {
+        auto it = resident.find(tile.key);
+        if (it != resident.end()) {
+            slot = it->second;
+            slotUse[slot] = frame;
+            return true;
+        }
+        slot = static_cast<unsigned>(std::min_element(slotUse.begin(), slotUse.end()) - slotUse.begin());
+        if (slotUse[slot] == frame)
+            return false;
+        if (slotUse[slot] != 0)
+            resident.erase(slotKeys[slot]);
+        slotKeys[slot] = tile.key;
+        slotUse[slot] = frame;
+        resident[tile.key] = slot;
+        colorizeHeatmap(tile.values.data(), tile.values.size(), low, high, rgba.data());
+        atlas.update(rgba.data(), HeatmapTileCache::kTileSize, HeatmapTileCache::kTileSize,
+            (slot % slotsPerRow) * HeatmapTileCache::kTileSize, (slot / slotsPerRow) * HeatmapTileCache::kTileSize);
+        uploaded++;
+        return true;
+    }
+
+    void rebuild(const PlotViewport& viewport) {
+        CALC_TRACE_SCOPE("HeatmapLayer::rebuild");
+        frame++;
+        // Кэш вмещает все плитки экрана с запасом: повторный кадр и сдвиг строят только новые плитки
+        cache->setMaxTiles(HeatmapTileCache::capacityFor(viewport));
+        built = cache->update(viewport, tiles, &defaultExecutor());
+        uploaded = 0;
+        if (!rangeKnown) {
+            // Шкала цветов фиксируется по первому кадру, чтобы загруженные плитки оставались верными
+            for (const auto& tile : tiles) {
+                if (!std::isfinite(tile->low))
+                    continue;
+                low = rangeKnown ? std::min(low, tile->low) : tile->low;
+                high = rangeKnown ? std::max(high, tile->high) : tile->high;
+                rangeKnown = true;
+            }
+        }
+        quads.clear();
+        const float size = static_cast<float>(HeatmapTileCache::kTileSize);
+        for (const auto& tile : tiles) {
+            unsigned slot = 0;
+            if (!slotFor(*tile, slot))
+                continue;
+            double x0, x1, y0, y1;
+            HeatmapTileCache::tileBounds(tile->key, x0, x1, y0, y1);
+            float left = static_cast<float>(viewport.toScreenX(x0));
+            float right = static_cast<float>(viewport.toScreenX(x1));
+            float top = static_cast<float>(viewport.toScreenY(y1));
+            float bottom = static_cast<float>(viewport.toScreenY(y0));
+            float u = (slot % slotsPerRow) * size;
+            float v = (slot / slotsPerRow) * size;
+            quads.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u, v)));
+            quads.append(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(u + size, v)));
+            quads.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u + size, v + size)));
+            quads.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(u, v + size)));
+        }
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        if (cache)
+            target.draw(quads, &atlas);
+    }
+};
+
+/**
+ * @brief Состояние окна графиков
+ */
+struct PlotView {
+    PlotViewport viewport;
+    PlotViewport initial;
+    PlotEvaluator evaluator{ defaultExecutor() };
+    std::vector<PlotSeries> series;
+    std::vector<std::unique_ptr<MinMaxPyramid>> data;
+    std::vector<PlotPoint> decimated;
+    IntervalPlotter intervalPlotter;
+    std::vector<PixelSpan> spans;
+    sf::VertexArray cells{ sf::Quads };
+    std::vector<Expression> relations;
+    HeatmapLayer heatmap;
+    ImplicitPlotter implicitPlotter;
+    std::vector<ImplicitSegment> segments;
+    sf::VertexArray contours{ sf::Lines };
+    std::vector<ParametricCurve> curves;
+    ParametricSampler parametricSampler;
+    std::vector<PlotPoint> curvePoints;
+    sf::VertexArray grid{ sf::Lines };
+    sf::VertexArray axes{ sf::Lines };
+    std::vector<sf::Vertex> vertices;
+    std::vector<CurveStrip> strips;
+    sf::VertexBuffer buffer{ sf::LineStrip, sf::VertexBuffer::Stream };
+    bool useBuffer = false;
+    std::vector<AtlasText> labels;
+    AtlasText status;
+    const GlyphAtlas* atlas = nullptr;
+    bool adaptive = true;
+    bool guaranteed = false;
+    uint64_t frameEvaluations = 0;
+    size_t drawnPoints = 0;
+    double rebuildMs = 0.0;
+
+    /**
+     * @brief Пересчитывает геометрию графиков, сетки и подписей для текущей области
+     */
+    void rebuild() {
+        CALC_TRACE_SCOPE("PlotView::rebuild");
+        auto start = std::chrono::steady_clock::now();
+        frameEvaluations = evaluator.refresh(viewport, adaptive, series).evaluations;
+        if (heatmap.cache) {
+            heatmap.rebuild(viewport);
+            frameEvaluations += static_cast<uint64_t>(heatmap.built) * HeatmapTileCache::kTileSize * HeatmapTileCache::kTileSize;
+        }
+        const size_t colors = sizeof(kPlotColors) / sizeof(kPlotColors[0]);
+        vertices.clear();
+        strips.clear();
+        cells.clear();
+        for (size_t f = 0; f < series.size(); f++) {
+            if (guaranteed) {
+                frameEvaluations += intervalPlotter.plot(evaluator.cache(f).function(), viewport, spans,
+                    &defaultExecutor()).evaluations;
+                appendCells(kPlotColors[f % colors]);
+                continue;
+            }
+            decimated.clear();
+            decimateMinMax(series[f].points.data(), series[f].points.size(), viewport, decimated);
+            appendCurve(decimated, kPlotColors[f % colors]);
+        }
+        for (size_t d = 0; d < data.size(); d++) {
+            data[d]->decimate(viewport, decimated, &defaultExecutor());
+            appendCurve(decimated, kPlotColors[(series.size() + d) % colors]);
+        }
+        contours.clear();
+        for (size_t r = 0; r < relations.size(); r++) {
+            frameEvaluations += implicitPlotter.plot(relations[r], viewport, segments, &defaultExecutor()).evaluations;
+            const sf::Color& color = kPlotColors[(series.size() + data.size() + r) % colors];
+            for (const auto& segment : segments) {
+                contours.append(sf::Vertex(sf::Vector2f(static_cast<float>(viewport.toScreenX(segment.a.x)),
+                    static_cast<float>(viewport.toScreenY(segment.a.y))), color));
+                contours.append(sf::Vertex(sf::Vector2f(static_cast<float>(viewport.toScreenX(segment.b.x)),
+                    static_cast<float>(viewport.toScreenY(segment.b.y))), color));
+            }
+        }
+        // Точки параметрической кривой не упорядочены по x, поэтому она не прореживается по столбцам
+        for (size_t c = 0; c < curves.size(); c++) {
+            frameEvaluations += parametricSampler.sample(curves[c], viewport, curvePoints).evaluations;
+            appendCurve(curvePoints, kPlotColors[(series.size() + data.size() + relations.size() + c) % colors]);
+        }
+        drawnPoints = vertices.size();
+        upload();
+        buildGrid();
+        rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        updateStatus();
+    }
+
+    /**
+     * @brief Дописывает ломаную по точкам с разрывами там, где функция не определена или уходит за экран
+     *
+     * Каждый непрерывный участок становится отдельной полосой (LineStrip) в общем буфере вершин.
+     */
+    void appendCurve(const std::vector<PlotPoint>& samples, const sf::Color& color) {
+        const double limit = 4.0 * viewport.height;
+        size_t first = vertices.size();
+        auto closeStrip = [&]() {
+            if (vertices.size() - first >= 2)
+                strips.push_back({ first, vertices.size() - first });
+            else
+                vertices.resize(first);
+            first = vertices.size();
+        };
+        for (size_t i = 1; i < samples.size(); i++) {
+            const PlotPoint& a = samples[i - 1];
+            const PlotPoint& b = samples[i];
+            double ay = viewport.toScreenY(a.y);
+            double by = viewport.toScreenY(b.y);
+            if (std::isnan(a.y) || std::isnan(b.y) || (ay < -limit && by < -limit) || (ay > limit && by > limit) ||
+                std::fabs(ay - by) > limit) {
+                closeStrip();
+                continue;
+            }
+            if (vertices.size() == first)
+                vertices.emplace_back(sf::Vector2f(static_cast<float>(viewport.toScreenX(a.x)), static_cast<float>(ay)), color);
+            vertices.emplace_back(sf::Vector2f(static_cast<float>(viewport.toScreenX(b.x)), static_cast<float>(by)), color);
+        }
+        closeStrip();
+    }
+
+    /**
+     * @brief Закрашивает пиксели, отмеченные интервальным построением
+     */
+    void appendCells(const sf::Color& color) {
+        for (const auto& span : spans) {
+            float x0 = static_cast<float>(span.column);
+            float y0 = static_cast<float>(span.rowBegin);
+            float y1 = static_cast<float>(span.rowEnd);
+            cells.append(sf::Vertex(sf::Vector2f(x0, y0), color));
+            cells.append(sf::Vertex(sf::Vector2f(x0 + 1.0f, y0), color));
+            cells.append(sf::Vertex(sf::Vector2f(x0 + 1.0f, y1), color));
+            cells.append(sf::Vertex(sf::Vector2f(x0, y1), color));
+        }
+    }
+
+    /**
+     * @brief Передаёт вершины в буфер видеопамяти; буфер растёт с запасом и переиспользуется между кадрами
+     */
+    void upload() {
+        if (!useBuffer || vertices.empty())
+            return;
+        if (buffer.getVertexCount() < vertices.size() && !buffer.create(vertices.size() + vertices.size() / 2)) {
+            useBuffer = false;
+            return;
+        }
+        if (!buffer.update(vertices.data(), vertices.size(), 0))
+            useBuffer = false;
+    }
+
+    void buildGrid() {
+        grid.clear();
+        axes.clear();
+        labels.clear();
+        const sf::Color gridColor(45, 45, 45);
+        const sf::Color axisColor(150, 150, 150);
+        float w = static_cast<float>(viewport.width);
+        float h = static_cast<float>(viewport.height);
+        double xStep = gridStep(viewport.xMax - viewport.xMin, 10);
+        double yStep = gridStep(viewport.yMax - viewport.yMin, 8);
+        float axisX = static_cast<float>(std::min(std::max(viewport.toScreenX(0.0), 0.0), static_cast<double>(w - 1)));
+        float axisY = static_cast<float>(std::min(std::max(viewport.toScreenY(0.0), 0.0), static_cast<double>(h - 1)));
+        for (double x = std::ceil(viewport.xMin / xStep) * xStep; x <= viewport.xMax; x += xStep) {
+            float px = static_cast<float>(viewport.toScreenX(x));
+            grid.append(sf::Vertex(sf::Vector2f(px, 0.0f), gridColor));
+            grid.append(sf::Vertex(sf::Vector2f(px, h), gridColor));
+            addLabel(formatTick(x, xStep), px + 3.0f, std::min(axisY + 3.0f, h - 20.0f));
+        }
+        for (double y = std::ceil(viewport.yMin / yStep) * yStep; y <= viewport.yMax; y += yStep) {
+            float py = static_cast<float>(viewport.toScreenY(y));
+            grid.append(sf::Vertex(sf::Vector2f(0.0f, py), gridColor));
+            grid.append(sf::Vertex(sf::Vector2f(w, py), gridColor));
+            if (std::fabs(y) > yStep * 1e-9)
+                addLabel(formatTick(y, yStep), std::min(axisX + 3.0f, w - 60.0f), py - 18.0f);
+        }
+        axes.append(sf::Vertex(sf::Vector2f(axisX, 0.0f), axisColor));
+        axes.append(sf::Vertex(sf::Vector2f(axisX, h), axisColor));
+        axes.append(sf::Vertex(sf::Vector2f(0.0f, axisY), axisColor));
+        axes.append(sf::Vertex(sf::Vector2f(w, axisY), axisColor));
+    }
+
+    void addLabel(const std::string& text, float x, float y) {
+        labels.emplace_back();
+        AtlasText& label = labels.back();
+        label.setAtlas(*atlas);
+        label.setString(text);
+        label.setFillColor(sf::Color(150, 150, 150));
+        label.setScale(0.6f, 0.6f);
+        label.setPosition(x, y);
+    }
+
+    void updateStatus() {
+        uint64_t reused = 0;
+        for (size_t f = 0; f < evaluator.size(); f++)
+            reused += evaluator.cache(f).stats().reusedSamples;
+        std::ostringstream text;
+        text.precision(3);
+        text << (guaranteed ? "interval" : adaptive ? "adaptive" : "uniform") << "   rebuild " << rebuildMs << " ms   evaluated "
+            << frameEvaluations << "   reused " << reused << "   points " << drawnPoints;
+        if (heatmap.cache)
+            text << "   tiles " << heatmap.tiles.size() << " (built " << heatmap.built << ", uploaded " << heatmap.uploaded << ")";
+        status.setString(text.str());
+        status.setPosition(10.0f, static_cast<float>(viewport.height) - 24.0f);
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        heatmap.draw(target);
+        target.draw(grid);
+        target.draw(axes);
+        for (const auto& label : labels)
+            target.draw(label);
+        target.draw(cells);
+        target.draw(contours);
+        for (const auto& strip : strips) {
+            if (useBuffer)
+                target.draw(buffer, strip.first, strip.count);
+            else
+                target.draw(&vertices[strip.first], strip.count, sf::LineStrip);
+        }
+        target.draw(status);
+    }
+};
+
+/**
+ * @brief Окно поверхности z = f(x, y) над квадратом [-10, 10] x [-10, 10]
+ *
+ * Кадр рисуется SurfaceRenderer в пуле потоков и целиком передаётся в текстуру;
+ * перерисовка выполняется только после изменения камеры или размера окна.
+ */
+static int runSurfaceWindow(const PlotWindowOptions& options) {
+    std::unique_ptr<SurfaceMesh> mesh;
+    try {
+        mesh = std::make_unique<SurfaceMesh>(Expression::parse(options.surface, { "x", "y" }), -10.0, 10.0, -10.0, 10.0, 512,
+            &defaultExecutor());
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
+    sf::RenderWindow window(sf::VideoMode(options.width, options.height), "Surface");
+    window.setVerticalSyncEnabled(true);
+    GlyphAtlas atlas;
+    if (!atlas.load()) {
+        std::cerr << "Ошибка загрузки встроенного шрифта Sansation_Bold.ttf" << std::endl;
+        return -1;
+    }
+    AtlasText status;
+    status.setAtlas(atlas);
+    status.setFillColor(sf::Color(200, 200, 200));
+    status.setScale(0.6f, 0.6f);
+
+    SurfaceRenderOptions renderOptions;
+    const SurfaceCamera initial;
+    SurfaceCamera camera = initial;
+    SurfaceFrame frame;
+    frame.width = options.width;
+    frame.height = options.height;
+    sf::Texture texture;
+    if (!texture.create(options.width, options.height)) {
+        std::cerr << "Cannot create surface texture" << std::endl;
+        return -1;
+    }
+    sf::Sprite sprite(texture);
+
+    bool changed = true;
+    bool dragging = false;
+    sf::Vector2i dragFrom;
+    sf::Event event;
+    while (window.isOpen()) {
+        if (changed) {
+            auto start = std::chrono::steady_clock::now();
+            SurfaceRenderStats stats = SurfaceRenderer(renderOptions).render(*mesh, camera, frame, &defaultExecutor());
+            texture.update(frame.rgba.data());
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::ostringstream text;
+            text.precision(3);
+            text << "render " << ms << " ms   triangles " << stats.triangles << "   back faces " << stats.backFaces
+                << (renderOptions.cullBackFaces ? " culled" : " drawn") << "   patches " << stats.patches << " (culled "
+                << stats.culled << ")   z " << mesh->low() << " .. " << mesh->high();
+            status.setString(text.str());
+            status.setPosition(10.0f, static_cast<float>(frame.height) - 24.0f);
+            changed = false;
+        }
+        window.clear(sf::Color(20, 20, 20));
+        window.draw(sprite);
+        window.draw(status);
+        window.display();
+
+        if (!window.waitEvent(event))
+            break;
+        do {
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
+                window.close();
+            else if (event.type == sf::Event::Resized) {
+                window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, static_cast<float>(event.size.width),
+                    static_cast<float>(event.size.height))));
+                frame.width = static_cast<int>(event.size.width);
+                frame.height = static_cast<int>(event.size.height);
+                if (!texture.create(event.size.width, event.size.height)) {
+                    std::cerr << "Cannot create surface texture" << std::endl;
+                    return -1;
+                }
+                sprite.setTexture(texture, true);
+                changed = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::B) {
+                renderOptions.cullBackFaces = !renderOptions.cullBackFaces;
+                changed = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+                camera = initial;
+                changed = true;
+            }
+            else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                dragging = true;
+                dragFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            }
+            else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+                dragging = false;
+            else if (event.type == sf::Event::MouseMoved && dragging) {
+                camera.yaw -= 0.4 * (event.mouseMove.x - dragFrom.x);
+                camera.pitch = std::min(std::max(camera.pitch + 0.4 * (event.mouseMove.y - dragFrom.y), -89.0), 89.0);
+                dragFrom = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+                changed = true;
+            }
+            else if (event.type == sf::Event::MouseWheelScrolled) {
+                camera.distance = std::min(std::max(camera.distance * std::pow(0.85, event.mouseWheelScroll.delta), 0.3), 20.0);
+                changed = true;
+            }
+        } while (window.isOpen() && window.pollEvent(event));
+    }
+    return 0;
+}
+
+int runPlotWindow(const PlotWindowOptions& options) {
+    if (!options.surface.empty())
+        return runSurfaceWindow(options);
+    PlotView view;
+    try {
+        for (const auto& text : options.functions)
+            view.evaluator.addFunction(Expression::parse(text));
+        if (!options.heatmap.empty() && !view.heatmap.create(Expression::parse(options.heatmap, { "x", "y" }))) {
+            std::cerr << "Cannot create heatmap texture" << std::endl;
+            return -1;
+        }
+        for (const auto& text : options.relations)
+            view.relations.push_back(parseRelation(text));
+        for (const auto& path : options.series)
+            view.data.push_back(std::make_unique<MinMaxPyramid>(loadSeries(path)));
+        for (const auto& spec : options.parametric)
+            view.curves.push_back(ParametricCurve::parse(spec));
+        for (const auto& spec : options.polar)
+            view.curves.push_back(ParametricCurve::parsePolar(spec));
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
+    sf::RenderWindow window(sf::VideoMode(options.width, options.height), "Plot");
+    window.setVerticalSyncEnabled(true);
+    GlyphAtlas atlas;
+    if (!atlas.load()) {
+        std::cerr << "Ошибка загрузки встроенного шрифта Sansation_Bold.ttf" << std::endl;
+        return -1;
+    }
+    view.atlas = &atlas;
+    view.useBuffer = sf::VertexBuffer::isAvailable();
+    view.status.setAtlas(atlas);
+    view.status.setFillColor(sf::Color(200, 200, 200));
+    view.status.setScale(0.6f, 0.6f);
+
+    view.viewport.width = options.width;
+    view.viewport.height = options.height;
+    double aspect = static_cast<double>(options.height) / options.width;
+    view.viewport.yMin = view.viewport.xMin * aspect;
+    view.viewport.yMax = view.viewport.xMax * aspect;
+    view.initial = view.viewport;
+    view.rebuild();
+
+    bool dragging = false;
+    sf::Vector2i dragFrom;
+    sf::Event event;
+    while (window.isOpen()) {
+        window.clear(sf::Color(20, 20, 20));
+        view.draw(window);
+        window.display();
+
+        if (!window.waitEvent(event))
+            break;
+        bool changed = false;
+        do {
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
+                window.close();
+            else if (event.type == sf::Event::Resized) {
+                window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, static_cast<float>(event.size.width),
+                    static_cast<float>(event.size.height))));
+                view.viewport.yMin = view.viewport.yMax - (view.viewport.yMax - view.viewport.yMin) *
+                    event.size.height / view.viewport.height;
+                view.viewport.xMax = view.viewport.xMin + (view.viewport.xMax - view.viewport.xMin) *
+                    event.size.width / view.viewport.width;
+                view.viewport.width = static_cast<int>(event.size.width);
+                view.viewport.height = static_cast<int>(event.size.height);
+                changed = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::A) {
+                view.adaptive = !view.adaptive;
+                changed = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::I) {
+                view.guaranteed = !view.guaranteed;
+                changed = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+                view.viewport = view.initial;
+                changed = true;
+            }
+            else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                dragging = true;
+                dragFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            }
+            else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+                dragging = false;
+            else if (event.type == sf::Event::MouseMoved && dragging) {
+                view.viewport.pan(event.mouseMove.x - dragFrom.x, event.mouseMove.y - dragFrom.y);
+                dragFrom = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+                changed = true;
+            }
+            else if (event.type == sf::Event::MouseWheelScrolled) {
+                double factor = std::pow(1.25, event.mouseWheelScroll.delta);
+                view.viewport.zoom(factor, event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                changed = true;
+            }
+        } while (window.isOpen() && window.pollEvent(event));
+        if (changed && window.isOpen())
+            view.rebuild();
+    }
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include "png_writer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief Таблица CRC-32 для полинома 0xEDB88320
+ */
+static const uint32_t* crcTable() {
+    static const struct Table {
+        uint32_t values[256];
+        Table() {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                values[n] = c;
+            }
+        }
+    } table;
+    return table.values;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    const uint32_t* table = crcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t size, uint32_t adler) {
+    const uint32_t kModulus = 65521;
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        // 5552 — наибольший блок, при котором сумма не переполняет 32 бита
+        size_t block = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= kModulus;
+        b %= kModulus;
+        data += block;
+        size -= block;
+    }
+    return (b << 16) | a;
+}
+
+/**
+ * @brief Запись битов в порядке deflate (младший бит первым)
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void write(uint32_t bits, int count) {
+        buffer_ |= static_cast<uint64_t>(bits) << filled_;
+        filled_ += count;
+        while (filled_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            filled_ -= 8;
+        }
+    }
+
+    void flush() {
+        if (filled_ > 0)
+            out_.push_back(static_cast<uint8_t>(buffer_));
+        buffer_ = 0;
+        filled_ = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t buffer_ = 0;
+    int filled_ = 0;
+};
+
+static uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Фиксированные коды Хаффмана deflate, заранее развёрнутые для записи младшим битом первым
+ */
+struct FixedCodes {
+    uint16_t literal[288];
+    uint8_t literalLength[288];
+    uint8_t distance[30];
+
+    FixedCodes() {
+        for (uint32_t v = 0; v < 288; v++) {
+            uint32_t code;
+            int length;
+            if (v < 144) {
+                code = 0x30 + v;
+                length = 8;
+            }
+            else if (v < 256) {
+                code = 0x190 + (v - 144);
+                length = 9;
+            }
+            else if (v < 280) {
+                code = v - 256;
+                length = 7;
+            }
+            else {
+                code = 0xC0 + (v - 280);
+                length = 8;
+            }
+            literal[v] = static_cast<uint16_t>(reverseBits(code, length));
+            literalLength[v] = static_cast<uint8_t>(length);
+        }
+        for (uint32_t d = 0; d < 30; d++)
+            distance[d] = static_cast<uint8_t>(reverseBits(d, 5));
+    }
+};
+
+static const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+    99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+    12, 12, 13, 13 };
+
+static const int kMinMatch = 3;
+static const int kMaxMatch = 258;
+static const int kWindow = 32768;
+static const int kHashBits = 15;
+static const int kMaxChain = 32;
+static const int kMaxInsert = 32;
+
+void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    static const FixedCodes codes;
+    // CMF: deflate с окном 32 КБ; FLG дополняет заголовок до кратного 31
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter bits(out);
+    bits.write(1, 1);
+    bits.write(1, 2);
+
+    std::vector<int32_t> head(static_cast<size_t>(1) << kHashBits, -1);
+    std::vector<int32_t> previous(kWindow, -1);
+    auto hashAt = [&](size_t i) {
+        uint32_t v = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+        return (v * 2654435761u) >> (32 - kHashBits);
+    };
+    auto insert = [&](size_t i) {
+        uint32_t h = hashAt(i);
+        previous[i & (kWindow - 1)] = head[h];
+        head[h] = static_cast<int32_t>(i);
+    };
+
+    size_t i = 0;
+    while (i < size) {
+        int bestLength = 0;
+        size_t bestDistance = 0;
+        if (i + kMinMatch <= size) {
+            int32_t candidate = head[hashAt(i)];
+            size_t limit = std::min<size_t>(kMaxMatch, size - i);
+            for (int chain = 0; chain < kMaxChain && candidate >= 0 && i - candidate <= kWindow; chain++) {
+                const uint8_t* a = data + candidate;
+                const uint8_t* b = data + i;
+                if (a[bestLength] == b[bestLength]) {
+                    size_t length = 0;
+                    while (length < limit && a[length] == b[length])
+                        length++;
+                    if (static_cast<int>(length) > bestLength) {
+                        bestLength = static_cast<int>(length);
+                        bestDistance = i - candidate;
+                        if (length == limit)
+                            break;
+                    }
+                }
+                int32_t next = previous[candidate & (kWindow - 1)];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+        if (bestLength >= kMinMatch) {
+            int code = static_cast<int>(std::upper_bound(kLengthBase, kLengthBase + 29, bestLength) - kLengthBase) - 1;
+            bits.write(codes.literal[257 + code], codes.literalLength[257 + code]);
+            bits.write(bestLength - kLengthBase[code], kLengthExtra[code]);
+            int distanceCode = static_cast<int>(std::upper_bound(kDistanceBase, kDistanceBase + 30, bestDistance) - kDistanceBase) - 1;
+            bits.write(codes.distance[distanceCode], 5);
+            bits.write(static_cast<uint32_t>(bestDistance - kDistanceBase[distanceCode]), kDistanceExtra[distanceCode]);
+            // Как в быстрых уровнях zlib: позиции внутри длинного повтора (однотонного фона) в словарь не вносятся
+            size_t end = i + bestLength;
+            if (bestLength > kMaxInsert)
+                i = end - 1;
+            for (; i < end; i++) {
+                if (i + kMinMatch <= size)
+                    insert(i);
+            }
+        }
+        else {
+            bits.write(codes.literal[data[i]], codes.literalLength[data[i]]);
+            if (i + kMinMatch <= size)
+                insert(i);
+            i++;
+        }
+    }
+    bits.write(codes.literal[256], codes.literalLength[256]);
+    bits.flush();
+    uint32_t adler = adler32(data, size);
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(adler >> shift));
+}
+
+static void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+/**
+ * @brief Дописывает блок PNG: длина, тип, данные и CRC типа с данными
+ */
+static void appendChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+    appendBigEndian(out, static_cast<uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    appendBigEndian(out, crc32(&out[start], size + 4));
+}
+
+static inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return static_cast<uint8_t>(a);
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+/**
+ * @brief Применяет фильтр PNG к строке и возвращает сумму модулей результата
+ *
+ * Подсчёт прерывается, как только сумма превысит limit: такой фильтр уже не лучший.
+ */
+static uint64_t filterRow(int filter, const uint8_t* row, const uint8_t* above, size_t stride, uint8_t* result,
+    uint64_t limit) {
+    uint64_t cost = 0;
+    const size_t kCheck = 256;
+    for (size_t start = 0; start < stride && cost <= limit; start += kCheck) {
+        size_t end = std::min(stride, start + kCheck);
+        switch (filter) {
+        case 0:
+            for (size_t x = start; x < end; x++)
+                result[x] = row[x];
+            break;
+        case 1:
+            for (size_t x = start; x < end; x++)
+                result[x] = static_cast<uint8_t>(row[x] - (x >= 4 ? row[x - 4] : 0));
+            break;
+        case 2:
+            for (size_t x = start; x < end; x++)
+                result[x] = static_cast<uint8_t>(row[x] - above[x]);
+            break;
+        default:
+            for (size_t x = start; x < end; x++) {
+                uint8_t predicted = x >= 4 ? paeth(row[x - 4], above[x], above[x - 4]) : above[x];
+                result[x] = static_cast<uint8_t>(row[x] - predicted);
+            }
+            break;
+        }
+        for (size_t x = start; x < end; x++)
+            cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(result[x])));
+    }
+    return cost;
+}
+
+void encodePng(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+    const size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> filtered;
+    filtered.reserve((stride + 1) * height);
+    std::vector<uint8_t> candidates[4];
+    for (auto& candidate : candidates)
+        candidate.resize(stride);
+    const std::vector<uint8_t> zeros(stride, 0);
+    // Строка графика почти совпадает с предыдущей или однотонна вдоль, поэтому сначала пробуются Up и Sub;
+    // Paeth и None — только для шумных строк (в среднем больше единицы на байт), а подсчёт
+    // бросается, как только фильтр становится хуже лучшего
+    static const int kOrder[4] = { 2, 1, 3, 0 };
+    const uint64_t goodEnough = stride * 4;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = rgba + y * stride;
+        const uint8_t* above = y > 0 ? row - stride : zeros.data();
+        uint64_t best = UINT64_MAX;
+        int bestFilter = 0;
+        for (int filter : kOrder) {
+            uint64_t cost = filterRow(filter, row, above, stride, candidates[filter].data(), best);
+            if (cost < best) {
+                best = cost;
+                bestFilter = filter;
+            }
+            if (filter == 1 && best <= goodEnough)
+                break;
+        }
+        // Коды фильтров PNG: 0 None, 1 Sub, 2 Up, 4 Paeth
+        filtered.push_back(static_cast<uint8_t>(bestFilter == 3 ? 4 : bestFilter));
+        filtered.insert(filtered.end(), candidates[bestFilter].begin(), candidates[bestFilter].end());
+    }
+
+    out.clear();
+    static const uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.insert(out.end(), kSignature, kSignature + 8);
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    // 8 бит на канал, тип цвета 6 (RGBA), сжатие deflate, фильтры по строкам, без чересстрочности
+    const uint8_t format[5] = { 8, 6, 0, 0, 0 };
+    header.insert(header.end(), format, format + 5);
+    appendChunk(out, "IHDR", header.data(), header.size());
+    std::vector<uint8_t> compressed;
+    zlibCompress(filtered.data(), filtered.size(), compressed);
+    appendChunk(out, "IDAT", compressed.data(), compressed.size());
+    appendChunk(out, "IEND", nullptr, 0);
+}
+
+void writePng(const std::string& path, const uint8_t* rgba, int width, int height) {
+    std::vector<uint8_t> png;
+    encodePng(rgba, width, height, png);
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size())))
+        throw std::runtime_error("Cannot write " + path);
+}
@@ -0,0 +1,225 @@
+#include "sample_cache.h"
+#include "grid_index.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Наименьший и наибольший уровень сетки (шаг от 2^-60 до 2^60)
+ */
+static const int kMinLevel = -60;
+static const int kMaxLevel = 60;
+
+/**
+ * @brief Наибольший модуль номера точки сетки: номер отрезка, умноженный на kChunkSamples, не переполняет int64_t
+ */
+static const double kMaxSampleIndex = 4611686018427387904.0;  // 2^62
+
+/**
+ * @brief Наибольшее число точек, вычисляемых без кэша для диапазона, который кэш не адресует
+ */
+static const double kMaxDirectSamples = 65536.0;
+
+/**
+ * @brief Деление с округлением вниз для отрицательных индексов
+ */
+static int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+/**
+ * @brief Диапазон индексов точек сетки уровня, покрывающий [xMin, xMax] с запасом в одну точку
+ *
+ * @param maxChunks Наибольшее число отрезков диапазона: больше не поместится в кэш
+ * @return false, если диапазон не адресуется сеткой уровня (номер точки вне ±2^62 или
+ *         отрезков больше maxChunks) и кэшировать его нельзя
+ */
+static bool indexRange(int level, double xMin, double xMax, size_t maxChunks, int64_t& first, int64_t& last) {
+    double step = std::ldexp(1.0, level);
+    if (!toGridIndex(std::floor(xMin / step) - 1.0, kMaxSampleIndex, first) ||
+        !toGridIndex(std::ceil(xMax / step) + 1.0, kMaxSampleIndex, last))
+        return false;
+    int64_t chunks = floorDiv(last, SampleCache::kChunkSamples) - floorDiv(first, SampleCache::kChunkSamples) + 1;
+    return chunks > 0 && static_cast<uint64_t>(chunks) <= maxChunks;
+}
+
+SampleCache::SampleCache(Expression function, size_t maxChunks)
+    : function_(std::move(function)), maxChunks_(std::max<size_t>(maxChunks, 16)) {
+}
+
+int SampleCache::levelFor(double xMin, double xMax, int pixels) {
+    double pixelWidth = (xMax - xMin) / std::max(pixels, 1);
+    if (!(pixelWidth > 0.0))
+        return kMinLevel;
+    int level = static_cast<int>(std::floor(std::log2(pixelWidth)));
+    return std::min(kMaxLevel, std::max(kMinLevel, level));
+}
+
+void SampleCache::sample(double xMin, double xMax, int pixels, std::vector<PlotPoint>& out) {
+    CALC_TRACE_SCOPE("SampleCache::sample");
+    int level = levelFor(xMin, xMax, pixels);
+    std::vector<SampleChunkKey> missing;
+    findMissing(level, xMin, xMax, missing);
+    for (const auto& key : missing)
+        buildChunk(key);
+    collect(level, xMin, xMax, out);
+}
+
+void SampleCache::findMissing(int level, double xMin, double xMax, std::vector<SampleChunkKey>& missing) const {
+    int64_t first;
+    int64_t last;
+    if (!indexRange(level, xMin, xMax, maxChunks_, first, last))
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int64_t chunk = floorDiv(first, kChunkSamples); chunk <= floorDiv(last, kChunkSamples); chunk++) {
+        SampleChunkKey key{ level, chunk };
+        if (chunks_.count(key) == 0)
+            missing.push_back(key);
+        else
+            stats_.chunkHits++;
+    }
+}
+
+std::shared_ptr<const SampleCache::Chunk> SampleCache::findChunk(const SampleChunkKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = chunks_.find(key);
+    return it == chunks_.end() ? nullptr : it->second;
+}
+
+void SampleCache::buildChunk(const SampleChunkKey& key) {
+    CALC_TRACE_SCOPE("SampleCache::buildChunk");
+    auto chunk = std::make_shared<Chunk>();
+    chunk->values.assign(kChunkSamples, 0.0);
+    std::vector<bool> known(kChunkSamples, false);
+    uint64_t reused = 0;
+
+    // Точка i уровня level совпадает с точкой 2i уровня level - 1 ...
+    if (key.level > kMinLevel) {
+        for (int half = 0; half < 2; half++) {
+            auto finer = findChunk({ key.level - 1, key.chunk * 2 + half });
+            if (!finer)
+                continue;
+            for (int j = 0; j < kChunkSamples / 2; j++) {
+                chunk->values[half * kChunkSamples / 2 + j] = finer->values[2 * j];
+                known[half * kChunkSamples / 2 + j] = true;
+            }
+            reused += kChunkSamples / 2;
+        }
+    }
+    // ... а чётная точка 2i — с точкой i уровня level + 1
+    if (key.level < kMaxLevel && reused < kChunkSamples) {
+        auto coarser = findChunk({ key.level + 1, floorDiv(key.chunk, 2) });
+        if (coarser) {
+            int offset = static_cast<int>(key.chunk - floorDiv(key.chunk, 2) * 2) * kChunkSamples / 2;
+            for (int j = 0; j < kChunkSamples; j += 2) {
+                if (!known[j]) {
+                    chunk->values[j] = coarser->values[offset + j / 2];
+                    known[j] = true;
+                    reused++;
+                }
+            }
+        }
+    }
+
+    std::vector<double> xs;
+    std::vector<int> slots;
+    double step = std::ldexp(1.0, key.level);
+    for (int j = 0; j < kChunkSamples; j++) {
+        if (!known[j]) {
+            xs.push_back(static_cast<double>(key.chunk * kChunkSamples + j) * step);
+            slots.push_back(j);
+        }
+    }
+    std::vector<double> ys(xs.size());
+    function_.evaluateBatch(xs.data(), ys.data(), xs.size());
+    for (size_t k = 0; k < slots.size(); k++)
+        chunk->values[slots[k]] = ys[k];
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunk->lastUse = ++useClock_;
+    chunks_[key] = chunk;
+    stats_.chunkMisses++;
+    stats_.evaluations += xs.size();
+    stats_.reusedSamples += reused;
+    evictLocked();
+}
+
+void SampleCache::collect(int level, double xMin, double xMax, std::vector<PlotPoint>& out) const {
+    CALC_TRACE_SCOPE("SampleCache::collect");
+    int64_t first;
+    int64_t last;
+    if (!indexRange(level, xMin, xMax, maxChunks_, first, last)) {
+        collectDirect(level, xMin, xMax, out);
+        return;
+    }
+    out.clear();
+    out.reserve(static_cast<size_t>(last - first + 1));
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t use = ++useClock_;
+    for (int64_t chunk = floorDiv(first, kChunkSamples); chunk <= floorDiv(last, kChunkSamples); chunk++) {
+        auto it = chunks_.find({ level, chunk });
+        if (it == chunks_.end())
+            continue;
+        it->second->lastUse = use;
+        int64_t base = chunk * kChunkSamples;
+        int64_t begin = std::max(first, base);
+        int64_t end = std::min(last + 1, base + kChunkSamples);
+        const double* values = it->second->values.data();
+        for (int64_t i = begin; i < end; i++)
+            out.push_back({ std::ldexp(static_cast<double>(i), level), values[i - base] });
+    }
+}
+
+void SampleCache::collectDirect(int level, double xMin, double xMax, std::vector<PlotPoint>& out) const {
+    CALC_TRACE_SCOPE("SampleCache::collectDirect");
+    out.clear();
+    if (!std::isfinite(xMin) || !std::isfinite(xMax) || !(xMax >= xMin))
+        return;
+    // Шаг не мельче шага уровня, а точек не больше kMaxDirectSamples, как при кэшировании — с запасом в одну точку
+    double intervals = std::min(kMaxDirectSamples, std::max(1.0, std::ceil((xMax - xMin) / std::ldexp(1.0, level))));
+    double step = (xMax - xMin) / intervals;
+    std::vector<double> xs(static_cast<size_t>(intervals) + 3);
+    for (size_t i = 0; i < xs.size(); i++)
+        xs[i] = xMin + (static_cast<double>(i) - 1.0) * step;
+    std::vector<double> ys(xs.size());
+    function_.evaluateBatch(xs.data(), ys.data(), xs.size());
+    out.reserve(xs.size());
+    for (size_t i = 0; i < xs.size(); i++)
+        out.push_back({ xs[i], ys[i] });
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.evaluations += xs.size();
+}
+
+void SampleCache::evictLocked() {
+    if (chunks_.size() <= maxChunks_)
+        return;
+    std::vector<uint64_t> uses;
+    uses.reserve(chunks_.size());
+    for (const auto& entry : chunks_)
+        uses.push_back(entry.second->lastUse);
+    size_t evict = chunks_.size() - maxChunks_ * 3 / 4;
+    std::nth_element(uses.begin(), uses.begin() + (evict - 1), uses.end());
+    uint64_t cutoff = uses[evict - 1];
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+        if (it->second->lastUse <= cutoff)
+            it = chunks_.erase(it);
+        else
+            ++it;
+    }
+}
+
+SampleCacheStats SampleCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t SampleCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunks_.size();
+}
+
+void SampleCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_.clear();
+}
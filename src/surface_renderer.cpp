@@ -0,0 +1,588 @@
+#include "surface_renderer.h"
+#include "heatmap_tiles.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double kPi = 3.14159265358979323846;
+
+/**
+ * @brief Ближняя плоскость отсечения в нормированных единицах
+ */
+static const float kNear = 0.01f;
+
+/**
+ * @brief Дробных разрядов экранных координат; вершины округляются до 1/16 пикселя,
+ * чтобы функции рёбер соседних треугольников совпадали точно и между ними не было щелей
+ */
+static const int kSubpixelBits = 4;
+static const float kSubpixel = 1 << kSubpixelBits;
+
+/**
+ * @brief Наибольшая экранная координата в пикселях; дальше вершины прижимаются
+ */
+static const float kGuardBand = 1 << 20;
+
+/**
+ * @brief Выполняет body(begin, end) задачами пула или в текущем потоке
+ */
+template <typename F>
+static void forRange(ThreadPool* pool, size_t count, size_t grain, F body) {
+    if (pool && count > grain)
+        pool->parallelFor(0, count, grain, body);
+    else
+        body(0, count);
+}
+
+SurfaceMesh::SurfaceMesh(const Expression& function, double xMin, double xMax, double yMin, double yMax, int resolution,
+    ThreadPool* pool)
+    : resolution_(std::max(kPatchCells, (resolution + kPatchCells - 1) / kPatchCells * kPatchCells)) {
+    CALC_TRACE_SCOPE("SurfaceMesh::SurfaceMesh");
+    const int side = resolution_ + 1;
+    const size_t count = static_cast<size_t>(side) * side;
+    std::vector<double> values(count);
+    forRange(pool, side, 16, [&](size_t begin, size_t end) {
+        size_t points = (end - begin) * side;
+        std::vector<double> xs(points);
+        std::vector<double> ys(points);
+        for (size_t j = begin; j < end; j++) {
+            for (int i = 0; i < side; i++) {
+                xs[(j - begin) * side + i] = xMin + (xMax - xMin) * i / resolution_;
+                ys[(j - begin) * side + i] = yMin + (yMax - yMin) * static_cast<double>(j) / resolution_;
+            }
+        }
+        const double* variables[] = { xs.data(), ys.data() };
+        function.evaluateBatch(variables, &values[begin * side], points);
+    });
+
+    // Шкала по перцентилям, чтобы полюс не сплющил остальную поверхность
+    std::vector<double> finite;
+    finite.reserve(count);
+    for (double value : values) {
+        if (std::isfinite(value))
+            finite.push_back(value);
+    }
+    if (!finite.empty()) {
+        size_t lowIndex = finite.size() / 100;
+        size_t highIndex = finite.size() - 1 - finite.size() / 100;
+        std::nth_element(finite.begin(), finite.begin() + lowIndex, finite.end());
+        low_ = finite[lowIndex];
+        std::nth_element(finite.begin(), finite.begin() + highIndex, finite.end());
+        high_ = finite[highIndex];
+    }
+    if (!(high_ - low_ > 1e-12 * std::max(1.0, std::fabs(low_)))) {
+        low_ -= 0.5;
+        high_ += 0.5;
+    }
+    double mid = 0.5 * (low_ + high_);
+    double scale = 1.0 / (high_ - low_);
+    heights_.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        heights_[k] = std::isfinite(values[k]) ? static_cast<float>(std::min(std::max((values[k] - mid) * scale, -0.5), 0.5))
+                                               : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    // Цвет по высоте, затем рассеянное освещение по нормали из центральных разностей
+    colors_.resize(count * 4);
+    colorizeHeatmap(heights_.data(), count, -0.5f, 0.5f, colors_.data());
+    const float cell = 2.0f / resolution_;
+    const float light[3] = { -0.2f, -0.6f, 0.77f };
+    const float lightLength = std::sqrt(light[0] * light[0] + light[1] * light[1] + light[2] * light[2]);
+    auto slope = [&](int i0, int j0, int i1, int j1) {
+        float d = height(i1, j1) - height(i0, j0);
+        return std::isfinite(d) ? d / (cell * std::max(std::abs(i1 - i0), std::abs(j1 - j0))) : 0.0f;
+    };
+    forRange(pool, side, 64, [&](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++) {
+            int row = static_cast<int>(j);
+            for (int i = 0; i < side; i++) {
+                float dx = slope(std::max(i - 1, 0), row, std::min(i + 1, resolution_), row);
+                float dy = slope(i, std::max(row - 1, 0), i, std::min(row + 1, resolution_));
+                float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+                float diffuse = (-dx * light[0] - dy * light[1] + light[2]) / (length * lightLength);
+                float shade = 0.3f + 0.7f * std::max(diffuse, 0.0f);
+                uint8_t* pixel = &colors_[(j * side + i) * 4];
+                for (int c = 0; c < 3; c++)
+                    pixel[c] = static_cast<uint8_t>(pixel[c] * shade + 0.5f);
+            }
+        }
+    });
+
+    // Ошибки уровней: отклонение каждого узла от треугольника грубой сетки с той же диагональю
+    const int patches = patchCount();
+    errors_.assign(static_cast<size_t>(patches) * patches * kLevels, 0.0f);
+    ranges_.assign(static_cast<size_t>(patches) * patches * 2, std::numeric_limits<float>::quiet_NaN());
+    forRange(pool, static_cast<size_t>(patches) * patches, 4, [&](size_t begin, size_t end) {
+        for (size_t patch = begin; patch < end; patch++) {
+            int baseI = static_cast<int>(patch % patches) * kPatchCells;
+            int baseJ = static_cast<int>(patch / patches) * kPatchCells;
+            float* errors = &errors_[patch * kLevels];
+            float& zMin = ranges_[patch * 2];
+            float& zMax = ranges_[patch * 2 + 1];
+            for (int j = baseJ; j <= baseJ + kPatchCells; j++) {
+                for (int i = baseI; i <= baseI + kPatchCells; i++) {
+                    float h = height(i, j);
+                    if (std::isfinite(h)) {
+                        zMin = std::isfinite(zMin) ? std::min(zMin, h) : h;
+                        zMax = std::isfinite(zMax) ? std::max(zMax, h) : h;
+                    }
+                }
+            }
+            for (int level = 1; level < kLevels; level++) {
+                int step = 1 << level;
+                float error = errors[level - 1];
+                for (int j = baseJ; j <= baseJ + kPatchCells; j++) {
+                    for (int i = baseI; i <= baseI + kPatchCells; i++) {
+                        int ci = std::min(baseI + (i - baseI) / step * step, baseI + kPatchCells - step);
+                        int cj = std::min(baseJ + (j - baseJ) / step * step, baseJ + kPatchCells - step);
+                        float u = static_cast<float>(i - ci) / step;
+                        float v = static_cast<float>(j - cj) / step;
+                        float h00 = height(ci, cj);
+                        float h11 = height(ci + step, cj + step);
+                        float approx = u >= v ? h00 + u * (height(ci + step, cj) - h00) + v * (h11 - height(ci + step, cj))
+                                              : h00 + v * (height(ci, cj + step) - h00) + u * (h11 - height(ci, cj + step));
+                        float h = height(i, j);
+                        if (std::isnan(h) != std::isnan(approx))
+                            error = std::numeric_limits<float>::infinity();
+                        else if (!std::isnan(h))
+                            error = std::max(error, std::fabs(h - approx));
+                    }
+                }
+                errors[level] = error;
+            }
+        }
+    });
+}
+
+bool SurfaceMesh::patchRange(int px, int py, float& zMin, float& zMax) const {
+    size_t patch = static_cast<size_t>(py) * patchCount() + px;
+    zMin = ranges_[patch * 2];
+    zMax = ranges_[patch * 2 + 1];
+    return std::isfinite(zMin);
+}
+
+/**
+ * @brief Система координат камеры и проекция на экран
+ */
+struct CameraBasis {
+    double eye[3];
+    double right[3];
+    double up[3];
+    double forward[3];
+    double focal;
+    double centerX;
+    double centerY;
+    double tanX;
+    double tanY;
+
+    CameraBasis(const SurfaceCamera& camera, int width, int height) {
+        double yaw = camera.yaw * kPi / 180.0;
+        double pitch = std::min(std::max(camera.pitch, -89.0), 89.0) * kPi / 180.0;
+        double distance = std::max(camera.distance, 1e-3);
+        eye[0] = distance * std::cos(pitch) * std::cos(yaw);
+        eye[1] = distance * std::cos(pitch) * std::sin(yaw);
+        eye[2] = distance * std::sin(pitch);
+        for (int k = 0; k < 3; k++)
+            forward[k] = -eye[k] / distance;
+        double length = std::hypot(forward[0], forward[1]);
+        right[0] = forward[1] / length;
+        right[1] = -forward[0] / length;
+        right[2] = 0.0;
+        up[0] = right[1] * forward[2] - right[2] * forward[1];
+        up[1] = right[2] * forward[0] - right[0] * forward[2];
+        up[2] = right[0] * forward[1] - right[1] * forward[0];
+        double fov = std::min(std::max(camera.fov, 1.0), 170.0) * kPi / 180.0;
+        focal = 0.5 * height / std::tan(0.5 * fov);
+        centerX = 0.5 * width;
+        centerY = 0.5 * height;
+        tanX = centerX / focal;
+        tanY = centerY / focal;
+    }
+
+    void toCamera(double x, double y, double z, float* out) const {
+        double dx = x - eye[0];
+        double dy = y - eye[1];
+        double dz = z - eye[2];
+        out[0] = static_cast<float>(dx * right[0] + dy * right[1] + dz * right[2]);
+        out[1] = static_cast<float>(dx * up[0] + dy * up[1] + dz * up[2]);
+        out[2] = static_cast<float>(dx * forward[0] + dy * forward[1] + dz * forward[2]);
+    }
+};
+
+/**
+ * @brief Вершина в координатах камеры с цветом
+ */
+struct CameraVertex {
+    float position[3];
+    float color[3];
+};
+
+/**
+ * @brief Вершина на экране: координаты в 1/16 пикселя, 1 / глубина и цвет
+ */
+struct ScreenVertex {
+    int32_t x;
+    int32_t y;
+    float invZ;
+    float color[3];
+};
+
+/**
+ * @brief Треугольник, ориентированный так, что его площадь положительна
+ */
+struct ScreenTriangle {
+    ScreenVertex v[3];
+    int yMin;
+    int yMax;
+};
+
+/**
+ * @brief Треугольники одного участка и строки экрана, которые они занимают
+ */
+struct PatchTriangles {
+    std::vector<ScreenTriangle> triangles;
+    int yMin = std::numeric_limits<int>::max();
+    int yMax = std::numeric_limits<int>::min();
+    uint64_t backFaces = 0;
+};
+
+/**
+ * @brief Проецирует треугольник перед ближней плоскостью, отбрасывает нелицевые и невидимые
+ */
+static void emitProjected(const CameraVertex* vertices, const CameraBasis& basis, int width, int height, bool cullBackFaces,
+    PatchTriangles& out) {
+    ScreenTriangle triangle;
+    float xMin = kGuardBand;
+    float xMax = -kGuardBand;
+    float yMin = kGuardBand;
+    float yMax = -kGuardBand;
+    for (int k = 0; k < 3; k++) {
+        const CameraVertex& vertex = vertices[k];
+        float invZ = 1.0f / vertex.position[2];
+        float x = std::min(std::max(static_cast<float>(basis.centerX + basis.focal * vertex.position[0] * invZ), -kGuardBand), kGuardBand);
+        float y = std::min(std::max(static_cast<float>(basis.centerY - basis.focal * vertex.position[1] * invZ), -kGuardBand), kGuardBand);
+        triangle.v[k].x = static_cast<int32_t>(std::lround(x * kSubpixel));
+        triangle.v[k].y = static_cast<int32_t>(std::lround(y * kSubpixel));
+        triangle.v[k].invZ = invZ;
+        std::copy(vertex.color, vertex.color + 3, triangle.v[k].color);
+        xMin = std::min(xMin, x);
+        xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y);
+        yMax = std::max(yMax, y);
+    }
+    if (xMax < 0.0f || xMin > width || yMax < 0.0f || yMin > height)
+        return;
+    const ScreenVertex& a = triangle.v[0];
+    const ScreenVertex& b = triangle.v[1];
+    const ScreenVertex& c = triangle.v[2];
+    int64_t area = static_cast<int64_t>(b.x - a.x) * (c.y - a.y) - static_cast<int64_t>(c.x - a.x) * (b.y - a.y);
+    if (area == 0)
+        return;
+    // Лицевая сторона (вид сверху, обход против часовой стрелки) на экране с осью y вниз имеет отрицательную площадь
+    if (area > 0) {
+        if (cullBackFaces) {
+            out.backFaces++;
+            return;
+        }
+    }
+    else
+        std::swap(triangle.v[1], triangle.v[2]);
+    triangle.yMin = std::max(static_cast<int>(std::floor(yMin)), 0);
+    triangle.yMax = std::min(static_cast<int>(std::ceil(yMax)), height - 1);
+    out.yMin = std::min(out.yMin, triangle.yMin);
+    out.yMax = std::max(out.yMax, triangle.yMax);
+    out.triangles.push_back(triangle);
+}
+
+/**
+ * @brief Обрезает треугольник ближней плоскостью (0, 1 или 2 треугольника) и передаёт части на проекцию
+ */
+static void emitTriangle(const CameraVertex& a, const CameraVertex& b, const CameraVertex& c, const CameraBasis& basis,
+    int width, int height, bool cullBackFaces, PatchTriangles& out) {
+    const CameraVertex* input[3] = { &a, &b, &c };
+    int inside = 0;
+    for (const CameraVertex* vertex : input)
+        inside += vertex->position[2] >= kNear;
+    if (inside == 0)
+        return;
+    if (inside == 3) {
+        CameraVertex vertices[3] = { a, b, c };
+        emitProjected(vertices, basis, width, height, cullBackFaces, out);
+        return;
+    }
+    CameraVertex polygon[4];
+    int count = 0;
+    for (int k = 0; k < 3; k++) {
+        const CameraVertex& p = *input[k];
+        const CameraVertex& q = *input[(k + 1) % 3];
+        bool pInside = p.position[2] >= kNear;
+        bool qInside = q.position[2] >= kNear;
+        if (pInside)
+            polygon[count++] = p;
+        if (pInside != qInside) {
+            float t = (kNear - p.position[2]) / (q.position[2] - p.position[2]);
+            CameraVertex& cut = polygon[count++];
+            for (int m = 0; m < 3; m++) {
+                cut.position[m] = p.position[m] + t * (q.position[m] - p.position[m]);
+                cut.color[m] = p.color[m] + t * (q.color[m] - p.color[m]);
+            }
+            cut.position[2] = kNear;
+        }
+    }
+    for (int k = 1; k + 1 < count; k++) {
+        CameraVertex vertices[3] = { polygon[0], polygon[k], polygon[k + 1] };
+        emitProjected(vertices, basis, width, height, cullBackFaces, out);
+    }
+}
+
+/**
+ * @brief Первый и последний пиксель строки, где функция ребра w + step * k неотрицательна
+ */
+static void clipSpan(int64_t w, int64_t step, int& first, int& last) {
+    if (step > 0) {
+        if (w < 0)
+            first = std::max(first, static_cast<int>((-w + step - 1) / step));
+    }
+    else if (step < 0) {
+        if (w < 0)
+            last = -1;
+        else
+            last = std::min(last, static_cast<int>(w / -step));
+    }
+    else if (w < 0)
+        last = -1;
+}
+
+/**
+ * @brief Растеризует треугольник в строках [rowBegin, rowEnd) с тестом глубины
+ *
+ * Отрезок строки внутри треугольника находится из функций рёбер точно, а глубина и цвет
+ * в нём меняются на постоянные приращения, так что на пиксель приходятся только сложения.
+ *
+ * @return Число записанных пикселей
+ */
+static uint64_t rasterize(const ScreenTriangle& triangle, int rowBegin, int rowEnd, SurfaceFrame& frame) {
+    const ScreenVertex& a = triangle.v[0];
+    const ScreenVertex& b = triangle.v[1];
+    const ScreenVertex& c = triangle.v[2];
+    int64_t area = static_cast<int64_t>(b.x - a.x) * (c.y - a.y) - static_cast<int64_t>(c.x - a.x) * (b.y - a.y);
+    int32_t xLow = std::min(a.x, std::min(b.x, c.x));
+    int32_t xHigh = std::max(a.x, std::max(b.x, c.x));
+    int32_t yLow = std::min(a.y, std::min(b.y, c.y));
+    int32_t yHigh = std::max(a.y, std::max(b.y, c.y));
+    // Центр пикселя (x, y) — точка (x + 0.5, y + 0.5)
+    const int32_t half = 1 << (kSubpixelBits - 1);
+    int xBegin = std::max(static_cast<int>((xLow - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits), 0);
+    int xEnd = std::min(static_cast<int>((xHigh - half) >> kSubpixelBits), frame.width - 1);
+    int yBegin = std::max(static_cast<int>((yLow - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits), rowBegin);
+    int yEnd = std::min(static_cast<int>((yHigh - half) >> kSubpixelBits), rowEnd - 1);
+    if (xBegin > xEnd || yBegin > yEnd)
+        return 0;
+
+    // Функция ребра pq в точке s: (q - p) x (s - p); внутри треугольника все три неотрицательны
+    auto edge = [](const ScreenVertex& p, const ScreenVertex& q, int64_t sx, int64_t sy) {
+        return static_cast<int64_t>(q.x - p.x) * (sy - p.y) - static_cast<int64_t>(q.y - p.y) * (sx - p.x);
+    };
+    const int64_t stepCA = -static_cast<int64_t>(a.y - c.y) * (1 << kSubpixelBits);
+    const int64_t stepAB = -static_cast<int64_t>(b.y - a.y) * (1 << kSubpixelBits);
+    const int64_t stepBC = -static_cast<int64_t>(c.y - b.y) * (1 << kSubpixelBits);
+    // Атрибут = a + (b - a) * wb / area + (c - a) * wc / area; приращения на пиксель по x
+    const float invArea = 1.0f / static_cast<float>(area);
+    float attributes[4][3];
+    const float starts[3][4] = { { a.invZ, a.color[0], a.color[1], a.color[2] },
+        { b.invZ, b.color[0], b.color[1], b.color[2] }, { c.invZ, c.color[0], c.color[1], c.color[2] } };
+    for (int k = 0; k < 4; k++) {
+        attributes[k][0] = starts[0][k];
+        attributes[k][1] = (starts[1][k] - starts[0][k]) * invArea;
+        attributes[k][2] = (starts[2][k] - starts[0][k]) * invArea;
+    }
+    float deltas[4];
+    for (int k = 0; k < 4; k++)
+        deltas[k] = attributes[k][1] * stepCA + attributes[k][2] * stepAB;
+
+    uint64_t written = 0;
+    for (int y = yBegin; y <= yEnd; y++) {
+        int64_t sy = (static_cast<int64_t>(y) << kSubpixelBits) + half;
+        int64_t sx = (static_cast<int64_t>(xBegin) << kSubpixelBits) + half;
+        int64_t wa = edge(b, c, sx, sy);
+        int64_t wb = edge(c, a, sx, sy);
+        int64_t wc = edge(a, b, sx, sy);
+        int first = 0;
+        int last = xEnd - xBegin;
+        clipSpan(wa, stepBC, first, last);
+        clipSpan(wb, stepCA, first, last);
+        clipSpan(wc, stepAB, first, last);
+        if (first > last)
+            continue;
+        float fb = static_cast<float>(wb + stepCA * first);
+        float fc = static_cast<float>(wc + stepAB * first);
+        float values[4];
+        for (int k = 0; k < 4; k++)
+            values[k] = attributes[k][0] + attributes[k][1] * fb + attributes[k][2] * fc;
+        size_t index = static_cast<size_t>(y) * frame.width + xBegin + first;
+        float* depth = &frame.depth[index];
+        uint8_t* pixel = &frame.rgba[index * 4];
+        for (int x = first; x <= last; x++, depth++, pixel += 4) {
+            if (values[0] > *depth) {
+                *depth = values[0];
+                for (int k = 0; k < 3; k++)
+                    pixel[k] = static_cast<uint8_t>(std::min(std::max(values[k + 1], 0.0f), 255.0f));
+                pixel[3] = 255;
+                written++;
+            }
+            for (int k = 0; k < 4; k++)
+                values[k] += deltas[k];
+        }
+    }
+    return written;
+}
+
+SurfaceRenderStats SurfaceRenderer::render(const SurfaceMesh& mesh, const SurfaceCamera& camera, SurfaceFrame& frame,
+    ThreadPool* pool) const {
+    CALC_TRACE_SCOPE("SurfaceRenderer::render");
+    SurfaceRenderStats stats;
+    const int width = std::max(frame.width, 1);
+    const int height = std::max(frame.height, 1);
+    frame.width = width;
+    frame.height = height;
+    frame.rgba.assign(static_cast<size_t>(width) * height * 4, 0);
+    frame.depth.assign(static_cast<size_t>(width) * height, 0.0f);
+    const CameraBasis basis(camera, width, height);
+
+    // Уровень каждого участка по экранной ошибке и отсечение по пирамиде видимости
+    const int patches = mesh.patchCount();
+    const double patchSize = 2.0 / patches;
+    std::vector<int> levels(static_cast<size_t>(patches) * patches, SurfaceMesh::kLevels - 1);
+    std::vector<int> visible;
+    for (int py = 0; py < patches; py++) {
+        for (int px = 0; px < patches; px++) {
+            float zMin = 0.0f;
+            float zMax = 0.0f;
+            if (!mesh.patchRange(px, py, zMin, zMax))
+                continue;
+            double box[2][3] = { { -1.0 + px * patchSize, -1.0 + py * patchSize, zMin },
+                { -1.0 + (px + 1) * patchSize, -1.0 + (py + 1) * patchSize, zMax } };
+            int outside[5] = { 0, 0, 0, 0, 0 };
+            for (int corner = 0; corner < 8; corner++) {
+                float p[3];
+                basis.toCamera(box[corner & 1][0], box[(corner >> 1) & 1][1], box[corner >> 2][2], p);
+                outside[0] += p[2] < kNear;
+                outside[1] += p[0] > p[2] * basis.tanX;
+                outside[2] += p[0] < -p[2] * basis.tanX;
+                outside[3] += p[1] > p[2] * basis.tanY;
+                outside[4] += p[1] < -p[2] * basis.tanY;
+            }
+            if (std::find(outside, outside + 5, 8) != outside + 5) {
+                stats.culled++;
+                continue;
+            }
+            double dx = std::max({ box[0][0] - basis.eye[0], 0.0, basis.eye[0] - box[1][0] });
+            double dy = std::max({ box[0][1] - basis.eye[1], 0.0, basis.eye[1] - box[1][1] });
+            double dz = std::max({ box[0][2] - basis.eye[2], 0.0, basis.eye[2] - box[1][2] });
+            double distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz), static_cast<double>(kNear));
+            int level = SurfaceMesh::kLevels - 1;
+            while (level > 0 && mesh.patchError(px, py, level) * basis.focal / distance > options_.tolerance)
+                level--;
+            levels[static_cast<size_t>(py) * patches + px] = level;
+            visible.push_back(py * patches + px);
+            stats.patches++;
+        }
+    }
+
+    // Вершины и треугольники участков; края у более грубого соседа ложатся на его рёбра
+    std::vector<PatchTriangles> lists(visible.size());
+    forRange(pool, visible.size(), 1, [&](size_t begin, size_t end) {
+        std::vector<CameraVertex> vertices;
+        std::vector<char> defined;
+        for (size_t v = begin; v < end; v++) {
+            int px = visible[v] % patches;
+            int py = visible[v] / patches;
+            int level = levels[visible[v]];
+            int step = 1 << level;
+            int cells = SurfaceMesh::kPatchCells / step;
+            int left = px > 0 ? levels[visible[v] - 1] : level;
+            int right = px + 1 < patches ? levels[visible[v] + 1] : level;
+            int bottom = py > 0 ? levels[visible[v] - patches] : level;
+            int top = py + 1 < patches ? levels[visible[v] + patches] : level;
+            int baseI = px * SurfaceMesh::kPatchCells;
+            int baseJ = py * SurfaceMesh::kPatchCells;
+            vertices.resize(static_cast<size_t>(cells + 1) * (cells + 1));
+            defined.resize(vertices.size());
+            for (int b = 0; b <= cells; b++) {
+                for (int a = 0; a <= cells; a++) {
+                    int i = baseI + a * step;
+                    int j = baseJ + b * step;
+                    float h = mesh.height(i, j);
+                    const uint8_t* color = mesh.color(i, j);
+                    float rgb[3] = { static_cast<float>(color[0]), static_cast<float>(color[1]), static_cast<float>(color[2]) };
+                    int snap = (a == 0 && left > level) ? left : (a == cells && right > level) ? right : 0;
+                    bool alongJ = snap != 0;
+                    if (!alongJ)
+                        snap = (b == 0 && bottom > level) ? bottom : (b == cells && top > level) ? top : 0;
+                    if (snap != 0) {
+                        int coarse = 1 << snap;
+                        int position = alongJ ? j : i;
+                        int first = position / coarse * coarse;
+                        if (first != position) {
+                            float t = static_cast<float>(position - first) / coarse;
+                            int i0 = alongJ ? i : first;
+                            int j0 = alongJ ? first : j;
+                            int i1 = alongJ ? i : first + coarse;
+                            int j1 = alongJ ? first + coarse : j;
+                            h = mesh.height(i0, j0) + t * (mesh.height(i1, j1) - mesh.height(i0, j0));
+                            const uint8_t* c0 = mesh.color(i0, j0);
+                            const uint8_t* c1 = mesh.color(i1, j1);
+                            for (int k = 0; k < 3; k++)
+                                rgb[k] = c0[k] + t * (c1[k] - c0[k]);
+                        }
+                    }
+                    size_t index = static_cast<size_t>(b) * (cells + 1) + a;
+                    defined[index] = !std::isnan(h);
+                    basis.toCamera(-1.0 + 2.0 * i / mesh.resolution(), -1.0 + 2.0 * j / mesh.resolution(), h,
+                        vertices[index].position);
+                    std::copy(rgb, rgb + 3, vertices[index].color);
+                }
+            }
+            PatchTriangles& out = lists[v];
+            for (int b = 0; b < cells; b++) {
+                for (int a = 0; a < cells; a++) {
+                    size_t v00 = static_cast<size_t>(b) * (cells + 1) + a;
+                    size_t v10 = v00 + 1;
+                    size_t v01 = v00 + cells + 1;
+                    size_t v11 = v01 + 1;
+                    if (defined[v00] && defined[v10] && defined[v11])
+                        emitTriangle(vertices[v00], vertices[v10], vertices[v11], basis, width, height, options_.cullBackFaces, out);
+                    if (defined[v00] && defined[v11] && defined[v01])
+                        emitTriangle(vertices[v00], vertices[v11], vertices[v01], basis, width, height, options_.cullBackFaces, out);
+                }
+            }
+        }
+    });
+    for (const auto& list : lists) {
+        stats.triangles += list.triangles.size();
+        stats.backFaces += list.backFaces;
+    }
+
+    // Полосы экрана растеризуются независимо: каждая пишет только в свои строки
+    const int bandHeight = std::max(options_.bandHeight, 1);
+    const size_t bands = static_cast<size_t>((height + bandHeight - 1) / bandHeight);
+    std::vector<uint64_t> written(bands, 0);
+    forRange(pool, bands, 1, [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; band++) {
+            int rowBegin = static_cast<int>(band) * bandHeight;
+            int rowEnd = std::min(rowBegin + bandHeight, height);
+            for (const auto& list : lists) {
+                if (list.yMax < rowBegin || list.yMin >= rowEnd)
+                    continue;
+                for (const auto& triangle : list.triangles) {
+                    if (triangle.yMax >= rowBegin && triangle.yMin < rowEnd)
+                        written[band] += rasterize(triangle, rowBegin, rowEnd, frame);
+                }
+            }
+        }
+    });
+    for (uint64_t count : written)
+        stats.pixels += count;
+    return stats;
+}
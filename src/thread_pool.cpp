@@ -0,0 +1,83 @@
+#include "thread_pool.h"
+
+/**
+ * @brief Пул и номер очереди текущего рабочего потока (nullptr вне рабочих потоков)
+ */
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local size_t currentIndex = 0;
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threads; i++)
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    for (size_t i = 0; i < threads; i++)
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    size_t index = currentPool == this ? currentIndex
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Счётчик меняется под мьютексом сна, чтобы поток не уснул, пропустив уведомление
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::tryPop(size_t index, std::function<void()>& task) {
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::trySteal(size_t index, std::function<void()>& task) {
+    for (size_t offset = 1; offset < queues_.size(); offset++) {
+        WorkerQueue& queue = *queues_[(index + offset) % queues_.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty())
+            continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    for (;;) {
+        std::function<void()> task;
+        if (tryPop(index, task) || trySteal(index, task)) {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (pending_.load(std::memory_order_acquire) > 0)
+            continue;
+        if (stopping_)
+            return;
+        wake_.wait(lock, [this]() { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+    }
+}
@@ -0,0 +1,113 @@
+#include "trace.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Событие трассы
+ */
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+/**
+ * @brief Буфер событий одного потока
+ *
+ * Пишет в него только поток-владелец; число записанных событий публикуется
+ * через атомарный счётчик, поэтому чтение при выводе трассы не требует блокировок.
+ */
+struct ThreadTraceBuffer {
+    static constexpr size_t kCapacity = 1 << 16;
+
+    int threadId = 0;
+    const char* threadName = nullptr;
+    std::unique_ptr<TraceEvent[]> events{ new TraceEvent[kCapacity] };
+    std::atomic<size_t> size{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+};
+
+/**
+ * @brief Реестр буферов всех потоков
+ *
+ * Буферы принадлежат реестру и переживают свои потоки, чтобы трассу можно было
+ * записать после их завершения. Мьютекс берётся только при регистрации нового потока.
+ */
+static std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::vector<std::unique_ptr<ThreadTraceBuffer>>& registry() {
+    static std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers;
+    return buffers;
+}
+
+static ThreadTraceBuffer& threadBuffer() {
+    thread_local ThreadTraceBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(std::make_unique<ThreadTraceBuffer>());
+        buffer = registry().back().get();
+        buffer->threadId = static_cast<int>(registry().size());
+    }
+    return *buffer;
+}
+
+void traceRecord(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadTraceBuffer& buffer = threadBuffer();
+    size_t index = buffer.size.load(std::memory_order_relaxed);
+    if (index >= ThreadTraceBuffer::kCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[index] = TraceEvent{ name, startNs, endNs };
+    buffer.size.store(index + 1, std::memory_order_release);
+}
+
+void traceSetThreadName(const char* name) {
+    threadBuffer().threadName = name;
+}
+
+bool traceWriteChromeJson(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex());
+    uint64_t originNs = UINT64_MAX;
+    for (const auto& buffer : registry()) {
+        size_t size = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; i++) {
+            if (buffer->events[i].startNs < originNs)
+                originNs = buffer->events[i].startNs;
+        }
+    }
+
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& buffer : registry()) {
+        if (buffer->threadName) {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", buffer->threadId, buffer->threadName);
+            first = false;
+        }
+        size_t size = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; i++) {
+            const TraceEvent& event = buffer->events[i];
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", event.name, buffer->threadId,
+                (event.startNs - originNs) / 1000.0, (event.endNs - event.startNs) / 1000.0);
+            first = false;
+        }
+        uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped)
+            std::fprintf(stderr, "trace: thread %d dropped %llu events\n", buffer->threadId,
+                static_cast<unsigned long long>(dropped));
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return std::fclose(file) == 0;
+}
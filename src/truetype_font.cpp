@@ -0,0 +1,341 @@
+#include "truetype_font.h"
+#include "coverage_rasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Чтение целых чисел в порядке big-endian, принятом в TrueType
+ */
+static uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static int16_t readI16(const uint8_t* p) {
+    return static_cast<int16_t>(readU16(p));
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+TrueTypeFont::TrueTypeFont(const uint8_t* data, size_t size) : data_(data), size_(size) {
+    if (size < 12)
+        throw std::runtime_error("Font data is too short");
+    uint32_t head = findTable("head");
+    uint32_t hhea = findTable("hhea");
+    uint32_t maxp = findTable("maxp");
+    glyf_ = findTable("glyf");
+    loca_ = findTable("loca");
+    hmtx_ = findTable("hmtx");
+    uint32_t cmap = findTable("cmap");
+    if (!head || !hhea || !maxp || !glyf_ || !loca_ || !hmtx_ || !cmap)
+        throw std::runtime_error("Font is not a TrueType outline font");
+
+    unitsPerEm_ = readU16(data_ + head + 18);
+    indexToLocFormat_ = readI16(data_ + head + 50);
+    numGlyphs_ = readU16(data_ + maxp + 4);
+    ascent_ = readI16(data_ + hhea + 4);
+    descent_ = readI16(data_ + hhea + 6);
+    lineGap_ = readI16(data_ + hhea + 8);
+    numHMetrics_ = readU16(data_ + hhea + 34);
+
+    // Предпочитаем полную таблицу Юникода (формат 12), затем BMP (формат 4)
+    int subtables = readU16(data_ + cmap + 2);
+    for (int i = 0; i < subtables; i++) {
+        const uint8_t* record = data_ + cmap + 4 + i * 8;
+        int platform = readU16(record);
+        int encoding = readU16(record + 2);
+        uint32_t offset = cmap + readU32(record + 4);
+        int format = readU16(data_ + offset);
+        bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        if (!unicode)
+            continue;
+        if (format == 12 || (format == 4 && (!cmap_ || readU16(data_ + cmap_) != 12)))
+            cmap_ = offset;
+    }
+    if (!cmap_)
+        throw std::runtime_error("Font has no Unicode character map");
+}
+
+uint32_t TrueTypeFont::findTable(const char* tag) const {
+    int tables = readU16(data_ + 4);
+    for (int i = 0; i < tables; i++) {
+        const uint8_t* record = data_ + 12 + i * 16;
+        if (std::memcmp(record, tag, 4) == 0) {
+            uint32_t offset = readU32(record + 8);
+            if (offset + readU32(record + 12) > size_)
+                throw std::runtime_error("Font table is out of bounds");
+            return offset;
+        }
+    }
+    return 0;
+}
+
+int TrueTypeFont::glyphIndex(uint32_t codepoint) const {
+    const uint8_t* table = data_ + cmap_;
+    if (readU16(table) == 12) {
+        uint32_t groups = readU32(table + 12);
+        for (uint32_t i = 0; i < groups; i++) {
+            const uint8_t* group = table + 16 + i * 12;
+            uint32_t start = readU32(group);
+            uint32_t end = readU32(group + 4);
+            if (codepoint >= start && codepoint <= end)
+                return static_cast<int>(readU32(group + 8) + codepoint - start);
+        }
+        return 0;
+    }
+    if (codepoint > 0xFFFF)
+        return 0;
+    int segments = readU16(table + 6) / 2;
+    const uint8_t* endCodes = table + 14;
+    const uint8_t* startCodes = endCodes + segments * 2 + 2;
+    const uint8_t* deltas = startCodes + segments * 2;
+    const uint8_t* rangeOffsets = deltas + segments * 2;
+    for (int i = 0; i < segments; i++) {
+        if (codepoint > readU16(endCodes + i * 2))
+            continue;
+        uint32_t start = readU16(startCodes + i * 2);
+        if (codepoint < start)
+            return 0;
+        uint16_t delta = readU16(deltas + i * 2);
+        uint16_t rangeOffset = readU16(rangeOffsets + i * 2);
+        if (rangeOffset == 0)
+            return static_cast<uint16_t>(codepoint + delta);
+        uint16_t glyph = readU16(rangeOffsets + i * 2 + rangeOffset + (codepoint - start) * 2);
+        return glyph ? static_cast<uint16_t>(glyph + delta) : 0;
+    }
+    return 0;
+}
+
+int TrueTypeFont::advanceWidth(int glyph) const {
+    int metric = std::min(glyph, numHMetrics_ - 1);
+    return readU16(data_ + hmtx_ + metric * 4);
+}
+
+void TrueTypeFont::appendOutline(int glyph, const float transform[6], int depth,
+    std::vector<std::vector<OutlinePoint>>& contours) const {
+    if (glyph < 0 || glyph >= numGlyphs_ || depth > 8)
+        return;
+    uint32_t start;
+    uint32_t end;
+    if (indexToLocFormat_ == 0) {
+        start = readU16(data_ + loca_ + glyph * 2) * 2u;
+        end = readU16(data_ + loca_ + glyph * 2 + 2) * 2u;
+    }
+    else {
+        start = readU32(data_ + loca_ + glyph * 4);
+        end = readU32(data_ + loca_ + glyph * 4 + 4);
+    }
+    if (start == end)
+        return;
+    const uint8_t* p = data_ + glyf_ + start;
+    int contourCount = readI16(p);
+
+    if (contourCount < 0) {
+        // Составной глиф: рекурсивно добавляем компоненты с их преобразованиями
+        const uint8_t* component = p + 10;
+        uint16_t flags;
+        do {
+            flags = readU16(component);
+            int child = readU16(component + 2);
+            component += 4;
+            float dx;
+            float dy;
+            if (flags & 0x0001) {
+                dx = readI16(component);
+                dy = readI16(component + 2);
+                component += 4;
+            }
+            else {
+                dx = static_cast<int8_t>(component[0]);
+                dy = static_cast<int8_t>(component[1]);
+                component += 2;
+            }
+            float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f;
+            if (flags & 0x0008) {
+                a = d = readI16(component) / 16384.0f;
+                component += 2;
+            }
+            else if (flags & 0x0040) {
+                a = readI16(component) / 16384.0f;
+                d = readI16(component + 2) / 16384.0f;
+                component += 4;
+            }
+            else if (flags & 0x0080) {
+                a = readI16(component) / 16384.0f;
+                b = readI16(component + 2) / 16384.0f;
+                c = readI16(component + 4) / 16384.0f;
+                d = readI16(component + 6) / 16384.0f;
+                component += 8;
+            }
+            if (!(flags & 0x0002))
+                dx = dy = 0.0f;
+            float local[6] = {
+                transform[0] * a + transform[2] * b, transform[1] * a + transform[3] * b,
+                transform[0] * c + transform[2] * d, transform[1] * c + transform[3] * d,
+                transform[0] * dx + transform[2] * dy + transform[4],
+                transform[1] * dx + transform[3] * dy + transform[5]
+            };
+            appendOutline(child, local, depth + 1, contours);
+        } while (flags & 0x0020);
+        return;
+    }
+
+    const uint8_t* endPoints = p + 10;
+    int pointCount = contourCount ? readU16(endPoints + (contourCount - 1) * 2) + 1 : 0;
+    const uint8_t* cursor = endPoints + contourCount * 2;
+    cursor += 2 + readU16(cursor);
+
+    std::vector<uint8_t> flags(pointCount);
+    for (int i = 0; i < pointCount;) {
+        uint8_t flag = *cursor++;
+        int repeat = (flag & 0x08) ? *cursor++ : 0;
+        for (int r = 0; r <= repeat && i < pointCount; r++)
+            flags[i++] = flag;
+    }
+    std::vector<int> xs(pointCount);
+    std::vector<int> ys(pointCount);
+    int value = 0;
+    for (int i = 0; i < pointCount; i++) {
+        if (flags[i] & 0x02) {
+            int delta = *cursor++;
+            value += (flags[i] & 0x10) ? delta : -delta;
+        }
+        else if (!(flags[i] & 0x10)) {
+            value += readI16(cursor);
+            cursor += 2;
+        }
+        xs[i] = value;
+    }
+    value = 0;
+    for (int i = 0; i < pointCount; i++) {
+        if (flags[i] & 0x04) {
+            int delta = *cursor++;
+            value += (flags[i] & 0x20) ? delta : -delta;
+        }
+        else if (!(flags[i] & 0x20)) {
+            value += readI16(cursor);
+            cursor += 2;
+        }
+        ys[i] = value;
+    }
+
+    int first = 0;
+    for (int contour = 0; contour < contourCount; contour++) {
+        int last = readU16(endPoints + contour * 2);
+        std::vector<OutlinePoint> points;
+        for (int i = first; i <= last; i++) {
+            OutlinePoint point;
+            point.x = transform[0] * xs[i] + transform[2] * ys[i] + transform[4];
+            point.y = transform[1] * xs[i] + transform[3] * ys[i] + transform[5];
+            point.onCurve = (flags[i] & 0x01) != 0;
+            points.push_back(point);
+        }
+        if (!points.empty())
+            contours.push_back(points);
+        first = last + 1;
+    }
+}
+
+GlyphBitmap TrueTypeFont::rasterize(int glyph, float pixelSize) const {
+    GlyphBitmap bitmap;
+    float scale = pixelSize / unitsPerEm_;
+    bitmap.advance = advanceWidth(glyph) * scale;
+
+    const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    std::vector<std::vector<OutlinePoint>> contours;
+    appendOutline(glyph, identity, 0, contours);
+    if (contours.empty())
+        return bitmap;
+
+    float minX = contours[0][0].x, maxX = minX;
+    float minY = contours[0][0].y, maxY = minY;
+    for (const auto& contour : contours) {
+        for (const auto& point : contour) {
+            minX = std::min(minX, point.x);
+            maxX = std::max(maxX, point.x);
+            minY = std::min(minY, point.y);
+            maxY = std::max(maxY, point.y);
+        }
+    }
+    int x0 = static_cast<int>(std::floor(minX * scale));
+    int x1 = static_cast<int>(std::ceil(maxX * scale));
+    int y0 = static_cast<int>(std::floor(minY * scale));
+    int y1 = static_cast<int>(std::ceil(maxY * scale));
+    bitmap.width = std::max(1, x1 - x0);
+    bitmap.height = std::max(1, y1 - y0);
+    bitmap.left = x0;
+    bitmap.top = -y1;
+
+    CoverageRasterizer rasterizer(bitmap.width, bitmap.height);
+    auto toPixelX = [&](float x) { return x * scale - x0; };
+    auto toPixelY = [&](float y) { return y1 - y * scale; };
+    for (const auto& contour : contours) {
+        size_t count = contour.size();
+        // Начинаем с точки на кривой; если таких нет, с середины первых двух управляющих точек
+        size_t startIndex = 0;
+        while (startIndex < count && !contour[startIndex].onCurve)
+            startIndex++;
+        float startX;
+        float startY;
+        if (startIndex == count) {
+            startIndex = 0;
+            startX = (contour[0].x + contour[1 % count].x) * 0.5f;
+            startY = (contour[0].y + contour[1 % count].y) * 0.5f;
+        }
+        else {
+            startX = contour[startIndex].x;
+            startY = contour[startIndex].y;
+        }
+        float penX = startX;
+        float penY = startY;
+        bool hasControl = false;
+        float controlX = 0.0f;
+        float controlY = 0.0f;
+        for (size_t step = 1; step <= count; step++) {
+            const OutlinePoint& point = contour[(startIndex + step) % count];
+            if (point.onCurve) {
+                if (hasControl)
+                    rasterizer.addQuadratic(toPixelX(penX), toPixelY(penY), toPixelX(controlX), toPixelY(controlY),
+                        toPixelX(point.x), toPixelY(point.y));
+                else
+                    rasterizer.addLine(toPixelX(penX), toPixelY(penY), toPixelX(point.x), toPixelY(point.y));
+                penX = point.x;
+                penY = point.y;
+                hasControl = false;
+            }
+            else {
+                if (hasControl) {
+                    float midX = (controlX + point.x) * 0.5f;
+                    float midY = (controlY + point.y) * 0.5f;
+                    rasterizer.addQuadratic(toPixelX(penX), toPixelY(penY), toPixelX(controlX), toPixelY(controlY),
+                        toPixelX(midX), toPixelY(midY));
+                    penX = midX;
+                    penY = midY;
+                }
+                controlX = point.x;
+                controlY = point.y;
+                hasControl = true;
+            }
+        }
+        if (hasControl)
+            rasterizer.addQuadratic(toPixelX(penX), toPixelY(penY), toPixelX(controlX), toPixelY(controlY),
+                toPixelX(startX), toPixelY(startY));
+        else if (penX != startX || penY != startY)
+            rasterizer.addLine(toPixelX(penX), toPixelY(penY), toPixelX(startX), toPixelY(startY));
+    }
+    bitmap.pixels.resize(static_cast<size_t>(bitmap.width) * bitmap.height);
+    rasterizer.resolve(bitmap.pixels.data());
+    return bitmap;
+}
+
+float TrueTypeFont::measure(const std::vector<uint32_t>& codepoints, float pixelSize) const {
+    float scale = pixelSize / unitsPerEm_;
+    float width = 0.0f;
+    for (uint32_t codepoint : codepoints)
+        width += advanceWidth(glyphIndex(codepoint)) * scale;
+    return width;
+}
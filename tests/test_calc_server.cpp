@@ -0,0 +1,171 @@
+#ifdef __linux__
+#include "doctest.h"
+#include "../include/calc_protocol.h"
+#include "../include/calc_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+TEST_CASE("calc protocol tests") {
+    std::string buffer;
+    appendRequest(buffer, 7, "2 + 2");
+    appendResponse(buffer, 7, CalcStatus::Ok, -1.5, "");
+    appendResponse(buffer, 8, CalcStatus::Error, 0.0, "Division by zero");
+
+    std::string_view payload;
+    CHECK(nextFrame(std::string_view(buffer).substr(0, 8), payload) == 0);
+    size_t offset = nextFrame(buffer, payload);
+    REQUIRE(offset == 13);
+    uint32_t id = 0;
+    std::string_view expression;
+    CHECK(decodeRequest(payload, id, expression));
+    CHECK(id == 7);
+    CHECK(expression == "2 + 2");
+
+    CalcResponse response;
+    offset += nextFrame(std::string_view(buffer).substr(offset), payload);
+    CHECK(decodeResponse(payload, response));
+    CHECK(response.id == 7);
+    CHECK(response.status == CalcStatus::Ok);
+    CHECK(response.value == -1.5);
+    REQUIRE(nextFrame(std::string_view(buffer).substr(offset), payload) > 0);
+    CHECK(decodeResponse(payload, response));
+    CHECK(response.id == 8);
+    CHECK(response.status == CalcStatus::Error);
+    CHECK(response.error == "Division by zero");
+
+    std::string huge;
+    appendRequest(huge, 1, std::string(kMaxFrameSize, '1'));
+    CHECK_THROWS_AS(nextFrame(huge, payload), std::runtime_error);
+}
+
+TEST_CASE("CalcServer tests") {
+    CalcServerOptions options;
+    options.socketPath = "calc_server_test.sock";
+    options.metricsPath = "calc_server_test.metrics.sock";
+    options.threads = 2;
+    options.batchSize = 8;
+    CalcServer server(options);
+    std::thread loop([&server]() { server.run(); });
+
+    {
+        // Запросы отправляются одной записью: одинаковые выражения оказываются в пути одновременно
+        CalcClient client(options.socketPath);
+        const int kRequests = 1000;
+        for (int i = 0; i < kRequests; i++)
+            client.send(static_cast<uint32_t>(i), i % 100 == 0 ? "1 / 0" : (i % 2 == 0 ? "2 ^ 10" : std::to_string(i) + " * 2"));
+        client.send(kRequests, "3 * (");
+        client.flush();
+        std::vector<int> seen(kRequests + 1, 0);
+        bool correct = true;
+        for (int i = 0; i <= kRequests; i++) {
+            CalcResponse response = client.receive();
+            REQUIRE(response.id <= static_cast<uint32_t>(kRequests));
+            seen[response.id]++;
+            int id = static_cast<int>(response.id);
+            if (id == kRequests || id % 100 == 0)
+                correct = correct && response.status == CalcStatus::Error && !response.error.empty();
+            else
+                correct = correct && response.status == CalcStatus::Ok && response.value == (id % 2 == 0 ? 1024.0 : id * 2.0);
+        }
+        CHECK(correct);
+        CHECK(std::count(seen.begin(), seen.end(), 1) == kRequests + 1);
+    }
+
+    std::string metrics = fetchMetrics(options.metricsPath);
+    CHECK(metrics.find("calc_requests_total 1001\n") != std::string::npos);
+    CHECK(metrics.find("calc_errors_total 11\n") != std::string::npos);
+    CHECK(metrics.find("calc_worker_threads 2\n") != std::string::npos);
+    // 490 одинаковых "2 ^ 10" отправлены одной записью: повторы ждут уже начатого вычисления, а не вычисляются заново
+    size_t coalesced = metrics.find("\ncalc_coalesced_requests_total ");
+    REQUIRE(coalesced != std::string::npos);
+    CHECK(std::strtoull(metrics.c_str() + coalesced + 31, nullptr, 10) > 0);
+    CHECK(metrics.find("calc_request_duration_seconds_count 1001\n") != std::string::npos);
+    CHECK(metrics.find("# TYPE calc_request_duration_seconds histogram") != std::string::npos);
+
+    // Поток больше четырёх буферов чтения дочитывается на следующих проходах цикла событий
+    {
+        CalcClient client(options.socketPath);
+        const int kRequests = 40000;
+        for (int i = 0; i < kRequests; i++)
+            client.send(static_cast<uint32_t>(i), "1 + 1");
+        client.flush();
+        int answered = 0;
+        for (int i = 0; i < kRequests; i++)
+            answered += client.receive().value == 2.0;
+        CHECK(answered == kRequests);
+    }
+
+    // Повреждённый кадр закрывает соединение, сервер продолжает работу
+    {
+        CalcClient client(options.socketPath);
+        client.send(1, std::string(kMaxFrameSize, '1'));
+        client.flush();
+        CHECK_THROWS_AS(client.receive(), std::runtime_error);
+    }
+    {
+        CalcClient client(options.socketPath);
+        client.send(5, "2 ^ 2");
+        client.flush();
+        CalcResponse response = client.receive();
+        CHECK(response.id == 5);
+        CHECK(response.value == 4.0);
+    }
+    CHECK(fetchMetrics(options.metricsPath).find("calc_protocol_errors_total 1\n") != std::string::npos);
+
+    server.stop();
+    loop.join();
+}
+TEST_CASE("CalcServer descriptor exhaustion tests") {
+    CalcServerOptions options;
+    options.socketPath = "calc_server_limit_test.sock";
+    options.metricsPath = "calc_server_limit_test.metrics.sock";
+    options.threads = 1;
+    CalcServer server(options);
+    std::thread loop([&server]() { server.run(); });
+    CalcClient first(options.socketPath);
+    first.send(1, "1 + 1");
+    first.flush();
+    CHECK(first.receive().value == 2.0);
+
+    // Лимит оставляет ровно один свободный дескриптор: его занимает клиент, а серверу принять соединение нечем
+    int probe = open("/dev/null", O_RDONLY);
+    REQUIRE(probe >= 0);
+    close(probe);
+    rlimit saved;
+    REQUIRE(getrlimit(RLIMIT_NOFILE, &saved) == 0);
+    rlimit limited = saved;
+    limited.rlim_cur = static_cast<rlim_t>(probe + 1);
+    REQUIRE(setrlimit(RLIMIT_NOFILE, &limited) == 0);
+    auto second = std::make_unique<CalcClient>(options.socketPath);
+    second->send(2, "2 * 3");
+    second->flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    setrlimit(RLIMIT_NOFILE, &saved);
+
+    // После снятия ограничения приём возобновляется, и соединение из очереди обслуживается
+    CalcResponse response = second->receive();
+    CHECK(response.id == 2);
+    CHECK(response.value == 6.0);
+    first.send(3, "2 ^ 3");
+    first.flush();
+    CHECK(first.receive().value == 8.0);
+    second.reset();
+    std::string metrics = fetchMetrics(options.metricsPath);
+    size_t pauses = metrics.find("\ncalc_accept_pauses_total ");
+    REQUIRE(pauses != std::string::npos);
+    CHECK(std::strtoull(metrics.c_str() + pauses + 26, nullptr, 10) > 0);
+
+    server.stop();
+    loop.join();
+}
+#endif
@@ -0,0 +1,98 @@
+#include "doctest.h"
+#include "../include/calculator_c.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("C API operation tests") {
+    CHECK(calc_abi_version() == CALC_ABI_VERSION);
+    double result = 0.0;
+    CHECK(calc_evaluate_operation(CALC_POWER, 2.0, 10.0, &result) == CALC_OK);
+    CHECK(result == 1024.0);
+    result = 7.0;
+    CHECK(calc_evaluate_operation(CALC_DIVIDE, 1.0, 0.0, &result) == CALC_DIVISION_BY_ZERO);
+    CHECK(result == 7.0);
+    CHECK(calc_evaluate_operation(CALC_TAN, 90.0, 0.0, &result) == CALC_TANGENT_UNDEFINED);
+    CHECK(calc_evaluate_operation(static_cast<calc_operation>(42), 1.0, 1.0, &result) == CALC_INVALID_ARGUMENT);
+    CHECK(calc_evaluate_operation(CALC_ADD, 1.0, 1.0, nullptr) == CALC_INVALID_ARGUMENT);
+    CHECK(std::string(calc_status_message(CALC_DIVISION_BY_ZERO)) == "Division by zero");
+
+    double a[] = { 1.0, 2.0, 3.0, 4.0 };
+    double b[] = { 1.0, 0.0, 2.0, 4.0 };
+    double out[4];
+    CHECK(calc_evaluate_vector(CALC_DIVIDE, a, b, out, 4) == CALC_OK);
+    CHECK(out[0] == 1.0);
+    CHECK(std::isnan(out[1]));
+    CHECK(out[2] == 1.5);
+    CHECK(calc_evaluate_vector(CALC_FACTORIAL, a, nullptr, out, 4) == CALC_OK);
+    CHECK(out[3] == 24.0);
+    CHECK(calc_evaluate_vector(CALC_ADD, a, nullptr, out, 4) == CALC_INVALID_ARGUMENT);
+}
+
+TEST_CASE("C API expression tests") {
+    const char* names[] = { "x", "y" };
+    const char text[] = "x^2 + y / 2";
+    calc_expression* expression = nullptr;
+    char error[16];
+    REQUIRE(calc_expression_create(text, sizeof(text) - 1, names, 2, &expression, error, sizeof(error)) == CALC_OK);
+    CHECK(calc_expression_variable_count(expression) == 2);
+    double point[] = { 3.0, 4.0 };
+    double result = 0.0;
+    CHECK(calc_expression_evaluate(expression, point, &result) == CALC_OK);
+    CHECK(result == 11.0);
+    CHECK(calc_expression_evaluate(expression, nullptr, &result) == CALC_INVALID_ARGUMENT);
+
+    // Пакет длиннее блока вычисления; объект используется двумя потоками сразу
+    std::vector<double> xs(1000);
+    std::vector<double> ys(1000);
+    for (size_t i = 0; i < xs.size(); i++) {
+        xs[i] = static_cast<double>(i);
+        ys[i] = 2.0;
+    }
+    const double* columns[] = { xs.data(), ys.data() };
+    std::vector<double> first(1000);
+    std::vector<double> second(1000);
+    std::thread other([&]() { calc_expression_evaluate_batch(expression, columns, second.data(), second.size()); });
+    CHECK(calc_expression_evaluate_batch(expression, columns, first.data(), first.size()) == CALC_OK);
+    other.join();
+    CHECK(first[999] == 999.0 * 999.0 + 1.0);
+    CHECK(first == second);
+    calc_expression_destroy(expression);
+
+    // Текст ошибки обрезается по буферу и завершается нулём; длина текста задаётся явно
+    expression = reinterpret_cast<calc_expression*>(&result);
+    CHECK(calc_expression_create("x + z + unused", 5, names, 1, &expression, error, sizeof(error)) == CALC_SYNTAX_ERROR);
+    CHECK(expression == nullptr);
+    CHECK(std::strlen(error) == sizeof(error) - 1);
+    CHECK(calc_expression_create("x + y", 5, nullptr, 1, &expression, nullptr, 0) == CALC_INVALID_ARGUMENT);
+    calc_expression_destroy(nullptr);
+}
+
+TEST_CASE("C API string tests") {
+    calc_evaluator* evaluator = calc_evaluator_create();
+    REQUIRE(evaluator != nullptr);
+    double result = 0.0;
+    char error[64];
+    CHECK(calc_evaluate_string(evaluator, "2 + 3 * 4", 9, &result, error, sizeof(error)) == CALC_OK);
+    CHECK(result == 14.0);
+    CHECK(calc_evaluate_string(evaluator, "1 / 0", 5, &result, error, sizeof(error)) == CALC_DIVISION_BY_ZERO);
+    CHECK(std::string(error) == "Division by zero");
+    CHECK(calc_evaluate_string(evaluator, "3 * (", 5, &result, error, sizeof(error)) == CALC_SYNTAX_ERROR);
+    CHECK(std::strlen(error) > 0);
+
+    const char* texts[] = { "1 + 1", "5!", "cot 180", "2 ^ 0.5" };
+    size_t lengths[] = { 5, 2, 7, 7 };
+    double results[4];
+    calc_status statuses[4];
+    CHECK(calc_evaluate_strings(evaluator, texts, lengths, 4, results, statuses) == 1);
+    CHECK(results[0] == 2.0);
+    CHECK(results[1] == 120.0);
+    CHECK(statuses[2] == CALC_COTANGENT_UNDEFINED);
+    CHECK(std::isnan(results[2]));
+    CHECK(results[3] == doctest::Approx(1.41421356));
+    CHECK(calc_evaluate_strings(nullptr, texts, lengths, 4, results, statuses) == 4);
+    CHECK(statuses[0] == CALC_INVALID_ARGUMENT);
+    calc_evaluator_destroy(evaluator);
+}
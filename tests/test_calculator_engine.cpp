@@ -0,0 +1,93 @@
+#include "doctest.h"
+#include "../include/calculator_engine.h"
+#include "../include/latency_histogram.h"
+#include "../include/async_evaluator.h"
+#include "../include/calculator_math.h"
+#include "../include/memo_cache.h"
+#include <string>
+#include <vector>
+
+static std::string pressAll(CalculatorEngine& engine, const std::vector<std::string>& keys) {
+    for (const auto& key : keys)
+        engine.press(key);
+    return engine.display();
+}
+
+TEST_CASE("CalculatorEngine tests") {
+    CalculatorEngine engine;
+    CHECK(pressAll(engine, { "1", "2", "+", "3", "=" }) == "15.000000");
+    engine.reset();
+    CHECK(pressAll(engine, { "5", "x!" }) == "120.000000");
+    engine.reset();
+    CHECK(pressAll(engine, { "3", "0", "sin" }) == "0.500000");
+    engine.reset();
+    CHECK(pressAll(engine, { "2", "5", "5", "16-cc" }) == "FF");
+    engine.reset();
+    CHECK(pressAll(engine, { "7", "±", "*", "6", "=" }) == "-42.000000");
+    engine.reset();
+    CHECK(pressAll(engine, { "9", "0", "tan" }) == "Error");
+    CHECK(pressAll(engine, { "4" }) == "4");
+    CHECK(pressAll(engine, { "+", "*" }) == "Error");
+    CHECK(pressAll(engine, { "C" }) == "");
+}
+
+TEST_CASE("CalculatorEngine memo cache tests") {
+    MemoCache memo(256);
+    CalculatorEngine engine;
+    engine.setMemoCache(&memo);
+    for (int i = 0; i < 2; i++) {
+        engine.reset();
+        CHECK(pressAll(engine, { "1", "2", "+", "3", "=" }) == "15.000000");
+        engine.reset();
+        CHECK(pressAll(engine, { "5", "x!" }) == "120.000000");
+        engine.reset();
+        CHECK(pressAll(engine, { "9", "0", "tan" }) == "Error");
+        engine.reset();
+        CHECK(pressAll(engine, { "2", "5", "5", "16-cc" }) == "FF");
+    }
+    CHECK(memo.operationStats().hits == 3);
+    CHECK(memo.conversionStats().hits == 1);
+}
+
+TEST_CASE("LatencyHistogram tests") {
+    LatencyHistogram histogram;
+    CHECK(histogram.percentile(50) == 0);
+    for (uint64_t i = 1; i <= 1000; i++)
+        histogram.record(i * 1000);
+    CHECK(histogram.count() == 1000);
+    CHECK(histogram.min() == 1000);
+    CHECK(histogram.max() == 1000000);
+    CHECK(histogram.percentile(50) >= 500000);
+    CHECK(histogram.percentile(50) <= 500000 * 9 / 8);
+    CHECK(histogram.percentile(100) == 1000000);
+}
+
+TEST_CASE("CalculatorEngine deferred evaluation tests") {
+    CalculatorEngine engine;
+    CHECK(CalculatorEngine::isEvaluationKey("="));
+    CHECK(CalculatorEngine::isEvaluationKey("16-cc"));
+    CHECK_FALSE(CalculatorEngine::isEvaluationKey("7"));
+
+    pressAll(engine, { "6", "x!" });
+    CHECK(engine.display() == "720.000000");
+    engine.reset();
+    pressAll(engine, { "1", "0" });
+    CalculatorEngine::EvaluationJob job = engine.beginEvaluation("2-cc");
+    engine.press("5");
+    EvaluationControl control;
+    engine.completeEvaluation(job(control));
+    CHECK(engine.display() == "1010");
+}
+
+TEST_CASE("AsyncEvaluator tests") {
+    AsyncEvaluator evaluator(2);
+    CalculatorEngine engine;
+    pressAll(engine, { "2", "5", "5" });
+    AsyncEvaluation evaluation = evaluator.submit(engine.beginEvaluation("16-cc"));
+    CHECK(evaluation.result.get() == "FF");
+    CHECK(evaluation.ready());
+
+    EvaluationControl control;
+    control.cancel();
+    CHECK_THROWS_AS(convertBase(std::string(5000, '1'), 2, 10, control), EvaluationCancelled);
+}
@@ -0,0 +1,113 @@
+#include "doctest.h"
+#include "../include/calculator_concurrent.h"
+#include "../include/memo_cache.h"
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("tryEvaluate and evaluate tests") {
+    double result = 0.0;
+    CHECK(tryEvaluate(Operation::Add, 2, 3, result) == MathError::None);
+    CHECK(result == doctest::Approx(5));
+    CHECK(tryEvaluate(Operation::Divide, 1, 0, result) == MathError::DivisionByZero);
+    CHECK(tryEvaluate(Operation::Factorial, -1, 0, result) == MathError::FactorialDomain);
+    CHECK(tryEvaluate(Operation::Tan, 90, 0, result) == MathError::TangentUndefined);
+    CHECK(evaluate(Operation::Factorial, 5) == doctest::Approx(120));
+    CHECK(evaluate(Operation::Sin, 30) == doctest::Approx(0.5));
+    CHECK_THROWS_WITH_AS(evaluate(Operation::Divide, 1, 0), "Division by zero", std::runtime_error);
+
+    Operation op = Operation::Add;
+    CHECK(parseOperation("^", op));
+    CHECK(op == Operation::Power);
+    CHECK(parseOperation("cot", op));
+    CHECK(op == Operation::Cot);
+    CHECK_FALSE(parseOperation("%", op));
+}
+
+TEST_CASE("ThreadPool tests") {
+    ThreadPool pool(3);
+    CHECK(pool.size() == 3);
+    CHECK(pool.submit([]() { return 42; }).get() == 42);
+
+    std::vector<int> hits(10000, 0);
+    pool.parallelFor(0, hits.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            hits[i]++;
+    });
+    bool allOnce = true;
+    for (int h : hits)
+        allOnce = allOnce && h == 1;
+    CHECK(allOnce);
+
+    std::atomic<int> nested(0);
+    pool.parallelFor(0, 8, 1, [&](size_t, size_t) {
+        pool.parallelFor(0, 8, 1, [&](size_t, size_t) { nested++; });
+    });
+    CHECK(nested == 64);
+
+    CHECK_THROWS_AS(pool.parallelFor(0, 100, 1, [](size_t begin, size_t) {
+        if (begin == 50)
+            throw std::runtime_error("chunk failed");
+    }), std::runtime_error);
+}
+
+TEST_CASE("evaluateBatch tests") {
+    const Operation ops[] = { Operation::Add, Operation::Divide, Operation::Factorial, Operation::Tan, Operation::Power };
+    std::vector<EvaluationRequest> requests;
+    for (int i = 0; i < 20000; i++)
+        requests.push_back({ ops[i % 5], static_cast<double>(i % 200 - 100), static_cast<double>(i % 7 - 3) });
+    std::vector<EvaluationResult> results(requests.size());
+
+    ThreadPool pool(4);
+    evaluateBatch(pool, requests.data(), results.data(), requests.size());
+    bool matches = true;
+    for (size_t i = 0; i < requests.size(); i++) {
+        double expected = 0.0;
+        MathError error = tryEvaluate(requests[i].op, requests[i].a, requests[i].b, expected);
+        matches = matches && results[i].error == error
+            && (error != MathError::None || results[i].value == expected || (std::isnan(expected) && std::isnan(results[i].value)));
+    }
+    CHECK(matches);
+
+    CHECK(evaluateAsync(pool, Operation::Multiply, 6, 7).get() == doctest::Approx(42));
+    CHECK_THROWS_AS(evaluateAsync(Operation::Cot, 0).get(), std::runtime_error);
+    CHECK(batchChunkSize(1000000, 8) % 8 == 0);
+}
+
+TEST_CASE("MemoCache tests") {
+    MemoCache memo(1024);
+    CHECK(memo.evaluate(Operation::Factorial, 10) == doctest::Approx(3628800));
+    CHECK(memo.evaluate(Operation::Factorial, 10) == doctest::Approx(3628800));
+    CHECK(memo.operationStats().hits == 1);
+    CHECK(memo.operationStats().misses == 1);
+
+    CHECK_THROWS_WITH_AS(memo.evaluate(Operation::Divide, 1, 0), "Division by zero", std::runtime_error);
+    CHECK_THROWS_WITH_AS(memo.evaluate(Operation::Divide, 1, 0), "Division by zero", std::runtime_error);
+    CHECK(memo.evaluate(Operation::Power, 2, 10) == doctest::Approx(1024));
+    CHECK(memo.evaluate(Operation::Power, 2, 11) == doctest::Approx(2048));
+
+    CHECK(memo.convertBase("255", 10, 16) == "FF");
+    CHECK(memo.convertBase("255", 10, 16) == "FF");
+    CHECK(memo.convertBase("255", 10, 2) == "11111111");
+    CHECK(memo.conversionStats().hits == 1);
+    CHECK_THROWS_AS(memo.convertBase("19", 2, 10), std::runtime_error);
+
+    for (int i = 0; i < 10000; i++)
+        memo.evaluate(Operation::Add, i, 1);
+    CacheStats stats = memo.operationStats();
+    CHECK(stats.evictions > 0);
+    CHECK(memo.evaluate(Operation::Add, 9999, 1) == doctest::Approx(10000));
+
+    memo.clear();
+    CHECK(memo.operationStats().hits == 0);
+    CHECK(memo.evaluate(Operation::Sin, 30) == doctest::Approx(0.5));
+
+    ThreadPool pool(4);
+    pool.parallelFor(0, 4000, 100, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            memo.evaluate(Operation::Multiply, static_cast<double>(i % 50), 2);
+    });
+    CHECK(memo.evaluate(Operation::Multiply, 49, 2) == doctest::Approx(98));
+    CHECK(memo.operationStats().hitRate() > 0.9);
+}
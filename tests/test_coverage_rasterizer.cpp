@@ -0,0 +1,47 @@
+#include "doctest.h"
+#include "../include/coverage_rasterizer.h"
+#include <vector>
+
+static void addRectangle(CoverageRasterizer& rasterizer, float x0, float y0, float x1, float y1) {
+    rasterizer.addLine(x0, y0, x1, y0);
+    rasterizer.addLine(x1, y0, x1, y1);
+    rasterizer.addLine(x1, y1, x0, y1);
+    rasterizer.addLine(x0, y1, x0, y0);
+}
+
+TEST_CASE("CoverageRasterizer tests") {
+    CoverageRasterizer rasterizer(4, 4);
+    addRectangle(rasterizer, 1.0f, 1.0f, 3.0f, 3.0f);
+    std::vector<uint8_t> pixels(16);
+    rasterizer.resolve(pixels.data());
+    CHECK(pixels[0] == 0);
+    CHECK(pixels[1 * 4 + 1] == 255);
+    CHECK(pixels[2 * 4 + 2] == 255);
+    CHECK(pixels[2 * 4 + 3] == 0);
+    CHECK(pixels[3 * 4 + 1] == 0);
+
+    CoverageRasterizer half(2, 1);
+    addRectangle(half, 0.5f, 0.0f, 1.5f, 1.0f);
+    std::vector<uint8_t> halfPixels(2);
+    half.resolve(halfPixels.data());
+    CHECK(halfPixels[0] == 128);
+    CHECK(halfPixels[1] == 128);
+
+    // Прямоугольник, выходящий за левый и правый край, покрывает всю строку без просачивания за её пределы
+    CoverageRasterizer wide(4, 2);
+    addRectangle(wide, -3.0f, 0.0f, 7.5f, 1.0f);
+    std::vector<uint8_t> widePixels(8);
+    wide.resolve(widePixels.data());
+    CHECK(widePixels[0] == 255);
+    CHECK(widePixels[3] == 255);
+    CHECK(widePixels[4] == 0);
+    CHECK(widePixels[7] == 0);
+
+    wide.clear();
+    wide.addLine(-2.0f, 0.0f, 6.0f, 2.0f);
+    wide.addLine(6.0f, 2.0f, -2.0f, 2.0f);
+    wide.addLine(-2.0f, 2.0f, -2.0f, 0.0f);
+    wide.resolve(widePixels.data());
+    CHECK(widePixels[0] > widePixels[3]);
+    CHECK(widePixels[4] == 255);
+}
@@ -0,0 +1,91 @@
+#include "doctest.h"
+#include "../include/evaluation_pipeline.h"
+#include "../include/line_evaluator.h"
+#include "../include/spsc_ring.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SpscRing tests") {
+    SpscRing<int> ring(3);
+    CHECK(ring.capacity() == 4);
+    CHECK(ring.empty());
+    for (int i = 0; i < 4; i++)
+        CHECK(ring.tryPush(std::move(i)));
+    int extra = 4;
+    CHECK_FALSE(ring.tryPush(std::move(extra)));
+    int value = -1;
+    CHECK(ring.tryPop(value));
+    CHECK(value == 0);
+    CHECK(ring.tryPush(std::move(extra)));
+
+    // Писатель в другом потоке упирается в заполненную очередь, порядок сохраняется
+    std::thread producer([&ring]() {
+        for (int i = 5; i < 100000; i++)
+            ring.push(i);
+    });
+    bool ordered = true;
+    for (int i = 1; i < 100000; i++)
+        ordered = ordered && ring.pop() == i;
+    producer.join();
+    CHECK(ordered);
+    CHECK(ring.empty());
+}
+
+static std::string readAll(std::FILE* file) {
+    std::string text;
+    std::rewind(file);
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    return text;
+}
+
+TEST_CASE("runEvaluationPipeline tests") {
+    std::string input;
+    std::string expected;
+    LineEvaluator reference;
+    for (int i = 0; i < 3000; i++) {
+        std::string line = i % 89 == 0 ? "sqrt(-" + std::to_string(i + 1) + ")" : std::to_string(i) + " / 8 + " + std::to_string(i % 11);
+        if (i % 250 == 0)
+            line = "  ";
+        input += line + (i % 4 == 0 ? "\r\n" : "\n");
+        reference.evaluateLine(line, expected);
+    }
+    input += "3 * (";
+    reference.evaluateLine("3 * (", expected);
+
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    REQUIRE(in != nullptr);
+    REQUIRE(out != nullptr);
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::fflush(in);
+    std::rewind(in);
+
+    // Маленькие пакеты и несколько цепочек: пакеты обходят все цепочки, строки режутся на границах чтения
+    PipelineOptions options;
+    options.lanes = 3;
+    options.batchBytes = 256;
+    options.batchesPerLane = 2;
+    PipelineStats stats = runEvaluationPipeline(in, out, options);
+    CHECK(stats.lines == 3001);
+    CHECK(stats.errors == 34);
+    CHECK(stats.batches > 3);
+    CHECK(stats.maxLatencyMs >= stats.meanLatencyMs);
+    CHECK(readAll(out) == expected);
+    std::fclose(out);
+
+    std::FILE* empty = std::tmpfile();
+    REQUIRE(empty != nullptr);
+    out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    stats = runEvaluationPipeline(empty, out);
+    CHECK(stats.lines == 0);
+    CHECK(readAll(out).empty());
+    std::fclose(out);
+    std::fclose(empty);
+    std::fclose(in);
+}
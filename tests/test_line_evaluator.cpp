@@ -0,0 +1,109 @@
+#include "doctest.h"
+#include "../include/line_evaluator.h"
+#include "../include/mapped_file.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::string format(double value) {
+    char buffer[kNumberBufferSize];
+    return std::string(buffer, formatNumber(value, buffer));
+}
+
+TEST_CASE("LineEvaluator tests") {
+    CHECK(format(14.0) == "14");
+    CHECK(format(0.1 + 0.2) == "0.3");
+    CHECK(format(-0.0005) == "-0.0005");
+    CHECK(format(1e20) == "1e+20");
+
+    LineEvaluator evaluator;
+    std::string out;
+    CHECK(evaluator.evaluateLine("2 + 3 * 4", out));
+    CHECK(evaluator.evaluateLine("sin 30", out));
+    CHECK(evaluator.evaluateLine("  ", out));
+    CHECK_FALSE(evaluator.evaluateLine("1 / 0", out));
+    CHECK_FALSE(evaluator.evaluateLine("2 +", out));
+    CHECK_FALSE(evaluator.evaluateLine("x", out));
+    CHECK(evaluator.evaluateLine("5!", out));
+    CHECK(out == "14\n0.5\n\nerror: Division by zero\nerror: Unexpected end of expression at position 4\n"
+                 "error: Unknown identifier 'x' at position 1\n120\n");
+}
+
+TEST_CASE("LineReader tests") {
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    std::string longLine(300, '7');
+    std::string text = "1 + 1\r\n\n" + longLine + "\n2 * 3";
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::rewind(file);
+
+    // Блок меньше длинной строки: хвост переносится, а буфер растёт
+    LineReader reader(file, 64);
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (reader.next(line))
+        lines.emplace_back(line);
+    std::fclose(file);
+    REQUIRE(lines.size() == 4);
+    CHECK(lines[0] == "1 + 1");
+    CHECK(lines[1].empty());
+    CHECK(lines[2] == longLine);
+    CHECK(lines[3] == "2 * 3");
+}
+
+/**
+ * @brief Содержимое временного файла целиком
+ */
+static std::string readAll(std::FILE* file) {
+    std::string text;
+    std::rewind(file);
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    return text;
+}
+
+TEST_CASE("evaluateLines tests") {
+    std::string input;
+    std::string expected;
+    LineEvaluator reference;
+    for (int i = 0; i < 5000; i++) {
+        std::string line = i % 97 == 0 ? "1 / 0" : std::to_string(i) + " * 3 - " + std::to_string(i % 7) + "!";
+        input += line + (i % 5 == 0 ? "\r\n" : "\n");
+        reference.evaluateLine(line, expected);
+    }
+    input += "2 ^ 10";
+    reference.evaluateLine("2 ^ 10", expected);
+
+    // Маленькие отрезки и окна: границы отрезков приходятся на середины строк, а окон несколько
+    ThreadPool pool(3);
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    LineBatchStats stats = evaluateLines(input, out, &pool, 1000);
+    CHECK(stats.lines == 5001);
+    CHECK(stats.errors == 52);
+    CHECK(readAll(out) == expected);
+    std::fclose(out);
+
+    out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    stats = evaluateLines("", out);
+    CHECK(stats.lines == 0);
+    CHECK(readAll(out).empty());
+    std::fclose(out);
+
+    const char* path = "mapped_file_test.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << input;
+    }
+    {
+        MappedFile mapped(path);
+        CHECK(mapped.view() == input);
+    }
+    std::remove(path);
+    CHECK_THROWS_AS(MappedFile{ path }, std::runtime_error);
+}
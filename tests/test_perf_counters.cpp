@@ -0,0 +1,64 @@
+#include "doctest.h"
+#include "../include/perf_counters.h"
+#include "../include/startup_profiler.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("RingCounter tests") {
+    RingCounter<4> counter;
+    CHECK(counter.size() == 0);
+    CHECK(counter.percentile(99) == 0);
+
+    counter.push(10);
+    counter.push(20);
+    counter.push(30);
+    CHECK(counter.last() == 30);
+    CHECK(counter.mean() == doctest::Approx(20));
+
+    counter.push(40);
+    counter.push(50);
+    CHECK(counter.size() == 4);
+    CHECK(counter.last() == 50);
+    CHECK(counter.percentile(0) == 20);
+    CHECK(counter.percentile(100) == 50);
+    CHECK(counter.mean() == doctest::Approx(35));
+}
+
+TEST_CASE("StartupProfiler tests") {
+    StartupProfiler profiler;
+    // Фоновый поток отмечает фазу раньше основного, но фаза основного отсчитывается от его собственной отметки
+    std::thread::id backgroundId;
+    StartupProfiler::Clock::time_point backgroundEnd;
+    std::thread background([&]() {
+        backgroundId = std::this_thread::get_id();
+        backgroundEnd = profiler.mark("background");
+    });
+    background.join();
+    StartupProfiler::Clock::time_point mainEnd = profiler.mark("main");
+    StartupProfiler::Clock::time_point againEnd = profiler.mark("main again");
+
+    std::vector<StartupProfiler::Phase> phases = profiler.phases();
+    REQUIRE(phases.size() == 3);
+    CHECK(phases[0].name == "background");
+    CHECK(phases[0].thread == backgroundId);
+    CHECK(phases[0].begin == profiler.start());
+    CHECK(phases[0].end == backgroundEnd);
+    CHECK(phases[1].name == "main");
+    CHECK(phases[1].thread == std::this_thread::get_id());
+    CHECK(phases[1].begin == profiler.start());
+    CHECK(phases[1].end == mainEnd);
+    CHECK(phases[2].name == "main again");
+    CHECK(phases[2].thread == std::this_thread::get_id());
+    CHECK(phases[2].begin == mainEnd);
+    CHECK(phases[2].end == againEnd);
+
+    // Явное начало фазы не зависит от отметок
+    profiler.mark("explicit", backgroundEnd);
+    CHECK(profiler.phases().back().begin == backgroundEnd);
+
+    std::ostringstream out;
+    profiler.report(out);
+    CHECK(out.str().find("main again: ") != std::string::npos);
+}
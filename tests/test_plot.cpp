@@ -0,0 +1,661 @@
+#include "doctest.h"
+#include "../include/expression.h"
+#include "../include/sample_cache.h"
+#include "../include/adaptive_sampler.h"
+#include "../include/plot_evaluator.h"
+#include "../include/plot_decimation.h"
+#include "../include/interval_plotter.h"
+#include "../include/implicit_plotter.h"
+#include "../include/heatmap_tiles.h"
+#include "../include/parametric_sampler.h"
+#include "../include/surface_renderer.h"
+#include "../include/plot_viewport.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+static const double kPi = 3.14159265358979323846;
+
+static double eval(const std::string& text, double x = 0.0) {
+    return Expression::parse(text)(x);
+}
+
+TEST_CASE("Expression tests") {
+    CHECK(eval("2 + 3 * 4") == doctest::Approx(14));
+    CHECK(eval("(2 + 3) * 4") == doctest::Approx(20));
+    CHECK(eval("2 ^ 3 ^ 2") == doctest::Approx(512));
+    CHECK(eval("-2 ^ 2") == doctest::Approx(-4));
+    CHECK(eval("5!") == doctest::Approx(120));
+    CHECK(eval("sin 30") == doctest::Approx(0.5));
+    CHECK(eval("cos(60) * 2") == doctest::Approx(1));
+    CHECK(eval("2x + 1", 3) == doctest::Approx(7));
+    CHECK(eval("x sin x", 90) == doctest::Approx(90));
+    CHECK(eval("sin x^2", 3) == doctest::Approx(std::sin(9 * 3.14159265358979323846 / 180)));
+    CHECK(std::isnan(eval("tan x", 90)));
+    CHECK(std::isnan(eval("1 / x", 0)));
+    CHECK(Expression::parse("2 * pi").isConstant());
+    CHECK_FALSE(Expression::parse("1 / 0").isConstant());
+
+    double result = 0.0;
+    double x = 90.0;
+    CHECK(Expression::parse("tan x").evaluate(&x, result) == MathError::TangentUndefined);
+    double xy[] = { 3.0, 4.0 };
+    CHECK(Expression::parse("x^2 + y^2", { "x", "y" }).evaluate(xy, result) == MathError::None);
+    CHECK(result == doctest::Approx(25));
+
+    CHECK_THROWS_AS(Expression::parse("2 +"), std::runtime_error);
+    CHECK_THROWS_AS(Expression::parse("(1 + 2"), std::runtime_error);
+    CHECK_THROWS_WITH_AS(Expression::parse("foo(1)"), "Unknown identifier 'foo' at position 1", std::runtime_error);
+    CHECK_THROWS_AS(Expression::parse("y + 1"), std::runtime_error);
+
+    CHECK(eval("0x10 + .5e1") == doctest::Approx(21));
+    CHECK(std::isinf(eval("1e400")));
+    CHECK(eval("2.5e-3x", 2) == doctest::Approx(0.005));
+
+    // compile переиспользует объект; после ошибки он пуст, а следующий разбор работает
+    Expression reused;
+    reused.compile("x + 1", { "x" });
+    CHECK(reused(1) == doctest::Approx(2));
+    CHECK_THROWS_AS(reused.compile("x +", { "x" }), std::runtime_error);
+    reused.compile(std::string_view("3 * 4 + garbage", 5), {});
+    CHECK(reused.isConstant());
+    CHECK(reused(0) == doctest::Approx(12));
+}
+
+TEST_CASE("Expression batch tests") {
+    Expression f = Expression::parse("x^2 / (x - 1) + tan(x * 45) - 3!");
+    std::vector<double> xs;
+    for (int i = -600; i < 600; i++)
+        xs.push_back(i * 0.25);
+    std::vector<double> ys(xs.size());
+    f.evaluateBatch(xs.data(), ys.data(), xs.size());
+    bool matches = true;
+    for (size_t i = 0; i < xs.size(); i++) {
+        double expected = f(xs[i]);
+        matches = matches && (ys[i] == expected || (std::isnan(ys[i]) && std::isnan(expected)));
+    }
+    CHECK(matches);
+}
+
+TEST_CASE("SampleCache tests") {
+    SampleCache cache(Expression::parse("x^2"));
+    std::vector<PlotPoint> points;
+    cache.sample(-10, 10, 1000, points);
+    REQUIRE(points.size() > 1000);
+    CHECK(points.front().x <= -10);
+    CHECK(points.back().x >= 10);
+    bool exact = true;
+    for (size_t i = 0; i < points.size(); i++)
+        exact = exact && points[i].y == points[i].x * points[i].x && (i == 0 || points[i].x > points[i - 1].x);
+    CHECK(exact);
+
+    uint64_t evaluations = cache.stats().evaluations;
+    cache.sample(-10, 10, 1000, points);
+    CHECK(cache.stats().evaluations == evaluations);
+
+    // Сдвиг на десятую часть диапазона вычисляет только открывшийся край
+    cache.sample(-8, 12, 1000, points);
+    uint64_t panned = cache.stats().evaluations - evaluations;
+    CHECK(panned > 0);
+    CHECK(panned <= 3 * SampleCache::kChunkSamples);
+
+    // Приближение в два раза берёт каждую вторую точку из уже вычисленного уровня
+    evaluations = cache.stats().evaluations;
+    cache.sample(-4, 6, 1000, points);
+    CHECK(cache.stats().reusedSamples > 0);
+    CHECK(cache.stats().evaluations - evaluations < points.size());
+    bool zoomExact = true;
+    for (const auto& point : points)
+        zoomExact = zoomExact && point.y == point.x * point.x;
+    CHECK(zoomExact);
+
+    // Номер точки мелкой сетки далеко от нуля не помещается в int64_t: диапазон вычисляется без кэша
+    size_t chunks = cache.size();
+    cache.sample(1e10, 1e10 + 1e-6, 1000, points);
+    CHECK(cache.size() == chunks);
+    REQUIRE(points.size() > 1000);
+    CHECK(points.front().x <= 1e10);
+    CHECK(points.back().x >= 1e10 + 1e-6);
+    bool farExact = true;
+    for (size_t i = 0; i < points.size(); i++)
+        farExact = farExact && points[i].y == points[i].x * points[i].x && (i == 0 || points[i].x >= points[i - 1].x);
+    CHECK(farExact);
+    cache.sample(-1e300, 1e300, 1000, points);
+    CHECK(cache.size() == chunks);
+    CHECK(points.size() <= 65539);
+    CHECK(points.front().x <= -1e300);
+    CHECK(points.back().x >= 1e300);
+}
+
+TEST_CASE("PlotViewport tests") {
+    PlotViewport viewport;
+    CHECK(viewport.toScreenX(0.0) == doctest::Approx(400));
+    CHECK(viewport.toWorldY(viewport.toScreenY(3.5)) == doctest::Approx(3.5));
+    viewport.zoom(2.0, 400, 300);
+    CHECK(viewport.xMax == doctest::Approx(5));
+    viewport.pan(80, 0);
+    CHECK(viewport.xMin == doctest::Approx(-6));
+    CHECK(gridStep(20, 10) == doctest::Approx(2));
+    CHECK(gridStep(7, 10) == doctest::Approx(1));
+}
+
+TEST_CASE("AdaptiveSampler tests") {
+    PlotViewport viewport;
+    viewport.xMin = 0;
+    viewport.xMax = 360;
+    viewport.yMin = -5;
+    viewport.yMax = 5;
+    std::vector<PlotPoint> points;
+    AdaptiveSampleStats stats = AdaptiveSampler().sample(Expression::parse("tan x"), viewport, points);
+    CHECK(stats.points == points.size());
+    CHECK(stats.evaluations < 2 * static_cast<uint64_t>(viewport.width));
+
+    // Ветви tan по разные стороны асимптот 90 и 270 не соединяются
+    int crossings = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+        const PlotPoint& a = points[i - 1];
+        const PlotPoint& b = points[i];
+        if (std::isfinite(a.y) && std::isfinite(b.y) && ((a.x < 90 && b.x > 90) || (a.x < 270 && b.x > 270)))
+            crossings++;
+    }
+    CHECK(crossings == 0);
+    CHECK(stats.breaks >= 2);
+
+    // Прямая не требует уточнения
+    stats = AdaptiveSampler().sample(Expression::parse("x / 100"), viewport, points);
+    CHECK(stats.breaks == 0);
+    CHECK(stats.evaluations <= 2 * static_cast<uint64_t>(viewport.width / 8 + 3));
+
+    // Начальная сетка из кэша при повторе не вычисляется заново
+    SampleCache cache(Expression::parse("sin(x * 4) * 4"));
+    uint64_t first = AdaptiveSampler().sample(cache.function(), viewport, points, &cache).evaluations;
+    uint64_t second = AdaptiveSampler().sample(cache.function(), viewport, points, &cache).evaluations;
+    CHECK(second < first);
+}
+
+TEST_CASE("PlotEvaluator tests") {
+    ThreadPool pool(3);
+    PlotEvaluator evaluator(pool, 64);
+    const char* texts[] = { "x^2 / 10", "tan(x * 9)", "1 / x" };
+    for (const char* text : texts)
+        evaluator.addFunction(Expression::parse(text));
+    PlotViewport viewport;
+    std::vector<PlotSeries> series;
+
+    PlotRefreshStats stats = evaluator.refresh(viewport, false, series);
+    REQUIRE(series.size() == 3);
+    CHECK(stats.chunksBuilt > 0);
+    for (size_t f = 0; f < 3; f++) {
+        SampleCache reference(Expression::parse(texts[f]));
+        std::vector<PlotPoint> expected;
+        reference.sample(viewport.xMin, viewport.xMax, viewport.width, expected);
+        REQUIRE(series[f].points.size() == expected.size());
+        bool same = true;
+        for (size_t i = 0; i < expected.size(); i++) {
+            same = same && series[f].points[i].x == expected[i].x &&
+                (series[f].points[i].y == expected[i].y || (std::isnan(expected[i].y) && std::isnan(series[f].points[i].y)));
+        }
+        CHECK(same);
+    }
+    CHECK(evaluator.refresh(viewport, false, series).evaluations == 0);
+
+    stats = evaluator.refresh(viewport, true, series);
+    CHECK(stats.tiles == 3 * ((viewport.width + 63) / 64));
+    for (const auto& s : series) {
+        bool sorted = true;
+        for (size_t i = 1; i < s.points.size(); i++)
+            sorted = sorted && s.points[i].x > s.points[i - 1].x;
+        CHECK(sorted);
+        CHECK(s.points.front().x <= viewport.xMin);
+        CHECK(s.points.back().x >= viewport.xMax);
+    }
+}
+
+TEST_CASE("Min/max decimation tests") {
+    PlotViewport viewport;
+    viewport.xMin = 0.0;
+    viewport.xMax = 1.0;
+    viewport.width = 100;
+    const size_t count = 200000;
+    std::vector<PlotPoint> points(count);
+    uint64_t state = 1;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double noise = static_cast<double>(state >> 11) / 9007199254740992.0;
+        points[i] = { static_cast<double>(i) / count, std::sin(i * 1e-4) + noise };
+    }
+    points[123457].y = NAN;
+
+    std::vector<PlotPoint> linear;
+    decimateMinMax(points.data(), points.size(), viewport, linear);
+    std::vector<int> perColumn(viewport.width, 0);
+    size_t breaks = 0;
+    for (const auto& point : linear) {
+        if (std::isnan(point.y))
+            breaks++;
+        else
+            perColumn[static_cast<int>(point.x * viewport.width)]++;
+    }
+    CHECK(breaks == 1);
+    CHECK(*std::max_element(perColumn.begin(), perColumn.end()) <= 8);
+
+    bool extremesKept = true;
+    for (int c = 0; c < viewport.width; c++) {
+        size_t begin = count * c / viewport.width;
+        size_t end = count * (c + 1) / viewport.width;
+        double low = INFINITY;
+        double high = -INFINITY;
+        for (size_t i = begin; i < end; i++) {
+            if (!std::isnan(points[i].y)) {
+                low = std::min(low, points[i].y);
+                high = std::max(high, points[i].y);
+            }
+        }
+        bool haveLow = false;
+        bool haveHigh = false;
+        for (const auto& point : linear) {
+            haveLow = haveLow || point.y == low;
+            haveHigh = haveHigh || point.y == high;
+        }
+        extremesKept = extremesKept && haveLow && haveHigh;
+    }
+    CHECK(extremesKept);
+
+    MinMaxPyramid pyramid(points);
+    CHECK(pyramid.levels() > 1);
+    auto same = [](const std::vector<PlotPoint>& a, const std::vector<PlotPoint>& b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].x != b[i].x || !(a[i].y == b[i].y || (std::isnan(a[i].y) && std::isnan(b[i].y))))
+                return false;
+        }
+        return true;
+    };
+    std::vector<PlotPoint> decimated;
+    pyramid.decimate(viewport, decimated);
+    CHECK(same(decimated, linear));
+    ThreadPool pool(3);
+    pyramid.decimate(viewport, decimated, &pool);
+    CHECK(same(decimated, linear));
+
+    PlotViewport zoomed = viewport;
+    zoomed.xMin = 0.25;
+    zoomed.xMax = 0.5;
+    pyramid.decimate(zoomed, decimated, &pool);
+    CHECK(decimated.front().x < zoomed.xMin);
+    CHECK(decimated.back().x > zoomed.xMax);
+    CHECK(decimated.size() <= 4 * static_cast<size_t>(zoomed.width) + 8);
+}
+
+TEST_CASE("Interval arithmetic tests") {
+    CHECK(evaluateInterval(Operation::Sin, { 0.0, 180.0 }).contains(1.0));
+    CHECK(evaluateInterval(Operation::Cos, { 10.0, 80.0 }).hi < 1.0);
+    Interval f = evaluateInterval(Operation::Factorial, { 2.5, 4.2 });
+    CHECK(f.contains(6.0));
+    CHECK(f.contains(24.0));
+    CHECK(f.lo > 5.9);
+    CHECK(f.partial);
+    CHECK(evaluateInterval(Operation::Factorial, { 2.2, 2.8 }).isEmpty());
+    CHECK(evaluateInterval(Operation::Divide, { 1.0, 2.0 }, { -1.0, 1.0 }).partial);
+    CHECK(evaluateInterval(Operation::Divide, { 1.0, 2.0 }, { -1e-7, 1e-7 }).isEmpty());
+    CHECK(evaluateInterval(Operation::Power, { -2.0, 3.0 }, Interval::point(2.0)).lo <= 0.0);
+    CHECK(evaluateInterval(Operation::Power, { -3.0, -2.0 }, Interval::point(0.5)).isEmpty());
+    CHECK(evaluateInterval(Operation::Tan, { 80.0, 100.0 }).partial);
+    CHECK(!evaluateInterval(Operation::Tan, { 10.0, 80.0 }).partial);
+
+    // Значение операции в любой точке промежутков лежит в промежутке-результате
+    const Operation ops[] = { Operation::Add, Operation::Subtract, Operation::Multiply, Operation::Divide,
+        Operation::Power, Operation::Factorial, Operation::Sin, Operation::Cos, Operation::Tan, Operation::Cot };
+    uint64_t state = 7;
+    auto random = [&state](double lo, double hi) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return lo + (hi - lo) * (static_cast<double>(state >> 11) / 9007199254740992.0);
+    };
+    bool sound = true;
+    for (Operation op : ops) {
+        for (int trial = 0; trial < 200; trial++) {
+            double scale = op == Operation::Power ? 4.0 : (op == Operation::Factorial ? 12.0 : 400.0);
+            double a0 = random(-scale, scale);
+            Interval a{ a0, a0 + random(0.0, scale / 4), false };
+            Interval b = trial % 3 == 0 ? Interval::point(std::round(random(-4.0, 4.0))) :
+                Interval{ random(-4.0, 2.0), 0.0, false };
+            if (trial % 3 != 0)
+                b.hi = b.lo + random(0.0, 3.0);
+            Interval range = evaluateInterval(op, a, b);
+            for (int k = 0; k <= 16; k++) {
+                double x = a.lo + (a.hi - a.lo) * k / 16;
+                double y = b.lo + (b.hi - b.lo) * ((k * 7) % 17) / 16;
+                if (op == Operation::Factorial)
+                    x = std::floor(x);
+                double value = 0.0;
+                if (!a.contains(x) || tryEvaluate(op, x, y, value) != MathError::None || std::isnan(value))
+                    continue;
+                sound = sound && range.contains(value);
+            }
+        }
+    }
+    CHECK(sound);
+
+    Expression e = Expression::parse("x^2 - 2x");
+    Interval x{ 0.0, 2.0, false };
+    Interval y = e.evaluateInterval(&x);
+    CHECK(y.contains(-1.0));
+    CHECK(y.contains(0.0));
+    CHECK(Expression::parse("1 / (x - x)").evaluateInterval(&x).partial);
+}
+
+TEST_CASE("IntervalPlotter tests") {
+    PlotViewport viewport;
+    viewport.width = 400;
+    viewport.height = 300;
+    const char* texts[] = { "x sin(x * 40)", "tan(x * 20)", "1 / ((x - 1.2345)^2 * 100000 + 0.01)", "(x / 3)!" };
+    ThreadPool pool(2);
+    for (const char* text : texts) {
+        Expression f = Expression::parse(text);
+        std::vector<PixelSpan> spans;
+        IntervalPlotStats stats = IntervalPlotter().plot(f, viewport, spans, &pool);
+        CHECK(stats.pixels > 0);
+        CHECK(stats.pixels < static_cast<uint64_t>(viewport.width) * viewport.height);
+        std::vector<std::vector<int>> covered(viewport.width);
+        for (const auto& span : spans) {
+            covered[span.column].push_back(span.rowBegin);
+            covered[span.column].push_back(span.rowEnd);
+        }
+        // Каждая точка плотной выборки, попавшая на экран, лежит в отмеченном пикселе
+        bool sound = true;
+        const int samples = viewport.width * 64;
+        for (int i = 0; i < samples; i++) {
+            double px = (i + 0.5) * viewport.width / samples;
+            double value = f(viewport.toWorldX(px));
+            if (!(value >= viewport.yMin && value <= viewport.yMax))
+                continue;
+            int column = static_cast<int>(px);
+            int row = std::min(static_cast<int>(viewport.toScreenY(value)), viewport.height - 1);
+            bool found = false;
+            for (size_t k = 0; k < covered[column].size(); k += 2)
+                found = found || (covered[column][k] <= row && row < covered[column][k + 1]);
+            sound = sound && found;
+        }
+        CHECK(sound);
+    }
+
+    // Пик уже пикселя: точечная выборка по пикселям его не видит, интервальная отмечает весь столбец
+    Expression spike = Expression::parse("1 / ((x - 1.2345)^2 * 100000 + 0.01)");
+    std::vector<PixelSpan> spans;
+    IntervalPlotter().plot(spike, viewport, spans);
+    int column = static_cast<int>(viewport.toScreenX(1.2345));
+    bool reachesTop = false;
+    for (const auto& span : spans)
+        reachesTop = reachesTop || (span.column == column && span.rowBegin == 0);
+    CHECK(reachesTop);
+}
+
+TEST_CASE("ImplicitPlotter tests") {
+    CHECK_THROWS_AS(parseRelation("x^2 + y^2"), std::runtime_error);
+    CHECK_THROWS_AS(parseRelation("x = y = 1"), std::runtime_error);
+    CHECK_THROWS_AS(parseRelation("x + = y"), std::runtime_error);
+    CHECK_THROWS_AS(ImplicitPlotter(ImplicitPlotOptions{ 64, 12, 1, true }), std::runtime_error);
+
+    PlotViewport viewport;
+    viewport.width = 400;
+    viewport.height = 300;
+    double pixel = (viewport.xMax - viewport.xMin) / viewport.width;
+    ThreadPool pool(2);
+
+    std::vector<ImplicitSegment> circle;
+    ImplicitPlotStats stats = ImplicitPlotter().plot(parseRelation("x^2 + y^2 = 25"), viewport, circle, &pool);
+    REQUIRE(!circle.empty());
+    bool onCircle = true;
+    double length = 0.0;
+    for (const auto& segment : circle) {
+        onCircle = onCircle && std::fabs(std::hypot(segment.a.x, segment.a.y) - 5.0) < pixel &&
+            std::fabs(std::hypot(segment.b.x, segment.b.y) - 5.0) < pixel;
+        length += std::hypot(segment.b.x - segment.a.x, segment.b.y - segment.a.y);
+    }
+    CHECK(onCircle);
+    CHECK(std::fabs(length - 10.0 * kPi) < 0.05);
+    // Вычисления сосредоточены у кривой: намного меньше числа узлов полной сетки
+    CHECK(stats.evaluations < static_cast<uint64_t>(viewport.width) * viewport.height / 8);
+
+    std::vector<ImplicitSegment> serial;
+    ImplicitPlotter().plot(parseRelation("x^2 + y^2 = 25"), viewport, serial);
+    CHECK(serial.size() == circle.size());
+
+    // Окружность меньше ячейки начальной сетки находится только по промежутку значений
+    std::vector<ImplicitSegment> small;
+    ImplicitPlotter().plot(parseRelation("(x - 0.013)^2 + (y + 0.021)^2 = 0.0016"), viewport, small);
+    CHECK(!small.empty());
+    ImplicitPlotter(ImplicitPlotOptions{ 64, 8, 1, false }).plot(parseRelation("(x - 0.013)^2 + (y + 0.021)^2 = 0.0016"),
+        viewport, small);
+    CHECK(small.empty());
+
+    std::vector<ImplicitSegment> waves;
+    ImplicitPlotter().plot(parseRelation("sin(x * 30) = cos(y * 30)"), viewport, waves, &pool);
+    bool onWaves = true;
+    for (const auto& segment : waves)
+        onWaves = onWaves && std::fabs(std::sin(segment.a.x * kPi / 6) - std::cos(segment.a.y * kPi / 6)) < 0.05;
+    CHECK(waves.size() > 1000);
+    CHECK(onWaves);
+
+    // У полюса tan знак меняется без нуля, такие отрезки отбрасываются
+    std::vector<ImplicitSegment> tangent;
+    PlotViewport shifted = viewport;
+    shifted.xMin += 0.013;
+    shifted.xMax += 0.013;
+    ImplicitPlotter().plot(parseRelation("y = tan(x * 20)"), shifted, tangent);
+    bool nearPole = false;
+    for (const auto& segment : tangent)
+        nearPole = nearPole || (std::fabs(std::fabs(segment.a.x) - 4.5) < pixel && std::fabs(segment.a.y) < 5.0);
+    CHECK(!tangent.empty());
+    CHECK(!nearPole);
+}
+
+TEST_CASE("HeatmapTileCache tests") {
+    PlotViewport viewport;
+    viewport.width = 640;
+    viewport.height = 480;
+    viewport.yMin = -7.5;
+    viewport.yMax = 7.5;
+    int level = HeatmapTileCache::levelFor(viewport);
+    CHECK(std::ldexp(1.0, level) == doctest::Approx(20.0 / 640).epsilon(0.5));
+
+    std::vector<HeatmapTileKey> keys;
+    HeatmapTileCache::visibleTiles(viewport, keys);
+    double xMin = 1e300;
+    double xMax = -1e300;
+    double yMin = 1e300;
+    double yMax = -1e300;
+    for (const auto& key : keys) {
+        double x0, x1, y0, y1;
+        HeatmapTileCache::tileBounds(key, x0, x1, y0, y1);
+        xMin = std::min(xMin, x0);
+        xMax = std::max(xMax, x1);
+        yMin = std::min(yMin, y0);
+        yMax = std::max(yMax, y1);
+    }
+    CHECK(xMin <= viewport.xMin);
+    CHECK(xMax >= viewport.xMax);
+    CHECK(yMin <= viewport.yMin);
+    CHECK(yMax >= viewport.yMax);
+
+    Expression f = Expression::parse("x * y - 1 / (x - 1)", { "x", "y" });
+    HeatmapTileCache cache(f);
+    ThreadPool pool(2);
+    std::vector<std::shared_ptr<const HeatmapTile>> tiles;
+    CHECK(cache.update(viewport, tiles, &pool) == keys.size());
+    REQUIRE(tiles.size() == keys.size());
+    const HeatmapTile& tile = *tiles[0];
+    double x0, x1, y0, y1;
+    HeatmapTileCache::tileBounds(tile.key, x0, x1, y0, y1);
+    double step = (x1 - x0) / HeatmapTileCache::kTileSize;
+    double variables[2] = { x0 + 3.5 * step, y1 - 5.5 * step };
+    double expected = 0.0;
+    f.evaluate(variables, expected);
+    CHECK(tile.values[5 * HeatmapTileCache::kTileSize + 3] == doctest::Approx(expected).epsilon(1e-6));
+    CHECK(tile.low <= tile.high);
+
+    // Повторный кадр и возврат к прежней области не вычисляют ничего, сдвиг — только новые плитки
+    CHECK(cache.update(viewport, tiles, &pool) == 0);
+    PlotViewport panned = viewport;
+    panned.xMin += (x1 - x0) * 1.5;
+    panned.xMax += (x1 - x0) * 1.5;
+    size_t built = cache.update(panned, tiles);
+    CHECK(built > 0);
+    CHECK(built < tiles.size());
+    CHECK(cache.update(viewport, tiles) == 0);
+    CHECK(cache.stats().evaluations == (keys.size() + built) * HeatmapTileCache::kTileSize * HeatmapTileCache::kTileSize);
+
+    // Экран 4K покрывают больше плиток, чем ёмкость по умолчанию: она задаётся по области, как в окне графиков
+    PlotViewport screen;
+    screen.width = 3840;
+    screen.height = 2160;
+    screen.yMin = -10.0 * 9 / 16;
+    screen.yMax = 10.0 * 9 / 16;
+    HeatmapTileCache::visibleTiles(screen, keys);
+    CHECK(keys.size() > 128);
+    CHECK(HeatmapTileCache::capacityFor(screen) >= 2 * keys.size());
+    PlotViewport moved = screen;
+    moved.pan(37.0, 11.0);
+    CHECK(HeatmapTileCache::capacityFor(moved) == HeatmapTileCache::capacityFor(screen));
+    HeatmapTileCache large(Expression::parse("x + y", { "x", "y" }));
+    large.setMaxTiles(HeatmapTileCache::capacityFor(screen));
+    CHECK(large.update(screen, tiles, &pool) == keys.size());
+    CHECK(large.update(screen, tiles, &pool) == 0);
+    screen.pan(10.0, 0.0);
+    large.setMaxTiles(HeatmapTileCache::capacityFor(screen));
+    CHECK(large.update(screen, tiles, &pool) <= 14);
+
+    // Номера плиток не помещаются в int64_t: вырожденная область далеко от нуля и область шире всех уровней не рисуются
+    PlotViewport degenerate = viewport;
+    degenerate.xMin = 1e6;
+    degenerate.xMax = 1e6;
+    HeatmapTileCache::visibleTiles(degenerate, keys);
+    CHECK(keys.empty());
+    PlotViewport huge = viewport;
+    huge.xMin = -1e300;
+    huge.xMax = 1e300;
+    HeatmapTileCache::visibleTiles(huge, keys);
+    CHECK(keys.empty());
+    CHECK(large.update(huge, tiles, &pool) == 0);
+    CHECK(tiles.empty());
+    CHECK(HeatmapTileCache::capacityFor(huge) > 0);
+
+    const float values[] = { 0.0f, 1.0f, NAN, 0.5f };
+    uint8_t rgba[16];
+    colorizeHeatmap(values, 4, 0.0f, 1.0f, rgba);
+    CHECK(rgba[0] == 68);
+    CHECK(rgba[3] == 255);
+    CHECK(rgba[4] == 253);
+    CHECK(rgba[6] == 37);
+    CHECK(rgba[11] == 0);
+    CHECK(rgba[13] == 145);
+}
+
+TEST_CASE("Parametric sampler tests") {
+    PlotViewport viewport;
+    viewport.width = 640;
+    viewport.height = 480;
+    viewport.yMin = -7.5;
+    viewport.yMax = 7.5;
+    ParametricSampler sampler;
+    std::vector<PlotPoint> points;
+
+    ParametricCurve circle = ParametricCurve::parsePolar("5");
+    CHECK(circle.isPolar());
+    sampler.sample(circle, viewport, points);
+    REQUIRE(points.size() > 8);
+    for (const auto& point : points)
+        CHECK(std::hypot(point.x, point.y) == doctest::Approx(5.0).epsilon(1e-9));
+    CHECK(circle(90.0).y == doctest::Approx(5.0));
+
+    ParametricCurve arc = ParametricCurve::parsePolar("2; 0; 90");
+    CHECK(arc.tMax() == 90.0);
+    CHECK(arc(arc.tMax()).x == doctest::Approx(0.0));
+
+    CHECK_THROWS_AS(ParametricCurve::parse("t"), std::runtime_error);
+    CHECK_THROWS_AS(ParametricCurve::parse("t; t; 5"), std::runtime_error);
+    CHECK_THROWS_AS(ParametricCurve::parse("t; t; 10; 0"), std::runtime_error);
+    CHECK_THROWS_AS(ParametricCurve::parse("t; q"), std::runtime_error);
+    CHECK_THROWS_AS(ParametricCurve::parsePolar("1; 2"), std::runtime_error);
+
+    // Прямая не уточняется, петли фигуры Лиссажу получают дополнительные точки
+    ParametricSampleStats line = sampler.sample(ParametricCurve::parse("t / 36 - 5; t / 18 - 10"), viewport, points);
+    CHECK(line.evaluations <= 2 * static_cast<uint64_t>(sampler.options().initialSamples) + 1);
+    CHECK(line.breaks == 0);
+    ParametricSampleStats loops = sampler.sample(ParametricCurve::parse("5 cos(t * 7); 5 sin(t * 3)"), viewport, points);
+    CHECK(loops.evaluations > line.evaluations);
+    for (size_t i = 1; i < points.size(); i++) {
+        double dx = viewport.toScreenX(points[i].x) - viewport.toScreenX(points[i - 1].x);
+        double dy = viewport.toScreenY(points[i].y) - viewport.toScreenY(points[i - 1].y);
+        CHECK(std::hypot(dx, dy) < 40.0);
+    }
+
+    // Полюс при t = 180 разрывает кривую
+    ParametricSampleStats pole = sampler.sample(ParametricCurve::parse("t / 36 - 5; 1 / (t / 36 - 5)"), viewport, points);
+    CHECK(pole.breaks >= 1);
+    CHECK(std::any_of(points.begin(), points.end(), [](const PlotPoint& point) { return std::isnan(point.y); }));
+}
+
+TEST_CASE("Surface renderer tests") {
+    SurfaceMesh plane(Expression::parse("x + y", { "x", "y" }), -10, 10, -10, 10, 100);
+    CHECK(plane.resolution() == 128);
+    CHECK(plane.height(0, 0) == doctest::Approx(-0.5));
+    CHECK(plane.height(128, 128) == doctest::Approx(0.5));
+    for (int level = 0; level < SurfaceMesh::kLevels; level++)
+        CHECK(plane.patchError(1, 2, level) < 1e-5f);
+
+    ThreadPool pool(2);
+    SurfaceMesh waves(Expression::parse("sin(x * 40) * cos(y * 40)", { "x", "y" }), -10, 10, -10, 10, 256, &pool);
+    CHECK(waves.patchError(3, 3, SurfaceMesh::kLevels - 1) > waves.patchError(3, 3, 1));
+    CHECK(waves.patchError(3, 3, 1) > 0.0f);
+
+    SurfaceRenderer renderer;
+    SurfaceFrame frame;
+    frame.width = 320;
+    frame.height = 200;
+    SurfaceCamera camera;
+    SurfaceRenderStats above = renderer.render(waves, camera, frame, &pool);
+    CHECK(above.patches == 64);
+    CHECK(above.culled == 0);
+    CHECK(above.pixels > 320 * 200 / 8);
+    CHECK(frame.rgba[(100 * 320 + 160) * 4 + 3] == 255);
+    CHECK(frame.rgba[3] == 0);
+
+    // Рядом с камерой детализация выше, а участки за краями экрана отбрасываются
+    SurfaceCamera close = camera;
+    close.distance = 0.8;
+    SurfaceRenderStats near = renderer.render(waves, close, frame, &pool);
+    CHECK(near.culled > 0);
+    SurfaceCamera far = camera;
+    far.distance = 12.0;
+    SurfaceRenderStats distant = renderer.render(waves, far, frame, &pool);
+    CHECK(distant.triangles < above.triangles);
+    CHECK(renderer.render(plane, far, frame, &pool).triangles < distant.triangles);
+
+    // Снизу видна только изнанка: с отсечением нелицевых граней кадр пуст
+    SurfaceCamera below = camera;
+    below.pitch = -60.0;
+    SurfaceRenderStats culled = renderer.render(plane, below, frame);
+    CHECK(culled.pixels == 0);
+    CHECK(culled.backFaces > 0);
+    SurfaceRenderOptions twoSided;
+    twoSided.cullBackFaces = false;
+    CHECK(SurfaceRenderer(twoSided).render(plane, below, frame).pixels > 0);
+
+    // Без трещин: однотонная плоскость сверху закрывает каждый пиксель внутри проекции
+    SurfaceCamera top = camera;
+    top.pitch = 89.0;
+    top.distance = 2.0;
+    SurfaceFrame single;
+    single.width = 64;
+    single.height = 64;
+    renderer.render(plane, top, single);
+    size_t holes = 0;
+    for (int y = 24; y < 40; y++) {
+        for (int x = 24; x < 40; x++)
+            holes += single.rgba[(static_cast<size_t>(y) * 64 + x) * 4 + 3] == 0;
+    }
+    CHECK(holes == 0);
+}
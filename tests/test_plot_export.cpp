@@ -0,0 +1,177 @@
+#include "doctest.h"
+#include "../include/plot_canvas.h"
+#include "../include/png_writer.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Распаковывает поток zlib из блоков с фиксированными кодами Хаффмана (как пишет zlibCompress)
+ */
+static std::vector<uint8_t> inflateFixed(const std::vector<uint8_t>& stream) {
+    size_t bit = 16;
+    auto read = [&](int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++, bit++)
+            value |= ((stream[bit / 8] >> (bit % 8)) & 1u) << i;
+        return value;
+    };
+    auto readReversed = [&](int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++, bit++)
+            value = (value << 1) | ((stream[bit / 8] >> (bit % 8)) & 1u);
+        return value;
+    };
+    auto literal = [&]() -> uint32_t {
+        uint32_t code = readReversed(7);
+        if (code <= 0x17)
+            return code + 256;
+        code = (code << 1) | readReversed(1);
+        if (code >= 0x30 && code <= 0xBF)
+            return code - 0x30;
+        if (code >= 0xC0 && code <= 0xC7)
+            return code - 0xC0 + 280;
+        code = (code << 1) | readReversed(1);
+        return code - 0x190 + 144;
+    };
+    static const int lengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99,
+        115, 131, 163, 195, 227, 258 };
+    static const int lengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    std::vector<uint8_t> out;
+    bool last = false;
+    while (!last) {
+        last = read(1) == 1;
+        REQUIRE(read(2) == 1);
+        for (uint32_t symbol = literal(); symbol != 256; symbol = literal()) {
+            if (symbol < 256) {
+                out.push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+            int length = lengthBase[symbol - 257] + static_cast<int>(read(lengthExtra[symbol - 257]));
+            uint32_t code = readReversed(5);
+            int extra = code < 4 ? 0 : static_cast<int>(code / 2 - 1);
+            size_t base = code < 4 ? code + 1 : ((2u + (code & 1)) << extra) + 1;
+            size_t distance = base + read(extra);
+            REQUIRE(distance <= out.size());
+            for (int i = 0; i < length; i++)
+                out.push_back(out[out.size() - distance]);
+        }
+    }
+    return out;
+}
+
+static uint32_t bigEndian(const uint8_t* data) {
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+TEST_CASE("PNG writer tests") {
+    const std::string check = "123456789";
+    CHECK(crc32(reinterpret_cast<const uint8_t*>(check.data()), check.size()) == 0xCBF43926u);
+    const std::string wiki = "Wikipedia";
+    CHECK(adler32(reinterpret_cast<const uint8_t*>(wiki.data()), wiki.size()) == 0x11E60398u);
+
+    std::vector<uint8_t> data(70000);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(i < 40000 ? (i % 7) * (i % 13) : (i * 2654435761u) >> 24);
+    std::vector<uint8_t> compressed;
+    zlibCompress(data.data(), data.size(), compressed);
+    CHECK((compressed[0] * 256 + compressed[1]) % 31 == 0);
+    CHECK(inflateFixed(compressed) == data);
+    CHECK(bigEndian(&compressed[compressed.size() - 4]) == adler32(data.data(), data.size()));
+
+    std::vector<uint8_t> flat(64 * 1024, 20);
+    std::vector<uint8_t> flatCompressed;
+    zlibCompress(flat.data(), flat.size(), flatCompressed);
+    CHECK(flatCompressed.size() < flat.size() / 100);
+    CHECK(inflateFixed(flatCompressed) == flat);
+
+    const int width = 5;
+    const int height = 3;
+    std::vector<uint8_t> rgba(width * height * 4);
+    for (size_t i = 0; i < rgba.size(); i++)
+        rgba[i] = static_cast<uint8_t>(i * 37);
+    std::vector<uint8_t> png;
+    encodePng(rgba.data(), width, height, png);
+    REQUIRE(png.size() > 8 + 25 + 12 + 12);
+    CHECK(std::memcmp(png.data(), "\x89PNG\r\n\x1a\n", 8) == 0);
+    CHECK(bigEndian(&png[8]) == 13);
+    CHECK(std::memcmp(&png[12], "IHDR", 4) == 0);
+    CHECK(bigEndian(&png[16]) == width);
+    CHECK(bigEndian(&png[20]) == height);
+    CHECK(bigEndian(&png[29]) == crc32(&png[12], 17));
+
+    // Расфильтровка данных IDAT должна вернуть исходные пиксели
+    size_t idat = 33;
+    size_t idatSize = bigEndian(&png[idat]);
+    CHECK(std::memcmp(&png[idat + 4], "IDAT", 4) == 0);
+    std::vector<uint8_t> stream(png.begin() + idat + 8, png.begin() + idat + 8 + idatSize);
+    std::vector<uint8_t> filtered = inflateFixed(stream);
+    REQUIRE(filtered.size() == static_cast<size_t>(height) * (width * 4 + 1));
+    std::vector<uint8_t> decoded;
+    const size_t stride = width * 4;
+    for (int y = 0; y < height; y++) {
+        uint8_t filter = filtered[y * (stride + 1)];
+        const uint8_t* row = &filtered[y * (stride + 1) + 1];
+        for (size_t x = 0; x < stride; x++) {
+            int left = x >= 4 ? decoded[y * stride + x - 4] : 0;
+            int up = y > 0 ? decoded[(y - 1) * stride + x] : 0;
+            int upLeft = x >= 4 && y > 0 ? decoded[(y - 1) * stride + x - 4] : 0;
+            int predicted = 0;
+            if (filter == 1)
+                predicted = left;
+            else if (filter == 2)
+                predicted = up;
+            else if (filter == 4) {
+                int p = left + up - upLeft;
+                int pa = std::abs(p - left);
+                int pb = std::abs(p - up);
+                int pc = std::abs(p - upLeft);
+                predicted = pa <= pb && pa <= pc ? left : pb <= pc ? up : upLeft;
+            }
+            decoded.push_back(static_cast<uint8_t>(row[x] + predicted));
+        }
+    }
+    CHECK(decoded == rgba);
+    CHECK(std::memcmp(&png[png.size() - 8], "IEND", 4) == 0);
+}
+
+TEST_CASE("PlotCanvas tests") {
+    const RgbaColor background = { 0, 0, 0 };
+    const RgbaColor white = { 255, 255, 255 };
+    PlotCanvas canvas(100, 150, background);
+    canvas.strokeLine(10.0f, 20.5f, 90.0f, 20.5f, 1.0f, white);
+    // Ломаная с разрывом и точкой далеко за краем (как у асимптоты)
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float polyline[] = { 10.0f, 100.0f, 50.0f, 130.0f, nan, nan, 50.0f, 70.0f, 60.0f, -1e9f };
+    canvas.strokePolyline(polyline, 5, 3.0f, white);
+    ThreadPool pool(2);
+    canvas.render(&pool, 16);
+    auto red = [&](int x, int y) { return canvas.pixels()[(static_cast<size_t>(y) * canvas.width() + x) * 4]; };
+    CHECK(red(30, 20) == 255);
+    CHECK(red(30, 19) == 0);
+    CHECK(red(30, 21) == 0);
+    CHECK(red(5, 20) == 0);
+    CHECK(red(30, 115) == 255);
+    CHECK(red(30, 105) == 0);
+    CHECK(red(50, 100) == 0);
+    CHECK(red(50, 10) > 0);
+    CHECK(red(55, 10) == 0);
+    CHECK(canvas.pixels()[3] == 255);
+
+    // Кромка гладкой ломаной из коротких отрезков не должна быть ярче кромки одного отрезка
+    PlotCanvas dense(100, 20, background);
+    std::vector<float> points;
+    for (int i = 0; i <= 200; i++) {
+        points.push_back(i * 0.5f);
+        points.push_back(10.25f);
+    }
+    dense.strokePolyline(points.data(), points.size() / 2, 2.0f, white);
+    dense.render();
+    const uint8_t edge = dense.pixels()[(9 * 100 + 50) * 4];
+    CHECK(edge > 0);
+    CHECK(edge < 255);
+    for (int x = 5; x < 95; x++)
+        CHECK(dense.pixels()[(9 * 100 + x) * 4] == edge);
+}
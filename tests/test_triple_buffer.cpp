@@ -0,0 +1,21 @@
+#include "doctest.h"
+#include "../include/triple_buffer.h"
+#include <string>
+
+TEST_CASE("TripleBuffer tests") {
+    TripleBuffer<std::string> buffer;
+    CHECK_FALSE(buffer.acquire());
+
+    buffer.writeBuffer() = "12";
+    buffer.publish();
+    CHECK(buffer.acquire());
+    CHECK(buffer.readBuffer() == "12");
+    CHECK_FALSE(buffer.acquire());
+
+    buffer.writeBuffer() = "12+";
+    buffer.publish();
+    buffer.writeBuffer() = "12+3";
+    buffer.publish();
+    CHECK(buffer.acquire());
+    CHECK(buffer.readBuffer() == "12+3");
+}
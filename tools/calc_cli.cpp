@@ -0,0 +1,189 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "command_line.h"
+#include "evaluation_pipeline.h"
+#include "line_evaluator.h"
+#include "mapped_file.h"
+
+/**
+ * @brief Размер накопленного вывода, после которого он сбрасывается в stdout
+ */
+static const size_t kFlushThreshold = 1 << 16;
+
+/**
+ * @brief Наибольшее число потоков, которое принимается из командной строки
+ */
+static const size_t kMaxThreads = 1024;
+
+static void printUsage() {
+    std::cerr << "Usage: calc-cli [--report] [expression...]\n"
+              << "       calc-cli [--report] [--threads N] [-o results.txt] --batch expressions.txt\n"
+              << "       calc-cli [--report] [--lanes N] --pipeline < expressions.txt\n"
+              << "Without expressions reads one expression per line from standard input." << std::endl;
+}
+
+/**
+ * @brief Пакетный режим: файл выражений отображается в память и вычисляется пулом потоков
+ */
+static int runBatch(const std::string& input, const std::string& output, size_t threads, bool report) {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        MappedFile file(input);
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> out(nullptr, std::fclose);
+        if (!output.empty()) {
+            out.reset(std::fopen(output.c_str(), "wb"));
+            if (!out)
+                throw std::runtime_error("Cannot write " + output);
+        }
+        ThreadPool pool(threads);
+        LineBatchStats stats = evaluateLines(file.view(), out ? out.get() : stdout, &pool);
+        if (out ? std::fclose(out.release()) != 0 : std::fflush(stdout) != 0)
+            throw std::runtime_error("Cannot write results");
+        if (report) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << stats.lines << " lines, " << stats.errors << " errors, " << file.size() / 1048576.0 << " MB in "
+                      << seconds * 1000.0 << " ms (" << stats.lines / seconds << " expressions per second, "
+                      << file.size() / 1048576.0 / seconds << " MB/s) on " << pool.size() << " threads" << std::endl;
+        }
+        return stats.errors > 0 ? 1 : 0;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+/**
+ * @brief Потоковый режим: стандартный ввод вычисляется конвейером потоков (runEvaluationPipeline)
+ */
+static int runPipeline(size_t lanes, bool report) {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        PipelineOptions options;
+        options.lanes = lanes;
+        PipelineStats stats = runEvaluationPipeline(stdin, stdout, options);
+        if (report) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cerr << stats.lines << " lines, " << stats.errors << " errors in " << seconds * 1000.0 << " ms ("
+                      << stats.lines / seconds << " expressions per second), " << stats.batches << " batches, latency mean "
+                      << stats.meanLatencyMs << " ms, max " << stats.maxLatencyMs << " ms" << std::endl;
+        }
+        return stats.errors > 0 ? 1 : 0;
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+/**
+ * @brief Консольный калькулятор без графической подсистемы
+ *
+ * Вычисляет выражения из аргументов или из стандартного ввода (по одному на строку)
+ * и печатает по строке результата на каждое. Строки читаются блоками без копирования,
+ * одно скомпилированное выражение переиспользуется, а результаты копятся в буфере
+ * и выводятся крупными порциями.
+ * В пакетном режиме файл отображается в память и вычисляется параллельно (evaluateLines),
+ * результаты записываются в порядке строк. В потоковом режиме непрерывный ввод проходит
+ * через конвейер стадий в отдельных потоках с ограниченными очередями.
+ * Использование:
+ *   calc-cli [--report] <выражение>...
+ *   calc-cli [--report] < выражения.txt
+ *   calc-cli [--report] [--threads N] [-o результаты.txt] --batch выражения.txt
+ *   calc-cli [--report] [--lanes N] --pipeline < выражения.txt
+ * --report печатает в stderr число строк, время и число выражений в секунду.
+ * Код возврата 1, если хотя бы одна строка содержит ошибку.
+ */
+int main(int argc, char* argv[]) {
+    bool report = false;
+    std::string batch;
+    std::string output;
+    size_t threads = 0;
+    bool pipeline = false;
+    size_t lanes = 0;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--report")
+            report = true;
+        else if (arg == "--batch" && i + 1 < argc)
+            batch = argv[++i];
+        else if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 0, kMaxThreads, threads)) {
+                std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--pipeline")
+            pipeline = true;
+        else if (arg == "--lanes" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 0, kMaxThreads, lanes)) {
+                std::cerr << "Invalid lane count: " << argv[i] << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--help") {
+            printUsage();
+            return 0;
+        }
+        else
+            arguments.push_back(arg);
+    }
+    if (!batch.empty())
+        return runBatch(batch, output, threads, report);
+    if (pipeline)
+        return runPipeline(lanes, report);
+
+    LineEvaluator evaluator;
+    std::string out;
+    out.reserve(kFlushThreshold * 2);
+    size_t lines = 0;
+    size_t errors = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto evaluate = [&](std::string_view line) {
+        lines++;
+        if (!evaluator.evaluateLine(line, out))
+            errors++;
+        if (out.size() >= kFlushThreshold) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    };
+    if (!arguments.empty()) {
+        for (const std::string& argument : arguments)
+            evaluate(argument);
+    }
+    else {
+        LineReader reader(stdin);
+        std::string_view line;
+        for (;;) {
+            // Перед ожиданием ввода накопленные результаты выводятся: в диалоговом режиме ответ виден сразу
+            if (!out.empty() && !reader.lineReady()) {
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                std::fflush(stdout);
+                out.clear();
+            }
+            if (!reader.next(line))
+                break;
+            evaluate(line);
+        }
+    }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+    if (report) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << lines << " lines, " << errors << " errors in " << seconds * 1000.0 << " ms ("
+                  << lines / seconds << " expressions per second)" << std::endl;
+    }
+    return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "calc_protocol.h"
+#include "command_line.h"
+
+/**
+ * @brief Результаты одного соединения нагрузки
+ */
+struct LoadResult {
+    std::vector<double> latencies;  ///< Микросекунды от отправки до ответа
+    size_t errors = 0;
+    std::string failure;
+};
+
+/**
+ * @brief Держит depth запросов в пути: на каждый ответ отправляется следующий запрос
+ */
+static void runConnection(const std::string& socketPath, const std::vector<std::string>& expressions, size_t requests,
+    size_t depth, size_t offset, LoadResult& result) {
+    using Clock = std::chrono::steady_clock;
+    try {
+        CalcClient client(socketPath);
+        std::vector<Clock::time_point> sent(requests);
+        result.latencies.reserve(requests);
+        size_t next = 0;
+        auto sendNext = [&]() {
+            sent[next] = Clock::now();
+            client.send(static_cast<uint32_t>(next), expressions[(offset + next * 7919) % expressions.size()]);
+            next++;
+        };
+        while (next < std::min(depth, requests))
+            sendNext();
+        client.flush();
+        for (size_t received = 0; received < requests; received++) {
+            CalcResponse response = client.receive();
+            if (response.id >= requests)
+                throw std::runtime_error("Unexpected response id " + std::to_string(response.id));
+            result.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[response.id]).count());
+            if (response.status != CalcStatus::Ok)
+                result.errors++;
+            if (next < requests) {
+                sendNext();
+                client.flush();
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        result.failure = ex.what();
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty())
+        return 0.0;
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * @brief Генератор нагрузки для calc-server
+ *
+ * Открывает несколько соединений, в каждом держит заданное число запросов в пути и печатает
+ * пропускную способность и задержку (p50, p99, p99.9, максимум) от отправки запроса до ответа.
+ * Выражения выбираются из distinct различных, поэтому при малом distinct одинаковые запросы
+ * совпадают во времени и сервер объединяет их.
+ * Использование:
+ *   calc-load [--socket путь] [--connections N] [--requests N] [--depth N] [--distinct N] [--metrics путь]
+ * --requests — запросов на соединение; --metrics печатает метрики сервера после прогона.
+ */
+int main(int argc, char* argv[]) {
+    std::string socketPath = "/tmp/calc-server.sock";
+    std::string metricsPath;
+    size_t connections = 8;
+    size_t requests = 50000;
+    size_t depth = 16;
+    size_t distinct = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        // Номер запроса передаётся в uint32, поэтому запросов на соединение не больше 2^32
+        if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--metrics" && i + 1 < argc)
+            metricsPath = argv[++i];
+        else if (arg == "--connections" && i + 1 < argc && parseCount(argv[i + 1], 1, 4096, connections))
+            i++;
+        else if (arg == "--requests" && i + 1 < argc && parseCount(argv[i + 1], 1, UINT32_MAX, requests))
+            i++;
+        else if (arg == "--depth" && i + 1 < argc && parseCount(argv[i + 1], 1, 1 << 20, depth))
+            i++;
+        else if (arg == "--distinct" && i + 1 < argc && parseCount(argv[i + 1], 1, 1 << 24, distinct))
+            i++;
+        else {
+            std::cerr << "Usage: calc-load [--socket path] [--connections N] [--requests N] [--depth N] [--distinct N]"
+                      << " [--metrics path]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<std::string> expressions;
+    for (size_t i = 0; i < distinct; i++)
+        expressions.push_back(std::to_string(i) + " * 3 + sin " + std::to_string(i % 90) + " - " + std::to_string(i % 7) + "!");
+
+    std::vector<LoadResult> results(connections);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < connections; c++) {
+        threads.emplace_back(runConnection, std::cref(socketPath), std::cref(expressions), requests, depth, c * 131,
+            std::ref(results[c]));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    bool failed = false;
+    for (const LoadResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+        if (!result.failure.empty()) {
+            std::cerr << result.failure << std::endl;
+            failed = true;
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << latencies.size() << " requests over " << connections << " connections (depth " << depth << ") in "
+              << seconds * 1000.0 << " ms: " << latencies.size() / seconds << " requests per second\n"
+              << "latency us: p50 " << percentile(latencies, 0.5) << ", p99 " << percentile(latencies, 0.99) << ", p99.9 "
+              << percentile(latencies, 0.999) << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << "\n"
+              << errors << " error responses" << std::endl;
+    if (!metricsPath.empty()) {
+        try {
+            std::cout << fetchMetrics(metricsPath);
+        }
+        catch (const std::exception& ex) {
+            std::cerr << ex.what() << std::endl;
+            failed = true;
+        }
+    }
+    return failed || errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "calc_server.h"
+#include "command_line.h"
+
+static CalcServer* runningServer = nullptr;
+
+static void onSignal(int) {
+    if (runningServer != nullptr)
+        runningServer->stop();
+}
+
+/**
+ * @brief Долгоживущий сервер вычислений для инструментов, которые раньше запускали калькулятор на каждый запрос
+ *
+ * Использование:
+ *   calc-server [--socket путь] [--metrics путь] [--threads N] [--batch N]
+ * По умолчанию запросы принимаются на /tmp/calc-server.sock, метрики — на /tmp/calc-server.metrics.sock
+ * (curl --unix-socket /tmp/calc-server.metrics.sock http://localhost/metrics). Завершается по SIGINT и SIGTERM.
+ */
+int main(int argc, char* argv[]) {
+    CalcServerOptions options;
+    options.socketPath = "/tmp/calc-server.sock";
+    options.metricsPath = "/tmp/calc-server.metrics.sock";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc)
+            options.socketPath = argv[++i];
+        else if (arg == "--metrics" && i + 1 < argc)
+            options.metricsPath = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc && parseCount(argv[i + 1], 0, 1024, options.threads))
+            i++;
+        else if (arg == "--batch" && i + 1 < argc && parseCount(argv[i + 1], 1, 1 << 20, options.batchSize))
+            i++;
+        else {
+            std::cerr << "Usage: calc-server [--socket path] [--metrics path] [--threads N] [--batch N]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    try {
+        CalcServer server(options);
+        runningServer = &server;
+        struct sigaction action{};
+        action.sa_handler = onSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        std::cerr << "Listening on " << options.socketPath;
+        if (!options.metricsPath.empty())
+            std::cerr << ", metrics on " << options.metricsPath;
+        std::cerr << std::endl;
+        server.run();
+        runningServer = nullptr;
+    }
+    catch (const std::exception& ex) {
+        runningServer = nullptr;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
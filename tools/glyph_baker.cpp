@@ -0,0 +1,118 @@
+#include "truetype_font.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Записывает массив байтов в виде инициализатора C++
+ */
+static void writeBytes(std::ofstream& out, const uint8_t* data, size_t size) {
+    char buffer[8];
+    for (size_t i = 0; i < size; i++) {
+        std::snprintf(buffer, sizeof(buffer), "%u,", data[i]);
+        out << buffer << ((i % 32 == 31) ? "\n" : "");
+    }
+    out << "\n";
+}
+
+/**
+ * @brief Генератор встроенного шрифта и атласа глифов
+ *
+ * Растеризует печатные символы ASCII и «±» заданным кеглем, упаковывает их в атлас
+ * по полкам и записывает исходный файл C++ с данными шрифта, атласом и метриками (см. baked_font.h).
+ * Использование: glyph_baker <font.ttf> <кегль> <выход.cpp>
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: glyph_baker <font.ttf> <pixel size> <output.cpp>" << std::endl;
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> fontData((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unsigned pixelSize = static_cast<unsigned>(std::atoi(argv[2]));
+
+    std::vector<uint32_t> charset;
+    for (uint32_t c = 32; c < 127; c++)
+        charset.push_back(c);
+    charset.push_back(0x00B1);
+
+    const int atlasWidth = 512;
+    const int padding = 1;
+    std::vector<GlyphBitmap> bitmaps;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    float lineSpacing;
+    try {
+        TrueTypeFont font(fontData.data(), fontData.size());
+        float scale = static_cast<float>(pixelSize) / font.unitsPerEm();
+        lineSpacing = (font.ascent() - font.descent() + font.lineGap()) * scale;
+        int penX = padding;
+        int penY = padding;
+        int shelfHeight = 0;
+        for (uint32_t c : charset) {
+            bitmaps.push_back(font.rasterize(font.glyphIndex(c), static_cast<float>(pixelSize)));
+            const GlyphBitmap& bitmap = bitmaps.back();
+            if (penX + bitmap.width + padding > atlasWidth) {
+                penX = padding;
+                penY += shelfHeight + padding;
+                shelfHeight = 0;
+            }
+            xs.push_back(penX);
+            ys.push_back(penY);
+            penX += bitmap.width + padding;
+            if (bitmap.height > shelfHeight)
+                shelfHeight = bitmap.height;
+        }
+        ys.push_back(penY + shelfHeight + padding);
+    }
+    catch (const std::exception& ex) {
+        std::cerr << argv[1] << ": " << ex.what() << std::endl;
+        return 1;
+    }
+
+    int atlasHeight = 1;
+    while (atlasHeight < ys.back())
+        atlasHeight *= 2;
+    std::vector<uint8_t> atlas(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+    for (size_t i = 0; i < bitmaps.size(); i++) {
+        const GlyphBitmap& bitmap = bitmaps[i];
+        for (int row = 0; row < bitmap.height && !bitmap.pixels.empty(); row++) {
+            for (int col = 0; col < bitmap.width; col++)
+                atlas[static_cast<size_t>(ys[i] + row) * atlasWidth + xs[i] + col] = bitmap.pixels[row * bitmap.width + col];
+        }
+    }
+
+    std::ofstream out(argv[3]);
+    if (!out) {
+        std::cerr << "Cannot write " << argv[3] << std::endl;
+        return 1;
+    }
+    out << std::fixed;
+    out << "// Generated by glyph_baker from " << argv[1] << ", do not edit.\n";
+    out << "#include \"baked_font.h\"\n\n";
+    out << "const uint8_t kEmbeddedFontData[] = {\n";
+    writeBytes(out, fontData.data(), fontData.size());
+    out << "};\nconst size_t kEmbeddedFontSize = " << fontData.size() << ";\n\n";
+    out << "const unsigned kBakedCharacterSize = " << pixelSize << ";\n";
+    out << "const float kBakedLineSpacing = " << lineSpacing << "f;\n";
+    out << "const unsigned kGlyphAtlasWidth = " << atlasWidth << ";\n";
+    out << "const unsigned kGlyphAtlasHeight = " << atlasHeight << ";\n";
+    out << "const uint8_t kGlyphAtlasPixels[] = {\n";
+    writeBytes(out, atlas.data(), atlas.size());
+    out << "};\n\nconst BakedGlyph kBakedGlyphs[] = {\n";
+    for (size_t i = 0; i < bitmaps.size(); i++) {
+        const GlyphBitmap& bitmap = bitmaps[i];
+        out << "    { " << charset[i] << ", " << xs[i] << ", " << ys[i] << ", " << bitmap.width << ", "
+            << bitmap.height << ", " << bitmap.left << ", " << bitmap.top << ", " << bitmap.advance << "f },\n";
+    }
+    out << "};\nconst size_t kBakedGlyphCount = " << bitmaps.size() << ";\n";
+    return out ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "baked_font.h"
+#include "command_line.h"
+#include "plot_export.h"
+
+/**
+ * @brief Задание пакетного экспорта: файл и функции
+ */
+struct ExportJob {
+    std::string path;
+    std::vector<std::string> functions;
+};
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Читает задания из строк "выход.png выражение; выражение"; пустые строки и строки с # пропускаются
+ */
+static std::vector<ExportJob> loadJobs(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open " + path);
+    std::vector<ExportJob> jobs;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+        size_t space = line.find_first_of(" \t");
+        if (space == std::string::npos)
+            throw std::runtime_error("Missing expression in batch line: " + line);
+        ExportJob job;
+        job.path = line.substr(0, space);
+        std::istringstream rest(line.substr(space + 1));
+        std::string function;
+        while (std::getline(rest, function, ';')) {
+            function = trim(function);
+            if (!function.empty())
+                job.functions.push_back(function);
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+/**
+ * @brief Разбирает размер вида <Ш>x<В>: два целых от 1 до 16384 без лишних символов
+ * @return false, если аргумент не такой размер
+ */
+static bool parseSize(const char* text, int& width, int& height) {
+    const char* separator = std::strchr(text, 'x');
+    if (!separator)
+        return false;
+    std::string widthText(text, separator);
+    return parseCount(widthText.c_str(), 1, 16384, width) && parseCount(separator + 1, 1, 16384, height);
+}
+
+static std::vector<Expression> parseFunctions(const std::vector<std::string>& texts) {
+    std::vector<Expression> functions;
+    for (const std::string& text : texts)
+        functions.push_back(Expression::parse(text));
+    return functions;
+}
+
+/**
+ * @brief Безоконный экспорт графиков в PNG
+ *
+ * Не использует SFML и OpenGL: работает на серверах без дисплея и видеокарты.
+ * Один график растеризуется полосами параллельно; в пакетном режиме параллельно
+ * строятся разные графики, а глифы подписей растеризуются один раз на все.
+ * Использование:
+ *   plot_export [параметры] -o <выход.png> <выражение>...
+ *   plot_export [параметры] --batch <задания.txt>
+ * Параметры: --size <Ш>x<В>, --scale <множитель>, --range <xMin> <xMax> <yMin> <yMax>,
+ * --threads <число>, --report (напечатать время и число графиков в минуту).
+ */
+int main(int argc, char* argv[]) {
+    PlotExportOptions options;
+    PlotViewport viewport;
+    std::string output;
+    std::string batch;
+    std::vector<std::string> texts;
+    size_t threads = 0;
+    bool report = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            if (!parseSize(argv[++i], options.width, options.height)) {
+                std::cerr << "Invalid size " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--scale" && i + 1 < argc) {
+            double scale = 0.0;
+            if (!parseNumber(argv[++i], scale) || scale <= 0.0) {
+                std::cerr << "Invalid scale " << argv[i] << std::endl;
+                return 1;
+            }
+            options.scale = std::max(0.25f, static_cast<float>(scale));
+        }
+        else if (arg == "--range" && i + 4 < argc) {
+            if (!parseNumber(argv[i + 1], viewport.xMin) || !parseNumber(argv[i + 2], viewport.xMax) ||
+                !parseNumber(argv[i + 3], viewport.yMin) || !parseNumber(argv[i + 4], viewport.yMax)) {
+                std::cerr << "Invalid range " << argv[i + 1] << " " << argv[i + 2] << " " << argv[i + 3] << " "
+                          << argv[i + 4] << std::endl;
+                return 1;
+            }
+            i += 4;
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseCount(argv[++i], 0, 1024, threads)) {
+                std::cerr << "Invalid thread count " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--batch" && i + 1 < argc)
+            batch = argv[++i];
+        else if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (arg == "--report")
+            report = true;
+        else
+            texts.push_back(arg);
+    }
+    if (batch.empty() && (output.empty() || texts.empty())) {
+        std::cerr << "Usage: plot_export [--size WxH] [--scale S] [--range xMin xMax yMin yMax] [--threads N] [--report]\n"
+                  << "                   -o <output.png> <expression>... | --batch <jobs.txt>" << std::endl;
+        return 1;
+    }
+    if (!(viewport.xMax > viewport.xMin) || !(viewport.yMax > viewport.yMin)) {
+        std::cerr << "Invalid range" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::vector<ExportJob> jobs;
+        if (!batch.empty())
+            jobs = loadJobs(batch);
+        else
+            jobs.push_back({ output, texts });
+        std::vector<std::vector<Expression>> functions;
+        for (const ExportJob& job : jobs)
+            functions.push_back(parseFunctions(job.functions));
+
+        TrueTypeFont font(kEmbeddedFontData, kEmbeddedFontSize);
+        GlyphCache glyphs(font);
+        PlotExporter exporter(glyphs, options);
+        ThreadPool pool(threads);
+        auto start = std::chrono::steady_clock::now();
+        if (jobs.size() == 1)
+            exporter.exportPng(functions[0], viewport, jobs[0].path, &pool);
+        else {
+            // Графики пакета независимы: каждый строится одним потоком, без дробления на полосы
+            std::atomic<size_t> failed{ 0 };
+            pool.parallelFor(0, jobs.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; j++) {
+                    try {
+                        exporter.exportPng(functions[j], viewport, jobs[j].path);
+                    }
+                    catch (const std::exception& ex) {
+                        std::cerr << jobs[j].path << ": " << ex.what() << std::endl;
+                        failed++;
+                    }
+                }
+            });
+            if (failed > 0)
+                return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (report) {
+            std::cout << jobs.size() << " plots " << options.width << "x" << options.height << " in " << seconds * 1000.0
+                      << " ms (" << jobs.size() / seconds * 60.0 << " plots per minute)" << std::endl;
+        }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}